@@ -0,0 +1,315 @@
+#!/usr/bin/env python3
+"""
+acceptance filter planner for STM8 beCAN
+
+Packs a list of wanted standard (11-bit) and extended (29-bit) IDs into the
+6 filter banks of the beCAN and writes a C header with a const table for
+can_filter_set(), see ../can.h
+
+usage:
+  python3 can_filter.py bench.json [-o can_filter_bench.h]
+
+description format:
+  {
+    "name":    "bench",                         C identifier of table
+    "std":     [ "0x100", "0x101", 257 ],       wanted 11-bit IDs
+    "ext":     [ "0x18FEF100" ],                wanted 29-bit IDs
+    "banks":   6,                               available banks (optional, default 6)
+    "scale8":  true                             allow 8-bit scale (optional, default true)
+  }
+
+Filter types and capacity per bank:
+  std ID         16-bit list     4 IDs
+  std group      8-bit list      8 entries, each accepts 8 IDs (STID[10:3])
+  std pattern    8-bit mask      4 ID/mask pairs on STID[10:3]
+  std pattern    16-bit mask     2 ID/mask pairs
+  ext ID         32-bit list     2 IDs
+  ext pattern    32-bit mask     1 ID/mask pair
+
+Each wanted ID starts as exact (list) entry. Entries are then merged into
+masked patterns (greedy): merges without unwanted IDs, e.g. 8 consecutive
+IDs into one 8-bit list entry, are always done. If the entries still don't
+fit into the banks, in each step the merge with the fewest additionally
+accepted (unwanted) IDs per saved bank fraction is selected. The result is
+not guaranteed to be optimal, check the reported number of unwanted IDs.
+
+Notes:
+  - 8-bit scale compares STID[10:3] only, i.e. also accepts remote frames
+    and extended frames with matching EXID[28:21]. Disable via "scale8": false
+  - 16/32-bit entries accept data frames only (RTR = 0)
+"""
+
+import sys
+import os
+import json
+import argparse
+
+
+# number of filter banks of beCAN
+NUM_BANKS = 6
+
+# ID width and full care mask
+STD_BITS  = 11
+EXT_BITS  = 29
+STD_FULL  = (1 << STD_BITS) - 1
+EXT_FULL  = (1 << EXT_BITS) - 1
+
+# filter scale (CAN_FCRx.FSC) and mode names of can.h
+FSC_NAME = { 8: 'CAN_FSC_8', 16: 'CAN_FSC_16', 32: 'CAN_FSC_32' }
+FM_NAME  = { 0: 'CAN_FM_MASK', 1: 'CAN_FM_LIST_LOW', 2: 'CAN_FM_LIST_HIGH', 3: 'CAN_FM_LIST' }
+
+# entry types: (scale, list mode, entries per half bank). 32-bit types use full banks
+TYPES = {
+  'L8':  (8,  True,  4),
+  'M8':  (8,  False, 2),
+  'L16': (16, True,  2),
+  'M16': (16, False, 1),
+  'L32': (32, True,  1),
+  'M32': (32, False, 1),
+}
+
+
+class FilterError(Exception):
+  pass
+
+
+class Pattern:
+  """
+  ID pattern: ID matches if (ID & care) == value
+  """
+  def __init__(self, ext, value, care):
+    self.ext   = ext
+    self.care  = care
+    self.value = value & care
+
+  def width(self):
+    return EXT_BITS if self.ext else STD_BITS
+
+  def size(self):
+    """ number of IDs accepted """
+    return 1 << (self.width() - bin(self.care).count('1'))
+
+  def match(self, other):
+    """ pattern contains other pattern """
+    return self.ext == other.ext and (other.care & self.care) == self.care and (other.value & self.care) == self.value
+
+  def kind(self, scale8):
+    """ cheapest filter type """
+    if self.ext:
+      return 'L32' if self.care == EXT_FULL else 'M32'
+    if self.care == STD_FULL:
+      return 'L16'
+    if scale8 and (self.care & 0x07) == 0:
+      return 'L8' if self.care == 0x7F8 else 'M8'
+    return 'M16'
+
+  def text(self):
+    digits = 8 if self.ext else 3
+    if self.care == (EXT_FULL if self.ext else STD_FULL):
+      return '0x%0*X' % (digits, self.value)
+    return '0x%0*X/0x%0*X' % (digits, self.value, digits, self.care)
+
+
+def merge(a, b):
+  """ smallest pattern containing a and b """
+  care = a.care & b.care & ~(a.value ^ b.value)
+  return Pattern(a.ext, a.value, care)
+
+
+def count_banks(patterns, scale8):
+  """ number of banks required for patterns """
+  n = dict((t, 0) for t in TYPES)
+  for p in patterns:
+    n[p.kind(scale8)] += 1
+  ceil = lambda x, y: (x + y - 1) // y
+  h8  = ceil(n['L8'], 4) + ceil(n['M8'], 2)
+  h16 = ceil(n['L16'], 2) + n['M16']
+  return ceil(h8, 2) + ceil(h16, 2) + ceil(n['L32'], 2) + n['M32']
+
+
+def weight(patterns, scale8):
+  """ fractional bank usage """
+  w = 0.0
+  for p in patterns:
+    kind = p.kind(scale8)
+    if TYPES[kind][0] == 32:
+      w += 0.5 if kind == 'L32' else 1.0
+    else:
+      w += 1.0 / (2 * TYPES[kind][2])
+  return w
+
+
+def unwanted(p, wanted):
+  """ number of accepted but unwanted IDs of pattern """
+  return p.size() - sum(1 for w in wanted if p.match(w))
+
+
+def plan(std, ext, banks, scale8):
+  """
+  merge exact IDs into patterns until they fit into 'banks'. Return list of patterns
+  """
+  wanted = [Pattern(False, i, STD_FULL) for i in sorted(set(std))] + [Pattern(True, i, EXT_FULL) for i in sorted(set(ext))]
+  patterns = list(wanted)
+  if not patterns:
+    return [Pattern(False, 0, 0), Pattern(True, 0, 0)]
+
+  # merge without unwanted IDs first, then until patterns fit into banks
+  while True:
+    fits = count_banks(patterns, scale8) <= banks
+    w = weight(patterns, scale8)
+    # candidates: merge of 2 patterns, or std pattern reduced to STID[10:3] (8-bit scale)
+    candidates = []
+    for i in range(len(patterns)):
+      for j in range(i + 1, len(patterns)):
+        if patterns[i].ext == patterns[j].ext:
+          candidates.append(merge(patterns[i], patterns[j]))
+      p = patterns[i]
+      if scale8 and not p.ext and (p.care & 0x07):
+        candidates.append(Pattern(False, p.value, p.care & 0x7F8))
+
+    # select candidate with fewest unwanted IDs per saved bank fraction
+    best = None
+    for m in candidates:
+      rest = [p for p in patterns if not m.match(p)] + [m]
+      gain = w - weight(rest, scale8)
+      if gain <= 0:
+        continue
+      extra = unwanted(m, wanted) - sum(unwanted(p, wanted) for p in patterns if m.match(p))
+      if fits and extra > 0:
+        continue
+      key = (extra / gain, -gain)
+      if best is None or key < best[0]:
+        best = (key, rest)
+    if best is None:
+      break
+    patterns = best[1]
+
+  if count_banks(patterns, scale8) > banks:
+    raise FilterError('IDs do not fit into %d banks' % banks)
+  return patterns
+
+
+def encode(p, mask=False):
+  """ filter register bytes of pattern: 8-bit (1 byte), 16-bit std (2 bytes) or 32-bit ext (4 bytes) """
+  kind = p.kind(True)
+  v = p.care if mask else p.value
+  if not p.ext and kind in ('L8', 'M8'):
+    return [v >> 3]
+  if not p.ext:
+    # STID[10:3] | STID[2:0], RTR, IDE, EXID[17:15]. Mask: RTR and IDE compared
+    return [v >> 3, ((v & 0x07) << 5) | (0x18 if mask else 0x00)]
+  # STID[10:3] | STID[2:0], RTR, IDE, EXID[17:15] | EXID[14:7] | EXID[6:0], 0
+  return [(v >> 21) & 0xFF, (((v >> 18) & 0x07) << 5) | (0x18 if mask else 0x08) | ((v >> 15) & 0x07),
+          (v >> 7) & 0xFF, (v & 0x7F) << 1]
+
+
+def half(kind, entries):
+  """ 4 register bytes and description of half bank """
+  cap = TYPES[kind][2]
+  entries = entries + [entries[0]] * (cap - len(entries))
+  r = []
+  for p in entries:
+    r += encode(p) if TYPES[kind][1] else encode(p) + encode(p, mask=True)
+  return r, ', '.join(p.text() for p in entries[:cap])
+
+
+def build(patterns, scale8):
+  """ assign patterns to banks. Return list of (scale, fm, registers, comment) """
+  groups = dict((t, [p for p in patterns if p.kind(scale8) == t]) for t in TYPES)
+  result = []
+
+  # 8-bit and 16-bit scale: 2 halves per bank with independent mode
+  for scale, kinds in ((8, ('L8', 'M8')), (16, ('L16', 'M16'))):
+    halves = []
+    for kind in kinds:
+      cap = TYPES[kind][2]
+      for i in range(0, len(groups[kind]), cap):
+        halves.append((kind, groups[kind][i:i+cap]))
+    for i in range(0, len(halves), 2):
+      low = halves[i]
+      high = halves[i+1] if i + 1 < len(halves) else low
+      r_low, c_low = half(*low)
+      r_high, c_high = half(*high)
+      fm = (1 if TYPES[low[0]][1] else 0) | (2 if TYPES[high[0]][1] else 0)
+      comment = '%d-bit %s %s | %s %s' % (scale, 'list' if fm & 1 else 'mask', c_low, 'list' if fm & 2 else 'mask', c_high)
+      result.append((scale, fm, r_low + r_high, comment))
+
+  # 32-bit list: 2 IDs per bank
+  lst = groups['L32']
+  for i in range(0, len(lst), 2):
+    pair = lst[i:i+2] if i + 1 < len(lst) else [lst[i], lst[i]]
+    result.append((32, 3, encode(pair[0]) + encode(pair[1]), '32-bit list %s, %s' % (pair[0].text(), pair[1].text())))
+
+  # 32-bit mask: 1 pattern per bank. Std patterns (accept all) use IDE = don't care
+  for p in groups['M32']:
+    result.append((32, 0, encode(p) + encode(p, mask=True), '32-bit mask %s' % p.text()))
+  return result
+
+
+def write_header(f, name, src, banks, stats):
+  """ write C header with const filter table """
+  guard = '_CAN_FILTER_%s_H_' % name.upper()
+  f.write('/**\n')
+  f.write('  \\file can_filter_%s.h\n\n' % name)
+  f.write('  \\brief CAN acceptance filters \'%s\' (generated, do not edit)\n\n' % name)
+  f.write('  acceptance filters for beCAN, generated by Utils/can_filter.py from\n')
+  f.write('  %s. %s\n' % (os.path.basename(src), stats))
+  f.write('  Set via can_filter_set().\n')
+  f.write('*/\n\n')
+  f.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+  f.write('#include "can.h"\n\n')
+  f.write('/// number of filter banks \'%s\'\n' % name)
+  f.write('#define CAN_FILTER_%s_NUM   %d\n\n' % (name.upper(), len(banks)))
+  f.write('/// filter banks \'%s\'\n' % name)
+  f.write('static const can_filter_t can_filter_%s[CAN_FILTER_%s_NUM] = {\n' % (name, name.upper()))
+  for i, (scale, fm, r, comment) in enumerate(banks):
+    f.write('  { %-10s, %-16s, { %s } },   // bank %d: %s\n' % (FSC_NAME[scale], FM_NAME[fm], ', '.join('0x%02X' % b for b in r), i, comment))
+  f.write('};\n\n')
+  f.write('#endif // %s\n' % guard)
+
+
+def main():
+  parser = argparse.ArgumentParser(description='pack wanted CAN IDs into beCAN filter banks')
+  parser.add_argument('description', help='ID list (JSON)')
+  parser.add_argument('-o', '--output', help='output header (default: can_filter_<name>.h)')
+  args = parser.parse_args()
+
+  with open(args.description) as f:
+    desc = json.load(f)
+
+  try:
+    name   = desc['name']
+    std    = [int(str(i), 0) for i in desc.get('std', [])]
+    ext    = [int(str(i), 0) for i in desc.get('ext', [])]
+    banks  = int(desc.get('banks', NUM_BANKS))
+    scale8 = bool(desc.get('scale8', True))
+    for i in std:
+      if not 0 <= i <= STD_FULL:
+        raise FilterError('invalid std ID 0x%X' % i)
+    for i in ext:
+      if not 0 <= i <= EXT_FULL:
+        raise FilterError('invalid ext ID 0x%X' % i)
+    if not 1 <= banks <= NUM_BANKS:
+      raise FilterError('banks must be 1..%d' % NUM_BANKS)
+    patterns = plan(std, ext, banks, scale8)
+    table = build(patterns, scale8)
+  except (FilterError, KeyError, ValueError) as e:
+    sys.stderr.write('error: %s\n' % e)
+    sys.exit(1)
+
+  # statistics
+  wanted = [Pattern(False, i, STD_FULL) for i in set(std)] + [Pattern(True, i, EXT_FULL) for i in set(ext)]
+  extra_std = sum(unwanted(p, wanted) for p in patterns if not p.ext)
+  extra_ext = sum(unwanted(p, wanted) for p in patterns if p.ext)
+  stats = '%d std + %d ext IDs in %d banks, unwanted accepted: %d std, %d ext.' % (len(set(std)), len(set(ext)), len(table), extra_std, extra_ext)
+
+  out = args.output or 'can_filter_%s.h' % name
+  with open(out, 'w') as f:
+    write_header(f, name, args.description, table, stats)
+  for i, (scale, fm, r, comment) in enumerate(table):
+    print('  bank %d: %s' % (i, comment))
+  print('%s -> %s' % (stats, out))
+
+
+if __name__ == '__main__':
+  main()
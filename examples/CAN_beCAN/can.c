@@ -0,0 +1,630 @@
+/**
+  \file can.c
+
+  \author G. Icking-Konert
+  \date 2021-09-25
+  \version 0.1
+
+  \brief implementation of interrupt driven beCAN driver with software queues for STM8AF
+
+  implementation of beCAN initialization, acceptance filters, software Rx
+  ring buffer and Tx priority queue. For details see can.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "can.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// register pages (CAN_PSR)
+#define CAN_PAGE_TX0          0               ///< Tx mailbox 0
+#define CAN_PAGE_TX1          1               ///< Tx mailbox 1
+#define CAN_PAGE_FILTER       2               ///< filter banks 0/1, +1 per 2 banks
+#define CAN_PAGE_TX2          5               ///< Tx mailbox 2
+#define CAN_PAGE_CONFIG       6               ///< configuration and diagnosis
+#define CAN_PAGE_RXFIFO       7               ///< Rx FIFO output mailbox
+
+// bits in CAN_MCR
+#define CAN_MCR_INRQ          0x01            ///< initialization request
+#define CAN_MCR_ABOM          0x40            ///< automatic bus-off management
+
+// bits in CAN_RFR
+#define CAN_RFR_FMP           0x03            ///< number of messages in FIFO
+#define CAN_RFR_FULL          0x08            ///< FIFO full
+#define CAN_RFR_FOVR          0x10            ///< FIFO overrun
+#define CAN_RFR_RFOM          0x20            ///< release FIFO output mailbox
+
+// bits in CAN_IER
+#define CAN_IER_TMEIE         0x01            ///< Tx mailbox empty interrupt
+#define CAN_IER_FMPIE         0x02            ///< FIFO message pending interrupt
+#define CAN_IER_FOVIE         0x08            ///< FIFO overrun interrupt
+
+// bits in CAN_TSR (mailbox 0, shift for mailbox 1/2)
+#define CAN_TSR_RQCP0         0x01            ///< request completed
+#define CAN_TSR_TXOK0         0x10            ///< transmission ok
+
+// bits in CAN_MCSR
+#define CAN_MCSR_TXRQ         0x01            ///< transmit request
+#define CAN_MCSR_ABRQ         0x02            ///< abort request
+
+// bits in CAN_MIDR1
+#define CAN_MIDR1_RTR         0x20            ///< remote frame
+#define CAN_MIDR1_IDE         0x40            ///< extended ID
+
+// bits in CAN_FCRx (bank 0, shift by 4 for bank 1)
+#define CAN_FCR_FACT          0x01            ///< filter active
+
+// number of Tx mailboxes
+#define CAN_MAILBOXES         3
+
+// unused mailbox or slot
+#define CAN_NONE              0xFF
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// software Rx ring buffer. Written by Rx ISR, read by can_receive()
+static can_msg_t          m_rxBuf[CAN_RX_SIZE];
+static volatile uint8_t   m_rxHead = 0;
+static volatile uint8_t   m_rxTail = 0;
+
+/// Tx message slots with arbitration key. Slot is used until message is sent
+static can_msg_t          m_txMsg[CAN_TX_SIZE];
+static uint32_t           m_txKey[CAN_TX_SIZE];
+
+/// queued slots sorted by priority (highest first), and free slots
+static uint8_t            m_txOrder[CAN_TX_SIZE];
+static uint8_t            m_txNum = 0;
+static uint8_t            m_txFree[CAN_TX_SIZE];
+static uint8_t            m_txFreeNum = 0;
+
+/// slot in Tx mailbox 0..2, or CAN_NONE
+static uint8_t            m_mbxSlot[CAN_MAILBOXES];
+
+/// mailboxes with pending abort request (bit 0..2)
+static uint8_t            m_mbxAbort = 0;
+
+/// register page of Tx mailbox 0..2
+static const uint8_t      m_mbxPage[CAN_MAILBOXES] = { CAN_PAGE_TX0, CAN_PAGE_TX1, CAN_PAGE_TX2 };
+
+/// filter accepting all messages: 32-bit mask mode, mask = 0
+static const can_filter_t m_acceptAll = { CAN_FSC_32, CAN_FM_MASK, { 0, 0, 0, 0, 0, 0, 0, 0 } };
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint32_t can_key(uint32_t id)
+
+  \brief arbitration key of ID
+
+  \param[in]  id    ID with CAN_ID_EXT / CAN_ID_RTR flags
+
+  \return key, lower value wins arbitration
+
+  order of bits on bus: base ID (11), RTR (std) or SRR=1 (ext), IDE, ID
+  extension (18), RTR (ext). I.e. std data < std remote < ext with same base ID.
+*/
+static uint32_t can_key(uint32_t id) {
+
+  uint32_t  key;
+
+  if (id & CAN_ID_EXT) {
+    key  = (id & 0x1FFC0000L) << 3;                 // base ID -> bits 31..21
+    key |= 0x00180000L;                             // SRR, IDE
+    key |= (id & 0x0003FFFFL) << 1;                 // ID extension
+    if (id & CAN_ID_RTR)
+      key |= 0x01;
+  }
+  else {
+    key = (id & 0x07FFL) << 21;
+    if (id & CAN_ID_RTR)
+      key |= 0x00100000L;
+  }
+
+  return(key);
+
+} // can_key
+
+
+
+/**
+  \fn void can_tx_insert(uint8_t slot, uint8_t requeue)
+
+  \brief insert slot into Tx queue
+
+  \param[in]  slot      Tx slot
+  \param[in]  requeue   1 = aborted message, 0 = new message
+
+  insert new message behind all messages with same or higher priority, and
+  aborted message ahead of messages with same priority (they are newer),
+  i.e. messages with same ID are sent in order. Must be called with
+  interrupts disabled.
+*/
+static void can_tx_insert(uint8_t slot, uint8_t requeue) {
+
+  uint8_t   i = m_txNum;
+  uint32_t  key = m_txKey[slot];
+
+  while ((i > 0) && ((m_txKey[m_txOrder[i-1]] > key) || (requeue && (m_txKey[m_txOrder[i-1]] == key)))) {
+    m_txOrder[i] = m_txOrder[i-1];
+    i--;
+  }
+  m_txOrder[i] = slot;
+  m_txNum++;
+
+} // can_tx_insert
+
+
+
+/**
+  \fn uint8_t can_tx_next(void)
+
+  \brief next queued message which may be loaded into a mailbox
+
+  \return index in m_txOrder, or CAN_NONE
+
+  first queued message whose ID is not in a mailbox. With TXFP=0 mailboxes
+  with same ID are sent by mailbox number, i.e. a newer message in a lower
+  mailbox would overtake an older one. Must be called with interrupts disabled.
+*/
+static uint8_t can_tx_next(void) {
+
+  uint8_t   i, mbx;
+  uint32_t  key;
+
+  for (i=0; i<m_txNum; i++) {
+    key = m_txKey[m_txOrder[i]];
+    for (mbx=0; mbx<CAN_MAILBOXES; mbx++) {
+      if ((m_mbxSlot[mbx] != CAN_NONE) && (m_txKey[m_mbxSlot[mbx]] == key))
+        break;
+    }
+    if (mbx == CAN_MAILBOXES)
+      return(i);
+  }
+
+  return(CAN_NONE);
+
+} // can_tx_next
+
+
+
+/**
+  \fn void can_tx_fill(void)
+
+  \brief load empty Tx mailboxes from queue
+
+  load highest priority messages into empty mailboxes and request
+  transmission. Messages with an ID already in a mailbox wait, see
+  can_tx_next(). If all mailboxes are busy and the next message has a higher
+  priority than the lowest mailbox, abort that mailbox. It is re-queued in
+  the Tx ISR. Must be called with interrupts disabled, changes CAN_PSR.
+*/
+static void can_tx_fill(void) {
+
+  uint8_t           mbx, slot, i, pos, lowest;
+  volatile uint8_t  *data;
+  const can_msg_t   *msg;
+  uint32_t          id;
+
+  // load empty mailboxes
+  for (mbx=0; (mbx<CAN_MAILBOXES) && (m_txNum > 0); mbx++) {
+    if (m_mbxSlot[mbx] != CAN_NONE)
+      continue;
+
+    // remove next message from queue
+    pos = can_tx_next();
+    if (pos == CAN_NONE)
+      return;
+    slot = m_txOrder[pos];
+    m_txNum--;
+    for (i=pos; i<m_txNum; i++)
+      m_txOrder[i] = m_txOrder[i+1];
+    m_mbxSlot[mbx] = slot;
+
+    // write ID, DLC and data to mailbox page
+    msg = &(m_txMsg[slot]);
+    id  = msg->id;
+    sfr_CAN.PSR.byte = m_mbxPage[mbx];
+    if (id & CAN_ID_EXT) {
+      sfr_CAN.MIDR1.byte = (uint8_t) (CAN_MIDR1_IDE | ((uint8_t) (id >> 24) & 0x1F));
+      sfr_CAN.MIDR2.byte = (uint8_t) (id >> 16);
+      sfr_CAN.MIDR3.byte = (uint8_t) (id >> 8);
+      sfr_CAN.MIDR4.byte = (uint8_t) id;
+    }
+    else {
+      sfr_CAN.MIDR1.byte = (uint8_t) (((uint16_t) id >> 6) & 0x1F);
+      sfr_CAN.MIDR2.byte = (uint8_t) ((uint16_t) id << 2);
+    }
+    if (id & CAN_ID_RTR)
+      sfr_CAN.MIDR1.byte |= CAN_MIDR1_RTR;
+    sfr_CAN.MDLCR.byte = msg->dlc;
+    data = &(sfr_CAN.MDAR1.byte);
+    for (i=0; i<msg->dlc; i++)
+      data[i] = msg->data[i];
+
+    // request transmission
+    sfr_CAN.MCSR.byte = CAN_MCSR_TXRQ;
+
+  } // loop over mailboxes
+
+  // all mailboxes busy -> avoid priority inversion
+  if ((m_txNum == 0) || (m_mbxAbort != 0))
+    return;
+  lowest = 0;
+  for (mbx=0; mbx<CAN_MAILBOXES; mbx++) {
+    if (m_mbxSlot[mbx] == CAN_NONE)
+      return;
+    if (m_txKey[m_mbxSlot[mbx]] > m_txKey[m_mbxSlot[lowest]])
+      lowest = mbx;
+  }
+  pos = can_tx_next();
+  if ((pos != CAN_NONE) && (m_txKey[m_txOrder[pos]] < m_txKey[m_mbxSlot[lowest]])) {
+    sfr_CAN.PSR.byte = m_mbxPage[lowest];
+    sfr_CAN.MCSR.byte = CAN_MCSR_ABRQ;
+    m_mbxAbort = (uint8_t) (1 << lowest);
+    g_canTxAbort++;
+  }
+
+} // can_tx_fill
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint8_t can_init(uint8_t btr1, uint8_t btr2, uint8_t mode)
+
+  \brief init beCAN
+
+  \param[in]  btr1    bit timing register 1, e.g. CAN_BTR1_500K
+  \param[in]  btr2    bit timing register 2, e.g. CAN_BTR2_500K
+  \param[in]  mode    CAN_MODE_NORMAL, CAN_MODE_LOOPBACK or CAN_MODE_SILENT
+
+  \return 1 on success, 0 on timeout (e.g. no bus connected)
+
+  enter initialization mode, set bit timing and mode, accept all messages,
+  clear queues and start the controller. Tx priority by ID, automatic
+  bus-off recovery. Interrupts must be enabled by application.
+*/
+uint8_t can_init(uint8_t btr1, uint8_t btr2, uint8_t mode) {
+
+  uint16_t  timeout;
+  uint8_t   i;
+
+  // enable CAN clock (PCKENR2 bit 7)
+  sfr_CLK.PCKENR2.byte |= 0x80;
+
+  // request initialization mode, leave sleep mode
+  sfr_CAN.IER.byte = 0x00;
+  sfr_CAN.MCR.byte = CAN_MCR_INRQ;
+  for (timeout=0xFFFF; (!sfr_CAN.MSR.INAK) && (timeout); timeout--);
+  if (!sfr_CAN.MSR.INAK)
+    return(0);
+
+  // Tx priority by ID (TXFP=0), FIFO not locked (RFLM=0), automatic retransmission and bus-off recovery
+  sfr_CAN.MCR.byte = CAN_MCR_INRQ | CAN_MCR_ABOM;
+  sfr_CAN.DGR.byte = mode;
+
+  // bit timing
+  sfr_CAN.PSR.byte  = CAN_PAGE_CONFIG;
+  sfr_CAN.BTR1.byte = btr1;
+  sfr_CAN.BTR2.byte = btr2;
+
+  // clear software queues
+  m_rxHead = m_rxTail = 0;
+  m_txNum = 0;
+  for (i=0; i<CAN_TX_SIZE; i++)
+    m_txFree[i] = i;
+  m_txFreeNum = CAN_TX_SIZE;
+  for (i=0; i<CAN_MAILBOXES; i++)
+    m_mbxSlot[i] = CAN_NONE;
+  m_mbxAbort = 0;
+
+  // accept all messages
+  can_filter_set(&m_acceptAll, 1);
+
+  // leave initialization mode. Requires 11 recessive bits on bus
+  sfr_CAN.MCR.byte = CAN_MCR_ABOM;
+  for (timeout=0xFFFF; (sfr_CAN.MSR.INAK) && (timeout); timeout--);
+  if (sfr_CAN.MSR.INAK)
+    return(0);
+
+  // enable Rx pending, Rx overrun and Tx mailbox empty interrupts
+  sfr_CAN.IER.byte = CAN_IER_FMPIE | CAN_IER_FOVIE | CAN_IER_TMEIE;
+
+  return(1);
+
+} // can_init
+
+
+
+/**
+  \fn void can_filter_set(const can_filter_t *banks, uint8_t num)
+
+  \brief set acceptance filters
+
+  \param[in]  banks   table of filter banks, e.g. generated by Utils/can_filter.py
+  \param[in]  num     number of banks 1..CAN_FILTER_BANKS
+
+  deactivate all banks, write filter registers, mode and scale, then activate
+  the given banks. Banks > num remain inactive. Messages are not received
+  during reconfiguration.
+*/
+void can_filter_set(const can_filter_t *banks, uint8_t num) {
+
+  volatile uint8_t  *r;
+  uint8_t           psr, i, j;
+  uint8_t           fcr[3] = { 0, 0, 0 };
+  uint8_t           fmr[2] = { 0, 0 };
+
+  // limit to available banks
+  if (num > CAN_FILTER_BANKS)
+    num = CAN_FILTER_BANKS;
+
+  // deactivate all banks
+  psr = sfr_CAN.PSR.byte;
+  sfr_CAN.PSR.byte  = CAN_PAGE_CONFIG;
+  sfr_CAN.FCR1.byte = 0x00;
+  sfr_CAN.FCR2.byte = 0x00;
+  sfr_CAN.FCR3.byte = 0x00;
+
+  // write filter registers. 2 banks per page: even bank FxR1..8 at 0x5428, odd bank at 0x5430
+  for (i=0; i<num; i++) {
+    sfr_CAN.PSR.byte = (uint8_t) (CAN_PAGE_FILTER + (i >> 1));
+    r = &(sfr_CAN.F0R1.byte) + ((i & 0x01) << 3);
+    for (j=0; j<8; j++)
+      r[j] = banks[i].r[j];
+    fcr[i >> 1] |= (uint8_t) ((CAN_FCR_FACT | ((banks[i].fsc & 0x03) << 1)) << ((i & 0x01) << 2));
+    fmr[i >> 2] |= (uint8_t) ((banks[i].fm & 0x03) << ((i & 0x03) << 1));
+  }
+
+  // set mode, then scale and activate
+  sfr_CAN.PSR.byte  = CAN_PAGE_CONFIG;
+  sfr_CAN.FMR1.byte = fmr[0];
+  sfr_CAN.FMR2.byte = fmr[1];
+  sfr_CAN.FCR1.byte = fcr[0];
+  sfr_CAN.FCR2.byte = fcr[1];
+  sfr_CAN.FCR3.byte = fcr[2];
+  sfr_CAN.PSR.byte  = psr;
+
+} // can_filter_set
+
+
+
+/**
+  \fn uint8_t can_send(const can_msg_t *msg)
+
+  \brief queue message for transmission
+
+  \param[in]  msg     message to send
+
+  \return 1 on success, 0 if Tx queue is full
+
+  copy message into a free slot, insert it into the priority queue and load
+  empty mailboxes. Must not be called from ISR.
+*/
+uint8_t can_send(const can_msg_t *msg) {
+
+  uint8_t   slot, psr, i;
+
+  DISABLE_INTERRUPTS();
+
+  // no free slot
+  if (m_txFreeNum == 0) {
+    ENABLE_INTERRUPTS();
+    return(0);
+  }
+
+  // copy message and queue it
+  slot = m_txFree[--m_txFreeNum];
+  m_txMsg[slot].id  = msg->id;
+  m_txMsg[slot].dlc = (msg->dlc > 8) ? 8 : msg->dlc;
+  for (i=0; i<m_txMsg[slot].dlc; i++)
+    m_txMsg[slot].data[i] = msg->data[i];
+  m_txKey[slot] = can_key(msg->id);
+  can_tx_insert(slot, 0);
+
+  // load empty mailboxes
+  psr = sfr_CAN.PSR.byte;
+  can_tx_fill();
+  sfr_CAN.PSR.byte = psr;
+
+  ENABLE_INTERRUPTS();
+
+  return(1);
+
+} // can_send
+
+
+
+/**
+  \fn uint8_t can_receive(can_msg_t *msg)
+
+  \brief get received message
+
+  \param[out] msg     received message
+
+  \return 1 if a message was copied, 0 if buffer is empty
+*/
+uint8_t can_receive(can_msg_t *msg) {
+
+  uint8_t   tail = m_rxTail;
+
+  if (tail == m_rxHead)
+    return(0);
+
+  *msg = m_rxBuf[tail];
+  m_rxTail = (uint8_t) ((tail + 1) & (CAN_RX_SIZE - 1));
+
+  return(1);
+
+} // can_receive
+
+
+
+/**
+  \fn uint8_t can_available(void)
+
+  \brief number of received messages
+
+  \return number of messages in software Rx buffer
+*/
+uint8_t can_available(void) {
+
+  return((uint8_t) ((m_rxHead - m_rxTail) & (CAN_RX_SIZE - 1)));
+
+} // can_available
+
+
+
+/**
+  \fn uint8_t can_pending(void)
+
+  \brief number of messages to send
+
+  \return number of messages in Tx queue and mailboxes
+*/
+uint8_t can_pending(void) {
+
+  return((uint8_t) (CAN_TX_SIZE - m_txFreeNum));
+
+} // can_pending
+
+
+
+/**
+  \fn void CAN_RX_ISR(void)
+
+  \brief ISR for Rx FIFO message pending and overrun
+
+  copy all messages from hardware FIFO into software ring buffer. The FIFO
+  page is selected once, the previous page is restored at exit. If the ring
+  is full, messages are dropped and counted.
+*/
+ISR_HANDLER(CAN_RX_ISR, _CAN_FMP_VECTOR_) {
+
+  uint8_t           psr, next, idr, dlc, i;
+  volatile uint8_t  *data;
+  can_msg_t         *msg;
+
+  // select FIFO page
+  psr = sfr_CAN.PSR.byte;
+  sfr_CAN.PSR.byte = CAN_PAGE_RXFIFO;
+
+  // copy all pending messages
+  while (sfr_CAN.RFR.byte & CAN_RFR_FMP) {
+
+    next = (uint8_t) ((m_rxHead + 1) & (CAN_RX_SIZE - 1));
+
+    // ring full -> drop message
+    if (next == m_rxTail) {
+      if (g_canRxLost != 0xFFFF)
+        g_canRxLost++;
+    }
+
+    // copy message
+    else {
+      msg = &(m_rxBuf[m_rxHead]);
+      idr = sfr_CAN.MIDR1.byte;
+      if (idr & CAN_MIDR1_IDE) {
+        msg->id = CAN_ID_EXT | ((uint32_t) (idr & 0x1F) << 24) | ((uint32_t) sfr_CAN.MIDR2.byte << 16) |
+                  ((uint16_t) sfr_CAN.MIDR3.byte << 8) | sfr_CAN.MIDR4.byte;
+      }
+      else
+        msg->id = ((uint16_t) (idr & 0x1F) << 6) | (sfr_CAN.MIDR2.byte >> 2);
+      if (idr & CAN_MIDR1_RTR)
+        msg->id |= CAN_ID_RTR;
+      dlc = sfr_CAN.MDLCR.DLC;
+      if (dlc > 8)
+        dlc = 8;
+      msg->dlc = dlc;
+      data = &(sfr_CAN.MDAR1.byte);
+      for (i=0; i<dlc; i++)
+        msg->data[i] = data[i];
+      m_rxHead = next;
+
+      // track max. fill level
+      i = (uint8_t) ((next - m_rxTail) & (CAN_RX_SIZE - 1));
+      if (i > g_canRxMax)
+        g_canRxMax = i;
+    }
+
+    // release FIFO output mailbox
+    sfr_CAN.RFR.byte = CAN_RFR_RFOM;
+    while (sfr_CAN.RFR.byte & CAN_RFR_RFOM);
+
+  } // while FIFO not empty
+
+  // FIFO overrun -> count and clear (write 1)
+  if (sfr_CAN.RFR.byte & CAN_RFR_FOVR) {
+    g_canRxOvr++;
+    sfr_CAN.RFR.byte = CAN_RFR_FOVR | CAN_RFR_FULL;
+  }
+
+  // restore page
+  sfr_CAN.PSR.byte = psr;
+
+} // CAN_RX_ISR
+
+
+
+/**
+  \fn void CAN_TX_ISR(void)
+
+  \brief ISR for Tx mailbox empty
+
+  release completed mailboxes. Sent messages free their slot, aborted
+  messages are re-queued. Then refill the mailboxes from the queue. The
+  previous page is restored at exit.
+*/
+ISR_HANDLER(CAN_TX_ISR, _CAN_RQCP0_VECTOR_) {
+
+  uint8_t   psr, tsr, mbx, slot;
+
+  psr = sfr_CAN.PSR.byte;
+  tsr = sfr_CAN.TSR.byte;
+
+  // release completed mailboxes
+  for (mbx=0; mbx<CAN_MAILBOXES; mbx++) {
+    if (!(tsr & (CAN_TSR_RQCP0 << mbx)))
+      continue;
+
+    // clear RQCPx and TXOKx (write 1)
+    sfr_CAN.TSR.byte = (uint8_t) (CAN_TSR_RQCP0 << mbx);
+    m_mbxAbort &= (uint8_t) ~(1 << mbx);
+    slot = m_mbxSlot[mbx];
+    m_mbxSlot[mbx] = CAN_NONE;
+    if (slot == CAN_NONE)
+      continue;
+
+    // sent -> free slot, else (aborted) -> re-queue
+    if (tsr & (CAN_TSR_TXOK0 << mbx))
+      m_txFree[m_txFreeNum++] = slot;
+    else
+      can_tx_insert(slot, 1);
+
+  } // loop over mailboxes
+
+  // refill mailboxes
+  can_tx_fill();
+
+  // restore page
+  sfr_CAN.PSR.byte = psr;
+
+} // CAN_TX_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,186 @@
+/**
+  \file can.h
+
+  \author G. Icking-Konert
+  \date 2021-09-25
+  \version 0.1
+
+  \brief declaration of interrupt driven beCAN driver with software queues for STM8AF
+
+  declaration of a driver for the beCAN controller of STM8AF52xx/STM8AF62xx.
+  The hardware has a receive FIFO of only 3 messages, i.e. at 500kBaud frames
+  are lost if the main loop is busy for >0.7ms. Therefore:
+
+    - Rx: the FIFO pending interrupt copies all messages from the hardware
+      FIFO into a software ring buffer of CAN_RX_SIZE messages. The main loop
+      reads them via can_receive()
+    - Tx: can_send() inserts the message into a software queue sorted by
+      arbitration priority (lowest ID first). The 3 transmit mailboxes are
+      refilled from the queue head in the mailbox empty interrupt, and the
+      mailbox with the lowest ID is sent first (MCR.TXFP=0). If all mailboxes
+      are busy with lower priority messages, the lowest is aborted and
+      re-queued, i.e. no priority inversion. Only one message per ID is in
+      the mailboxes, i.e. messages with same ID are sent in order
+
+  Most beCAN registers are paged (CAN_PSR): page 0/1/5 = Tx mailbox 0/1/2,
+  2..4 = filter banks, 6 = configuration, 7 = Rx FIFO. The ISRs switch the
+  page once per call and restore the previous page at exit, i.e. main code
+  does not have to lock interrupts around paged accesses.
+
+  Acceptance filters are set via can_filter_set() from a table generated by
+  the filter planner Utils/can_filter.py.
+
+  Example:
+    can_init(CAN_BTR1_500K, CAN_BTR2_500K, CAN_MODE_NORMAL);
+    can_filter_set(can_filter_bench, CAN_FILTER_BENCH_NUM);
+    can_send(&tx);
+    if (can_receive(&rx))
+      ...
+
+  \note CAN_TX = PG0, CAN_RX = PG1
+  \note for 500kBaud on a real bus an HSE crystal is required, the HSI is not accurate enough
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CAN_H_
+#define _CAN_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// size of software Rx ring buffer [messages] (2^n); can be overwritten via compiler option
+#ifndef CAN_RX_SIZE
+  #define CAN_RX_SIZE           32
+#endif
+
+// size of software Tx priority queue [messages]; can be overwritten via compiler option
+#ifndef CAN_TX_SIZE
+  #define CAN_TX_SIZE           16
+#endif
+
+// CAN clock = fMASTER [Hz]; can be overwritten via compiler option
+#ifndef CAN_CLK
+  #define CAN_CLK               16000000L
+#endif
+
+// flags in can_msg_t.id
+#define CAN_ID_EXT              0x80000000L   ///< 29-bit extended ID
+#define CAN_ID_RTR              0x40000000L   ///< remote frame
+#define CAN_ID_MASK             0x1FFFFFFFL   ///< ID bits
+
+// bit timing: BRP = prescaler (1..64), SJW = 1..4 tq, BS1 = 1..16 tq, BS2 = 1..8 tq
+#define CAN_BTR1(brp, sjw)      ((uint8_t) ((((sjw)-1) << 6) | ((brp)-1)))
+#define CAN_BTR2(bs1, bs2)      ((uint8_t) ((((bs2)-1) << 4) | ((bs1)-1)))
+
+// 500kBaud: 16 tq per bit (1 + 13 + 2), sample point 87.5%
+#define CAN_BTR1_500K           CAN_BTR1(CAN_CLK/8000000L, 1)
+#define CAN_BTR2_500K           CAN_BTR2(13, 2)
+
+// 250kBaud / 125kBaud: same segments, larger prescaler
+#define CAN_BTR1_250K           CAN_BTR1(CAN_CLK/4000000L, 1)
+#define CAN_BTR2_250K           CAN_BTR2_500K
+#define CAN_BTR1_125K           CAN_BTR1(CAN_CLK/2000000L, 1)
+#define CAN_BTR2_125K           CAN_BTR2_500K
+
+// operating modes for can_init() (CAN_DGR)
+#define CAN_MODE_NORMAL         0x00          ///< normal operation
+#define CAN_MODE_LOOPBACK       0x03          ///< loop back + silent: self test w/o bus
+#define CAN_MODE_SILENT         0x02          ///< listen only, no acknowledge
+
+// filter scale for can_filter_t.fsc (CAN_FCRx.FSC)
+#define CAN_FSC_8               0             ///< 8-bit: STID[10:3] only
+#define CAN_FSC_16_8            1             ///< 16-bit + 8-bit
+#define CAN_FSC_16              2             ///< 16-bit: STID, RTR, IDE, EXID[17:15]
+#define CAN_FSC_32              3             ///< 32-bit: STID/EXID, RTR, IDE
+
+// filter mode for can_filter_t.fm (CAN_FMRx)
+#define CAN_FM_MASK             0x00          ///< both halves mask mode
+#define CAN_FM_LIST_LOW         0x01          ///< low half (R1..R4) list mode
+#define CAN_FM_LIST_HIGH        0x02          ///< high half (R5..R8) list mode
+#define CAN_FM_LIST             0x03          ///< both halves list mode
+
+// number of filter banks
+#define CAN_FILTER_BANKS        6
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// CAN message
+typedef struct {
+  uint32_t  id;                   ///< 11-bit or 29-bit ID, or'ed with CAN_ID_EXT and CAN_ID_RTR
+  uint8_t   dlc;                  ///< data length 0..8
+  uint8_t   data[8];              ///< data bytes
+} can_msg_t;
+
+/// configuration of 1 filter bank, e.g. generated by Utils/can_filter.py
+typedef struct {
+  uint8_t   fsc;                  ///< scale CAN_FSC_xx
+  uint8_t   fm;                   ///< mode CAN_FM_xx
+  uint8_t   r[8];                 ///< filter registers FxR1..FxR8
+} can_filter_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint16_t g_canRxLost = 0;            ///< messages dropped, software Rx buffer full
+  volatile uint16_t g_canRxOvr = 0;             ///< hardware FIFO overruns (message lost before ISR)
+  volatile uint8_t  g_canRxMax = 0;             ///< max. fill level of software Rx buffer
+  volatile uint16_t g_canTxAbort = 0;           ///< mailboxes aborted for higher priority message
+#else // _MAIN_
+  extern volatile uint16_t g_canRxLost;
+  extern volatile uint16_t g_canRxOvr;
+  extern volatile uint8_t  g_canRxMax;
+  extern volatile uint16_t g_canTxAbort;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init beCAN with bit timing and CAN_MODE_xx, accept all messages. Return 0 on timeout
+uint8_t   can_init(uint8_t btr1, uint8_t btr2, uint8_t mode);
+
+/// set acceptance filters from table of 'num' banks (max. CAN_FILTER_BANKS)
+void      can_filter_set(const can_filter_t *banks, uint8_t num);
+
+/// queue message for transmission. Return 0 if queue is full
+uint8_t   can_send(const can_msg_t *msg);
+
+/// get received message. Return 0 if none is available
+uint8_t   can_receive(can_msg_t *msg);
+
+/// return number of messages in software Rx buffer
+uint8_t   can_available(void);
+
+/// return number of messages in Tx queue and mailboxes
+uint8_t   can_pending(void);
+
+/// ISR for Rx FIFO message pending and overrun
+ISR_HANDLER(CAN_RX_ISR, _CAN_FMP_VECTOR_);
+
+/// ISR for Tx mailbox empty
+ISR_HANDLER(CAN_TX_ISR, _CAN_RQCP0_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CAN_H_
@@ -0,0 +1,28 @@
+/**
+  \file can_filter_bench.h
+
+  \brief CAN acceptance filters 'bench' (generated, do not edit)
+
+  acceptance filters for beCAN, generated by Utils/can_filter.py from
+  bench.json. 17 std + 4 ext IDs in 5 banks, unwanted accepted: 0 std, 0 ext.
+  Set via can_filter_set().
+*/
+
+#ifndef _CAN_FILTER_BENCH_H_
+#define _CAN_FILTER_BENCH_H_
+
+#include "can.h"
+
+/// number of filter banks 'bench'
+#define CAN_FILTER_BENCH_NUM   5
+
+/// filter banks 'bench'
+static const can_filter_t can_filter_bench[CAN_FILTER_BENCH_NUM] = {
+  { CAN_FSC_8 , CAN_FM_LIST     , { 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20 } },   // bank 0: 8-bit list 0x100/0x7F8, 0x100/0x7F8, 0x100/0x7F8, 0x100/0x7F8 | list 0x100/0x7F8, 0x100/0x7F8, 0x100/0x7F8, 0x100/0x7F8
+  { CAN_FSC_16, CAN_FM_LIST     , { 0x7C, 0x00, 0x7C, 0x20, 0xFB, 0xE0, 0xFC, 0x00 } },   // bank 1: 16-bit list 0x3E0, 0x3E1 | list 0x7DF, 0x7E0
+  { CAN_FSC_16, CAN_FM_LIST_LOW , { 0xFD, 0x00, 0xFD, 0x00, 0x40, 0x00, 0xF9, 0xF8 } },   // bank 2: 16-bit list 0x7E8, 0x7E8 | mask 0x200/0x7CF
+  { CAN_FSC_32, CAN_FM_LIST     , { 0xC6, 0xCC, 0x21, 0xE2, 0xC6, 0xCD, 0xE2, 0x20 } },   // bank 3: 32-bit list 0x18DA10F1, 0x18DAF110
+  { CAN_FSC_32, CAN_FM_LIST     , { 0xC7, 0xED, 0xE2, 0x00, 0xC7, 0xED, 0xE4, 0x00 } },   // bank 4: 32-bit list 0x18FEF100, 0x18FEF200
+};
+
+#endif // _CAN_FILTER_BENCH_H_
@@ -0,0 +1,29 @@
+/**
+  \file config.h
+   
+  \brief set project configurations
+   
+  set project configurations like used device or board etc.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "../../include/STM8AF5288.h"
+
+// UART for printf()
+#define sfr_UART             sfr_USART
+#define _UART_RXNE_VECTOR_   _USART_R_RXNE_VECTOR_
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CONFIG_H_
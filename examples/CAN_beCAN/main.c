@@ -0,0 +1,183 @@
+/**********************
+  Interrupt driven beCAN driver with software queues and sustained frame rate benchmark
+
+  supported hardware:
+    - STM8AF5288 (e.g. STM8A Discovery board), other STM8AF52xx/STM8S208 with beCAN
+
+  Functionality:
+    - init beCAN for 500kBaud in loop back mode, i.e. w/o bus and transceiver
+    - set acceptance filters from can_filter_bench.h (generated by Utils/can_filter.py from bench.json)
+    - keep Tx queue full with 8-byte data frames. IDs cycle through a table of
+      wanted and unwanted IDs. Wanted frames carry a sequence number per ID
+    - received frames are checked for sequence gaps (=dropped frames) and unwanted IDs (=filter error)
+    - every 100ms the main loop is blocked for BENCH_BUSY ms to simulate load
+    - every 1s print frame rates and driver statistics via UART (19.2kBaud)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "timer4.h"
+  #include "uart.h"
+  #include "can.h"
+#undef _MAIN_
+#include "can_filter_bench.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define BENCH_BUSY      3             // main loop blocked every 100ms [ms]. At 500kBaud ~4 frames/ms
+#define BENCH_IDS       (sizeof(m_benchId)/sizeof(m_benchId[0]))
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// IDs sent in benchmark. Must match bench.json
+static const uint32_t m_benchId[] = {
+  0x100, 0x105, 0x210, 0x3E1, 0x7DF, 0x7E8,
+  CAN_ID_EXT | 0x18FEF100L, CAN_ID_EXT | 0x18DAF110L,
+  0x555, CAN_ID_EXT | 0x18FEF300L                         // not in bench.json -> rejected by filter
+};
+
+/// IDs of m_benchId[] accepted by filter
+#define BENCH_WANTED    8
+
+/// next sequence number to send / expected per ID
+static uint8_t  m_txSeq[BENCH_IDS];
+static uint8_t  m_rxSeq[BENCH_IDS];
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  can_msg_t   tx, rx;
+  uint8_t     idx = 0, i;
+  uint32_t    nextBusy = 100, nextPrint = 1000, t;
+  uint16_t    numTx = 0, numRx = 0, numGap = 0, numLeak = 0;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // init 1ms interrupt
+  TIM4_init();
+
+  // init CAN for 500kBaud in loop back mode and set filters
+  if (!can_init(CAN_BTR1_500K, CAN_BTR2_500K, CAN_MODE_LOOPBACK)) {
+    ENABLE_INTERRUPTS();
+    printf("\nCAN init failed\n");
+    while (1);
+  }
+  can_filter_set(can_filter_bench, CAN_FILTER_BENCH_NUM);
+
+  // init test frames
+  for (i=0; i<BENCH_IDS; i++)
+    m_txSeq[i] = m_rxSeq[i] = 0;
+  tx.dlc = 8;
+  for (i=0; i<8; i++)
+    tx.data[i] = i;
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  printf("\nCAN benchmark 500kBaud, %d filter banks, load %dms/100ms\n", (int) CAN_FILTER_BENCH_NUM, (int) BENCH_BUSY);
+
+
+  // main loop
+  while(1) {
+
+    // keep Tx queue full. data[0] = ID index, data[1] = sequence number per ID
+    do {
+      tx.id      = m_benchId[idx];
+      tx.data[0] = idx;
+      tx.data[1] = m_txSeq[idx];
+      if (!can_send(&tx))
+        break;
+      m_txSeq[idx]++;
+      numTx++;
+      if (++idx >= BENCH_IDS)
+        idx = 0;
+    } while (1);
+
+    // check received frames
+    while (can_receive(&rx)) {
+      numRx++;
+      i = rx.data[0];
+      if ((i >= BENCH_WANTED) || (rx.id != m_benchId[i]))
+        numLeak++;
+      else {
+        if (rx.data[1] != m_rxSeq[i])
+          numGap++;
+        m_rxSeq[i] = (uint8_t) (rx.data[1] + 1);
+      }
+    }
+
+    // simulate load: block main loop
+    if (g_millis >= nextBusy) {
+      nextBusy += 100;
+      t = g_millis + BENCH_BUSY;
+      while (g_millis < t);
+    }
+
+    // print statistics every 1s
+    if (g_millis >= nextPrint) {
+      nextPrint += 1000;
+      printf("tx %u/s, rx %u/s, gaps %u, leaks %u | lost %u, ovr %u, max %d/%d, abort %u\n",
+        numTx, numRx, numGap, numLeak, g_canRxLost, g_canRxOvr, (int) g_canRxMax, (int) CAN_RX_SIZE, g_canTxAbort);
+      numTx = numRx = numGap = numLeak = 0;
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,390 @@
+/**
+  \file comp.c
+
+  \author G. Icking-Konert
+  \date 2021-08-21
+  \version 0.1
+
+  \brief implementation of comparator service with routing interface and timestamped events for STM8L
+
+  implementation of COMP1/COMP2 configuration, RI input routing, hardware
+  output routing to timers and timestamped event FIFO. For details see comp.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "comp.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// comparator module is named COMP1_2 or COMP, depending on device
+#if defined(sfr_COMP1_2_CSR1_RESET_VALUE)
+  #define COMP_SFR        sfr_COMP1_2
+#else
+  #define COMP_SFR        sfr_COMP
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// event FIFO. Written in ISRs, read by comp_get_event()
+static comp_event_t       m_fifo[COMP_FIFO_SIZE];
+
+/// FIFO write and read index
+static volatile uint8_t   m_head = 0, m_tail = 0;
+
+/// number of lost events (FIFO full or capture overrun)
+static volatile uint8_t   m_lost = 0;
+
+/// 1 = capture both edges of COMP2 via TIM2 by toggling capture polarity
+static uint8_t            m_captureBoth = 0;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn static void comp_push(uint16_t time, uint8_t comp, uint8_t edge)
+
+  \brief store event in FIFO
+
+  \param[in]  time    timestamp
+  \param[in]  comp    comparator (COMP_1 or COMP_2)
+  \param[in]  edge    COMP_EDGE_RISING or COMP_EDGE_FALLING
+
+  store event in FIFO. If FIFO is full, event is dropped and counted.
+  Called from ISRs with same priority, i.e. w/o locking.
+*/
+static void comp_push(uint16_t time, uint8_t comp, uint8_t edge) {
+
+  uint8_t   next = (uint8_t) ((m_head + 1) & (COMP_FIFO_SIZE - 1));
+
+  // FIFO full -> drop event
+  if (next == m_tail) {
+    m_lost++;
+    return;
+  }
+
+  // store event
+  m_fifo[m_head].time = time;
+  m_fifo[m_head].comp = comp;
+  m_fifo[m_head].edge = edge;
+  m_head = next;
+
+} // comp_push
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void comp_init(void)
+
+  \brief initialize comparator service
+
+  enable clocks of comparators/RI and TIM2. Start TIM2 as free-running
+  16-bit timebase with prescaler 2^COMP_TIM_PSC for timestamps. Clear
+  event FIFO.
+*/
+void comp_init(void) {
+
+  // enable clocks of comparators/RI and TIM2
+  sfr_CLK.PCKENR2.PCKEN25 = 1;
+  sfr_CLK.PCKENR1.PCKEN10 = 1;
+
+  // TIM2: free-running 16-bit timebase
+  sfr_TIM2.CR1.byte  = 0x00;
+  sfr_TIM2.PSCR.byte = COMP_TIM_PSC;
+  sfr_TIM2.ARRH.byte = 0xFF;
+  sfr_TIM2.ARRL.byte = 0xFF;
+  sfr_TIM2.EGR.UG    = 1;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // clear FIFO
+  m_head = 0;
+  m_tail = 0;
+  m_lost = 0;
+
+} // comp_init
+
+
+
+/**
+  \fn uint16_t comp_time(void)
+
+  \brief read timestamp
+
+  \return current TIM2 counter
+
+  read TIM2 counter. Reading the high byte latches the low byte, i.e. the
+  value is consistent.
+*/
+uint16_t comp_time(void) {
+
+  uint8_t   h = sfr_TIM2.CNTRH.byte;
+
+  return(((uint16_t) h << 8) | sfr_TIM2.CNTRL.byte);
+
+} // comp_time
+
+
+
+/**
+  \fn void comp1_init(uint8_t channel, uint8_t edges)
+
+  \brief start COMP1
+
+  \param[in]  channel   RI I/O channel (1..24) of non-inverting input
+  \param[in]  edges     edge sensitivity (COMP_EDGE_xxx). COMP_EDGE_NONE disables COMP1
+
+  connect I/O channel to COMP1 non-inverting input by closing its RI analog
+  switch (RI_IOSRx.CHxE), and VREFINT to the inverting input. Crossings
+  generate an interrupt, the event is timestamped in the ISR.
+*/
+void comp1_init(uint8_t channel, uint8_t edges) {
+
+  uint8_t   idx;
+
+  // stop COMP1
+  COMP_SFR.CSR1.byte = 0x00;
+  if (edges == COMP_EDGE_NONE)
+    return;
+
+  // close RI switch. Channels are interleaved: CH1->IOSR1.0, CH2->IOSR2.0, CH3->IOSR3.0, CH4->IOSR1.1, ...
+  idx = (uint8_t) (channel - 1);
+  (&(sfr_RI.IOSR1.byte))[idx % 3] |= (uint8_t) (1 << (idx / 3));
+
+  // VREFINT to inverting input
+  COMP_SFR.CSR3.VREFEN = 1;
+
+  // enable COMP1 with edge detection and interrupt
+  COMP_SFR.CSR1.CMP1 = edges;
+  COMP_SFR.CSR1.EF1  = 0;
+  COMP_SFR.CSR1.IE1  = 1;
+
+} // comp1_init
+
+
+
+/**
+  \fn void comp2_init(uint8_t inm, uint8_t out, uint8_t edges, uint8_t fast)
+
+  \brief start COMP2
+
+  \param[in]  inm     inverting input (COMP_INM_xxx)
+  \param[in]  out     output routing (COMP_OUT_xxx)
+  \param[in]  edges   edge sensitivity (COMP_EDGE_xxx). COMP_EDGE_NONE disables COMP2
+  \param[in]  fast    1 = fast mode (short propagation delay), 0 = slow mode (low power)
+
+  start COMP2 with selected threshold and hardware output routing.
+  With COMP_OUT_TIM2_IC2, events are timestamped by TIM2 input capture.
+  Both edges are captured by toggling the capture polarity after each capture.
+  Else events are timestamped in the COMP ISR. For COMP_OUT_TIM1_BREAK,
+  TIM1 break must be enabled by the application (TIM1_BKR.BKE, BKP=1).
+*/
+void comp2_init(uint8_t inm, uint8_t out, uint8_t edges, uint8_t fast) {
+
+  // stop COMP2 and TIM2 capture
+  COMP_SFR.CSR2.byte  = 0x00;
+  sfr_TIM2.IER.CC2IE  = 0;
+  sfr_TIM2.CCER1.CC2E = 0;
+  if (edges == COMP_EDGE_NONE)
+    return;
+
+  // select threshold and output routing
+  COMP_SFR.CSR3.INSEL  = inm;
+  COMP_SFR.CSR3.OUTSEL = out;
+
+  // enable COMP2 with edge detection
+  COMP_SFR.CSR2.SPEED = fast;
+  COMP_SFR.CSR2.CMP2  = edges;
+  COMP_SFR.CSR2.EF2   = 0;
+
+  // timestamp via TIM2 input capture 2. Capture polarity 0=rising, 1=falling
+  if (out == COMP_OUT_TIM2_IC2) {
+    m_captureBoth = (edges == COMP_EDGE_BOTH);
+    sfr_TIM2.CCMR2.CC2S = 1;
+    if (m_captureBoth)
+      sfr_TIM2.CCER1.CC2P = COMP_SFR.CSR2.CMP2OUT;
+    else
+      sfr_TIM2.CCER1.CC2P = (edges == COMP_EDGE_FALLING);
+    sfr_TIM2.SR1.CC2IF  = 0;
+    sfr_TIM2.SR2.CC2OF  = 0;
+    sfr_TIM2.CCER1.CC2E = 1;
+    sfr_TIM2.IER.CC2IE  = 1;
+  }
+
+  // else timestamp in COMP ISR
+  else
+    COMP_SFR.CSR2.IE2 = 1;
+
+} // comp2_init
+
+
+
+/**
+  \fn void comp_stop(uint8_t comp)
+
+  \brief stop comparator
+
+  \param[in]  comp    comparator (COMP_1 or COMP_2)
+
+  disable comparator and its interrupts. RI switches and routing are kept.
+*/
+void comp_stop(uint8_t comp) {
+
+  if (comp == COMP_1)
+    comp1_init(0, COMP_EDGE_NONE);
+  else
+    comp2_init(0, 0, COMP_EDGE_NONE, 0);
+
+} // comp_stop
+
+
+
+/**
+  \fn uint8_t comp_output(uint8_t comp)
+
+  \brief read comparator output
+
+  \param[in]  comp    comparator (COMP_1 or COMP_2)
+
+  \return 1 if non-inverting input > inverting input, else 0
+
+  read current comparator output level.
+*/
+uint8_t comp_output(uint8_t comp) {
+
+  if (comp == COMP_1)
+    return(COMP_SFR.CSR1.CMP1OUT);
+  return(COMP_SFR.CSR2.CMP2OUT);
+
+} // comp_output
+
+
+
+/**
+  \fn uint8_t comp_get_event(comp_event_t *event)
+
+  \brief get oldest event
+
+  \param[out] event   oldest event
+
+  \return 1 if event was available, else 0
+
+  get and remove oldest event from FIFO.
+*/
+uint8_t comp_get_event(comp_event_t *event) {
+
+  // FIFO empty
+  if (m_tail == m_head)
+    return(0);
+
+  // copy event and advance read index
+  *event = m_fifo[m_tail];
+  m_tail = (uint8_t) ((m_tail + 1) & (COMP_FIFO_SIZE - 1));
+
+  return(1);
+
+} // comp_get_event
+
+
+
+/**
+  \fn uint8_t comp_get_lost(void)
+
+  \brief get number of lost events
+
+  \return number of lost events since last call
+
+  return and clear number of events lost due to full FIFO or TIM2 capture overrun.
+*/
+uint8_t comp_get_lost(void) {
+
+  uint8_t   lost;
+
+  DISABLE_INTERRUPTS();
+  lost   = m_lost;
+  m_lost = 0;
+  ENABLE_INTERRUPTS();
+
+  return(lost);
+
+} // comp_get_lost
+
+
+
+/**
+  \fn void COMP_ISR(void)
+
+  \brief ISR for COMP1 and COMP2 events
+
+  timestamp with TIM2 counter at ISR entry, clear event flags and store
+  events. Edge is derived from the current output level.
+*/
+ISR_HANDLER(COMP_ISR, _COMP_EF1_VECTOR_) {
+
+  uint16_t  time = comp_time();
+
+  // COMP1 event
+  if (COMP_SFR.CSR1.EF1) {
+    COMP_SFR.CSR1.EF1 = 0;
+    comp_push(time, COMP_1, COMP_SFR.CSR1.CMP1OUT ? COMP_EDGE_RISING : COMP_EDGE_FALLING);
+  }
+
+  // COMP2 event. Ignore if timestamped by TIM2 capture
+  if (COMP_SFR.CSR2.EF2) {
+    COMP_SFR.CSR2.EF2 = 0;
+    if (COMP_SFR.CSR2.IE2)
+      comp_push(time, COMP_2, COMP_SFR.CSR2.CMP2OUT ? COMP_EDGE_RISING : COMP_EDGE_FALLING);
+  }
+
+} // COMP_ISR
+
+
+
+/**
+  \fn void COMP_TIM2_CC_ISR(void)
+
+  \brief ISR for TIM2 capture of COMP2 output
+
+  store captured timestamp of COMP2 crossing. For both edges toggle capture
+  polarity. A capture overrun (2 edges within ISR latency) is counted as lost.
+*/
+ISR_HANDLER(COMP_TIM2_CC_ISR, _TIM2_CAPCOM_CC2IF_VECTOR_) {
+
+  uint8_t   h, l, edge;
+
+  // read capture (high byte first). Reading CCR2L clears CC2IF
+  h = sfr_TIM2.CCR2H.byte;
+  l = sfr_TIM2.CCR2L.byte;
+
+  // edge from capture polarity
+  edge = sfr_TIM2.CCER1.CC2P ? COMP_EDGE_FALLING : COMP_EDGE_RISING;
+
+  // capture overrun -> lost edge
+  if (sfr_TIM2.SR2.CC2OF) {
+    sfr_TIM2.SR2.CC2OF = 0;
+    m_lost++;
+  }
+
+  // capture next edge with opposite polarity
+  if (m_captureBoth)
+    sfr_TIM2.CCER1.CC2P ^= 1;
+
+  comp_push(((uint16_t) h << 8) | l, COMP_2, edge);
+
+} // COMP_TIM2_CC_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,138 @@
+/**
+  \file comp.h
+
+  \author G. Icking-Konert
+  \date 2021-08-21
+  \version 0.1
+
+  \brief declaration of comparator service with routing interface and timestamped events for STM8L
+
+  declaration of a service for the STM8L15x/16x comparators COMP1 and COMP2
+  and the routing interface (RI). Instead of polling the ADC, threshold
+  crossings are detected by the comparators in hardware:
+
+    - COMP1: non-inverting input via RI analog switch (I/O channel),
+      inverting input VREFINT (1.224V). Crossings generate an interrupt, which
+      is timestamped with the TIM2 counter (latency = interrupt latency)
+    - COMP2: non-inverting input COMP2_INP pin, inverting input selectable
+      (I/O, VREFINT, 3/4, 1/2 or 1/4 VREFINT, DAC). The output is routed in
+      hardware to:
+        - TIM2 input capture 2: crossings are timestamped by the capture unit
+          (latency = comparator propagation delay + 1 timer tick)
+        - TIM1 break: PWM outputs are switched off w/o software, e.g. for
+          overcurrent protection (latency = comparator propagation delay)
+        - TIM3 input capture 2 or TIM1 OCREF clear
+
+  Crossings are stored as events {time, comparator, edge} in a FIFO, which
+  is read via comp_get_event(). TIM2 is the free-running 1MHz timebase of the
+  timestamps, i.e. timestamps wrap every 65.5ms.
+
+  \note module is called COMP1_2 or COMP in device headers, both are supported
+  \note RI channel to pin mapping see device datasheet, table "I/O groups"
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _COMP_H_
+#define _COMP_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// event FIFO size (2^n); can be overwritten via compiler option
+#ifndef COMP_FIFO_SIZE
+  #define COMP_FIFO_SIZE        8
+#endif
+
+// TIM2 prescaler 2^n for timestamps; can be overwritten via compiler option. Default 16MHz/16 = 1us
+#ifndef COMP_TIM_PSC
+  #define COMP_TIM_PSC          4
+#endif
+
+// comparator ID in events
+#define COMP_1                  1             ///< COMP1
+#define COMP_2                  2             ///< COMP2
+
+// edge sensitivity for comp1_init() and comp2_init(), see COMP_CSR1.CMP1, COMP_CSR2.CMP2
+#define COMP_EDGE_NONE          0             ///< no events
+#define COMP_EDGE_FALLING       1             ///< event on falling output edge (INP drops below INM)
+#define COMP_EDGE_RISING        2             ///< event on rising output edge (INP rises above INM)
+#define COMP_EDGE_BOTH          3             ///< event on both edges
+
+// COMP2 inverting input, see COMP_CSR3.INSEL
+#define COMP_INM_IO             1             ///< COMP2_INM pin
+#define COMP_INM_VREFINT        2             ///< VREFINT (1.224V)
+#define COMP_INM_VREFINT_3_4    3             ///< 3/4 VREFINT (0.92V)
+#define COMP_INM_VREFINT_1_2    4             ///< 1/2 VREFINT (0.61V)
+#define COMP_INM_VREFINT_1_4    5             ///< 1/4 VREFINT (0.31V)
+#define COMP_INM_DAC1           6             ///< DAC channel 1 output, e.g. adjustable threshold
+#define COMP_INM_DAC2           7             ///< DAC channel 2 output (devices with 2-channel DAC)
+
+// COMP2 output routing, see COMP_CSR3.OUTSEL
+#define COMP_OUT_TIM2_IC2       0             ///< TIM2 input capture 2 -> hardware timestamp
+#define COMP_OUT_TIM3_IC2       1             ///< TIM3 input capture 2
+#define COMP_OUT_TIM1_BREAK     2             ///< TIM1 break -> PWM off w/o software
+#define COMP_OUT_TIM1_OCREF     3             ///< TIM1 OCREF clear
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// comparator crossing event
+typedef struct {
+  uint16_t  time;                     ///< timestamp [TIM2 ticks, default 1us]
+  uint8_t   comp;                     ///< comparator (COMP_1 or COMP_2)
+  uint8_t   edge;                     ///< COMP_EDGE_RISING or COMP_EDGE_FALLING
+} comp_event_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// enable comparator clock and start TIM2 timebase for timestamps
+void      comp_init(void);
+
+/// read timestamp [TIM2 ticks]
+uint16_t  comp_time(void);
+
+/// start COMP1 with RI channel 'channel' (1..24) vs. VREFINT and edge sensitivity 'edges'
+void      comp1_init(uint8_t channel, uint8_t edges);
+
+/// start COMP2 with inverting input 'inm', output routing 'out', edge sensitivity 'edges' and fast mode (1) or slow mode (0)
+void      comp2_init(uint8_t inm, uint8_t out, uint8_t edges, uint8_t fast);
+
+/// stop comparator 'comp' (COMP_1 or COMP_2)
+void      comp_stop(uint8_t comp);
+
+/// read current output of comparator 'comp'. 1 = INP > INM
+uint8_t   comp_output(uint8_t comp);
+
+/// get oldest event from FIFO. Return 1 if event is available, else 0
+uint8_t   comp_get_event(comp_event_t *event);
+
+/// return and clear number of events lost due to full FIFO
+uint8_t   comp_get_lost(void);
+
+/// ISR for COMP1 and COMP2 events
+ISR_HANDLER(COMP_ISR, _COMP_EF1_VECTOR_);
+
+/// ISR for TIM2 capture of COMP2 output
+ISR_HANDLER(COMP_TIM2_CC_ISR, _TIM2_CAPCOM_CC2IF_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _COMP_H_
@@ -0,0 +1,236 @@
+/**********************
+  Comparator events with hardware timestamps and overcurrent shutdown via routing interface
+
+  supported hardware:
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - zero-crossing detection: COMP1 with RI channel vs. VREFINT, both edges.
+      Crossing events are timestamped with 1us TIM2 timebase; period and
+      frequency are printed via UART
+    - overcurrent protection: COMP2 with COMP2_INP pin vs. 1/2 VREFINT (0.61V),
+      output routed to TIM1 break -> 20kHz PWM on TIM1_CH1 (PD2) is switched off
+      by hardware w/o software latency
+    - after a trip, green LED is on and PWM is re-armed after 1s if current is ok
+    - events are printed via UART (19.2kBaud)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "timer4.h"
+#undef _MAIN_
+#include "comp.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED_GREEN       sfr_PORTE.ODR.ODR7    // overcurrent trip
+#define LED_BLUE        sfr_PORTC.ODR.ODR7    // toggles on zero crossing
+
+#define COMP1_CHANNEL   1                     // RI channel of zero-crossing input, see datasheet
+
+#define PWM_PERIOD      800                   // TIM1 period @16MHz -> 20kHz
+#define PWM_DUTY        200                   // 25% duty
+
+#define REARM_DELAY     1000                  // re-arm delay after trip [ms]
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// set in TIM1 break ISR
+volatile uint8_t    g_tripped = 0;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void pwm_init(void)
+
+  \brief init TIM1 PWM with break input
+
+  init TIM1 channel 1 (PD2) with 20kHz PWM. Break input is active high,
+  i.e. COMP2 output high (overcurrent) clears MOE and switches off the output.
+*/
+void pwm_init(void) {
+
+  // enable TIM1 clock and set PD2 to output
+  sfr_CLK.PCKENR2.PCKEN21 = 1;
+  sfr_PORTD.DDR.DDR2 = 1;
+  sfr_PORTD.CR1.C12  = 1;
+
+  // 20kHz PWM mode 1 on channel 1
+  sfr_TIM1.PSCRH.byte = 0;
+  sfr_TIM1.PSCRL.byte = 0;
+  sfr_TIM1.ARRH.byte  = (uint8_t) ((PWM_PERIOD-1) >> 8);
+  sfr_TIM1.ARRL.byte  = (uint8_t) (PWM_PERIOD-1);
+  sfr_TIM1.CCR1H.byte = (uint8_t) (PWM_DUTY >> 8);
+  sfr_TIM1.CCR1L.byte = (uint8_t) PWM_DUTY;
+  sfr_TIM1.CCMR1.OC1M = 6;
+  sfr_TIM1.CCMR1.OC1PE = 1;
+  sfr_TIM1.CCER1.CC1E = 1;
+
+  // break active high with interrupt. Outputs on
+  sfr_TIM1.BKR.byte  = 0x00;
+  sfr_TIM1.BKR.BKP   = 1;
+  sfr_TIM1.BKR.BKE   = 1;
+  sfr_TIM1.SR1.BIF   = 0;
+  sfr_TIM1.IER.BIE   = 1;
+  sfr_TIM1.BKR.MOE   = 1;
+
+  // start timer
+  sfr_TIM1.CR1.CEN   = 1;
+
+} // pwm_init
+
+
+
+/**
+  \fn void TIM1_BRK_ISR(void)
+
+  \brief ISR for TIM1 break
+
+  PWM is already off by hardware. Signal trip to main and disable break
+  interrupt until re-arm (break input is level sensitive).
+*/
+ISR_HANDLER(TIM1_BRK_ISR, _TIM1_BIF_VECTOR_)
+{
+  sfr_TIM1.IER.BIE = 0;
+  sfr_TIM1.SR1.BIF = 0;
+  g_tripped = 1;
+  LED_GREEN = 1;
+  return;
+} // TIM1_BRK_ISR
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  comp_event_t  event;
+  uint16_t      lastRising = 0, period;
+  uint8_t       havePeriod = 0, lost;
+  uint32_t      tripTime = 0;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pins as push-pull outputs
+  sfr_PORTE.DDR.DDR7 = 1;
+  sfr_PORTE.CR1.C17  = 1;
+  sfr_PORTC.DDR.DDR7 = 1;
+  sfr_PORTC.CR1.C17  = 1;
+
+  // init UART for 19.2kBaud and 1ms timer
+  UART_begin(19200);
+  TIM4_init();
+
+  // init comparators: COMP1 zero-crossing, COMP2 overcurrent -> TIM1 break
+  comp_init();
+  comp1_init(COMP1_CHANNEL, COMP_EDGE_BOTH);
+  comp2_init(COMP_INM_VREFINT_1_2, COMP_OUT_TIM1_BREAK, COMP_EDGE_RISING, 1);
+
+  // start PWM with hardware break
+  pwm_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  // main loop
+  while (1) {
+
+    // print comparator events
+    while (comp_get_event(&event)) {
+
+      // COMP1: measure period between rising edges
+      if (event.comp == COMP_1) {
+        LED_BLUE ^= 1;
+        if (event.edge == COMP_EDGE_RISING) {
+          period = event.time - lastRising;
+          lastRising = event.time;
+          if ((havePeriod) && (period))
+            printf("zero-crossing: period %u us, f = %u Hz\n", period, (uint16_t) (1000000L / period));
+          havePeriod = 1;
+        }
+      }
+
+      // COMP2: overcurrent
+      else
+        printf("overcurrent at %u us (%s)\n", event.time, (event.edge == COMP_EDGE_RISING) ? "trip" : "ok");
+
+    } // loop over events
+
+    // report lost events
+    lost = comp_get_lost();
+    if (lost) {
+      printf("%d events lost\n", (int) lost);
+      havePeriod = 0;
+    }
+
+    // PWM tripped -> re-arm after delay if overcurrent is gone
+    if (g_tripped) {
+      if (tripTime == 0)
+        tripTime = millis() | 1;
+      else if ((millis() - tripTime >= REARM_DELAY) && (!comp_output(COMP_2))) {
+        tripTime  = 0;
+        g_tripped = 0;
+        LED_GREEN = 0;
+        sfr_TIM1.SR1.BIF = 0;
+        sfr_TIM1.IER.BIE = 1;
+        sfr_TIM1.BKR.MOE = 1;
+        printf("PWM re-armed\n");
+      }
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
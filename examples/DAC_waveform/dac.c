@@ -0,0 +1,570 @@
+/**
+  \file dac.c
+
+  \author G. Icking-Konert
+  \date 2021-08-14
+  \version 0.1
+
+  \brief implementation of DAC waveform generator with DMA and timer trigger for STM8L
+
+  implementation of table streaming via circular DMA, glitch-free table
+  swap at end of period, DDS sine with phase accumulator and hardware
+  noise/triangle. For details see dac.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stddef.h>
+#include "dac.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// DAC channel 1 register names differ between 1- and 2-channel DAC
+#if DAC_HAS_WAVE
+  #define DAC_CR1             CH1CR1
+  #define DAC_CR2             CH1CR2
+  #define DAC_RDHRH           CH1RDHRH
+  #define DAC_RDHRL           CH1RDHRL
+  #define DAC_DHR8            CH1DHR8
+#else
+  #define DAC_CR1             CR1
+  #define DAC_CR2             CR2
+  #define DAC_RDHRH           RDHRH
+  #define DAC_RDHRL           RDHRL
+  #define DAC_DHR8            DHR8
+#endif
+
+// bits in DAC_CR1
+#define DAC_CR1_EN            0x01            ///< enable channel (output buffer on, BOFF=0)
+#define DAC_CR1_TEN           0x04            ///< enable trigger
+
+// bits in DMA1_C3CR
+#define DMA_CR_EN             0x01            ///< enable channel
+#define DMA_CR_TCIE           0x02            ///< transfer complete interrupt
+#define DMA_CR_HTIE           0x04            ///< half transfer interrupt
+#define DMA_CR_DIR            0x08            ///< memory -> peripheral
+#define DMA_CR_CIRC           0x10            ///< circular mode
+#define DMA_CR_MINC           0x20            ///< increment memory address
+
+// bits in DMA1_C3SPR
+#define DMA_SPR_TCIF          0x02            ///< transfer complete flag
+#define DMA_SPR_HTIF          0x04            ///< half transfer flag
+#define DMA_SPR_TSIZE         0x08            ///< 16-bit transfer
+#define DMA_SPR_PL_HIGH       0x20            ///< priority high
+
+// TIMx_CR2.MMS: update event -> TRGO
+#define TIM_CR2_MMS_UPDATE    0x20
+
+// operating mode
+#define DAC_MODE_IDLE         0               ///< no DMA
+#define DAC_MODE_TABLE        1               ///< table in circular DMA
+#define DAC_MODE_DDS          2               ///< DDS ring buffer
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// used trigger timer (DAC_TRIG_xxx)
+static uint8_t                  m_trigger;
+
+/// actual sample rate [Hz]
+static uint32_t                 m_rate = 0;
+
+/// operating mode (DAC_MODE_xxx)
+static volatile uint8_t         m_mode = DAC_MODE_IDLE;
+
+/// sample format of current table (DAC_FORMAT_xxx)
+static uint8_t                  m_format;
+
+/// table queued by dac_swap(), or NULL
+static const void * volatile    m_nextTable = NULL;
+
+/// length of queued table
+static volatile uint8_t         m_nextLen;
+
+/// DDS phase accumulator and increment per sample
+static uint32_t                 m_phase, m_inc;
+
+/// DDS ring buffer, refilled half by half in DMA ISR
+static uint8_t                  m_dds[DAC_DDS_SIZE];
+
+/// 8-bit sine for DDS, 256 samples per period
+static const uint8_t            m_sine[256] = {
+  128, 131, 134, 137, 140, 143, 146, 149, 152, 155, 158, 162, 165, 167, 170, 173,
+  176, 179, 182, 185, 188, 190, 193, 196, 198, 201, 203, 206, 208, 211, 213, 215,
+  218, 220, 222, 224, 226, 228, 230, 232, 234, 235, 237, 238, 240, 241, 243, 244,
+  245, 246, 248, 249, 250, 250, 251, 252, 253, 253, 254, 254, 254, 255, 255, 255,
+  255, 255, 255, 255, 254, 254, 254, 253, 253, 252, 251, 250, 250, 249, 248, 246,
+  245, 244, 243, 241, 240, 238, 237, 235, 234, 232, 230, 228, 226, 224, 222, 220,
+  218, 215, 213, 211, 208, 206, 203, 201, 198, 196, 193, 190, 188, 185, 182, 179,
+  176, 173, 170, 167, 165, 162, 158, 155, 152, 149, 146, 143, 140, 137, 134, 131,
+  128, 124, 121, 118, 115, 112, 109, 106, 103, 100,  97,  93,  90,  88,  85,  82,
+   79,  76,  73,  70,  67,  65,  62,  59,  57,  54,  52,  49,  47,  44,  42,  40,
+   37,  35,  33,  31,  29,  27,  25,  23,  21,  20,  18,  17,  15,  14,  12,  11,
+   10,   9,   7,   6,   5,   5,   4,   3,   2,   2,   1,   1,   1,   0,   0,   0,
+    0,   0,   0,   0,   1,   1,   1,   2,   2,   3,   4,   5,   5,   6,   7,   9,
+   10,  11,  12,  14,  15,  17,  18,  20,  21,  23,  25,  27,  29,  31,  33,  35,
+   37,  40,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  73,  76,
+   79,  82,  85,  88,  90,  93,  97, 100, 103, 106, 109, 112, 115, 118, 121, 124
+};
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn static void dma_start(const void *addr, uint8_t len, uint8_t format, uint8_t ie)
+
+  \brief start DMA1 channel 3 in circular mode
+
+  \param[in]  addr    first sample in memory
+  \param[in]  len     number of samples
+  \param[in]  format  sample format (DAC_FORMAT_xxx)
+  \param[in]  ie      interrupt enable bits (DMA_CR_TCIE, DMA_CR_HTIE)
+
+  (re-)start DMA1 channel 3 from memory to DAC data holding register in
+  circular mode, and enable DAC DMA requests and trigger.
+*/
+static void dma_start(const void *addr, uint8_t len, uint8_t format, uint8_t ie) {
+
+  // stop channel, clear flags and set transfer size
+  sfr_DMA1.C3CR.byte  = 0x00;
+  sfr_DMA1.C3SPR.byte = (format == DAC_FORMAT_12BIT) ? (DMA_SPR_TSIZE | DMA_SPR_PL_HIGH) : DMA_SPR_PL_HIGH;
+
+  // peripheral address: 8-bit or 12-bit right aligned data holding register
+  if (format == DAC_FORMAT_12BIT) {
+    sfr_DMA1.C3PARH_C3M1ARH.byte = (uint8_t) (((uint16_t) &(sfr_DAC.DAC_RDHRH)) >> 8);
+    sfr_DMA1.C3PARL_C3M1ARL.byte = (uint8_t) ((uint16_t) &(sfr_DAC.DAC_RDHRH));
+  }
+  else {
+    sfr_DMA1.C3PARH_C3M1ARH.byte = (uint8_t) (((uint16_t) &(sfr_DAC.DAC_DHR8)) >> 8);
+    sfr_DMA1.C3PARL_C3M1ARL.byte = (uint8_t) ((uint16_t) &(sfr_DAC.DAC_DHR8));
+  }
+
+  // memory address and number of samples
+  #if defined(sfr_DMA1_C3M0EAR_RESET_VALUE)
+    sfr_DMA1.C3M0EAR.byte = 0x00;
+  #endif
+  sfr_DMA1.C3M0ARH.byte = (uint8_t) (((uint16_t) addr) >> 8);
+  sfr_DMA1.C3M0ARL.byte = (uint8_t) ((uint16_t) addr);
+  sfr_DMA1.C3NDTR.byte  = len;
+
+  // start channel: memory -> DAC, circular, memory increment
+  sfr_DMA1.C3CR.byte = (uint8_t) (DMA_CR_EN | DMA_CR_DIR | DMA_CR_CIRC | DMA_CR_MINC | ie);
+
+  // enable DAC DMA request and trigger
+  sfr_DAC.DAC_CR2.byte = 0x00;
+  sfr_DAC.DAC_CR2.DMAEN = 1;
+  sfr_DAC.DAC_CR1.byte = (uint8_t) (DAC_CR1_EN | DAC_CR1_TEN | (m_trigger << 3));
+
+} // dma_start
+
+
+
+/**
+  \fn static uint32_t dds_increment(uint16_t freq)
+
+  \brief calculate DDS phase increment
+
+  \param[in]  freq    output frequency [Hz]
+
+  \return phase increment per sample = freq * 2^32 / sample rate
+
+  calculate phase increment in 2 steps of 16 bit to avoid 48-bit
+  intermediate results. Requires sample rate <65536Hz.
+*/
+static uint32_t dds_increment(uint16_t freq) {
+
+  uint32_t  num, hi, lo;
+  uint16_t  rate = (uint16_t) m_rate;
+
+  // avoid division by zero before dac_set_rate()
+  if (rate == 0)
+    return(0);
+
+  // upper 16 bit
+  num = (uint32_t) freq << 16;
+  hi  = num / rate;
+
+  // lower 16 bit from remainder
+  num = (num % rate) << 16;
+  lo  = num / rate;
+
+  return((hi << 16) | lo);
+
+} // dds_increment
+
+
+
+/**
+  \fn static void dds_fill(uint8_t *buf)
+
+  \brief fill half of DDS ring buffer
+
+  \param[in]  buf   first sample of buffer half
+
+  fill DAC_DDS_SIZE/2 samples from sine table via phase accumulator.
+  Index is the upper 8 bit of the phase.
+*/
+static void dds_fill(uint8_t *buf) {
+
+  uint8_t   i;
+  uint32_t  phase = m_phase;
+  uint32_t  inc   = m_inc;
+
+  for (i=DAC_DDS_SIZE/2; i; i--) {
+    *(buf++) = m_sine[(uint8_t) (phase >> 24)];
+    phase += inc;
+  }
+  m_phase = phase;
+
+} // dds_fill
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void dac_init(uint8_t trigger)
+
+  \brief initialize DAC
+
+  \param[in]  trigger   trigger timer (DAC_TRIG_TIM4 or DAC_TRIG_TIM5)
+
+  enable clocks of DAC, DMA1 and trigger timer. Enable DAC channel 1 with
+  output buffer and DMA controller. Output is 0 until first output. Set
+  sample rate with dac_set_rate() before starting a waveform.
+*/
+void dac_init(uint8_t trigger) {
+
+  // enable peripheral clocks of DAC, DMA1 and timer
+  sfr_CLK.PCKENR1.PCKEN17 = 1;
+  sfr_CLK.PCKENR2.PCKEN24 = 1;
+  if (trigger == DAC_TRIG_TIM4)
+    sfr_CLK.PCKENR1.PCKEN12 = 1;
+  #if DAC_HAS_TIM5
+    if (trigger == DAC_TRIG_TIM5)
+      sfr_CLK.PCKENR3.PCKEN31 = 1;
+  #endif
+  m_trigger = trigger;
+
+  // enable DAC channel 1 with output buffer, no trigger yet
+  sfr_DAC.DAC_CR2.byte = 0x00;
+  sfr_DAC.DAC_CR1.byte = DAC_CR1_EN;
+
+  // enable DMA controller
+  sfr_DMA1.GCSR.GEN = 1;
+
+  // reset state
+  m_mode = DAC_MODE_IDLE;
+  m_nextTable = NULL;
+
+} // dac_init
+
+
+
+/**
+  \fn uint32_t dac_set_rate(uint32_t rate)
+
+  \brief set sample rate
+
+  \param[in]  rate    sample rate [Hz]
+
+  \return actual sample rate [Hz]
+
+  set trigger timer to the requested sample rate. The smallest prescaler
+  is used for best resolution. TRGO is the update event. The auto-reload
+  register is preloaded, i.e. the rate changes w/o glitch at the next update.
+*/
+uint32_t dac_set_rate(uint32_t rate) {
+
+  uint8_t   psc;
+  uint32_t  ticks;
+
+  // avoid division by zero
+  if (rate == 0)
+    rate = 1;
+
+  #if DAC_HAS_TIM5
+
+    // TIM5: 16-bit counter, prescaler 2^0..2^7
+    if (m_trigger == DAC_TRIG_TIM5) {
+      for (psc=0; psc<7; psc++) {
+        if (((uint32_t) DAC_TIM_CLK >> psc) / rate <= 65536L)
+          break;
+      }
+      ticks = ((uint32_t) DAC_TIM_CLK >> psc) / rate;
+      if (ticks > 65536L) ticks = 65536L;
+      if (ticks < 1)      ticks = 1;
+      sfr_TIM5.CR1.byte  = 0x00;
+      sfr_TIM5.CR2.byte  = TIM_CR2_MMS_UPDATE;
+      sfr_TIM5.PSCR.byte = psc;
+      sfr_TIM5.ARRH.byte = (uint8_t) ((ticks-1) >> 8);
+      sfr_TIM5.ARRL.byte = (uint8_t) (ticks-1);
+      sfr_TIM5.EGR.UG    = 1;
+      sfr_TIM5.CR1.ARPE  = 1;
+      sfr_TIM5.CR1.CEN   = 1;
+    }
+    else
+
+  #endif // DAC_HAS_TIM5
+
+  // TIM4: 8-bit counter, prescaler 2^0..2^15
+  {
+    for (psc=0; psc<15; psc++) {
+      if (((uint32_t) DAC_TIM_CLK >> psc) / rate <= 256)
+        break;
+    }
+    ticks = ((uint32_t) DAC_TIM_CLK >> psc) / rate;
+    if (ticks > 256) ticks = 256;
+    if (ticks < 1)   ticks = 1;
+    sfr_TIM4.CR1.byte  = 0x00;
+    sfr_TIM4.CR2.byte  = TIM_CR2_MMS_UPDATE;
+    sfr_TIM4.PSCR.byte = psc;
+    sfr_TIM4.ARR.byte  = (uint8_t) (ticks-1);
+    sfr_TIM4.EGR.UG    = 1;
+    sfr_TIM4.CR1.ARPE  = 1;
+    sfr_TIM4.CR1.CEN   = 1;
+  }
+
+  // store actual rate for DDS
+  m_rate = ((uint32_t) DAC_TIM_CLK >> psc) / ticks;
+  return(m_rate);
+
+} // dac_set_rate
+
+
+
+/**
+  \fn void dac_stop(void)
+
+  \brief stop waveform
+
+  stop DMA, queued table swap and hardware wave generator. The DAC output
+  keeps the last value, the trigger timer keeps running.
+*/
+void dac_stop(void) {
+
+  DISABLE_INTERRUPTS();
+  sfr_DMA1.C3CR.byte    = 0x00;
+  sfr_DMA1.C3SPR.byte   = 0x00;
+  sfr_DAC.DAC_CR2.byte  = 0x00;
+  sfr_DAC.DAC_CR1.byte  = DAC_CR1_EN;
+  m_mode      = DAC_MODE_IDLE;
+  m_nextTable = NULL;
+  ENABLE_INTERRUPTS();
+
+} // dac_stop
+
+
+
+/**
+  \fn void dac_write(uint16_t value)
+
+  \brief output static value
+
+  \param[in]  value   output value 0..4095 (12-bit right aligned)
+
+  stop waveform and output static value, e.g. for DC calibration. W/o trigger
+  the value is output immediately.
+*/
+void dac_write(uint16_t value) {
+
+  dac_stop();
+  sfr_DAC.DAC_RDHRH.byte = (uint8_t) (value >> 8);
+  sfr_DAC.DAC_RDHRL.byte = (uint8_t) value;
+
+} // dac_write
+
+
+
+/**
+  \fn void dac_play(const void *table, uint8_t len, uint8_t format)
+
+  \brief stream sample table
+
+  \param[in]  table   sample table (uint8_t or uint16_t, see 'format')
+  \param[in]  len     number of samples (2..255)
+  \param[in]  format  sample format (DAC_FORMAT_8BIT or DAC_FORMAT_12BIT)
+
+  stream sample table to DAC in circular DMA mode. One sample is output per
+  trigger, i.e. output frequency = sample rate / len. No CPU load and no
+  interrupts. 12-bit samples are right aligned and stored MSB first (native
+  byte order of STM8), as expected by the 16-bit DMA transfer.
+*/
+void dac_play(const void *table, uint8_t len, uint8_t format) {
+
+  dac_stop();
+  m_format = format;
+  m_mode   = DAC_MODE_TABLE;
+  dma_start(table, len, format, 0x00);
+
+} // dac_play
+
+
+
+/**
+  \fn void dac_swap(const void *table, uint8_t len)
+
+  \brief queue table swap
+
+  \param[in]  table   new sample table in same format as current table
+  \param[in]  len     number of samples (2..255)
+
+  queue a new table for table mode. At the end of the current period the
+  DMA ISR restarts the DMA with the new table before the next trigger, i.e.
+  the waveform changes at a period boundary w/o glitch. Then g_dacSwapped
+  is set. A previously queued table is replaced.
+*/
+void dac_swap(const void *table, uint8_t len) {
+
+  // only in table mode
+  if (m_mode != DAC_MODE_TABLE)
+    return;
+
+  // queue table and enable transfer complete interrupt
+  DISABLE_INTERRUPTS();
+  m_nextTable  = table;
+  m_nextLen    = len;
+  g_dacSwapped = 0;
+  sfr_DMA1.C3SPR.byte &= (uint8_t) ~DMA_SPR_TCIF;
+  sfr_DMA1.C3CR.byte  |= DMA_CR_TCIE;
+  ENABLE_INTERRUPTS();
+
+} // dac_swap
+
+
+
+/**
+  \fn void dac_tone(uint16_t freq)
+
+  \brief start DDS sine
+
+  \param[in]  freq    frequency [Hz], < sample rate/2
+
+  start sine output via direct digital synthesis. Frequency resolution is
+  sample rate / 2^32, i.e. any frequency w/o relation to the sample rate.
+  The DMA streams a RAM ring buffer of DAC_DDS_SIZE 8-bit samples. The half
+  not being output is refilled in the DMA half/full transfer ISR.
+  CPU load see README.md.
+*/
+void dac_tone(uint16_t freq) {
+
+  dac_stop();
+
+  // prefill complete ring buffer from phase 0
+  m_phase = 0;
+  m_inc   = dds_increment(freq);
+  dds_fill(m_dds);
+  dds_fill(m_dds + DAC_DDS_SIZE/2);
+
+  // start circular DMA with refill interrupts
+  m_format = DAC_FORMAT_8BIT;
+  m_mode   = DAC_MODE_DDS;
+  dma_start(m_dds, DAC_DDS_SIZE, DAC_FORMAT_8BIT, DMA_CR_HTIE | DMA_CR_TCIE);
+
+} // dac_tone
+
+
+
+/**
+  \fn void dac_set_tone(uint16_t freq)
+
+  \brief change DDS frequency
+
+  \param[in]  freq    new frequency [Hz], < sample rate/2
+
+  change frequency of running DDS sine. The phase is continuous, i.e. no
+  click. The new frequency is effective after max. DAC_DDS_SIZE/2 samples.
+*/
+void dac_set_tone(uint16_t freq) {
+
+  uint32_t  inc = dds_increment(freq);
+
+  DISABLE_INTERRUPTS();
+  m_inc = inc;
+  ENABLE_INTERRUPTS();
+
+} // dac_set_tone
+
+
+
+#if DAC_HAS_WAVE
+
+/**
+  \fn void dac_wave(uint8_t mode, uint8_t amp, uint16_t offset)
+
+  \brief start hardware noise or triangle
+
+  \param[in]  mode    DAC_WAVE_NOISE or DAC_WAVE_TRIANGLE
+  \param[in]  amp     noise: number of unmasked LFSR bits-1, triangle: amplitude 2^(amp+1)-1 (0..11)
+  \param[in]  offset  DC value 0..4095 added to wave
+
+  start noise or triangle generated by the DAC itself. Each trigger steps
+  the generator, i.e. triangle frequency = sample rate / 2^(amp+2).
+  No DMA and no CPU load.
+*/
+void dac_wave(uint8_t mode, uint8_t amp, uint16_t offset) {
+
+  dac_stop();
+
+  // DC value and amplitude
+  sfr_DAC.DAC_RDHRH.byte = (uint8_t) (offset >> 8);
+  sfr_DAC.DAC_RDHRL.byte = (uint8_t) offset;
+  sfr_DAC.DAC_CR2.byte   = (uint8_t) (amp & 0x0F);
+
+  // start wave generator with trigger
+  sfr_DAC.DAC_CR1.byte = (uint8_t) (DAC_CR1_EN | DAC_CR1_TEN | (m_trigger << 3) | (mode << 6));
+
+} // dac_wave
+
+#endif // DAC_HAS_WAVE
+
+
+
+/**
+  \fn void DAC_DMA_ISR(void)
+
+  \brief ISR for DMA1 channel 3
+
+  DDS mode: refill the half of the ring buffer, which was just output.
+  Table mode: on transfer complete restart DMA with table queued by dac_swap().
+  The restart must be done within 1 sample period.
+
+  Note: vector is shared with DMA1 channel 2
+*/
+ISR_HANDLER(DAC_DMA_ISR, _DMA1_CH3_TC_VECTOR_) {
+
+  uint8_t   flags = sfr_DMA1.C3SPR.byte;
+
+  // clear flags (write 0)
+  sfr_DMA1.C3SPR.byte = (uint8_t) (flags & ~(DMA_SPR_TCIF | DMA_SPR_HTIF));
+
+  // DDS: refill 1st half after half transfer, 2nd half after transfer complete
+  if (m_mode == DAC_MODE_DDS) {
+    if (flags & DMA_SPR_HTIF)
+      dds_fill(m_dds);
+    if (flags & DMA_SPR_TCIF)
+      dds_fill(m_dds + DAC_DDS_SIZE/2);
+  }
+
+  // table mode: swap table at end of period
+  else if ((m_mode == DAC_MODE_TABLE) && (flags & DMA_SPR_TCIF) && (m_nextTable != NULL)) {
+    dma_start(m_nextTable, m_nextLen, m_format, 0x00);
+    m_nextTable  = NULL;
+    g_dacSwapped = 1;
+  }
+
+} // DAC_DMA_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
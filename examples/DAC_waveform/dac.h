@@ -0,0 +1,153 @@
+/**
+  \file dac.h
+
+  \author G. Icking-Konert
+  \date 2021-08-14
+  \version 0.1
+
+  \brief declaration of DAC waveform generator with DMA and timer trigger for STM8L
+
+  declaration of a waveform engine for the STM8L15x/16x DAC channel 1. The
+  DAC is triggered by TIM4 (or TIM5 on devices with TIM5) at the sample rate,
+  each trigger requests the next sample via DMA1 channel 3. Modes:
+
+    - table mode: a sample table (8-bit or 12-bit) is streamed in circular DMA
+      mode w/o CPU. Output frequency = sample rate / table length.
+      dac_swap() queues a new table, which is started at the end of the
+      current period, i.e. w/o glitch (double-buffered table swapping)
+    - tone mode: direct digital synthesis (DDS). A 32-bit phase accumulator
+      steps through a 256-entry sine table with an increment computed from
+      the requested frequency (resolution = sample rate / 2^32). Samples are
+      written to a RAM ring buffer, which is refilled half by half in the DMA
+      half/full transfer interrupt
+    - noise and triangle: generated by the DAC hardware w/o DMA on devices
+      with DAC wave generator (DAC_HAS_WAVE), e.g. STM8L152R8
+
+  Example:
+    dac_init(DAC_TRIG_TIM4);
+    dac_set_rate(32000);                            // 32ksps
+    dac_play(sine, 32, DAC_FORMAT_12BIT);           // 1kHz sine w/o CPU
+    ...
+    dac_tone(440);                                  // 440Hz via DDS
+
+  \note DAC output DAC_OUT (PF0 on STM8L152C6) must be configured as floating input w/o interrupt (default)
+  \note the trigger timer is used exclusively, i.e. no 1ms TIM4 tick
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _DAC_H_
+#define _DAC_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// device has 2-channel DAC with noise/triangle generator (registers CH1CR1 etc.)
+#if defined(sfr_DAC_CH1CR1_RESET_VALUE)
+  #define DAC_HAS_WAVE          1
+#else
+  #define DAC_HAS_WAVE          0
+#endif
+
+// device has 16-bit TIM5 as alternative trigger
+#if defined(sfr_TIM5_CR1_RESET_VALUE)
+  #define DAC_HAS_TIM5          1
+#else
+  #define DAC_HAS_TIM5          0
+#endif
+
+// timer clock [Hz] for dac_set_rate(); can be overwritten via compiler option
+#ifndef DAC_TIM_CLK
+  #define DAC_TIM_CLK           16000000L
+#endif
+
+// DDS ring buffer size [samples]. Even, max. 255; can be overwritten via compiler option
+#ifndef DAC_DDS_SIZE
+  #define DAC_DDS_SIZE          64
+#endif
+
+// trigger source for dac_init(), see DAC_CR1.TSEL
+#define DAC_TRIG_TIM4           0             ///< TIM4 TRGO
+#if DAC_HAS_TIM5
+  #define DAC_TRIG_TIM5         1             ///< TIM5 TRGO
+#endif
+
+// sample format for dac_play()
+#define DAC_FORMAT_8BIT         0             ///< uint8_t samples 0..255 (8-bit data register)
+#define DAC_FORMAT_12BIT        1             ///< uint16_t samples 0..4095 (right aligned)
+
+// hardware wave generator for dac_wave(), see DAC_CH1CR1.WAVEN
+#if DAC_HAS_WAVE
+  #define DAC_WAVE_NOISE        1             ///< LFSR noise, amplitude = bits unmasked
+  #define DAC_WAVE_TRIANGLE     2             ///< triangle 0..2^(amp+1)-1 on top of DC value
+#endif
+
+// max. number of samples per table (DMA counter is 8-bit)
+#define DAC_TABLE_MAX           255
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint8_t  g_dacSwapped;                 ///< set in DMA ISR when table queued by dac_swap() is started
+#else // _MAIN_
+  extern volatile uint8_t  g_dacSwapped;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// enable DAC channel 1 with output buffer, DMA and trigger source (DAC_TRIG_xxx)
+void      dac_init(uint8_t trigger);
+
+/// set sample rate [Hz] of trigger timer. Return actual sample rate
+uint32_t  dac_set_rate(uint32_t rate);
+
+/// stop DMA and wave generator. Output keeps last value
+void      dac_stop(void);
+
+/// output static value 0..4095 (12-bit right aligned)
+void      dac_write(uint16_t value);
+
+/// stream table with 'len' samples in format DAC_FORMAT_xxx in circular mode w/o CPU
+void      dac_play(const void *table, uint8_t len, uint8_t format);
+
+/// queue new table of same format. Started at end of current period, then g_dacSwapped is set
+void      dac_swap(const void *table, uint8_t len);
+
+/// start DDS sine with frequency 'freq' [Hz] < sample rate/2. Sample rate must be <65536Hz
+void      dac_tone(uint16_t freq);
+
+/// change DDS frequency w/o phase jump
+void      dac_set_tone(uint16_t freq);
+
+#if DAC_HAS_WAVE
+
+  /// start hardware noise or triangle (DAC_WAVE_xxx) with amplitude 'amp' (0..11) on top of DC value 'offset'
+  void    dac_wave(uint8_t mode, uint8_t amp, uint16_t offset);
+
+#endif // DAC_HAS_WAVE
+
+/// ISR for DMA1 channel 3 half/full transfer (DDS refill, table swap)
+ISR_HANDLER(DAC_DMA_ISR, _DMA1_CH3_TC_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _DAC_H_
@@ -0,0 +1,188 @@
+/**********************
+  DAC waveform generator with DMA and timer trigger
+
+  supported hardware:
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - DAC channel 1 triggered by TIM4 at 32ksps, samples via DMA1 channel 3
+    - user button (PC1) selects next waveform, output on DAC_OUT (PF0):
+      0: 1kHz sine from 12-bit table (32 samples) w/o CPU
+      1: 1kHz ramp, swapped at period end via dac_swap(). Green LED on after swap
+      2: 440Hz sine via DDS phase accumulator
+      3: DC mid-scale for calibration
+      4: triangle via DAC hardware (only devices with DAC wave generator)
+    - blue LED toggles on each mode change
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "dac.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED_GREEN     sfr_PORTE.ODR.ODR7      // table swapped
+#define LED_BLUE      sfr_PORTC.ODR.ODR7      // mode change
+#define BUTTON        sfr_PORTC.IDR.IDR1      // user button, high when pressed
+
+#define SAMPLE_RATE   32000                   // DAC sample rate [Hz]
+
+#if DAC_HAS_WAVE
+  #define NUM_MODES   5
+#else
+  #define NUM_MODES   4
+#endif
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// 12-bit sine, 32 samples per period
+const uint16_t  g_sine[32] = {
+  2048, 2447, 2831, 3185, 3495, 3750, 3939, 4056,
+  4095, 4056, 3939, 3750, 3495, 3185, 2831, 2447,
+  2048, 1648, 1264,  910,  600,  345,  156,   39,
+     0,   39,  156,  345,  600,  910, 1264, 1648
+};
+
+/// 12-bit ramp, 32 samples per period
+const uint16_t  g_ramp[32] = {
+     0,  132,  264,  396,  528,  660,  792,  924,
+  1057, 1189, 1321, 1453, 1585, 1717, 1849, 1981,
+  2113, 2245, 2377, 2509, 2641, 2773, 2905, 3038,
+  3170, 3302, 3434, 3566, 3698, 3830, 3962, 4095
+};
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void delay(uint16_t count)
+
+  \brief busy delay
+
+  \param[in]  count   number of ~1us loops
+
+  busy delay w/o timer, as TIM4 is used as DAC trigger.
+*/
+void delay(uint16_t count) {
+
+  while (count--) {
+    NOP(); NOP(); NOP(); NOP(); NOP(); NOP(); NOP(); NOP();
+  }
+
+} // delay
+
+
+
+/**
+  \fn void set_mode(uint8_t mode)
+
+  \brief start waveform
+
+  \param[in]  mode    waveform 0..NUM_MODES-1
+
+  start waveform for mode. Mode 1 swaps table at period end.
+*/
+void set_mode(uint8_t mode) {
+
+  switch (mode) {
+
+    // sine table w/o CPU
+    case 0:
+      dac_play(g_sine, 32, DAC_FORMAT_12BIT);
+      break;
+
+    // glitch-free swap to ramp
+    case 1:
+      dac_swap(g_ramp, 32);
+      break;
+
+    // DDS sine
+    case 2:
+      dac_tone(440);
+      break;
+
+    // DC mid-scale
+    case 3:
+      dac_write(2048);
+      break;
+
+    // hardware triangle 0..4095 -> 4096*2 samples per period (~4Hz)
+    #if DAC_HAS_WAVE
+      case 4:
+        dac_wave(DAC_WAVE_TRIANGLE, 11, 0);
+        break;
+    #endif
+
+  } // switch mode
+
+} // set_mode
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint8_t   mode = 0;
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pins as push-pull outputs. Button PC1 has external pull-down
+  sfr_PORTE.DDR.DDR7 = 1;
+  sfr_PORTE.CR1.C17  = 1;
+  sfr_PORTC.DDR.DDR7 = 1;
+  sfr_PORTC.CR1.C17  = 1;
+
+  // init DAC with TIM4 trigger at 32ksps
+  dac_init(DAC_TRIG_TIM4);
+  dac_set_rate(SAMPLE_RATE);
+
+  // enable interrupts (DMA ISR for DDS and table swap)
+  ENABLE_INTERRUPTS();
+
+  // start with sine table
+  set_mode(mode);
+
+  // main loop
+  while (1) {
+
+    // indicate table swap
+    LED_GREEN = g_dacSwapped;
+
+    // on button press select next waveform. Debounce 20ms
+    if (BUTTON) {
+      delay(20000);
+      if (BUTTON) {
+        if (++mode >= NUM_MODES)
+          mode = 0;
+        if (mode == 0)
+          g_dacSwapped = 0;
+        set_mode(mode);
+        LED_BLUE ^= 1;
+        while (BUTTON);
+        delay(20000);
+      }
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,479 @@
+/**
+  \file dali.c
+
+  \author G. Icking-Konert
+  \date 2021-07-24
+  \version 0.1
+
+  \brief implementation of interrupt driven DALI control gear for STLUX / STNRG devices
+
+  implementation of DALI forward frame decoding and dispatch in ISR,
+  forward frame queue for main context and backward frames for queries.
+  For details see dali.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stddef.h>
+#include "dali.h"
+
+
+/*----------------------------------------------------------
+    TYPEDEFS
+----------------------------------------------------------*/
+
+/// entry of forward frame queue
+typedef struct {
+  dali_frame_t      frame;            ///< decoded frame
+  dali_handler_t    handler;          ///< handler from dispatch table
+} dali_queue_t;
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// active configuration
+static const dali_config_t  *m_config;
+
+/// own short address 0..63 or DALI_NO_ADDRESS
+static volatile uint8_t     m_shortAddr;
+
+/// group membership, bit (n & 7) of byte (n >> 3) = group n
+static volatile uint8_t     m_groups[4];
+
+/// forward frame queue. Head is only written by ISR, tail only by dali_process()
+static dali_queue_t         m_queue[DALI_QUEUE_SIZE];
+static volatile uint8_t     m_queueHead;
+static volatile uint8_t     m_queueTail;
+
+/// last frame of pending send-twice command and remaining time [ms]
+static uint8_t              m_twiceRaw[3];
+static volatile uint8_t     m_twiceTimer;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn const dali_cmd_t *dali_lookup(const dali_cmd_t *table, uint8_t opcode)
+
+  \brief find opcode in dispatch table
+
+  \param[in]  table   dispatch table terminated by handler==NULL, or NULL
+  \param[in]  opcode  opcode to find
+
+  \return table entry for opcode, or NULL if not found
+*/
+static const dali_cmd_t *dali_lookup(const dali_cmd_t *table, uint8_t opcode) {
+
+  if (table == NULL)
+    return(NULL);
+  while (table->handler != NULL) {
+    if ((opcode >= table->first) && (opcode <= table->last))
+      return(table);
+    table++;
+  }
+  return(NULL);
+
+} // dali_lookup
+
+
+
+/**
+  \fn uint8_t dali_match_address(uint8_t a, uint8_t *addr)
+
+  \brief check if address byte addresses this device
+
+  \param[in]  a       address byte of forward frame (YAAAAAAS)
+  \param[out] addr    addressing mode | address (DALI_ADDR_xxx)
+
+  \return 1 if frame is for this device, else 0
+
+  decode address byte of 16-bit or 24-bit frame. Frames for other devices are
+  rejected after one compare (short address) or one bit test (group).
+*/
+static uint8_t dali_match_address(uint8_t a, uint8_t *addr) {
+
+  uint8_t   n = (uint8_t) (a >> 1);
+
+  // short address 0AAAAAAS
+  if (a < 0x80) {
+    if (n != m_shortAddr)
+      return(0);
+    *addr = DALI_ADDR_SHORT | n;
+    return(1);
+  }
+
+  // group address 100GGGGS (24-bit: 10GGGGGS)
+  if (a < 0xC0) {
+    n &= 0x1F;
+    if (!(m_groups[n >> 3] & (uint8_t) (1 << (n & 0x07))))
+      return(0);
+    *addr = DALI_ADDR_GROUP | n;
+    return(1);
+  }
+
+  // broadcast 1111111S, or unaddressed broadcast 1111110S for devices w/o short address
+  if ((a >= 0xFE) || ((a >= 0xFC) && (m_shortAddr == DALI_NO_ADDRESS))) {
+    *addr = DALI_ADDR_BROADCAST;
+    return(1);
+  }
+
+  // reserved or not for this device
+  return(0);
+
+} // dali_match_address
+
+
+
+/**
+  \fn void dali_enqueue(const dali_frame_t *frame, dali_handler_t handler)
+
+  \brief put frame into forward frame queue
+
+  \param[in]  frame     decoded frame
+  \param[in]  handler   handler to call from dali_process()
+
+  put frame into queue for execution in main context. If queue is full,
+  frame is dropped and counted.
+*/
+static void dali_enqueue(const dali_frame_t *frame, dali_handler_t handler) {
+
+  dali_queue_t  *entry;
+
+  if ((uint8_t) (m_queueHead - m_queueTail) >= DALI_QUEUE_SIZE) {
+    g_daliStats.dropped++;
+    return;
+  }
+  entry = &(m_queue[m_queueHead & (DALI_QUEUE_SIZE-1)]);
+  entry->frame   = *frame;
+  entry->handler = handler;
+  m_queueHead++;
+
+} // dali_enqueue
+
+
+
+/**
+  \fn void dali_dispatch(const uint8_t *raw, uint8_t len)
+
+  \brief decode and dispatch forward frame
+
+  \param[in]  raw   frame bytes in bus order (address byte first)
+  \param[in]  len   frame length in bytes (2 or 3)
+
+  decode forward frame and dispatch it to the table of the respective
+  addressing mode. Queries are answered immediately, other commands are queued.
+*/
+static void dali_dispatch(const uint8_t *raw, uint8_t len) {
+
+  dali_frame_t      frame;
+  const dali_cmd_t  *table, *entry;
+  dali_handler_t    handler;
+  uint8_t           a = raw[0];
+  uint8_t           twice;
+  int16_t           answer;
+
+  // check if frame repeats pending send-twice command. Any frame ends the window
+  twice = (uint8_t) ((m_twiceTimer != 0) && (m_twiceRaw[0] == a) && (m_twiceRaw[1] == raw[1]) && ((len == 2) || (m_twiceRaw[2] == raw[2])));
+  m_twiceTimer = 0;
+
+  // 24-bit frame: address, instance, opcode. Special commands 0xC1 addressed to all devices
+  if (len == 3) {
+    if (a == 0xC1)
+      frame.addr = DALI_ADDR_SPECIAL;
+    else if ((!(a & 0x01)) || (!dali_match_address(a, &(frame.addr))))
+      return;
+    frame.type   = DALI_TYPE_DEVICE;
+    frame.opcode = raw[2];
+    frame.data   = raw[1];
+    table        = m_config->deviceCmds;
+  }
+
+  // 16-bit special command 101CCCC1 / 110CCCC1, addressed to all devices
+  else if ((a >= 0xA0) && (a < 0xE0)) {
+    if (!(a & 0x01))
+      return;
+    frame.type   = DALI_TYPE_SPECIAL;
+    frame.addr   = DALI_ADDR_SPECIAL;
+    frame.opcode = a;
+    frame.data   = raw[1];
+    table        = m_config->specialCmds;
+  }
+
+  // 16-bit frame with short, group or broadcast address
+  else {
+    if (!dali_match_address(a, &(frame.addr)))
+      return;
+
+    // direct arc power YAAAAAA0 -> no table
+    if (!(a & 0x01)) {
+      frame.type   = DALI_TYPE_ARC;
+      frame.opcode = 0x00;
+      frame.data   = raw[1];
+      g_daliStats.accepted++;
+      if (m_config->arcPower != NULL)
+        dali_enqueue(&frame, m_config->arcPower);
+      return;
+    }
+
+    // command YAAAAAA1
+    frame.type   = DALI_TYPE_CMD;
+    frame.opcode = raw[1];
+    frame.data   = 0x00;
+    if (DALI_ADDR_MODE(frame.addr) == DALI_ADDR_SHORT)
+      table = m_config->shortCmds;
+    else if (DALI_ADDR_MODE(frame.addr) == DALI_ADDR_GROUP)
+      table = m_config->groupCmds;
+    else
+      table = m_config->broadcastCmds;
+  }
+
+  // find handler. Ignore unsupported commands
+  entry = dali_lookup(table, frame.opcode);
+  if (entry == NULL)
+    return;
+  handler = entry->handler;
+  g_daliStats.accepted++;
+
+  // query -> answer from ISR. Hardware inserts settling time before backward frame
+  if (entry->flags & DALI_QUERY) {
+    answer = handler(&frame);
+    if (answer >= 0) {
+      sfr_DALI.DALI_BD.byte = (uint8_t) answer;
+      sfr_DALI.DALI_CR.RTS  = 1;
+      g_daliStats.answered++;
+    }
+    return;
+  }
+
+  // configuration command -> execute only 2nd frame within time window
+  if (entry->flags & DALI_TWICE) {
+    if (!twice) {
+      m_twiceRaw[0] = raw[0];
+      m_twiceRaw[1] = raw[1];
+      m_twiceRaw[2] = raw[2];
+      m_twiceTimer  = DALI_TWICE_TIME;
+      return;
+    }
+  }
+
+  // execute in main context
+  dali_enqueue(&frame, handler);
+
+} // dali_dispatch
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void dali_init(const dali_config_t *config)
+
+  \brief initialize DALI peripheral and stack
+
+  \param[in]  config    const configuration incl. dispatch tables
+
+  initialize DALI peripheral (clock, frame length, noise filter, line watchdog,
+  polarity), reset stack state and enable receive interrupt. Device starts w/o
+  short address and w/o group membership. Call with interrupts disabled.
+*/
+void dali_init(const dali_config_t *config) {
+
+  uint8_t   i;
+
+  // reset stack state
+  m_config    = config;
+  m_shortAddr = DALI_NO_ADDRESS;
+  for (i=0; i<4; i++)
+    m_groups[i] = 0x00;
+  m_queueHead  = 0;
+  m_queueTail  = 0;
+  m_twiceTimer = 0;
+  g_daliStats.received   = 0;
+  g_daliStats.accepted   = 0;
+  g_daliStats.answered   = 0;
+  g_daliStats.errors     = 0;
+  g_daliStats.dropped    = 0;
+  g_daliStats.busFailure = 0;
+
+  // disable DALI interrupts and clear flags
+  sfr_DALI.DALI_CSR.byte = 0x00;
+
+  // set bit clock prescaler (MSB first)
+  sfr_DALI.DALI_H.byte = (uint8_t) (config->clockDiv >> 8);
+  sfr_DALI.DALI_L.byte = (uint8_t) (config->clockDiv);
+
+  // set polarity of receive and transmit line
+  sfr_DALI.DALI_REVLN.byte = 0x00;
+  if (config->polarity) {
+    sfr_DALI.DALI_REVLN.REV_DIN  = (config->polarity & DALI_INVERT_RX) ? 1 : 0;
+    sfr_DALI.DALI_REVLN.REV_DOUT = (config->polarity & DALI_INVERT_TX) ? 1 : 0;
+    sfr_DALI.DALI_REVLN.EN_REV   = 1;
+  }
+
+  // set frame length and line watchdog
+  sfr_DALI.DALI_CR.byte = 0x00;
+  sfr_DALI.DALI_CR.MLN  = config->frameLength;
+  if (config->lineWatchdog) {
+    sfr_DALI.DALI_CSR1.WDG_PRSC = config->lineWatchdog - 1;
+    sfr_DALI.DALI_CR.LNWDG_EN   = 1;
+    sfr_DALI.DALI_CSR.WDGE      = 1;
+  }
+
+  // set noise filter and enable receiver
+  sfr_DALI.DALI_CSR1.CKS     = config->noiseFilter;
+  sfr_DALI.DALI_CSR1.RDY_REC = 1;
+
+  // enable frame received interrupt
+  sfr_DALI.DALI_CSR.IEN = 1;
+
+} // dali_init
+
+
+
+/**
+  \fn void dali_set_short_address(uint8_t addr)
+
+  \brief set short address
+
+  \param[in]  addr    short address 0..63, or DALI_NO_ADDRESS
+
+  set short address, e.g. after commissioning or from non-volatile memory.
+*/
+void dali_set_short_address(uint8_t addr) {
+
+  m_shortAddr = (addr < 64) ? addr : DALI_NO_ADDRESS;
+
+} // dali_set_short_address
+
+
+
+/**
+  \fn void dali_set_groups(uint32_t groups)
+
+  \brief set group membership
+
+  \param[in]  groups    bit n = member of group n. 16-bit frames use groups 0..15
+
+  set group membership, e.g. after commissioning or from non-volatile memory.
+*/
+void dali_set_groups(uint32_t groups) {
+
+  DISABLE_INTERRUPTS();
+  m_groups[0] = (uint8_t) (groups);
+  m_groups[1] = (uint8_t) (groups >> 8);
+  m_groups[2] = (uint8_t) (groups >> 16);
+  m_groups[3] = (uint8_t) (groups >> 24);
+  ENABLE_INTERRUPTS();
+
+} // dali_set_groups
+
+
+
+/**
+  \fn uint8_t dali_process(void)
+
+  \brief execute queued forward frames
+
+  \return number of executed frames
+
+  execute all frames in forward frame queue by calling their handlers.
+  Returns immediately if queue is empty. Call periodically from main loop.
+*/
+uint8_t dali_process(void) {
+
+  dali_queue_t  *entry;
+  uint8_t       num = 0;
+
+  while (m_queueTail != m_queueHead) {
+    entry = &(m_queue[m_queueTail & (DALI_QUEUE_SIZE-1)]);
+    entry->handler(&(entry->frame));
+    m_queueTail++;                      // release entry only after execution
+    num++;
+  }
+
+  return(num);
+
+} // dali_process
+
+
+
+/**
+  \fn void dali_tick(void)
+
+  \brief 1ms tick for send-twice window
+
+  decrement time window of pending send-twice command. Call every 1ms from
+  timer ISR with same priority as DALI ISR.
+*/
+void dali_tick(void) {
+
+  if (m_twiceTimer)
+    m_twiceTimer--;
+
+} // dali_tick
+
+
+
+/**
+  \fn void dali_isr(void)
+
+  \brief DALI ISR handler
+
+  handle DALI interrupt: line watchdog (bus failure), backward frame sent
+  and forward frame received. Call from ISR for _DALI_ITF_VECTOR_.
+*/
+void dali_isr(void) {
+
+  uint8_t   raw[3];
+
+  // bus failure detected by line watchdog
+  if (sfr_DALI.DALI_CSR.WDGF) {
+    sfr_DALI.DALI_CSR.WDGF = 0;
+    g_daliStats.busFailure = 1;
+  }
+
+  // backward frame sent
+  if (sfr_DALI.DALI_CSR.RTF)
+    sfr_DALI.DALI_CSR.RTF = 0;
+
+  // forward frame received
+  if (sfr_DALI.DALI_CSR.ITF) {
+    g_daliStats.received++;
+
+    // discard frame with error (e.g. timing violation)
+    if (sfr_DALI.DALI_CSR.EF) {
+      sfr_DALI.DALI_CSR.EF = 0;
+      g_daliStats.errors++;
+      m_twiceTimer = 0;
+    }
+
+    // copy frame in bus order (address first) and dispatch
+    else if (m_config->frameLength == DALI_FRAME_24) {
+      raw[0] = sfr_DALI.DALI_FB2.byte;
+      raw[1] = sfr_DALI.DALI_FB1.byte;
+      raw[2] = sfr_DALI.DALI_FB0.byte;
+      dali_dispatch(raw, 3);
+    }
+    else {
+      raw[0] = sfr_DALI.DALI_FB1.byte;
+      raw[1] = sfr_DALI.DALI_FB0.byte;
+      raw[2] = 0x00;
+      dali_dispatch(raw, 2);
+    }
+
+    // clear flag and re-enable receiver
+    sfr_DALI.DALI_CSR.ITF      = 0;
+    sfr_DALI.DALI_CSR1.RDY_REC = 1;
+  }
+
+} // dali_isr
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
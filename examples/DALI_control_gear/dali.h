@@ -0,0 +1,183 @@
+/**
+  \file dali.h
+
+  \author G. Icking-Konert
+  \date 2021-07-24
+  \version 0.1
+
+  \brief declaration of interrupt driven DALI control gear for STLUX / STNRG devices
+
+  declaration of a DALI (IEC 62386) slave stack using the DALI peripheral of
+  STLUX and STNRG devices. Received forward frames are decoded in the DALI ISR:
+    - frames for other devices are discarded after one compare (short address)
+      or mask test (group), i.e. a busy 64-device bus costs only a few us per frame
+    - frames for this device are looked up in the dispatch table of the addressing
+      mode (short address, group, broadcast), special commands in a separate table
+    - queries (DALI_QUERY) are answered from the ISR. The backward frame is loaded
+      long before the settling time has expired, independent of main loop load
+    - direct arc power and all other commands are put into a forward frame queue
+      and are executed by dali_process() in the main loop, w/o blocking
+    - configuration commands (DALI_TWICE) are only accepted if received twice
+      within 100ms w/o other frame in between
+
+  24-bit frames (IEC 62386-103 control devices) are dispatched via a separate table.
+  Frame length, noise filter, line watchdog and polarity are set via dali_config_t.
+
+  \note interpretation of DALI_CR.MLN, DALI_CSR1.CKS and the frame byte order
+    follows RM0380. Check the values in dali.h if using a different device revision
+  \note call dali_tick() every 1ms from a timer ISR with same priority as DALI ISR
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _DALI_H_
+#define _DALI_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// size of forward frame queue (power of 2); can be overwritten via compiler option
+#ifndef DALI_QUEUE_SIZE
+  #define DALI_QUEUE_SIZE       8
+#endif
+
+// time window for commands which have to be received twice [ms]
+#define DALI_TWICE_TIME         100
+
+/// prescaler for DALI_L/H for 1200 baud at clock 'fclk' [Hz]. Peripheral samples with 16x bitrate
+#define DALI_CLK_DIV(fclk)      ((uint16_t) ((fclk) / (16L * 1200L) - 1))
+
+// frame length for dali_config_t.frameLength (-> DALI_CR.MLN)
+#define DALI_FRAME_16           0             ///< 16-bit forward frames (IEC 62386-102 control gear)
+#define DALI_FRAME_17           1             ///< 17-bit forward frames (reserved for future use)
+#define DALI_FRAME_24           2             ///< 24-bit forward frames (IEC 62386-103 control devices)
+
+// polarity settings for dali_config_t.polarity (-> DALI_REVLN)
+#define DALI_INVERT_RX          0x02          ///< invert receive line (REV_DIN)
+#define DALI_INVERT_TX          0x04          ///< invert transmit line (REV_DOUT)
+
+// command table flags
+#define DALI_QUERY              0x01          ///< query: handler is called from ISR and returns answer
+#define DALI_TWICE              0x02          ///< configuration command: only executed if received twice within 100ms
+
+// addressing mode in dali_frame_t.addr (upper bits), lower bits = address / group number
+#define DALI_ADDR_SHORT         0x00          ///< short address 0..63
+#define DALI_ADDR_GROUP         0x40          ///< group 0..15 (24-bit frames: 0..31)
+#define DALI_ADDR_BROADCAST     0x80          ///< broadcast (incl. unaddressed broadcast if no short address)
+#define DALI_ADDR_SPECIAL       0xC0          ///< special command, opcode = address byte
+#define DALI_ADDR_MODE(addr)    ((addr) & 0xC0)
+
+// frame types in dali_frame_t.type
+#define DALI_TYPE_ARC           0             ///< direct arc power, level in dali_frame_t.data
+#define DALI_TYPE_CMD           1             ///< 16-bit command, opcode in dali_frame_t.opcode
+#define DALI_TYPE_SPECIAL       2             ///< special command, opcode = address byte, data = 2nd byte
+#define DALI_TYPE_DEVICE        3             ///< 24-bit frame, opcode = 3rd byte, data = instance byte
+
+// special values
+#define DALI_NO_ADDRESS         0xFF          ///< short address of device without address (MASK)
+#define DALI_NO_ANSWER          (-1)          ///< return value of query handler: don't answer
+#define DALI_YES                0xFF          ///< backward frame "yes"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// decoded forward frame
+typedef struct {
+  uint8_t   type;                     ///< frame type (DALI_TYPE_xxx)
+  uint8_t   addr;                     ///< addressing mode | address (DALI_ADDR_xxx)
+  uint8_t   opcode;                   ///< command opcode
+  uint8_t   data;                     ///< arc power level, data byte or instance byte
+} dali_frame_t;
+
+
+/// command handler. Return answer 0..255 for queries, else DALI_NO_ANSWER
+typedef int16_t (*dali_handler_t)(const dali_frame_t *frame);
+
+
+/// dispatch table entry for range of opcodes. Tables are terminated by handler==NULL
+typedef struct {
+  uint8_t           first;            ///< first opcode of range
+  uint8_t           last;             ///< last opcode of range
+  uint8_t           flags;            ///< DALI_QUERY, DALI_TWICE
+  dali_handler_t    handler;          ///< handler for opcodes first..last
+} dali_cmd_t;
+
+
+/// const configuration of DALI stack
+typedef struct {
+  const dali_cmd_t  *shortCmds;       ///< commands addressed to own short address, or NULL
+  const dali_cmd_t  *groupCmds;       ///< commands addressed to a group of this device, or NULL
+  const dali_cmd_t  *broadcastCmds;   ///< broadcast commands, or NULL
+  const dali_cmd_t  *specialCmds;     ///< special commands (address byte 0xA1..0xDF), or NULL
+  const dali_cmd_t  *deviceCmds;      ///< 24-bit frames (all addressing modes), or NULL
+  dali_handler_t    arcPower;         ///< direct arc power handler (queued like commands), or NULL
+  uint16_t          clockDiv;         ///< DALI_L/H prescaler, see DALI_CLK_DIV()
+  uint8_t           frameLength;      ///< DALI_FRAME_16 or DALI_FRAME_24
+  uint8_t           noiseFilter;      ///< noise filter setting 0..15 (-> DALI_CSR1.CKS)
+  uint8_t           lineWatchdog;     ///< 0=off, else line watchdog prescaler+1 (1..8 -> DALI_CSR1.WDG_PRSC)
+  uint8_t           polarity;         ///< DALI_INVERT_RX | DALI_INVERT_TX, or 0
+} dali_config_t;
+
+
+/// statistics of DALI stack
+typedef struct {
+  uint16_t  received;                 ///< forward frames received (all devices)
+  uint16_t  accepted;                 ///< forward frames for this device
+  uint16_t  answered;                 ///< backward frames sent
+  uint8_t   errors;                   ///< frames with error (DALI_CSR.EF)
+  uint8_t   dropped;                  ///< frames dropped due to full queue
+  uint8_t   busFailure;               ///< 1 = line watchdog detected bus failure (DALI_CSR.WDGF)
+} dali_stats_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile dali_stats_t   g_daliStats;
+#else // _MAIN_
+  extern volatile dali_stats_t   g_daliStats;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// initialize DALI peripheral and stack. Call with interrupts disabled
+void    dali_init(const dali_config_t *config);
+
+/// set short address 0..63 or DALI_NO_ADDRESS
+void    dali_set_short_address(uint8_t addr);
+
+/// set group membership, bit n = group n (24-bit frames: groups 0..31)
+void    dali_set_groups(uint32_t groups);
+
+/// execute queued forward frames in main context w/o blocking. Return number of executed frames
+uint8_t dali_process(void);
+
+/// 1ms tick for send-twice window. Call from timer ISR
+void    dali_tick(void);
+
+/// DALI ISR handler. Call from ISR for _DALI_ITF_VECTOR_
+void    dali_isr(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _DALI_H_
@@ -0,0 +1,241 @@
+/**********************
+  DALI control gear with interrupt driven frame decoding, dispatch tables and forward frame queue
+
+  supported hardware:
+    - STLUX385A (all STLUX and STNRG devices with DALI peripheral)
+
+  Functionality:
+    - DALI slave with 16-bit forward frames at 1200 baud
+    - commands are dispatched via tables for short address, group and broadcast
+    - queries are answered from ISR, other commands are executed in main loop
+    - configuration commands (reset, address, groups) must be received twice
+    - STMR provides 1ms tick for send-twice time window
+    - arc power level is stored in a variable, e.g. for SMED PWM (see SMED_config)
+    - DALI pins and bus interface are board specific and keep reset setting
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "dali.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// master clock [Hz] after clock setup
+#define F_MASTER          16000000L
+
+// DALI command opcodes (IEC 62386-102) used below
+#define CMD_OFF           0x00
+#define CMD_RECALL_MAX    0x05
+#define CMD_RECALL_MIN    0x06
+#define CMD_RESET         0x20
+#define CMD_STORE_ADDR    0x80
+#define CMD_ADD_GROUP     0x60          // 0x60..0x6F
+#define CMD_REMOVE_GROUP  0x70          // 0x70..0x7F
+#define CMD_QUERY_STATUS  0x90
+#define CMD_QUERY_PRESENT 0x91
+#define CMD_QUERY_LEVEL   0xA0
+#define CMD_QUERY_GROUPS  0xC0          // 0xC0 = groups 0-7, 0xC1 = groups 8-15
+
+// special command opcodes (address byte)
+#define SPC_DTR0          0xA3
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// actual arc power level 0..254. Set in main context via queue
+volatile uint8_t    g_arcLevel = 0;
+
+// DALI device state
+uint8_t             g_dtr0 = 0;
+uint8_t             g_shortAddr = DALI_NO_ADDRESS;
+uint16_t            g_groups = 0x0000;
+
+
+/*----------------------------------------------------------
+    DALI HANDLERS
+----------------------------------------------------------*/
+
+/// direct arc power (main context). 0xFF = stop fading, ignored here
+int16_t arc_power(const dali_frame_t *frame) {
+  if (frame->data != 0xFF)
+    g_arcLevel = frame->data;
+  return(DALI_NO_ANSWER);
+}
+
+/// OFF, RECALL MAX/MIN (main context). UP, DOWN, STEP UP/DOWN (0x01..0x04) are not in tables -> ignored
+int16_t set_level(const dali_frame_t *frame) {
+  if (frame->opcode == CMD_OFF)
+    g_arcLevel = 0;
+  else if (frame->opcode == CMD_RECALL_MAX)
+    g_arcLevel = 254;
+  else if (frame->opcode == CMD_RECALL_MIN)
+    g_arcLevel = 1;
+  return(DALI_NO_ANSWER);
+}
+
+/// RESET, STORE DTR AS SHORT ADDRESS, ADD TO / REMOVE FROM GROUP (main context, received twice)
+int16_t configure(const dali_frame_t *frame) {
+  uint8_t  op = frame->opcode;
+  if (op == CMD_RESET) {
+    g_arcLevel = 254;
+    g_groups   = 0x0000;
+  }
+  else if (op == CMD_STORE_ADDR) {
+    g_shortAddr = (g_dtr0 == 0xFF) ? DALI_NO_ADDRESS : (uint8_t) (g_dtr0 >> 1);
+    dali_set_short_address(g_shortAddr);
+  }
+  else if ((op & 0xF0) == CMD_ADD_GROUP)
+    g_groups |= (uint16_t) (1 << (op & 0x0F));
+  else
+    g_groups &= (uint16_t) ~(1 << (op & 0x0F));
+  dali_set_groups(g_groups);
+  return(DALI_NO_ANSWER);
+}
+
+/// queries (ISR context, must be short)
+int16_t query(const dali_frame_t *frame) {
+  switch (frame->opcode) {
+    case CMD_QUERY_STATUS:
+      return((g_arcLevel != 0) ? 0x04 : 0x00);    // bit 2 = lamp on
+    case CMD_QUERY_PRESENT:
+      return(DALI_YES);
+    case CMD_QUERY_LEVEL:
+      return(g_arcLevel);
+    case CMD_QUERY_GROUPS:
+      return((uint8_t) g_groups);
+    default:
+      return((uint8_t) (g_groups >> 8));
+  }
+}
+
+/// special command DTR0 (main context)
+int16_t set_dtr0(const dali_frame_t *frame) {
+  g_dtr0 = frame->data;
+  return(DALI_NO_ANSWER);
+}
+
+
+/// dispatch table for short address: all commands incl. configuration
+const dali_cmd_t    m_shortCmds[] = {
+  { CMD_OFF,          CMD_OFF,            0,            set_level },
+  { CMD_RECALL_MAX,   CMD_RECALL_MIN,     0,            set_level },
+  { CMD_RESET,        CMD_RESET,          DALI_TWICE,   configure },
+  { CMD_ADD_GROUP,    CMD_REMOVE_GROUP+15,DALI_TWICE,   configure },
+  { CMD_STORE_ADDR,   CMD_STORE_ADDR,     DALI_TWICE,   configure },
+  { CMD_QUERY_STATUS, CMD_QUERY_PRESENT,  DALI_QUERY,   query },
+  { CMD_QUERY_LEVEL,  CMD_QUERY_LEVEL,    DALI_QUERY,   query },
+  { CMD_QUERY_GROUPS, CMD_QUERY_GROUPS+1, DALI_QUERY,   query },
+  { 0, 0, 0, NULL }
+};
+
+/// dispatch table for groups: level commands only
+const dali_cmd_t    m_groupCmds[] = {
+  { CMD_OFF,          CMD_OFF,            0,            set_level },
+  { CMD_RECALL_MAX,   CMD_RECALL_MIN,     0,            set_level },
+  { 0, 0, 0, NULL }
+};
+
+/// dispatch table for broadcast: level, reset and presence query
+const dali_cmd_t    m_broadcastCmds[] = {
+  { CMD_OFF,          CMD_OFF,            0,            set_level },
+  { CMD_RECALL_MAX,   CMD_RECALL_MIN,     0,            set_level },
+  { CMD_RESET,        CMD_RESET,          DALI_TWICE,   configure },
+  { CMD_STORE_ADDR,   CMD_STORE_ADDR,     DALI_TWICE,   configure },
+  { CMD_QUERY_PRESENT,CMD_QUERY_PRESENT,  DALI_QUERY,   query },
+  { 0, 0, 0, NULL }
+};
+
+/// dispatch table for special commands
+const dali_cmd_t    m_specialCmds[] = {
+  { SPC_DTR0,         SPC_DTR0,           0,            set_dtr0 },
+  { 0, 0, 0, NULL }
+};
+
+/// DALI configuration
+const dali_config_t m_daliConfig = {
+  m_shortCmds,                        // shortCmds
+  m_groupCmds,                        // groupCmds
+  m_broadcastCmds,                    // broadcastCmds
+  m_specialCmds,                      // specialCmds
+  NULL,                               // deviceCmds (no 24-bit frames)
+  arc_power,                          // arcPower
+  DALI_CLK_DIV(F_MASTER),             // clockDiv
+  DALI_FRAME_16,                      // frameLength
+  4,                                  // noiseFilter
+  8,                                  // lineWatchdog
+  0                                   // polarity
+};
+
+
+/*----------------------------------------------------------
+    INTERRUPT SERVICE ROUTINES
+----------------------------------------------------------*/
+
+/// DALI frame received, backward frame sent or bus failure
+ISR_HANDLER(DALI_ISR, _DALI_ITF_VECTOR_)
+{
+  dali_isr();
+
+} // DALI_ISR
+
+
+/// 1ms system timer tick
+ISR_HANDLER(STMR_ISR, _STMR_OVF_VECTOR_)
+{
+  sfr_STMR.STMR_SR1.UIF = 0;
+  dali_tick();
+
+} // STMR_ISR
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.DIVR.byte = 0x00;
+
+  // STMR: 16MHz/2^4 = 1MHz, reload 1000 -> 1ms tick
+  sfr_STMR.STMR_PSCL.byte = 4;
+  sfr_STMR.STMR_ARRH.byte = (uint8_t) ((1000-1) >> 8);
+  sfr_STMR.STMR_ARRL.byte = (uint8_t) (1000-1);
+  sfr_STMR.STMR_IER.UIE   = 1;
+  sfr_STMR.STMR_CR1.CEN   = 1;
+
+  // init DALI stack. Device starts w/o short address
+  dali_init(&m_daliConfig);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // main loop
+  while (1) {
+
+    // execute received commands w/o blocking
+    dali_process();
+
+    // other tasks, e.g. update PWM from g_arcLevel
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,35 @@
+/**
+  \file config.h
+   
+  \brief set project configurations
+   
+  set project configurations like used device or board etc.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+
+/*----------------------------------------------------------
+    SELECT BOARD
+----------------------------------------------------------*/
+#define STM8L_DISCOVERY
+
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#if defined(STM8L_DISCOVERY)
+  #include "../../include/STM8L152C6.h"
+#else
+  #error undefined board (IR transmitter requires STM8L15x/16x)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CONFIG_H_
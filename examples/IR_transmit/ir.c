@@ -0,0 +1,598 @@
+/**
+  \file ir.c
+
+  \author G. Icking-Konert
+  \date 2021-08-28
+  \version 0.1
+
+  \brief implementation of infrared transmitter for NEC, RC5 and RC6 via IRTIM for STM8L
+
+  implementation of frame encoders, double-buffered envelope DMA and request
+  queue for IR transmitter. For details see ir.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "ir.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// registers of selected DMA channel
+#if (IR_DMA_CHANNEL == 0)
+  #define IR_DMA_CR           sfr_DMA1.C0CR
+  #define IR_DMA_SPR          sfr_DMA1.C0SPR
+  #define IR_DMA_NDTR         sfr_DMA1.C0NDTR
+  #define IR_DMA_PARH         sfr_DMA1.C0PARH
+  #define IR_DMA_PARL         sfr_DMA1.C0PARL
+  #define IR_DMA_M0ARH        sfr_DMA1.C0M0ARH
+  #define IR_DMA_M0ARL        sfr_DMA1.C0M0ARL
+#elif (IR_DMA_CHANNEL == 1)
+  #define IR_DMA_CR           sfr_DMA1.C1CR
+  #define IR_DMA_SPR          sfr_DMA1.C1SPR
+  #define IR_DMA_NDTR         sfr_DMA1.C1NDTR
+  #define IR_DMA_PARH         sfr_DMA1.C1PARH
+  #define IR_DMA_PARL         sfr_DMA1.C1PARL
+  #define IR_DMA_M0ARH        sfr_DMA1.C1M0ARH
+  #define IR_DMA_M0ARL        sfr_DMA1.C1M0ARL
+#elif (IR_DMA_CHANNEL == 2)
+  #define IR_DMA_CR           sfr_DMA1.C2CR
+  #define IR_DMA_SPR          sfr_DMA1.C2SPR
+  #define IR_DMA_NDTR         sfr_DMA1.C2NDTR
+  #define IR_DMA_PARH         sfr_DMA1.C2PARH
+  #define IR_DMA_PARL         sfr_DMA1.C2PARL
+  #define IR_DMA_M0ARH        sfr_DMA1.C2M0ARH
+  #define IR_DMA_M0ARL        sfr_DMA1.C2M0ARL
+#else
+  #define IR_DMA_CR           sfr_DMA1.C3CR
+  #define IR_DMA_SPR          sfr_DMA1.C3SPR
+  #define IR_DMA_NDTR         sfr_DMA1.C3NDTR
+  #define IR_DMA_PARH         sfr_DMA1.C3PARH_C3M1ARH
+  #define IR_DMA_PARL         sfr_DMA1.C3PARL_C3M1ARL
+  #define IR_DMA_M0ARH        sfr_DMA1.C3M0ARH
+  #define IR_DMA_M0ARL        sfr_DMA1.C3M0ARL
+#endif
+
+// bits in DMA1_CxCR
+#define DMA_CR_EN             0x01            ///< enable channel
+#define DMA_CR_TCIE           0x02            ///< transfer complete interrupt
+#define DMA_CR_DIR            0x08            ///< memory -> peripheral
+#define DMA_CR_MINC           0x20            ///< increment memory address
+
+// bits in DMA1_CxSPR
+#define DMA_SPR_TCIF          0x02            ///< transfer complete flag
+#define DMA_SPR_PL_HIGH       0x20            ///< priority high
+
+// TIM2 prescaler 2^n for envelope. 16MHz/64 -> 4us resolution, max. unit 1ms
+#define IR_TIM_PSC            6
+
+// envelope ticks per time unit [ns], rounded. Must be <255 (8-bit DMA to CCR1L)
+#define IR_UNIT(ns)           ((uint8_t) ((((IR_TIM_CLK >> IR_TIM_PSC) / 1000L) * (ns) + 500000L) / 1000000L))
+
+// carrier period [timer ticks] for frequency [Hz]
+#define IR_CARRIER(freq)      ((uint16_t) (IR_TIM_CLK / (freq)))
+
+// no buffer is sent
+#define IR_IDLE               0xFF
+
+
+/*----------------------------------------------------------
+    MODULE TYPEDEFS
+----------------------------------------------------------*/
+
+/// protocol timing
+typedef struct {
+  uint8_t   unit;                     ///< time unit [TIM2 ticks]
+  uint8_t   period;                   ///< frame period incl. pause [units]
+  uint16_t  carrier;                  ///< carrier period [TIM3 ticks]
+} ir_timing_t;
+
+/// queued request
+typedef struct {
+  uint16_t  address;                  ///< device address
+  uint8_t   command;                  ///< command
+  uint8_t   protocol;                 ///< IR_xxx
+  uint8_t   repeats;                  ///< number of repetitions
+} ir_request_t;
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// timing of IR_NEC, IR_RC5, IR_RC6
+static const ir_timing_t  m_timing[3] = {
+  { IR_UNIT(562500L), 192, IR_CARRIER(38000L) },    // NEC: 562.5us, 108ms, 38kHz
+  { IR_UNIT(888889L), 128, IR_CARRIER(36000L) },    // RC5: 889us, 114ms, 36kHz
+  { IR_UNIT(444444L), 241, IR_CARRIER(36000L) }     // RC6: 444us, 107ms, 36kHz
+};
+
+/// double buffer of envelope levels (1 byte per time unit). Written by encoders, read by DMA
+static uint8_t            m_buf[2][IR_UNITS_MAX];
+
+/// protocol of buffer content
+static uint8_t            m_bufProtocol[2];
+
+/// buffer currently sent (0, 1 or IR_IDLE)
+static volatile uint8_t   m_active = IR_IDLE;
+
+/// 1 = other buffer contains next frame
+static uint8_t            m_ready = 0;
+
+/// request queue and write/read index
+static ir_request_t       m_queue[IR_QUEUE_SIZE];
+static volatile uint8_t   m_head = 0, m_tail = 0;
+
+/// request currently sent and remaining repetitions
+static ir_request_t       m_current;
+static volatile uint8_t   m_repeats = 0;
+
+/// RC5/RC6 toggle bit. Changes with each new request, not on repetitions
+static uint8_t            m_toggle = 0;
+
+/// encoder state: buffer write pointer, number of units and level of mark
+static uint8_t            *m_ptr;
+static uint8_t            m_units;
+static uint8_t            m_markLevel;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn static void ir_level(uint8_t level, uint8_t units)
+
+  \brief append envelope level to frame
+
+  \param[in]  level   envelope level, i.e. CCR1 value (0 or m_markLevel)
+  \param[in]  units   number of time units
+*/
+static void ir_level(uint8_t level, uint8_t units) {
+
+  while (units--) {
+    *(m_ptr++) = level;
+    m_units++;
+  }
+
+} // ir_level
+
+#define ir_mark(units)    ir_level(m_markLevel, units)      ///< append carrier on
+#define ir_space(units)   ir_level(0, units)                ///< append carrier off
+
+
+
+/**
+  \fn static void ir_encode_nec(const ir_request_t *req, uint8_t repeat)
+
+  \brief encode NEC frame or repeat code
+
+  \param[in]  req     request
+  \param[in]  repeat  1 = repeat code, 0 = full frame
+
+  Frame: 9ms mark, 4.5ms space, 32 bits LSB first, stop mark. Bit = 562.5us mark
+  + 562.5us (0) or 1687.5us (1) space. Data is address, inverted address (or
+  high byte of 16-bit extended address), command, inverted command.
+*/
+static void ir_encode_nec(const ir_request_t *req, uint8_t repeat) {
+
+  uint8_t   data[4], i, j, b;
+
+  // repeat code
+  if (repeat) {
+    ir_mark(16);
+    ir_space(4);
+    ir_mark(1);
+    return;
+  }
+
+  // assemble data
+  data[0] = (uint8_t) req->address;
+  data[1] = (req->address > 0xFF) ? (uint8_t) (req->address >> 8) : (uint8_t) ~data[0];
+  data[2] = req->command;
+  data[3] = (uint8_t) ~req->command;
+
+  // leader
+  ir_mark(16);
+  ir_space(8);
+
+  // pulse distance coded bits, LSB first
+  for (i=0; i<4; i++) {
+    b = data[i];
+    for (j=0; j<8; j++) {
+      ir_mark(1);
+      ir_space((b & 0x01) ? 3 : 1);
+      b >>= 1;
+    }
+  }
+
+  // stop bit
+  ir_mark(1);
+
+} // ir_encode_nec
+
+
+
+/**
+  \fn static void ir_encode_rc5(const ir_request_t *req)
+
+  \brief encode RC5 frame
+
+  \param[in]  req     request
+
+  Frame: 14 Manchester bits MSB first, 2 units (1.778ms) each. 1 = space-mark,
+  0 = mark-space. Bits: start (1), field (inverted command bit 6, RC5X),
+  toggle, 5 address bits, 6 command bits.
+*/
+static void ir_encode_rc5(const ir_request_t *req) {
+
+  uint16_t  data;
+  uint8_t   i;
+
+  // assemble 14 bits
+  data = 0x2000;
+  if (!(req->command & 0x40))
+    data |= 0x1000;
+  if (m_toggle)
+    data |= 0x0800;
+  data |= (uint16_t) (req->address & 0x1F) << 6;
+  data |= req->command & 0x3F;
+
+  // Manchester coding, MSB first
+  for (i=0; i<14; i++) {
+    if (data & 0x2000) {
+      ir_space(1);
+      ir_mark(1);
+    }
+    else {
+      ir_mark(1);
+      ir_space(1);
+    }
+    data <<= 1;
+  }
+
+} // ir_encode_rc5
+
+
+
+/**
+  \fn static void ir_encode_rc6(const ir_request_t *req)
+
+  \brief encode RC6 mode 0 frame
+
+  \param[in]  req     request
+
+  Frame: 2.666ms mark, 889us space, start bit (1), 3 mode bits (000), toggle
+  (trailer bit with double width), 8 address bits, 8 command bits MSB first.
+  Manchester coding with 444us half-bits, 1 = mark-space, 0 = space-mark,
+  i.e. inverse to RC5.
+*/
+static void ir_encode_rc6(const ir_request_t *req) {
+
+  uint16_t  data;
+  uint8_t   i;
+
+  // leader and start bit
+  ir_mark(6);
+  ir_space(2);
+  ir_mark(1);
+  ir_space(1);
+
+  // mode 0
+  for (i=0; i<3; i++) {
+    ir_space(1);
+    ir_mark(1);
+  }
+
+  // trailer (toggle) bit with double width
+  if (m_toggle) {
+    ir_mark(2);
+    ir_space(2);
+  }
+  else {
+    ir_space(2);
+    ir_mark(2);
+  }
+
+  // address and command, MSB first
+  data = ((uint16_t) (req->address & 0xFF) << 8) | req->command;
+  for (i=0; i<16; i++) {
+    if (data & 0x8000) {
+      ir_mark(1);
+      ir_space(1);
+    }
+    else {
+      ir_space(1);
+      ir_mark(1);
+    }
+    data <<= 1;
+  }
+
+} // ir_encode_rc6
+
+
+
+/**
+  \fn static uint8_t ir_next(uint8_t idx)
+
+  \brief encode next frame into buffer
+
+  \param[in]  idx   buffer index (0 or 1)
+
+  \return 1 if a frame was encoded, 0 if nothing to send
+
+  encode repetition of current request or next request from queue into buffer.
+  The frame is padded with space up to the frame period, i.e. the next frame
+  can directly follow. Called from ISR or with interrupts disabled.
+*/
+static uint8_t ir_next(uint8_t idx) {
+
+  uint8_t   repeat = 1;
+
+  // no repetition pending -> get next request from queue
+  if (m_repeats == 0) {
+    if (m_tail == m_head)
+      return(0);
+    m_current = m_queue[m_tail];
+    m_tail    = (uint8_t) ((m_tail + 1) & (IR_QUEUE_SIZE - 1));
+    m_repeats = m_current.repeats;
+    m_toggle ^= 1;
+    repeat    = 0;
+  }
+  else
+    m_repeats--;
+
+  // init encoder. Mark = CCR1 > ARR, i.e. envelope on for complete unit
+  m_ptr       = m_buf[idx];
+  m_units     = 0;
+  m_markLevel = m_timing[m_current.protocol].unit;
+  m_bufProtocol[idx] = m_current.protocol;
+
+  // encode frame
+  if (m_current.protocol == IR_NEC)
+    ir_encode_nec(&m_current, repeat);
+  else if (m_current.protocol == IR_RC5)
+    ir_encode_rc5(&m_current);
+  else
+    ir_encode_rc6(&m_current);
+
+  // pad with space up to frame period
+  ir_space((uint8_t) (m_timing[m_current.protocol].period - m_units));
+
+  return(1);
+
+} // ir_next
+
+
+
+/**
+  \fn static void ir_start(uint8_t idx)
+
+  \brief start sending buffer
+
+  \param[in]  idx   buffer index (0 or 1)
+
+  set unit length and carrier of protocol and start DMA of envelope levels.
+  Timer registers are preloaded, i.e. the new timing is active from the next
+  update event. As the last unit of each frame is space, the switch is glitch-free.
+*/
+static void ir_start(uint8_t idx) {
+
+  const ir_timing_t   *timing = &(m_timing[m_bufProtocol[idx]]);
+  uint16_t            duty = timing->carrier / 3;
+
+  // envelope: period = 1 time unit
+  sfr_TIM2.ARRH.byte = 0;
+  sfr_TIM2.ARRL.byte = (uint8_t) (timing->unit - 1);
+
+  // carrier with 1/3 duty cycle
+  sfr_TIM3.ARRH.byte  = (uint8_t) ((timing->carrier - 1) >> 8);
+  sfr_TIM3.ARRL.byte  = (uint8_t) (timing->carrier - 1);
+  sfr_TIM3.CCR1H.byte = (uint8_t) (duty >> 8);
+  sfr_TIM3.CCR1L.byte = (uint8_t) duty;
+
+  // DMA: 1 byte per TIM2 update from buffer to CCR1L
+  IR_DMA_CR.byte    = 0x00;
+  IR_DMA_SPR.byte   = DMA_SPR_PL_HIGH;
+  IR_DMA_M0ARH.byte = (uint8_t) (((uint16_t) m_buf[idx]) >> 8);
+  IR_DMA_M0ARL.byte = (uint8_t) ((uint16_t) m_buf[idx]);
+  IR_DMA_NDTR.byte  = timing->period;
+  IR_DMA_CR.byte    = DMA_CR_EN | DMA_CR_TCIE | DMA_CR_DIR | DMA_CR_MINC;
+
+} // ir_start
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void ir_init(void)
+
+  \brief init IR transmitter
+
+  enable clocks of TIM2, TIM3 and DMA1. Start TIM3 as carrier and TIM2 as
+  envelope (PWM mode 1 on channel 1, both with preload), TIM2 update requests
+  DMA. Enable IRTIM, which outputs TIM2_CH1 AND TIM3_CH1 on IR_TIM with high sink.
+  Envelope is off until a frame is sent.
+*/
+void ir_init(void) {
+
+  // enable clocks of TIM2, TIM3 and DMA1
+  sfr_CLK.PCKENR1.PCKEN10 = 1;
+  sfr_CLK.PCKENR1.PCKEN11 = 1;
+  sfr_CLK.PCKENR2.PCKEN24 = 1;
+
+  // reset queue and state
+  m_active  = IR_IDLE;
+  m_ready   = 0;
+  m_head    = 0;
+  m_tail    = 0;
+  m_repeats = 0;
+
+  // TIM3 carrier: PWM mode 1 with preload. Timing is set per frame in ir_start()
+  sfr_TIM3.CR1.byte    = 0x00;
+  sfr_TIM3.PSCR.byte   = 0;
+  sfr_TIM3.CCMR1.OC1M  = 6;
+  sfr_TIM3.CCMR1.OC1PE = 1;
+  sfr_TIM3.CCER1.CC1E  = 1;
+  sfr_TIM3.BKR.MOE     = 1;
+  sfr_TIM3.CR1.ARPE    = 1;
+  sfr_TIM3.CR1.CEN     = 1;
+
+  // TIM2 envelope: PWM mode 1 with preload, CCR1 = 0 -> off. CCR1H stays 0, DMA writes CCR1L
+  sfr_TIM2.CR1.byte    = 0x00;
+  sfr_TIM2.PSCR.byte   = IR_TIM_PSC;
+  sfr_TIM2.ARRH.byte   = 0;
+  sfr_TIM2.ARRL.byte   = (uint8_t) (m_timing[IR_NEC].unit - 1);
+  sfr_TIM2.CCR1H.byte  = 0;
+  sfr_TIM2.CCR1L.byte  = 0;
+  sfr_TIM2.CCMR1.OC1M  = 6;
+  sfr_TIM2.CCMR1.OC1PE = 1;
+  sfr_TIM2.CCER1.CC1E  = 1;
+  sfr_TIM2.BKR.MOE     = 1;
+  sfr_TIM2.CR1.ARPE    = 1;
+  sfr_TIM2.EGR.UG      = 1;
+
+  // DMA: TIM2 update -> CCR1L
+  IR_DMA_CR.byte   = 0x00;
+  IR_DMA_PARH.byte = (uint8_t) (((uint16_t) &(sfr_TIM2.CCR1L)) >> 8);
+  IR_DMA_PARL.byte = (uint8_t) ((uint16_t) &(sfr_TIM2.CCR1L));
+  sfr_DMA1.GCSR.GEN = 1;
+  sfr_TIM2.DER.UDE  = 1;
+  sfr_TIM2.CR1.CEN  = 1;
+
+  // IRTIM: IR_TIM = TIM2_CH1 AND TIM3_CH1 with high sink output
+  sfr_IRTIM.CR.byte = 0x00;
+  sfr_IRTIM.CR.HS_EN = 1;
+  sfr_IRTIM.CR.IR_EN = 1;
+
+} // ir_init
+
+
+
+/**
+  \fn uint8_t ir_send(uint8_t protocol, uint16_t address, uint8_t command, uint8_t repeats)
+
+  \brief queue frame
+
+  \param[in]  protocol  IR_NEC, IR_RC5 or IR_RC6
+  \param[in]  address   device address. NEC: >255 for 16-bit extended address
+  \param[in]  command   command. RC5: bit 6 for RC5X
+  \param[in]  repeats   number of repetitions after frame
+
+  \return 1 if request was queued, 0 if queue is full
+
+  queue request. If the transmitter is idle, the frame is encoded and started
+  immediately, else it is sent after the current request including repetitions.
+  If the second buffer is free, the frame is encoded into it already now.
+*/
+uint8_t ir_send(uint8_t protocol, uint16_t address, uint8_t command, uint8_t repeats) {
+
+  uint8_t   next;
+
+  DISABLE_INTERRUPTS();
+
+  // queue full
+  next = (uint8_t) ((m_head + 1) & (IR_QUEUE_SIZE - 1));
+  if (next == m_tail) {
+    ENABLE_INTERRUPTS();
+    return(0);
+  }
+
+  // store request
+  m_queue[m_head].protocol = protocol;
+  m_queue[m_head].address  = address;
+  m_queue[m_head].command  = command;
+  m_queue[m_head].repeats  = repeats;
+  m_head = next;
+
+  // idle -> encode and start frame, then prepare next
+  if (m_active == IR_IDLE) {
+    ir_next(0);
+    m_active = 0;
+    ir_start(0);
+    m_ready = ir_next(1);
+  }
+
+  // sending and second buffer free -> prepare
+  else if (!m_ready)
+    m_ready = ir_next((uint8_t) (m_active ^ 1));
+
+  ENABLE_INTERRUPTS();
+
+  return(1);
+
+} // ir_send
+
+
+
+/**
+  \fn void ir_release(void)
+
+  \brief stop repetitions
+
+  stop repetitions of current request, e.g. on key release. A repetition
+  which is already encoded into the second buffer is still sent.
+*/
+void ir_release(void) {
+
+  m_repeats = 0;
+
+} // ir_release
+
+
+
+/**
+  \fn uint8_t ir_busy(void)
+
+  \brief check if transmitter is busy
+
+  \return 1 while frames are sent or queued, else 0
+*/
+uint8_t ir_busy(void) {
+
+  return(m_active != IR_IDLE);
+
+} // ir_busy
+
+
+
+/**
+  \fn void IR_DMA_ISR(void)
+
+  \brief ISR for DMA transfer complete
+
+  called after the last envelope level of a frame was transferred, i.e. 1 unit
+  before the frame period ends. Start the prepared buffer (must be done within
+  1 unit), then encode the next frame into the buffer just finished. If nothing
+  is prepared, the transmitter becomes idle with envelope off.
+
+  Note: vector is shared with another DMA1 channel
+*/
+ISR_HANDLER(IR_DMA_ISR, IR_DMA_VECTOR) {
+
+  // clear flag (write 0) and stop channel
+  IR_DMA_SPR.byte &= (uint8_t) ~DMA_SPR_TCIF;
+  IR_DMA_CR.byte   = 0x00;
+
+  // nothing prepared -> idle. Last level was space
+  if (!m_ready) {
+    m_active = IR_IDLE;
+    return;
+  }
+
+  // start prepared buffer, then encode next frame into finished buffer
+  m_active ^= 1;
+  ir_start(m_active);
+  m_ready = ir_next((uint8_t) (m_active ^ 1));
+
+} // IR_DMA_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,119 @@
+/**
+  \file ir.h
+
+  \author G. Icking-Konert
+  \date 2021-08-28
+  \version 0.1
+
+  \brief declaration of infrared transmitter for NEC, RC5 and RC6 via IRTIM for STM8L
+
+  declaration of an infrared remote control transmitter for STM8L15x/16x.
+  The infrared interface IRTIM combines the channel 1 outputs of TIM2 and TIM3
+  in hardware (logical AND) to the IR_TIM pin:
+
+    - TIM3 channel 1 generates the carrier (38kHz NEC, 36kHz RC5/RC6, 1/3 duty)
+    - TIM2 channel 1 generates the envelope. The timer period is 1 protocol
+      time unit (562.5us NEC, 889us RC5, 444us RC6). In each period CCR1 is
+      either 0 (space) or ARR+1 (mark)
+
+  A frame is encoded into a sequence of envelope levels, 1 byte per time unit,
+  including the pause until the next frame. On each TIM2 update the next
+  level is written to CCR1L via DMA. I.e. neither carrier nor bit timing
+  requires the CPU, and there is exactly 1 interrupt (DMA transfer complete)
+  per frame. In this interrupt the next frame is started from the second
+  buffer and the following frame is encoded into the free buffer.
+
+  Frames are requested via a queue. Each request contains the number of
+  repetitions, e.g. while a key is pressed:
+
+    - NEC: repeat code (9ms mark, 2.25ms space, 562.5us mark) every 108ms
+    - RC5/RC6: same frame with unchanged toggle bit every 114ms / 107ms
+
+  Example:
+    ir_init();
+    ir_send(IR_NEC, 0x00, 0x45, 3);                 // frame + 3 repeat codes
+    ir_send(IR_RC5, 0x00, 0x0C, 0);                 // standby
+    while (ir_busy());
+
+  \note IR_TIM is PA0, which is shared with SWIM, i.e. debugging is not possible while IRTIM is enabled
+  \note TIM2 and TIM3 are used exclusively
+  \note the DMA channel serving the TIM2 update request depends on device, see IR_DMA_CHANNEL
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _IR_H_
+#define _IR_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// DMA1 channel (0..3) of TIM2 update request, see RM0031 table "DMA requests"; can be overwritten via compiler option
+#ifndef IR_DMA_CHANNEL
+  #define IR_DMA_CHANNEL        1
+#endif
+
+// interrupt vector of DMA channel
+#if (IR_DMA_CHANNEL == 0)
+  #define IR_DMA_VECTOR         _DMA1_CH0_TC_VECTOR_
+#elif (IR_DMA_CHANNEL == 1)
+  #define IR_DMA_VECTOR         _DMA1_CH1_TC_VECTOR_
+#elif (IR_DMA_CHANNEL == 2)
+  #define IR_DMA_VECTOR         _DMA1_CH2_TC_VECTOR_
+#else
+  #define IR_DMA_VECTOR         _DMA1_CH3_TC_VECTOR_
+#endif
+
+// timer clock [Hz]; can be overwritten via compiler option
+#ifndef IR_TIM_CLK
+  #define IR_TIM_CLK            16000000L
+#endif
+
+// request queue size (2^n); can be overwritten via compiler option
+#ifndef IR_QUEUE_SIZE
+  #define IR_QUEUE_SIZE         4
+#endif
+
+// protocols for ir_send()
+#define IR_NEC                  0             ///< NEC: 8-bit address + inverse (or 16-bit extended address), 8-bit command + inverse
+#define IR_RC5                  1             ///< Philips RC5: 5-bit address, 6-bit command (7-bit RC5X)
+#define IR_RC6                  2             ///< Philips RC6 mode 0: 8-bit address, 8-bit command
+
+// max. number of time units per frame incl. pause (RC6: 107ms / 444us)
+#define IR_UNITS_MAX            241
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init TIM2 envelope, TIM3 carrier, DMA and IRTIM
+void      ir_init(void);
+
+/// queue frame of 'protocol' (IR_xxx) with 'address', 'command' and 'repeats' repetitions. Return 0 if queue is full
+uint8_t   ir_send(uint8_t protocol, uint16_t address, uint8_t command, uint8_t repeats);
+
+/// stop repetitions of current frame, e.g. on key release. Queued frames are still sent
+void      ir_release(void);
+
+/// return 1 while frames are sent or queued
+uint8_t   ir_busy(void);
+
+/// ISR for DMA transfer complete, i.e. end of frame
+ISR_HANDLER(IR_DMA_ISR, IR_DMA_VECTOR);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _IR_H_
@@ -0,0 +1,113 @@
+/**********************
+  Infrared remote control transmitter (NEC, RC5, RC6) via IRTIM
+
+  supported hardware:
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+      with IR LED + series resistor from IR_TIM (PA0) to GND
+
+  Functionality:
+    - carrier by TIM3, envelope by TIM2 + DMA, combined by IRTIM -> 1 interrupt per frame
+    - while user button (PC1) is pressed, a command is sent with repetitions
+      (NEC repeat codes, RC5/RC6 frames with unchanged toggle bit)
+    - each button press selects next protocol: NEC -> RC5 -> RC6 -> NEC ...
+    - green LED is on while transmitter is busy, blue LED toggles on each press
+
+  Note: PA0 is shared with SWIM, i.e. no debugging while IRTIM is active
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "ir.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED_GREEN     sfr_PORTE.ODR.ODR7      // transmitter busy
+#define LED_BLUE      sfr_PORTC.ODR.ODR7      // button press
+#define BUTTON        sfr_PORTC.IDR.IDR1      // user button, high when pressed
+
+#define IR_ADDRESS    0x00                    // device address (TV)
+#define IR_COMMAND    0x0C                    // command (RC5/RC6: standby)
+#define IR_REPEATS    255                     // max. repetitions while button pressed
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void delay(uint16_t count)
+
+  \brief busy delay
+
+  \param[in]  count   number of ~1us loops
+
+  busy delay w/o timer, as TIM2 and TIM3 are used by IR transmitter.
+*/
+void delay(uint16_t count) {
+
+  while (count--) {
+    NOP(); NOP(); NOP(); NOP(); NOP(); NOP(); NOP(); NOP();
+  }
+
+} // delay
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint8_t   protocol = IR_NEC;
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pins as push-pull outputs. Button PC1 has external pull-down
+  sfr_PORTE.DDR.DDR7 = 1;
+  sfr_PORTE.CR1.C17  = 1;
+  sfr_PORTC.DDR.DDR7 = 1;
+  sfr_PORTC.CR1.C17  = 1;
+
+  // init IR transmitter
+  ir_init();
+
+  // enable interrupts (DMA ISR at end of frame)
+  ENABLE_INTERRUPTS();
+
+  // main loop
+  while (1) {
+
+    // indicate transmission
+    LED_GREEN = ir_busy();
+
+    // on button press send command with repetitions until release. Debounce 20ms
+    if (BUTTON) {
+      delay(20000);
+      if (BUTTON) {
+        LED_BLUE ^= 1;
+        ir_send(protocol, IR_ADDRESS, IR_COMMAND, IR_REPEATS);
+        while (BUTTON)
+          LED_GREEN = ir_busy();
+        ir_release();
+        delay(20000);
+
+        // next protocol
+        if (++protocol > IR_RC6)
+          protocol = IR_NEC;
+      }
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
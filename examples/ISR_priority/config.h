@@ -0,0 +1,44 @@
+/**
+  \file config.h
+
+  \brief set project configurations
+
+  set project configurations like used device or board etc.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _CONFIG_H_
+#define _CONFIG_H_
+
+
+/*----------------------------------------------------------
+    SELECT BOARD
+----------------------------------------------------------*/
+#define NUCLEO_8S208RB
+
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#if defined(NUCLEO_8S208RB)
+  #include "../../include/STM8S208RB.h"
+
+  // UART for printf() (VCP of ST-Link)
+  #define sfr_UART              sfr_UART1
+  #define _UART_RXNE_VECTOR_    _UART1_R_RXNE_VECTOR_
+
+  // UART for latency measurement (Tx=PD5 connected to Rx=PD6)
+  #define sfr_UART_BENCH        sfr_UART3
+  #define _BENCH_RXNE_VECTOR_   _UART3_R_RXNE_VECTOR_
+
+#else
+  #error undefined board
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _CONFIG_H_
@@ -0,0 +1,303 @@
+/**********************
+  Interrupt priorities: UART receive latency under ISR load with and without prioritisation
+
+  supported hardware:
+    - NUCLEO-8S208RB, other STM8S207/208 with UART3 and TIM3
+
+  Functionality:
+    - TIM2 runs free at 16MHz as time base for latency measurement
+    - TIM3 ISR simulates a long ISR: every 1ms it is busy for LOAD_US
+    - UART3 sends a byte at a pseudo-random phase, which is received via a wire (PD5->PD6).
+      The UART3 receive ISR measures the latency from RXNE to ISR entry
+    - measurement alternates between all ISRs on level 3 (reset state, no nesting) and
+      a priority table with UART3 receive on level 3 and the load ISR on level 1
+    - every BENCH_SAMPLES bytes print min/avg/max latency via UART1 (19.2kBaud)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "timer4.h"
+  #include "uart.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define BENCH_BAUD      500000L                         // baudrate of measurement UART
+#define BENCH_FRAME     (uint16_t) (10*16000000L/BENCH_BAUD)  // duration of 1 byte (start+8+stop) [TIM2 ticks]
+#define BENCH_SAMPLES   1000                            // bytes per measurement
+#define LOAD_US         250                             // duration of load ISR every 1ms [us]
+
+// reset state: all ISRs on level 3, i.e. no nesting
+#define PRIO_FLAT(X,k)
+
+// prioritised: UART3 Rx preempts 1ms tick and printf() Rx, which preempt the load ISR
+#define PRIO_RX(X,k)    X(k, _BENCH_RXNE_VECTOR_,   3) \
+                        X(k, _TIM4_OVR_UIF_VECTOR_, 2) \
+                        X(k, _UART_RXNE_VECTOR_,    2) \
+                        X(k, _TIM3_OVR_UIF_VECTOR_, 1)
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// time when byte was sent [TIM2 ticks]. Set in main
+static volatile uint16_t  m_txTime;
+
+/// latency from RXNE to receive ISR [TIM2 ticks]. Set in UART3 ISR
+static volatile uint16_t  m_latency;
+
+/// flag for byte received. Set in UART3 ISR
+static volatile uint8_t   m_rxDone;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint16_t bench_time(void)
+
+  \brief read TIM2 counter
+
+  \return  TIM2 counter [62.5ns]
+
+  read free running TIM2 counter. READ16() reads MSB first with a single
+  ldw, i.e. it can't be torn by a nested bench_time() in an ISR
+*/
+static uint16_t bench_time(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM2, CNTR);
+
+  return(t);
+
+} // bench_time
+
+
+
+/**
+  \fn void BENCH_RXNE_ISR(void)
+
+  \brief ISR for UART3 receive
+
+  measure time from RXNE (= send time + 1 frame) to ISR entry.
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: requires additional entry in file stm8_interrupt_vector.c
+    IAR: no additional measures
+*/
+ISR_HANDLER(BENCH_RXNE_ISR, _BENCH_RXNE_VECTOR_) {
+
+  uint16_t  t = bench_time();
+
+  // clear RXNE by reading DR
+  (void) sfr_UART_BENCH.DR.byte;
+
+  // latency after end of frame
+  m_latency = (uint16_t) (t - m_txTime - BENCH_FRAME);
+  m_rxDone = 1;
+
+} // BENCH_RXNE_ISR
+
+
+
+/**
+  \fn void LOAD_ISR(void)
+
+  \brief ISR for timer 3 (load)
+
+  busy wait LOAD_US to simulate a long ISR, e.g. a control loop.
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: requires additional entry in file stm8_interrupt_vector.c
+    IAR: no additional measures
+*/
+ISR_HANDLER(LOAD_ISR, _TIM3_OVR_UIF_VECTOR_) {
+
+  uint16_t  start = bench_time();
+
+  // clear interrupt flag
+  sfr_TIM3.SR1.UIF = 0;
+
+  // busy wait
+  while ((uint16_t) (bench_time() - start) < (uint16_t) (LOAD_US*16));
+
+} // LOAD_ISR
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/**
+  \fn void print_result(const char *name, uint16_t min, uint32_t sum, uint16_t max)
+
+  \brief print latency statistics
+
+  \param[in]  name   name of measurement
+  \param[in]  min    min. latency [TIM2 ticks]
+  \param[in]  sum    sum of BENCH_SAMPLES latencies [TIM2 ticks]
+  \param[in]  max    max. latency [TIM2 ticks]
+
+  print min/avg/max latency in us with 1 decimal
+*/
+void print_result(const char *name, uint16_t min, uint32_t sum, uint16_t max) {
+
+  uint16_t  avg = (uint16_t) (sum / BENCH_SAMPLES);
+
+  // convert ticks (62.5ns) to 0.1us
+  min = (uint16_t) (((uint32_t) min * 10) / 16);
+  avg = (uint16_t) (((uint32_t) avg * 10) / 16);
+  max = (uint16_t) (((uint32_t) max * 10) / 16);
+
+  printf("%s: min %u.%uus, avg %u.%uus, max %u.%uus", name, min/10, min%10, avg/10, avg%10, max/10, max%10);
+
+} // print_result
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint8_t   prio = 0;
+  uint16_t  lfsr = 0xACE1, i, t, min, max;
+  uint32_t  sum, timeout;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART1 for 19.2kBaud
+  UART_begin(19200);
+
+  // init 1ms interrupt
+  TIM4_init();
+
+  // init TIM2 as free running 16MHz counter
+  sfr_TIM2.PSCR.byte = 0;
+  sfr_TIM2.ARRH.byte = 0xFF;
+  sfr_TIM2.ARRL.byte = 0xFF;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // init TIM3 for 1ms load interrupt (16MHz/16, 1000 ticks)
+  sfr_TIM3.PSCR.byte = 4;
+  sfr_TIM3.ARRH.byte = (uint8_t) (999 >> 8);
+  sfr_TIM3.ARRL.byte = (uint8_t) (999 & 0xFF);
+  sfr_TIM3.IER.UIE   = 1;
+  sfr_TIM3.CR1.CEN   = 1;
+
+  // init UART3 for BENCH_BAUD (note: BRR2 must be written before BRR1!)
+  t = (uint16_t) (16000000L / BENCH_BAUD);
+  sfr_UART_BENCH.BRR2.byte = (uint8_t) (((t & 0xF000) >> 8) | (t & 0x000F));
+  sfr_UART_BENCH.BRR1.byte = (uint8_t) ((t & 0x0FF0) >> 4);
+  sfr_UART_BENCH.CR2.REN   = 1;
+  sfr_UART_BENCH.CR2.TEN   = 1;
+  sfr_UART_BENCH.CR2.RIEN  = 1;
+
+  // start with reset priorities
+  ISR_SET_PRIORITIES(PRIO_FLAT);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  printf("\nUART Rx latency at %lubaud, load %dus/1ms\n", (unsigned long) BENCH_BAUD, (int) LOAD_US);
+
+
+  // main loop
+  while(1) {
+
+    // measure BENCH_SAMPLES bytes
+    min = 0xFFFF;
+    max = 0;
+    sum = 0;
+    for (i=0; i<BENCH_SAMPLES; i++) {
+
+      // wait pseudo-random 0..1ms to vary phase relative to load ISR
+      lfsr = (lfsr >> 1) ^ ((lfsr & 0x01) ? 0xB400 : 0x0000);
+      t = bench_time();
+      while ((uint16_t) (bench_time() - t) < (lfsr & 0x3FFF));
+
+      // send byte. Don't get interrupted between timestamp and start of frame
+      m_rxDone = 0;
+      ENTER_CRITICAL();
+        m_txTime = bench_time();
+        sfr_UART_BENCH.DR.byte = (uint8_t) i;
+      EXIT_CRITICAL();
+
+      // wait for ISR
+      timeout = g_millis + 10;
+      while ((!m_rxDone) && (g_millis < timeout));
+      if (!m_rxDone) {
+        printf("timeout, connect PD5 and PD6\n");
+        break;
+      }
+
+      // update statistics
+      t = m_latency;
+      sum += t;
+      if (t < min)
+        min = t;
+      if (t > max)
+        max = t;
+
+    } // loop samples
+
+    // print result
+    if (i == BENCH_SAMPLES) {
+      print_result(prio ? "prio" : "flat", min, sum, max);
+      printf(prio ? "\n" : " | ");
+    }
+
+    // toggle priority table. ITC_SPRx can only be written with interrupts disabled
+    prio ^= 1;
+    DISABLE_INTERRUPTS();
+    if (prio)
+      ISR_SET_PRIORITIES(PRIO_RX);
+    else
+      ISR_SET_PRIORITIES(PRIO_FLAT);
+    ENABLE_INTERRUPTS();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,434 @@
+/**
+  \file lcd.c
+
+  \author G. Icking-Konert
+  \date 2021-08-07
+  \version 0.1
+
+  \brief implementation of segment LCD driver for STM8L15x/16x with frame-synchronous update
+
+  implementation of LCD driver with shadow buffer, which is committed to
+  LCD RAM in the start-of-frame interrupt. For details see lcd.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "lcd.h"
+#include "lcd_glass.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// external clock control register is named ECKCR or ECKR, depending on device
+#if defined(sfr_CLK_ECKCR_RESET_VALUE)
+  #define LCD_ECKR        ECKCR
+#else
+  #define LCD_ECKR        ECKR
+#endif
+
+// LCD_CR1: 1/4 duty (DUTY=3) and 1/3 bias (B2=0)
+#define LCD_CR1_DUTY4     0x06
+
+// segment of digit in glass map
+#define LCD_SEG_DP        7
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// shadow buffer (back buffer) of LCD RAM
+static uint8_t            m_shadow[LCD_RAM_SIZE];
+
+/// 1 = commit of shadow buffer pending. Cleared in SOF ISR
+static volatile uint8_t   m_commit = 0;
+
+/// remaining frames of lcd_sleep(). Decremented in SOF ISR
+static volatile uint8_t   m_frames = 0;
+
+/// pixels of glass digits, order a..g, dp
+static const uint8_t      m_glass[LCD_GLASS_DIGITS][8] = LCD_GLASS_MAP;
+
+/// 7-segment font, starting with LCD_FONT_FIRST
+static const uint8_t      m_font[] = LCD_FONT;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void lcd_init(uint8_t clockSource)
+
+  \brief initialize LCD
+
+  \param[in]  clockSource   RTC/LCD clock source (LCD_CLK_LSE or LCD_CLK_LSI)
+
+  start LCD clock source and configure LCD controller for the glass in
+  lcd_glass.h: 1/4 duty, 1/3 bias, internal step-up, ~60Hz frame rate
+  with LSE. Segment lines are enabled via LCD_GLASS_SEG_MASK, LCD RAM and
+  shadow buffer are cleared. SOF interrupt is only enabled on demand.
+*/
+void lcd_init(uint8_t clockSource) {
+
+  uint8_t   i;
+  uint8_t   *ram = (uint8_t*) &(sfr_LCD.RAM0);
+
+  // enable RTC and LCD clock
+  sfr_CLK.PCKENR2.PCKEN22 = 1;
+  sfr_CLK.PCKENR2.PCKEN23 = 1;
+
+  // start LSE or LSI and wait until stable
+  if (clockSource == LCD_CLK_LSE) {
+    sfr_CLK.LCD_ECKR.LSEON = 1;
+    while (!sfr_CLK.LCD_ECKR.LSERDY);
+  }
+  else {
+    sfr_CLK.ICKCR.LSION = 1;
+    while (!sfr_CLK.ICKCR.LSIRDY);
+  }
+
+  // select RTC clock source w/o divider and wait until switch is done
+  sfr_CLK.CRTCR.byte = clockSource;
+  while (sfr_CLK.CRTCR.RTCSWBSY);
+
+  // disable LCD for configuration
+  sfr_LCD.CR3.byte = 0x00;
+
+  // set frame rate, duty and bias
+  sfr_LCD.FRQ.byte = (uint8_t) ((LCD_FRQ_PS << 4) | LCD_FRQ_DIV);
+  sfr_LCD.CR1.byte = LCD_CR1_DUTY4;
+
+  // internal step-up with medium contrast and pulse on duration
+  sfr_LCD.CR2.byte = (uint8_t) ((LCD_PULSE_ON << 5) | (3 << 1));
+
+  // enable used segment lines
+  sfr_LCD.PM0.byte = (uint8_t) (LCD_GLASS_SEG_MASK);
+  sfr_LCD.PM1.byte = (uint8_t) (LCD_GLASS_SEG_MASK >> 8);
+  sfr_LCD.PM2.byte = (uint8_t) (LCD_GLASS_SEG_MASK >> 16);
+  sfr_LCD.PM3.byte = (uint8_t) (LCD_GLASS_SEG_MASK >> 24);
+
+  // clear LCD RAM and shadow buffer
+  for (i=0; i<LCD_RAM_SIZE; i++) {
+    ram[i] = 0x00;
+    m_shadow[i] = 0x00;
+  }
+  m_commit = 0;
+  m_frames = 0;
+
+  // enable LCD
+  sfr_LCD.CR3.LCDEN = 1;
+
+} // lcd_init
+
+
+
+/**
+  \fn void lcd_clear(void)
+
+  \brief clear shadow buffer
+
+  clear all pixels in shadow buffer. Display is updated with next lcd_update().
+*/
+void lcd_clear(void) {
+
+  uint8_t   i;
+
+  for (i=0; i<LCD_RAM_SIZE; i++)
+    m_shadow[i] = 0x00;
+
+} // lcd_clear
+
+
+
+/**
+  \fn void lcd_pixel(uint8_t pixel, uint8_t on)
+
+  \brief set or clear pixel in shadow buffer
+
+  \param[in]  pixel   pixel index, see LCD_PIXEL()
+  \param[in]  on      1=pixel on, 0=pixel off
+
+  set or clear single pixel in shadow buffer.
+*/
+void lcd_pixel(uint8_t pixel, uint8_t on) {
+
+  uint8_t   mask = (uint8_t) (1 << (pixel & 0x07));
+
+  if (on)
+    m_shadow[pixel >> 3] |= mask;
+  else
+    m_shadow[pixel >> 3] &= (uint8_t) ~mask;
+
+} // lcd_pixel
+
+
+
+/**
+  \fn void lcd_putc(uint8_t pos, char c)
+
+  \brief draw character into digit
+
+  \param[in]  pos   digit (0=left)
+  \param[in]  c     character
+
+  draw character into digit 'pos' of shadow buffer via font and glass map.
+  Lower case letters are shown as upper case. The decimal point of the
+  digit is not changed, except for c='.' which sets it.
+*/
+void lcd_putc(uint8_t pos, char c) {
+
+  uint8_t         i, glyph;
+  const uint8_t   *seg;
+
+  // skip digits outside glass
+  if (pos >= LCD_GLASS_DIGITS)
+    return;
+  seg = m_glass[pos];
+
+  // decimal point only
+  if (c == '.') {
+    lcd_pixel(seg[LCD_SEG_DP], 1);
+    return;
+  }
+
+  // get glyph. Characters outside font are blank
+  if ((c >= 'a') && (c <= 'z'))
+    c = (char) (c - 'a' + 'A');
+  if (((uint8_t) c < (uint8_t) LCD_FONT_FIRST) || ((uint8_t) c >= (uint8_t) (LCD_FONT_FIRST + sizeof(m_font))))
+    glyph = 0x00;
+  else
+    glyph = m_font[(uint8_t) c - (uint8_t) LCD_FONT_FIRST];
+
+  // set segments a..g
+  for (i=0; i<7; i++) {
+    lcd_pixel(seg[i], glyph & 0x01);
+    glyph >>= 1;
+  }
+
+} // lcd_putc
+
+
+
+/**
+  \fn uint8_t lcd_puts(uint8_t pos, const char *s)
+
+  \brief draw string into shadow buffer
+
+  \param[in]  pos   first digit (0=left)
+  \param[in]  s     zero terminated string
+
+  \return next digit after string
+
+  draw string from digit 'pos'. A '.' following a character is shown as
+  decimal point of that digit, e.g. "12.34" uses 4 digits. Decimal points
+  of all written digits are overwritten. Characters beyond the last digit
+  are ignored.
+*/
+uint8_t lcd_puts(uint8_t pos, const char *s) {
+
+  uint8_t   last = 0;
+
+  while ((*s) && (pos < LCD_GLASS_DIGITS)) {
+
+    // merge '.' into previous digit
+    if ((*s == '.') && (last)) {
+      lcd_putc(pos-1, '.');
+      last = 0;
+    }
+
+    // new digit. Single '.' is shown as blank digit with decimal point
+    else {
+      lcd_putc(pos, (*s == '.') ? ' ' : *s);
+      lcd_pixel(m_glass[pos][LCD_SEG_DP], (*s == '.'));
+      last = (*s != '.');
+      pos++;
+    }
+    s++;
+
+  }
+
+  // '.' after last digit
+  if ((*s == '.') && (last))
+    lcd_putc(pos-1, '.');
+
+  return(pos);
+
+} // lcd_puts
+
+
+
+/**
+  \fn void lcd_update(void)
+
+  \brief request commit of shadow buffer
+
+  request commit of shadow buffer to LCD RAM. The commit is done in the SOF
+  interrupt at the next start of frame, i.e. the display never shows a
+  partly updated image. Don't draw until lcd_busy() returns 0.
+*/
+void lcd_update(void) {
+
+  DISABLE_INTERRUPTS();
+  m_commit = 1;
+  if (!sfr_LCD.CR3.SOFIE) {
+    sfr_LCD.CR3.SOFC  = 1;        // clear stale SOF flag, else commit is done immediately
+    sfr_LCD.CR3.SOFIE = 1;
+  }
+  ENABLE_INTERRUPTS();
+
+} // lcd_update
+
+
+
+/**
+  \fn uint8_t lcd_busy(void)
+
+  \brief check for pending commit
+
+  \return 1 if commit is pending, else 0
+
+  check if a commit requested by lcd_update() is still pending.
+*/
+uint8_t lcd_busy(void) {
+
+  return(m_commit);
+
+} // lcd_busy
+
+
+
+/**
+  \fn void lcd_wait(void)
+
+  \brief wait for pending commit
+
+  wait in wait mode until a commit requested by lcd_update() is done,
+  i.e. max. 1 frame. Other peripherals keep running.
+*/
+void lcd_wait(void) {
+
+  // check with interrupts disabled to avoid missing SOF. WFI re-enables interrupts
+  DISABLE_INTERRUPTS();
+  while (m_commit) {
+    WAIT_FOR_INTERRUPT();
+    DISABLE_INTERRUPTS();
+  }
+  ENABLE_INTERRUPTS();
+
+} // lcd_wait
+
+
+
+/**
+  \fn void lcd_sleep(uint8_t frames)
+
+  \brief active-halt for number of frames
+
+  \param[in]  frames  number of LCD frames to sleep (1..255)
+
+  enter active-halt until 'frames' SOF interrupts have occurred and a
+  pending commit is done. LCD and RTC keep running, CPU only wakes on SOF
+  or other interrupts (e.g. EXTI). Peripherals clocked by the main clock
+  (e.g. TIM4) stop.
+*/
+void lcd_sleep(uint8_t frames) {
+
+  // start frame counter
+  DISABLE_INTERRUPTS();
+  m_frames = frames;
+  if (!sfr_LCD.CR3.SOFIE) {
+    sfr_LCD.CR3.SOFC  = 1;
+    sfr_LCD.CR3.SOFIE = 1;
+  }
+
+  // active-halt with main regulator off. HALT re-enables interrupts
+  sfr_CLK.ICKCR.SAHALT = 1;
+  while ((m_frames) || (m_commit)) {
+    ENTER_HALT();
+    DISABLE_INTERRUPTS();
+  }
+  ENABLE_INTERRUPTS();
+
+} // lcd_sleep
+
+
+
+/**
+  \fn void lcd_contrast(uint8_t level)
+
+  \brief set contrast
+
+  \param[in]  level   contrast 0 (VLCD min., ~2.6V) .. 7 (VLCD max., ~3.3V)
+
+  set LCD voltage of internal step-up, see LCD_CR2.CC.
+*/
+void lcd_contrast(uint8_t level) {
+
+  sfr_LCD.CR2.byte = (uint8_t) ((sfr_LCD.CR2.byte & ~0x0E) | ((level & 0x07) << 1));
+
+} // lcd_contrast
+
+
+
+/**
+  \fn void lcd_blink(uint8_t mode, uint8_t freq)
+
+  \brief set blink mode
+
+  \param[in]  mode    blink mode (LCD_BLINK_xxx)
+  \param[in]  freq    blink frequency (LCD_BLINKF_xxx)
+
+  set hardware blinking, e.g. LCD_BLINK_ALL with LCD_BLINKF_DIV256 blinks
+  the display at ~1Hz w/o CPU.
+*/
+void lcd_blink(uint8_t mode, uint8_t freq) {
+
+  sfr_LCD.CR1.byte = (uint8_t) (((mode & 0x03) << 6) | ((freq & 0x07) << 3) | LCD_CR1_DUTY4);
+
+} // lcd_blink
+
+
+
+/**
+  \fn void LCD_ISR(void)
+
+  \brief ISR for LCD start of frame
+
+  acknowledge SOF. If a commit is pending, copy changed bytes of shadow
+  buffer to LCD RAM. Count down frames of lcd_sleep(). If neither is
+  pending, disable SOF interrupt to avoid CPU wakeup every frame.
+*/
+ISR_HANDLER(LCD_ISR, _LCD_SOF_VECTOR_) {
+
+  uint8_t   i;
+  uint8_t   *ram = (uint8_t*) &(sfr_LCD.RAM0);
+
+  // clear SOF flag
+  sfr_LCD.CR3.SOFC = 1;
+
+  // commit shadow buffer. Only write changed bytes
+  if (m_commit) {
+    for (i=0; i<LCD_RAM_SIZE; i++) {
+      if (ram[i] != m_shadow[i])
+        ram[i] = m_shadow[i];
+    }
+    m_commit = 0;
+  }
+
+  // count frames of lcd_sleep()
+  if (m_frames)
+    m_frames--;
+
+  // nothing pending -> disable SOF interrupt
+  if (m_frames == 0)
+    sfr_LCD.CR3.SOFIE = 0;
+
+} // LCD_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
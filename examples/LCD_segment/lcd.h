@@ -0,0 +1,134 @@
+/**
+  \file lcd.h
+
+  \author G. Icking-Konert
+  \date 2021-08-07
+  \version 0.1
+
+  \brief declaration of segment LCD driver for STM8L15x/16x with frame-synchronous update
+
+  declaration of a driver for the STM8L LCD controller (4 COM x 28 SEG).
+  The application draws into a shadow buffer in RAM (back buffer). After
+  drawing, lcd_update() requests a commit. The commit is done in the LCD
+  start-of-frame (SOF) interrupt, i.e. at a frame boundary, and only LCD RAM
+  bytes which differ from the shadow buffer are written:
+    lcd_puts(0, "12.34");       // draw into shadow buffer
+    lcd_update();               // request commit at next frame start
+    lcd_sleep(15);              // active-halt for 15 frames (~250ms)
+
+  This avoids tearing (a partly updated display during one frame), and the
+  CPU is only woken by SOF while a commit or lcd_sleep() is pending. Else
+  the SOF interrupt is disabled and the LCD refreshes w/o CPU in active-halt.
+
+  Segment map and font of the connected glass are defined at compile-time
+  in lcd_glass.h.
+
+  \note LCD is clocked by RTCCLK, i.e. RTC clock setting is shared with the RTC
+  \note drawing while lcd_busy() may commit a partial image. Call lcd_wait() or lcd_sleep() first
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _LCD_H_
+#define _LCD_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// LCD RAM organization for 1/4 duty (RAM0..RAM13)
+#define LCD_COMS                4                                   ///< number of common lines
+#define LCD_SEGS                28                                  ///< number of segment lines
+#define LCD_RAM_SIZE            14                                  ///< LCD RAM size [B] = 4*28 bit
+
+/// pixel index in LCD RAM for common line 'com' and segment line 'seg'
+#define LCD_PIXEL(com, seg)     ((uint8_t) ((com)*LCD_SEGS + (seg)))
+
+// LCD clock source for lcd_init(), see CLK_CRTCR.RTCSEL
+#define LCD_CLK_LSI             0x04          ///< LSI (~38kHz, uncalibrated)
+#define LCD_CLK_LSE             0x10          ///< LSE (32.768kHz crystal)
+
+// frame rate divider in LCD_FRQ: f_frame = RTCCLK / (2^PS * (16+DIV)) * duty. Can be overwritten via compiler option
+#ifndef LCD_FRQ_PS
+  #define LCD_FRQ_PS            3             ///< prescaler 2^3 -> with LSE ~60Hz frame rate
+#endif
+#ifndef LCD_FRQ_DIV
+  #define LCD_FRQ_DIV           1             ///< divider 16+1
+#endif
+
+// pulse on duration of internal step-up in LCD_CR2 (0..7). Longer = more contrast, higher current
+#ifndef LCD_PULSE_ON
+  #define LCD_PULSE_ON          2
+#endif
+
+// blink mode for lcd_blink(), see LCD_CR1.BLINK
+#define LCD_BLINK_OFF           0             ///< no blinking
+#define LCD_BLINK_SEG0_COM0     1             ///< blink SEG0 on COM0
+#define LCD_BLINK_SEG0_ALL      2             ///< blink SEG0 on all COMs
+#define LCD_BLINK_ALL           3             ///< blink all pixels
+
+// blink frequency for lcd_blink() as divider of LCD clock, see LCD_CR1.BLINKF
+#define LCD_BLINKF_DIV8         0             ///< f_LCD/8
+#define LCD_BLINKF_DIV16        1             ///< f_LCD/16
+#define LCD_BLINKF_DIV32        2             ///< f_LCD/32
+#define LCD_BLINKF_DIV64        3             ///< f_LCD/64
+#define LCD_BLINKF_DIV128       4             ///< f_LCD/128
+#define LCD_BLINKF_DIV256       5             ///< f_LCD/256
+#define LCD_BLINKF_DIV512       6             ///< f_LCD/512
+#define LCD_BLINKF_DIV1024      7             ///< f_LCD/1024
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// start LCD clock, configure LCD for glass in lcd_glass.h and clear display
+void    lcd_init(uint8_t clockSource);
+
+/// clear shadow buffer. Display is updated with next lcd_update()
+void    lcd_clear(void);
+
+/// set (on=1) or clear (on=0) pixel in shadow buffer
+void    lcd_pixel(uint8_t pixel, uint8_t on);
+
+/// draw character into digit 'pos' of shadow buffer. Characters w/o glyph are blank
+void    lcd_putc(uint8_t pos, char c);
+
+/// draw string from digit 'pos' into shadow buffer. '.' is merged into previous digit. Return next digit
+uint8_t lcd_puts(uint8_t pos, const char *s);
+
+/// request commit of shadow buffer to LCD RAM at next start of frame
+void    lcd_update(void);
+
+/// return 1 if commit is pending, else 0
+uint8_t lcd_busy(void);
+
+/// wait in wait mode until pending commit is done
+void    lcd_wait(void);
+
+/// stay in active-halt for 'frames' LCD frames. A pending commit is done meanwhile
+void    lcd_sleep(uint8_t frames);
+
+/// set contrast (0..7), i.e. LCD voltage of internal step-up
+void    lcd_contrast(uint8_t level);
+
+/// set blink mode (LCD_BLINK_xxx) and frequency (LCD_BLINKF_xxx)
+void    lcd_blink(uint8_t mode, uint8_t freq);
+
+/// ISR for LCD start of frame
+ISR_HANDLER(LCD_ISR, _LCD_SOF_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _LCD_H_
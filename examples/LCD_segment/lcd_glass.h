@@ -0,0 +1,87 @@
+/**
+  \file lcd_glass.h
+
+  \author G. Icking-Konert
+  \date 2021-08-07
+  \version 0.1
+
+  \brief compile-time segment map and font of LCD glass
+
+  description of the connected LCD glass for lcd.c: number of digits, used
+  segment lines and for each digit the pixel (COM, SEG) of each segment a..g, dp.
+  The example glass is a 4-digit 7-segment glass with 1/4 duty, using 2 segment
+  lines per digit:
+
+            COM0    COM1    COM2    COM3
+    SEG 2n  a       b       c       dp
+    SEG 2n+1 f      g       e       d
+
+  For a different glass only adapt this file according to its datasheet.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _LCD_GLASS_H_
+#define _LCD_GLASS_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "lcd.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLASS
+-----------------------------------------------------------------------------*/
+
+/// number of digits
+#define LCD_GLASS_DIGITS        4
+
+/// used segment lines SEG0..SEG27 (-> LCD_PM0..3)
+#define LCD_GLASS_SEG_MASK      0x000000FFL
+
+/// pixels of digit 'n' (0=left) with segment lines 2n, 2n+1. Order: a, b, c, d, e, f, g, dp
+#define _LCD_GLASS_DIGIT(n)     { LCD_PIXEL(0, 2*(n)),   LCD_PIXEL(1, 2*(n)),   LCD_PIXEL(2, 2*(n)),   LCD_PIXEL(3, 2*(n)+1), \
+                                  LCD_PIXEL(2, 2*(n)+1), LCD_PIXEL(0, 2*(n)+1), LCD_PIXEL(1, 2*(n)+1), LCD_PIXEL(3, 2*(n)) }
+
+/// segment map: pixel of each segment of each digit
+#define LCD_GLASS_MAP           { _LCD_GLASS_DIGIT(0), _LCD_GLASS_DIGIT(1), _LCD_GLASS_DIGIT(2), _LCD_GLASS_DIGIT(3) }
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF FONT
+-----------------------------------------------------------------------------*/
+
+// segment bits of font
+#define _A      0x01
+#define _B      0x02
+#define _C      0x04
+#define _D      0x08
+#define _E      0x10
+#define _F      0x20
+#define _G      0x40
+
+/// first character in font
+#define LCD_FONT_FIRST          ' '
+
+/// 7-segment font for ASCII 0x20..0x5F. Lower case letters are mapped to upper case
+#define LCD_FONT { \
+  /* ' '..'/' */  0, _B|_F, _B|_F, 0, 0, 0, 0, _B, _A|_D|_E|_F, _A|_B|_C|_D, 0, 0, _E, _G, 0, _B|_E|_G, \
+  /* '0'..'9' */  _A|_B|_C|_D|_E|_F, _B|_C, _A|_B|_D|_E|_G, _A|_B|_C|_D|_G, _B|_C|_F|_G, \
+                  _A|_C|_D|_F|_G, _A|_C|_D|_E|_F|_G, _A|_B|_C, _A|_B|_C|_D|_E|_F|_G, _A|_B|_C|_D|_F|_G, \
+  /* ':'..'@' */  0, 0, 0, _D|_G, 0, _A|_B|_E|_G, 0, \
+  /* 'A'..'M' */  _A|_B|_C|_E|_F|_G, _C|_D|_E|_F|_G, _A|_D|_E|_F, _B|_C|_D|_E|_G, _A|_D|_E|_F|_G, _A|_E|_F|_G, _A|_C|_D|_E|_F, \
+                  _C|_E|_F|_G, _E|_F, _B|_C|_D|_E, _B|_C|_E|_F|_G, _D|_E|_F, _A|_C|_E, \
+  /* 'N'..'Z' */  _C|_E|_G, _C|_D|_E|_G, _A|_B|_E|_F|_G, _A|_B|_C|_F|_G, _E|_G, _A|_C|_D|_F|_G, _D|_E|_F|_G, \
+                  _C|_D|_E, _B|_C|_D|_E|_F, _B|_D|_F, _B|_C|_E|_F|_G, _B|_C|_D|_F|_G, _A|_B|_D|_E|_G, \
+  /* '['..'_' */  _A|_D|_E|_F, _C|_F|_G, _A|_B|_C|_D, _A, _D \
+}
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _LCD_GLASS_H_
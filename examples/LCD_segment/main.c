@@ -0,0 +1,114 @@
+/**********************
+  Segment LCD with shadow buffer, frame-synchronous update and active-halt between updates
+
+  supported hardware:
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+      with a 4-digit 7-segment glass, see lcd_glass.h
+
+  Functionality:
+    - LCD clocked by LSE, 1/4 duty, 1/3 bias, ~60Hz frame rate
+    - counter 00.00..99.99 is drawn into shadow buffer and committed at start of frame
+    - between updates the CPU sleeps 15 frames (~250ms) in active-halt, the LCD refreshes w/o CPU
+    - on counter overflow, display blinks for ~2s via hardware blinking
+    - green LED is on while CPU is active -> measure duty cycle with scope
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "lcd.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED_GREEN     sfr_PORTE.ODR.ODR7      // CPU active
+
+#define FRAMES_STEP   15                      // frames per counter step (~250ms)
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void draw_counter(uint16_t count)
+
+  \brief draw counter into LCD shadow buffer
+
+  \param[in]  count   counter 0..9999
+
+  draw counter as "xx.xx" into LCD shadow buffer w/o printf().
+*/
+void draw_counter(uint16_t count) {
+
+  char      str[6];
+
+  // convert to 4 digits via subtraction
+  str[0] = '0'; str[1] = '0'; str[2] = '.'; str[3] = '0'; str[4] = '0'; str[5] = 0;
+  while (count >= 1000) { count -= 1000; str[0]++; }
+  while (count >= 100)  { count -= 100;  str[1]++; }
+  while (count >= 10)   { count -= 10;   str[3]++; }
+  str[4] += (uint8_t) count;
+
+  // remove leading zero
+  if (str[0] == '0')
+    str[0] = ' ';
+
+  // draw into shadow buffer
+  lcd_puts(0, str);
+
+} // draw_counter
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint16_t  count = 0;
+
+  // configure LED pin as push-pull output
+  sfr_PORTE.DDR.DDR7 = 1;
+  sfr_PORTE.CR1.C17  = 1;
+
+  // start LCD with LSE
+  lcd_init(LCD_CLK_LSE);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // main loop
+  while (1) {
+
+    // CPU active
+    LED_GREEN = 1;
+
+    // draw new counter value and request commit at next frame start
+    draw_counter(count);
+    lcd_update();
+
+    // on overflow blink display for ~2s at ~1Hz (f_LCD=241Hz / 256)
+    if (++count > 9999) {
+      count = 0;
+      lcd_blink(LCD_BLINK_ALL, LCD_BLINKF_DIV256);
+      LED_GREEN = 0;
+      lcd_sleep(120);
+      lcd_blink(LCD_BLINK_OFF, 0);
+    }
+
+    // sleep in active-halt until next step. Commit is done meanwhile
+    LED_GREEN = 0;
+    lcd_sleep(FRAMES_STEP);
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,573 @@
+/**
+  \file lin.c
+
+  \author G. Icking-Konert
+  \date 2021-10-02
+  \version 0.1
+
+  \brief implementation of LIN 2.x master/slave driver on LINUART for STM8AF
+
+  implementation of header handling, response transfer with read-back and
+  checksum, and master schedule table. For details see lin.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "lin.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// bits in LINUART_SR
+#define LIN_SR_FE             0x02            ///< framing error
+#define LIN_SR_OR_LHE         0x08            ///< overrun (master) or header error (slave)
+#define LIN_SR_RXNE           0x20            ///< data received
+
+// sync field
+#define LIN_SYNC              0x55
+
+// frame state
+#define LIN_IDLE              0               ///< wait for header
+#define LIN_BREAK             1               ///< master: wait for read-back of break and sync
+#define LIN_PID               2               ///< master: wait for read-back of PID
+#define LIN_TX                3               ///< send response, wait for read-back of byte
+#define LIN_RX                4               ///< receive response
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// protected ID (with parity bits P0/P1) of ID 0..63
+static const uint8_t      m_pidTab[64] = {
+  0x80, 0xC1, 0x42, 0x03, 0xC4, 0x85, 0x06, 0x47,
+  0x08, 0x49, 0xCA, 0x8B, 0x4C, 0x0D, 0x8E, 0xCF,
+  0x50, 0x11, 0x92, 0xD3, 0x14, 0x55, 0xD6, 0x97,
+  0xD8, 0x99, 0x1A, 0x5B, 0x9C, 0xDD, 0x5E, 0x1F,
+  0x20, 0x61, 0xE2, 0xA3, 0x64, 0x25, 0xA6, 0xE7,
+  0xA8, 0xE9, 0x6A, 0x2B, 0xEC, 0xAD, 0x2E, 0x6F,
+  0xF0, 0xB1, 0x32, 0x73, 0xB4, 0xF5, 0x76, 0x37,
+  0x78, 0x39, 0xBA, 0xFB, 0x3C, 0x7D, 0xFE, 0xBF
+};
+
+/// frame table and frame index of ID 0..63 (LIN_NONE = ignore). Set in lin_init()
+static const lin_frame_t  *m_frames;
+static uint8_t            m_idIdx[64];
+
+/// LIN_UPDATED / LIN_ERROR per frame
+static volatile uint8_t   m_status[LIN_FRAMES_MAX];
+
+/// current frame: state, index, PID, length, byte position, checksum and data
+static volatile uint8_t   m_state = LIN_IDLE;
+static uint8_t            m_frame = LIN_NONE;
+static uint8_t            m_pid;
+static uint8_t            m_len;
+static uint8_t            m_pos;
+static uint16_t           m_sum;
+static uint8_t            m_buf[9];
+
+/// TIM3 counter at entry of LIN_RX_ISR() for latency measurement
+#if LIN_LATENCY
+  static uint16_t         m_tEntry;
+#endif
+
+/// node role LIN_MASTER / LIN_SLAVE
+static uint8_t            m_role;
+
+/// master: active schedule table, current slot and remaining slot time [ms]
+static const lin_slot_t   *m_table;
+static uint8_t            m_tableNum = 0;
+static uint8_t            m_tableIdx = 0;
+static uint8_t            m_slotTime = 1;
+
+/// master: requested schedule table, applied at next slot boundary
+static const lin_slot_t   *m_reqTable;
+static uint8_t            m_reqNum;
+static volatile uint8_t   m_req = 0;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void lin_abort(void)
+
+  \brief abort current frame
+
+  called if a new header starts or the master slot ends before the frame is
+  complete. Count as missing response, or as bit error if the master header
+  was not read back. Called from ISR.
+*/
+static void lin_abort(void) {
+
+  if ((m_state == LIN_BREAK) || (m_state == LIN_PID))
+    g_linErrBit++;
+  else {
+    g_linErrNoResp++;
+    m_status[m_frame] |= LIN_ERROR;
+  }
+  m_state = LIN_IDLE;
+
+} // lin_abort
+
+
+
+#if LIN_LATENCY
+
+/**
+  \fn void lin_latency(void)
+
+  \brief update max. response latency
+
+  called after the 1st response byte was written to LINUART_DR. Time since
+  entry of LIN_RX_ISR() [cycles] is measured via TIM3 and its max. is
+  stored in g_linLatency. Called from ISR.
+*/
+static void lin_latency(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM3, CNTR);
+  t = (uint16_t) (t - m_tEntry);
+  if (t > g_linLatency)
+    g_linLatency = t;
+
+} // lin_latency
+
+#endif // LIN_LATENCY
+
+
+
+/**
+  \fn void lin_header(uint8_t pid)
+
+  \brief start response after PID
+
+  \param[in]  pid   received protected ID
+
+  check parity via table, look up frame of ID and start its response. For a
+  published frame the first byte is written to LINUART_DR before the data is
+  copied, i.e. the latency after the PID stop bit is constant (no loops).
+  Called from ISR.
+*/
+INLINE void lin_header(uint8_t pid) {
+
+  const lin_frame_t *frame;
+  uint8_t           id = (uint8_t) (pid & 0x3F);
+  uint8_t           i;
+
+  // parity error
+  if (m_pidTab[id] != pid) {
+    g_linErrHeader++;
+    m_state = LIN_IDLE;
+    return;
+  }
+
+  // ID not handled by this node
+  m_frame = m_idIdx[id];
+  if (m_frame == LIN_NONE) {
+    m_state = LIN_IDLE;
+    return;
+  }
+
+  // init frame. Enhanced checksum includes PID, diagnostic frames always classic
+  frame = &(m_frames[m_frame]);
+  m_len = frame->len;
+  m_pos = 0;
+  m_sum = ((frame->flags & LIN_CLASSIC) || (id >= 0x3C)) ? 0 : pid;
+
+  // publish: send 1st byte, then copy remaining data for consistency
+  if (frame->flags & LIN_PUBLISH) {
+    m_buf[0] = frame->data[0];
+    sfr_LINUART.DR.byte = m_buf[0];
+    #if LIN_LATENCY
+      lin_latency();
+    #endif
+    for (i=1; i<m_len; i++)
+      m_buf[i] = frame->data[i];
+    m_state = LIN_TX;
+  }
+
+  // subscribe: receive response
+  else
+    m_state = LIN_RX;
+
+} // lin_header
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void lin_init(uint16_t baud, uint8_t role, const lin_frame_t *frames, uint8_t num)
+
+  \brief init LIN node
+
+  \param[in]  baud    nominal baudrate, e.g. 19200
+  \param[in]  role    LIN_MASTER or LIN_SLAVE
+  \param[in]  frames  frame table. Must remain valid
+  \param[in]  num     number of frames (max. LIN_FRAMES_MAX)
+
+  build ID -> frame lookup table and set LINUART to LIN mode:
+    - slave: 11-bit break detection, header interrupt, automatic resynchronization
+    - master: 13-bit break generation, TIM2 1ms interrupt for schedule table
+  Interrupts must be enabled by application.
+*/
+void lin_init(uint16_t baud, uint8_t role, const lin_frame_t *frames, uint8_t num) {
+
+  uint16_t  div;
+  uint8_t   i;
+
+  // build lookup table ID -> frame index
+  if (num > LIN_FRAMES_MAX)
+    num = LIN_FRAMES_MAX;
+  for (i=0; i<64; i++)
+    m_idIdx[i] = LIN_NONE;
+  for (i=0; i<num; i++) {
+    m_idIdx[frames[i].id & 0x3F] = i;
+    m_status[i] = 0;
+  }
+  m_frames   = frames;
+  m_role     = role;
+  m_state    = LIN_IDLE;
+  m_tableNum = 0;
+  m_slotTime = 1;
+  m_req      = 0;
+
+  // disable LINUART
+  sfr_LINUART.CR2.byte = 0x00;
+  sfr_LINUART.CR3.byte = 0x00;
+  sfr_LINUART.CR6.byte = 0x00;
+
+  // set nominal baudrate. BRR2 must be written before BRR1
+  div = (uint16_t) (16000000L / (uint32_t) baud);
+  sfr_LINUART.BRR2.byte = (uint8_t) (((div >> 8) & 0xF0) | (div & 0x0F));
+  sfr_LINUART.BRR1.byte = (uint8_t) (div >> 4);
+
+  // 8N1, 11-bit break detection
+  sfr_LINUART.CR1.byte   = 0x00;
+  sfr_LINUART.CR4.byte   = 0x00;
+  sfr_LINUART.CR4.LBDL   = 1;
+
+  // TIM3 runs free at 16MHz for latency measurement. Separate from TIM2, which is the master schedule tick
+  #if LIN_LATENCY
+    sfr_TIM3.PSCR.byte = 0;
+    sfr_TIM3.CR1.CEN   = 1;
+  #endif
+
+  // slave: header detection with interrupt, automatic resynchronization (LDIV updated after sync field)
+  if (role == LIN_SLAVE) {
+    sfr_LINUART.CR6.LSLV   = 1;
+    sfr_LINUART.CR6.LASE   = 1;
+    sfr_LINUART.CR6.LHDIEN = 1;
+  }
+
+  // master: TIM2 1ms interrupt for schedule
+  else {
+    sfr_TIM2.CR1.byte  = 0x00;
+    sfr_TIM2.PSCR.byte = 4;                 // 16MHz/2^4 = 1MHz
+    sfr_TIM2.ARRH.byte = (uint8_t) (999 >> 8);
+    sfr_TIM2.ARRL.byte = (uint8_t) 999;
+    sfr_TIM2.EGR.UG    = 1;
+    sfr_TIM2.SR1.UIF   = 0;
+    sfr_TIM2.IER.UIE   = 1;
+    sfr_TIM2.CR1.CEN   = 1;
+  }
+
+  // enable LIN mode, receiver with interrupt and transmitter
+  sfr_LINUART.CR3.LINEN = 1;
+  sfr_LINUART.CR2.REN   = 1;
+  sfr_LINUART.CR2.TEN   = 1;
+  sfr_LINUART.CR2.RIEN  = 1;
+
+} // lin_init
+
+
+
+/**
+  \fn void lin_schedule(const lin_slot_t *table, uint8_t num)
+
+  \brief set master schedule table
+
+  \param[in]  table   schedule table. Must remain valid
+  \param[in]  num     number of slots, 0 = stop
+
+  the new table starts at the next slot boundary, i.e. a running frame is
+  completed. Only for LIN_MASTER.
+*/
+void lin_schedule(const lin_slot_t *table, uint8_t num) {
+
+  DISABLE_INTERRUPTS();
+  m_reqTable = table;
+  m_reqNum   = num;
+  m_req      = 1;
+  ENABLE_INTERRUPTS();
+
+} // lin_schedule
+
+
+
+/**
+  \fn void lin_read(uint8_t frame, uint8_t *data)
+
+  \brief read frame data
+
+  \param[in]  frame   index in frame table
+  \param[out] data    buffer for frame length bytes
+
+  copy data of last received frame with interrupts disabled, i.e. consistent.
+*/
+void lin_read(uint8_t frame, uint8_t *data) {
+
+  const lin_frame_t *f = &(m_frames[frame]);
+  uint8_t           i;
+
+  DISABLE_INTERRUPTS();
+  for (i=0; i<f->len; i++)
+    data[i] = f->data[i];
+  ENABLE_INTERRUPTS();
+
+} // lin_read
+
+
+
+/**
+  \fn void lin_write(uint8_t frame, const uint8_t *data)
+
+  \brief write frame data
+
+  \param[in]  frame   index in frame table
+  \param[in]  data    frame length bytes
+
+  copy data for next response with interrupts disabled, i.e. consistent. A
+  running response is not affected, because it was copied at the PID.
+*/
+void lin_write(uint8_t frame, const uint8_t *data) {
+
+  const lin_frame_t *f = &(m_frames[frame]);
+  uint8_t           i;
+
+  DISABLE_INTERRUPTS();
+  for (i=0; i<f->len; i++)
+    f->data[i] = data[i];
+  ENABLE_INTERRUPTS();
+
+} // lin_write
+
+
+
+/**
+  \fn uint8_t lin_status(uint8_t frame)
+
+  \brief get and clear frame status
+
+  \param[in]  frame   index in frame table
+
+  \return LIN_UPDATED and/or LIN_ERROR since last call
+*/
+uint8_t lin_status(uint8_t frame) {
+
+  uint8_t   status;
+
+  DISABLE_INTERRUPTS();
+  status = m_status[frame];
+  m_status[frame] = 0;
+  ENABLE_INTERRUPTS();
+
+  return(status);
+
+} // lin_status
+
+
+
+/**
+  \fn void LIN_RX_ISR(void)
+
+  \brief ISR for LINUART receive, header detection and errors
+
+  slave: on header detection start response via lin_header(). Master: check
+  read-back of break, sync and PID. Then for each response byte:
+    - publish: compare read-back with sent byte, add to checksum, send next
+      byte or checksum
+    - subscribe: store byte and add to checksum, compare checksum
+  Errors abort the frame until the next header.
+*/
+ISR_HANDLER(LIN_RX_ISR, _LINUART_RXNE_VECTOR_) {
+
+  uint8_t   sr, data;
+
+  // start of latency measurement. Adds the counter read (few cycles) to the response latency
+  #if LIN_LATENCY
+    READ16(m_tEntry, sfr_TIM3, CNTR);
+  #endif
+
+  // read SR, then DR clears flags
+  sr   = sfr_LINUART.SR.byte;
+  data = sfr_LINUART.DR.byte;
+
+  // slave: header detected, PID in DR (sync field consumed by hardware)
+  if (sfr_LINUART.CR6.LHDF) {
+    sfr_LINUART.CR6.LHDF = 0;
+    if (m_state != LIN_IDLE)
+      lin_abort();
+    if (sr & LIN_SR_OR_LHE) {
+      g_linErrHeader++;
+      return;
+    }
+    lin_header(data);
+    return;
+  }
+
+  // slave: header error w/o header (e.g. sync field deviation)
+  if ((m_role == LIN_SLAVE) && (sr & LIN_SR_OR_LHE)) {
+    g_linErrHeader++;
+    m_state = LIN_IDLE;
+    return;
+  }
+
+  // no data received
+  if (!(sr & LIN_SR_RXNE))
+    return;
+
+  switch (m_state) {
+
+    // master: ignore break (0x00 with framing error), then read-back of sync -> send PID
+    case LIN_BREAK:
+      if ((data == 0x00) && (sr & LIN_SR_FE))
+        break;
+      if ((data == LIN_SYNC) && !(sr & (LIN_SR_FE | LIN_SR_OR_LHE))) {
+        sfr_LINUART.DR.byte = m_pid;
+        m_state = LIN_PID;
+      }
+      else
+        lin_abort();
+      break;
+
+    // master: read-back of PID -> start response
+    case LIN_PID:
+      if ((data == m_pid) && !(sr & (LIN_SR_FE | LIN_SR_OR_LHE)))
+        lin_header(data);
+      else
+        lin_abort();
+      break;
+
+    // publish: check read-back, then send next byte or checksum
+    case LIN_TX:
+      if ((data != m_buf[m_pos]) || (sr & (LIN_SR_FE | LIN_SR_OR_LHE))) {
+        g_linErrBit++;
+        m_status[m_frame] |= LIN_ERROR;
+        m_state = LIN_IDLE;
+        break;
+      }
+      if (m_pos == m_len) {
+        g_linOk++;
+        m_status[m_frame] |= LIN_UPDATED;
+        m_state = LIN_IDLE;
+        break;
+      }
+      m_sum += data;
+      if (m_sum > 0xFF)
+        m_sum -= 0xFF;
+      if (++m_pos == m_len)
+        m_buf[m_pos] = (uint8_t) ~m_sum;
+      sfr_LINUART.DR.byte = m_buf[m_pos];
+      break;
+
+    // subscribe: store data, then compare checksum
+    case LIN_RX:
+      if (sr & (LIN_SR_FE | LIN_SR_OR_LHE)) {
+        g_linErrBit++;
+        m_status[m_frame] |= LIN_ERROR;
+        m_state = LIN_IDLE;
+        break;
+      }
+      if (m_pos < m_len) {
+        m_buf[m_pos++] = data;
+        m_sum += data;
+        if (m_sum > 0xFF)
+          m_sum -= 0xFF;
+        break;
+      }
+      if (data == (uint8_t) ~m_sum) {
+        for (m_pos=0; m_pos<m_len; m_pos++)
+          m_frames[m_frame].data[m_pos] = m_buf[m_pos];
+        g_linOk++;
+        m_status[m_frame] |= LIN_UPDATED;
+      }
+      else {
+        g_linErrChecksum++;
+        m_status[m_frame] |= LIN_ERROR;
+      }
+      m_state = LIN_IDLE;
+      break;
+
+    // idle: ignore
+    default:
+      break;
+
+  } // switch (m_state)
+
+} // LIN_RX_ISR
+
+
+
+/**
+  \fn void LIN_TIM_ISR(void)
+
+  \brief ISR for master schedule (TIM2, 1ms)
+
+  at the end of a slot abort an incomplete frame, apply a requested schedule
+  table and start the header of the next slot: break (13 bit), sync and PID.
+  The PID is sent after read-back of the sync field.
+*/
+ISR_HANDLER(LIN_TIM_ISR, _TIM2_OVR_UIF_VECTOR_) {
+
+  const lin_frame_t *frame;
+
+  // clear flag
+  sfr_TIM2.SR1.UIF = 0;
+
+  // slot not finished
+  if (m_slotTime > 1) {
+    m_slotTime--;
+    return;
+  }
+
+  // slot end: previous frame incomplete
+  if (m_state != LIN_IDLE)
+    lin_abort();
+
+  // apply new schedule table
+  if (m_req) {
+    m_table    = m_reqTable;
+    m_tableNum = m_reqNum;
+    m_tableIdx = 0;
+    m_req      = 0;
+  }
+  if (m_tableNum == 0)
+    return;
+
+  // start next slot
+  m_frame    = m_table[m_tableIdx].frame;
+  m_slotTime = m_table[m_tableIdx].slot;
+  if (++m_tableIdx >= m_tableNum)
+    m_tableIdx = 0;
+
+  // send break and sync. PID follows after read-back of sync
+  frame = &(m_frames[m_frame]);
+  m_pid = m_pidTab[frame->id & 0x3F];
+  m_state = LIN_BREAK;
+  sfr_LINUART.CR2.SBK = 1;
+  sfr_LINUART.DR.byte = LIN_SYNC;
+
+} // LIN_TIM_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,154 @@
+/**
+  \file lin.h
+
+  \author G. Icking-Konert
+  \date 2021-10-02
+  \version 0.1
+
+  \brief declaration of LIN 2.x master/slave driver on LINUART for STM8AF
+
+  declaration of a LIN 2.x driver using the LIN features of the LINUART:
+
+    - slave: hardware break and header detection (CR6.LHDF) with automatic
+      resynchronization to the sync field (CR6.LASE). The header interrupt
+      looks up the PID in a precomputed table and writes the first response
+      byte w/o loops, i.e. with bounded latency
+    - master: a schedule table is executed from a 1ms TIM2 interrupt. Each
+      slot sends break, sync and PID, followed by the response of the
+      publishing node
+    - response bytes are read back (single-wire bus) and compared to detect
+      bit errors. The checksum (classic or enhanced) is computed per byte in
+      the receive ISR
+
+  The application defines a table of frames with the direction of this node:
+
+    static uint8_t  cmd[2], status[4];
+    static const lin_frame_t frames[] = {
+      { 0x10, 2, LIN_SUBSCRIBE, cmd },                  // frame 0: received from master
+      { 0x20, 4, LIN_PUBLISH, status },                 // frame 1: sent by this node
+    };
+    lin_init(19200, LIN_SLAVE, frames, 2);
+
+  Data is exchanged via lin_write() / lin_read(), i.e. consistently per frame.
+  Frames with an ID not in the table are ignored.
+
+  \note LINUART Tx = PD5, Rx = PD6. A LIN transceiver is required
+  \note diagnostic frames 0x3C/0x3D always use the classic checksum, sleep/wake-up is not supported
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _LIN_H_
+#define _LIN_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// max. number of frames in frame table; can be overwritten via compiler option
+#ifndef LIN_FRAMES_MAX
+  #define LIN_FRAMES_MAX        16
+#endif
+
+// measure slave response latency (ISR entry -> 1st byte in LINUART_DR) with TIM3 at fCPU; can be overwritten via compiler option
+#ifndef LIN_LATENCY
+  #define LIN_LATENCY           1
+#endif
+
+// node role for lin_init()
+#define LIN_SLAVE               0             ///< respond to headers
+#define LIN_MASTER              1             ///< send headers from schedule table
+
+// frame direction and checksum for lin_frame_t.flags
+#define LIN_SUBSCRIBE           0x00          ///< response is received
+#define LIN_PUBLISH             0x01          ///< response is sent by this node
+#define LIN_CLASSIC             0x02          ///< classic checksum (LIN 1.x), default enhanced
+
+// frame status for lin_status()
+#define LIN_UPDATED             0x01          ///< frame transferred since last call
+#define LIN_ERROR               0x02          ///< transfer error since last call
+
+// no frame
+#define LIN_NONE                0xFF
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPES
+-----------------------------------------------------------------------------*/
+
+/// frame description
+typedef struct {
+  uint8_t   id;                   ///< frame ID 0..63
+  uint8_t   len;                  ///< data length 1..8
+  uint8_t   flags;                ///< LIN_PUBLISH or LIN_SUBSCRIBE, or'ed with LIN_CLASSIC
+  uint8_t   *data;                ///< data buffer [len]. Access via lin_read() / lin_write()
+} lin_frame_t;
+
+/// schedule table entry (master)
+typedef struct {
+  uint8_t   frame;                ///< index in frame table
+  uint8_t   slot;                 ///< slot time [ms], >= frame time
+} lin_slot_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint16_t g_linOk = 0;                ///< frames transferred w/o error
+  volatile uint16_t g_linErrHeader = 0;         ///< PID parity or sync field errors
+  volatile uint16_t g_linErrBit = 0;            ///< read-back mismatch, framing or overrun errors
+  volatile uint16_t g_linErrChecksum = 0;       ///< checksum errors
+  volatile uint16_t g_linErrNoResp = 0;         ///< missing or incomplete responses
+  volatile uint16_t g_linLatency = 0;           ///< max. cycles from ISR entry to 1st response byte in DR (LIN_LATENCY=1)
+#else // _MAIN_
+  extern volatile uint16_t g_linOk;
+  extern volatile uint16_t g_linErrHeader;
+  extern volatile uint16_t g_linErrBit;
+  extern volatile uint16_t g_linErrChecksum;
+  extern volatile uint16_t g_linErrNoResp;
+  extern volatile uint16_t g_linLatency;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init LINUART as LIN master or slave with frame table. Interrupts must be enabled by application
+void      lin_init(uint16_t baud, uint8_t role, const lin_frame_t *frames, uint8_t num);
+
+/// master: execute schedule table of 'num' slots, starting with next slot. num=0 stops
+void      lin_schedule(const lin_slot_t *table, uint8_t num);
+
+/// copy data of frame into buffer (subscribed frames)
+void      lin_read(uint8_t frame, uint8_t *data);
+
+/// copy buffer into data of frame (published frames)
+void      lin_write(uint8_t frame, const uint8_t *data);
+
+/// return and clear LIN_UPDATED / LIN_ERROR of frame
+uint8_t   lin_status(uint8_t frame);
+
+/// ISR for LINUART receive, header detection and errors
+ISR_HANDLER(LIN_RX_ISR, _LINUART_RXNE_VECTOR_);
+
+/// ISR for master schedule (TIM2, 1ms)
+ISR_HANDLER(LIN_TIM_ISR, _TIM2_OVR_UIF_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _LIN_H_
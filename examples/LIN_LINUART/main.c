@@ -0,0 +1,187 @@
+/**********************
+  LIN 2.x master or slave node on LINUART
+
+  supported hardware:
+    - STM8AF5288 (e.g. STM8A Discovery board) with LIN transceiver, other STM8AF/STM8AL with LINUART
+
+  Functionality:
+    - node role is selected via NODE_ROLE (default master, -DNODE_ROLE=LIN_SLAVE for slave)
+    - master: schedule table sends frame 0x10 (command) and header 0x20 (status) in alternating 10ms slots
+    - slave: receives command 0x10 and responds to 0x20 with its status
+    - every 1s print frame and error counters and last data via UART (19.2kBaud)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "timer4.h"
+  #include "uart.h"
+  #include "lin.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// node role; can be overwritten via compiler option
+#ifndef NODE_ROLE
+  #define NODE_ROLE     LIN_MASTER
+#endif
+
+// LIN baudrate
+#define LIN_BAUD        19200
+
+// frame indices in m_frames[]
+#define FRAME_CMD       0
+#define FRAME_STATUS    1
+
+// direction of frames for this node
+#if (NODE_ROLE == LIN_MASTER)
+  #define DIR_CMD       LIN_PUBLISH
+  #define DIR_STATUS    LIN_SUBSCRIBE
+#else
+  #define DIR_CMD       LIN_SUBSCRIBE
+  #define DIR_STATUS    LIN_PUBLISH
+#endif
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// frame data
+static uint8_t  m_cmd[2];         // command: counter, flags
+static uint8_t  m_status[4];      // status: last command counter, number of commands (16-bit), key
+
+/// frame table of this node
+static const lin_frame_t m_frames[] = {
+  { 0x10, sizeof(m_cmd),    DIR_CMD,    m_cmd },
+  { 0x20, sizeof(m_status), DIR_STATUS, m_status }
+};
+
+/// master schedule table: 2 slots of 10ms
+static const lin_slot_t m_schedule[] = {
+  { FRAME_CMD,    10 },
+  { FRAME_STATUS, 10 }
+};
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint8_t   cmd[2] = { 0, 0 };
+  uint8_t   status[4] = { 0, 0, 0, 0 };
+  uint32_t  nextPrint = 1000;
+  #if (NODE_ROLE != LIN_MASTER)
+    uint16_t  numCmd = 0;
+  #endif
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // init 1ms interrupt
+  TIM4_init();
+
+  // init LIN node. Master starts schedule table
+  lin_init(LIN_BAUD, NODE_ROLE, m_frames, sizeof(m_frames)/sizeof(m_frames[0]));
+  #if (NODE_ROLE == LIN_MASTER)
+    lin_schedule(m_schedule, sizeof(m_schedule)/sizeof(m_schedule[0]));
+  #endif
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  printf("\nLIN %s, %ubaud\n", (NODE_ROLE == LIN_MASTER) ? "master" : "slave", (uint16_t) LIN_BAUD);
+
+
+  // main loop
+  while(1) {
+
+    #if (NODE_ROLE == LIN_MASTER)
+
+      // command sent -> update counter for next frame
+      if (lin_status(FRAME_CMD) & LIN_UPDATED) {
+        cmd[0]++;
+        cmd[1] = g_key;
+        lin_write(FRAME_CMD, cmd);
+      }
+
+      // status received
+      if (lin_status(FRAME_STATUS) & LIN_UPDATED)
+        lin_read(FRAME_STATUS, status);
+
+    #else // LIN_SLAVE
+
+      // command received -> update status for next response
+      if (lin_status(FRAME_CMD) & LIN_UPDATED) {
+        lin_read(FRAME_CMD, cmd);
+        numCmd++;
+        status[0] = cmd[0];
+        status[1] = (uint8_t) (numCmd >> 8);
+        status[2] = (uint8_t) numCmd;
+        status[3] = g_key;
+        lin_write(FRAME_STATUS, status);
+      }
+
+    #endif // NODE_ROLE
+
+    // print statistics every 1s
+    if (g_millis >= nextPrint) {
+      nextPrint += 1000;
+      printf("ok %u, header %u, bit %u, checksum %u, no resp %u | cmd %d, status %d %u | latency %u cycles\n",
+        g_linOk, g_linErrHeader, g_linErrBit, g_linErrChecksum, g_linErrNoResp,
+        (int) cmd[0], (int) status[0], ((uint16_t) status[1] << 8) | status[2], g_linLatency);
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
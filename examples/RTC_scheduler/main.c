@@ -0,0 +1,116 @@
+/**********************
+  Task scheduler with RTC time-keeping in active-halt
+
+  supported hardware:
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - RTC clocked by LSE, calendar set at first start
+    - task scheduler with 1ms TIM4 tick (see Task_Scheduler) while CPU is active
+    - if next task is due in >=5ms, enter active-halt and wake via RTC wake-up timer.
+      Sleep time is added to millis() and scheduler -> no time is lost in halt
+    - task 1: flash green LED for 20ms every 2s
+    - RTC alarm every minute at second 0: toggle blue LED
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "Tasks.h"
+#define _MAIN_          // required for global variables
+  #include "rtc.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED_GREEN     sfr_PORTE.ODR.ODR7      // task LED
+#define LED_BLUE      sfr_PORTC.ODR.ODR7      // alarm LED
+
+
+/*----------------------------------------------------------
+    TASKS
+----------------------------------------------------------*/
+
+/// switch green LED off. Single-shot task
+void led_off(void) {
+
+  LED_GREEN = 0;
+
+} // led_off
+
+
+/// switch green LED on and schedule switch off in 20ms. Call every 2s
+void led_flash(void) {
+
+  LED_GREEN = 1;
+  Tasks_Add(led_off, 0, 20);
+
+} // led_flash
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  rtc_time_t    time  = { 21, 7, 31, 6, 12, 0, 0, 0 };     // 2021-07-31 (saturday) 12:00:00
+  rtc_alarm_t   alarm = { 0, 0, 0, 0, 0, RTC_ALARM_MASK_DAY | RTC_ALARM_MASK_HOUR | RTC_ALARM_MASK_MINUTE };
+  int16_t       next;
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pins as push-pull outputs
+  sfr_PORTE.DDR.DDR7 = 1;
+  sfr_PORTE.CR1.C17  = 1;
+  sfr_PORTC.DDR.DDR7 = 1;
+  sfr_PORTC.CR1.C17  = 1;
+
+  // start RTC with LSE. Set calendar only at first start
+  rtc_init(RTC_CLK_LSE);
+  if (!sfr_RTC.ISR1.INITS)
+    rtc_set_time(&time);
+
+  // alarm every minute at second 0
+  rtc_set_alarm(&alarm);
+
+  // init scheduler and add task
+  Tasks_Init();
+  Tasks_Clear();
+  Tasks_Add(led_flash, 2000, 0);
+  Tasks_Start();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // main loop
+  while (1) {
+
+    // next task is far enough -> sleep in active-halt, then advance millis() and scheduler
+    next = Tasks_NextEvent();
+    if (next >= RTC_SLEEP_MIN)
+      Tasks_Advance(rtc_sleep((uint32_t) next));
+
+    // else wait for next 1ms tick
+    else
+      WAIT_FOR_INTERRUPT();
+
+    // RTC alarm -> toggle blue LED
+    if (g_rtcAlarm) {
+      g_rtcAlarm = 0;
+      LED_BLUE ^= 1;
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,560 @@
+/**
+  \file rtc.c
+
+  \author G. Icking-Konert
+  \date 2021-07-31
+  \version 0.1
+
+  \brief implementation of RTC driver for STM8L with calendar, wake-up timer, alarm and calibration
+
+  implementation of STM8L RTC access incl. write protection, init mode,
+  shadow register handling and active-halt sleep. For details see rtc.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "rtc.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+/// disable RTC write protection via key sequence
+#define RTC_UNLOCK()      { sfr_RTC.WPR.byte = 0xCA; sfr_RTC.WPR.byte = 0x53; }
+
+/// enable RTC write protection via wrong key
+#define RTC_LOCK()        { sfr_RTC.WPR.byte = 0xFF; }
+
+// external clock control register is named ECKCR or ECKR, depending on device
+#if defined(sfr_CLK_ECKCR_RESET_VALUE)
+  #define RTC_ECKR        ECKCR
+#else
+  #define RTC_ECKR        ECKR
+#endif
+
+// status flags in RTC_ISR2. Cleared by writing 0, writing 1 has no effect
+#define RTC_FLAG_ALRAF    0x01
+#define RTC_FLAG_WUTF     0x04
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// remainder of wake-up timer sleep times [ms*RTC_CLK_HZ/16], carried to next rtc_sleep() -> no drift of millis()
+uint16_t    m_sleepRest;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/// convert binary 0..99 to BCD
+static uint8_t bin2bcd(uint8_t val) {
+  uint8_t tens = 0;
+  while (val >= 10) {
+    val -= 10;
+    tens++;
+  }
+  return((uint8_t) ((tens << 4) | val));
+}
+
+/// convert BCD to binary 0..99. Tens*10 via shift & add
+static uint8_t bcd2bin(uint8_t val) {
+  uint8_t tens = (uint8_t) (val >> 4);
+  return((uint8_t) ((tens << 3) + (tens << 1) + (val & 0x0F)));
+}
+
+
+/**
+  \fn void rtc_enter_init(void)
+
+  \brief enter RTC init mode
+
+  disable write protection and enter init mode. Calendar counter is stopped
+  until rtc_exit_init(). Waits max. 2 RTCCLK cycles.
+*/
+static void rtc_enter_init(void) {
+
+  RTC_UNLOCK();
+  sfr_RTC.ISR1.INIT = 1;
+  while (!sfr_RTC.ISR1.INITF);
+
+} // rtc_enter_init
+
+
+
+/**
+  \fn void rtc_exit_init(void)
+
+  \brief exit RTC init mode
+
+  exit init mode and enable write protection. Calendar starts counting.
+*/
+static void rtc_exit_init(void) {
+
+  sfr_RTC.ISR1.INIT = 0;
+  RTC_LOCK();
+
+} // rtc_exit_init
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void rtc_init(uint8_t clockSource)
+
+  \brief initialize RTC
+
+  \param[in]  clockSource   RTC clock source (RTC_CLK_LSE or RTC_CLK_LSI)
+
+  start RTC clock source and select it for RTC. If calendar is not yet
+  initialized (RTC_ISR1.INITS=0), set prescalers for 1Hz and 24h format.
+  Else calendar keeps running, e.g. after a reset w/o power loss.
+*/
+void rtc_init(uint8_t clockSource) {
+
+  // enable RTC clock
+  sfr_CLK.PCKENR2.PCKEN22 = 1;
+
+  // start LSE or LSI and wait until stable
+  if (clockSource == RTC_CLK_LSE) {
+    sfr_CLK.RTC_ECKR.LSEON = 1;
+    while (!sfr_CLK.RTC_ECKR.LSERDY);
+  }
+  else {
+    sfr_CLK.ICKCR.LSION = 1;
+    while (!sfr_CLK.ICKCR.LSIRDY);
+  }
+
+  // select RTC clock source w/o divider and wait until switch is done
+  sfr_CLK.CRTCR.byte = clockSource;
+  while (sfr_CLK.CRTCR.RTCSWBSY);
+
+  // calendar already initialized -> keep it
+  if (sfr_RTC.ISR1.INITS)
+    return;
+
+  // set prescalers for 1Hz calendar clock (synchronous first) and 24h format
+  rtc_enter_init();
+  sfr_RTC.SPRERH.byte = (uint8_t) (RTC_PREDIV_S >> 8);
+  sfr_RTC.SPRERL.byte = (uint8_t) (RTC_PREDIV_S);
+  sfr_RTC.APRER.byte  = RTC_PREDIV_A;
+  sfr_RTC.CR1.FMT     = 0;
+  rtc_exit_init();
+
+} // rtc_init
+
+
+
+/**
+  \fn void rtc_set_time(const rtc_time_t *time)
+
+  \brief set calendar time and date
+
+  \param[in]  time    new time and date. Field 'millis' is ignored
+
+  set calendar time and date in init mode. The sub-second counter restarts,
+  i.e. the next second starts 1s after this call.
+*/
+void rtc_set_time(const rtc_time_t *time) {
+
+  rtc_enter_init();
+  sfr_RTC.TR1.byte = bin2bcd(time->second);
+  sfr_RTC.TR2.byte = bin2bcd(time->minute);
+  sfr_RTC.TR3.byte = bin2bcd(time->hour);
+  sfr_RTC.DR1.byte = bin2bcd(time->day);
+  sfr_RTC.DR2.byte = (uint8_t) ((time->weekday << 5) | bin2bcd(time->month));
+  sfr_RTC.DR3.byte = bin2bcd(time->year);
+  rtc_exit_init();
+
+} // rtc_set_time
+
+
+
+/**
+  \fn void rtc_get_time(rtc_time_t *time)
+
+  \brief read calendar time and date consistently
+
+  \param[out] time    current time and date
+
+  read calendar from shadow registers. Reading the sub-second register (or
+  RTC_TR1 on devices w/o) freezes the higher-order registers until RTC_DR3
+  is read, therefore the registers are read from sub-second up to year.
+  After wake from halt call rtc_sync() first.
+*/
+void rtc_get_time(rtc_time_t *time) {
+
+  uint8_t   tr1, tr2, tr3, dr1, dr2, dr3;
+  #if RTC_HAS_SUBSECOND
+    uint16_t  ss;
+  #endif
+
+  // read registers in locking order: sub-seconds -> TR1..3 -> DR1..3 (unlock).
+  // Reading SSRL locks the higher-order registers incl. SSRH, therefore read SSRL first
+  #if RTC_HAS_SUBSECOND
+    ss  = sfr_RTC.SSRL.byte;
+    ss |= (uint16_t) sfr_RTC.SSRH.byte << 8;
+  #endif
+  tr1 = sfr_RTC.TR1.byte;
+  tr2 = sfr_RTC.TR2.byte;
+  tr3 = sfr_RTC.TR3.byte;
+  dr1 = sfr_RTC.DR1.byte;
+  dr2 = sfr_RTC.DR2.byte;
+  dr3 = sfr_RTC.DR3.byte;
+
+  // convert from BCD
+  time->second  = bcd2bin(tr1 & 0x7F);
+  time->minute  = bcd2bin(tr2 & 0x7F);
+  time->hour    = bcd2bin(tr3 & 0x3F);
+  time->day     = bcd2bin(dr1 & 0x3F);
+  time->month   = bcd2bin(dr2 & 0x1F);
+  time->weekday = (uint8_t) (dr2 >> 5);
+  time->year    = bcd2bin(dr3);
+
+  // sub-second counter runs down from PREDIV_S to 0
+  #if RTC_HAS_SUBSECOND
+    if (ss > RTC_PREDIV_S)            // after negative shift
+      ss = RTC_PREDIV_S;
+    time->millis = (uint16_t) (((uint32_t) (RTC_PREDIV_S - ss) * 1000L) / (RTC_PREDIV_S + 1));
+  #else
+    time->millis = 0;
+  #endif
+
+} // rtc_get_time
+
+
+
+/**
+  \fn void rtc_sync(void)
+
+  \brief wait for calendar shadow register update
+
+  clear RTC_ISR1.RSF and wait until shadow registers are updated from
+  the calendar counter. Required after wake from halt, else rtc_get_time()
+  may return the time of entering halt. Takes ~2 RTCCLK cycles.
+*/
+void rtc_sync(void) {
+
+  RTC_UNLOCK();
+  sfr_RTC.ISR1.RSF = 0;
+  RTC_LOCK();
+  while (!sfr_RTC.ISR1.RSF);
+
+} // rtc_sync
+
+
+
+/**
+  \fn uint32_t rtc_timestamp(void)
+
+  \brief get milliseconds since midnight
+
+  \return milliseconds since midnight (0..86399999)
+
+  return calendar time of day in milliseconds. Resolution is 1s on devices
+  w/o sub-second register.
+*/
+uint32_t rtc_timestamp(void) {
+
+  rtc_time_t  t;
+
+  rtc_get_time(&t);
+  return(((uint32_t) ((uint16_t) t.hour * 60 + t.minute) * 60 + t.second) * 1000L + t.millis);
+
+} // rtc_timestamp
+
+
+
+/**
+  \fn void rtc_set_wakeup(uint8_t clock, uint16_t reload)
+
+  \brief start periodic wake-up timer
+
+  \param[in]  clock   wake-up timer clock (RTC_WUCK_xxx)
+  \param[in]  reload  reload value. Period is (reload+1) clock cycles
+
+  configure and start wake-up timer with interrupt. Wake-up interrupt
+  also exits active-halt. Flag g_rtcWakeup is set on each event.
+*/
+void rtc_set_wakeup(uint8_t clock, uint16_t reload) {
+
+  RTC_UNLOCK();
+
+  // stop timer and wait until reload is writable
+  sfr_RTC.CR2.WUTE = 0;
+  while (!sfr_RTC.ISR1.WUTWF);
+
+  // set clock and reload value
+  sfr_RTC.CR1.WUCKSEL = clock;
+  sfr_RTC.WUTRH.byte  = (uint8_t) (reload >> 8);
+  sfr_RTC.WUTRL.byte  = (uint8_t) (reload);
+
+  // clear pending event, enable interrupt and start timer
+  sfr_RTC.ISR2.byte  = (uint8_t) ~RTC_FLAG_WUTF;
+  sfr_RTC.CR2.WUTIE  = 1;
+  sfr_RTC.CR2.WUTE   = 1;
+
+  RTC_LOCK();
+
+} // rtc_set_wakeup
+
+
+
+/**
+  \fn void rtc_stop_wakeup(void)
+
+  \brief stop wake-up timer
+
+  stop wake-up timer and disable its interrupt.
+*/
+void rtc_stop_wakeup(void) {
+
+  RTC_UNLOCK();
+  sfr_RTC.CR2.WUTE  = 0;
+  sfr_RTC.CR2.WUTIE = 0;
+  RTC_LOCK();
+
+} // rtc_stop_wakeup
+
+
+
+/**
+  \fn void rtc_set_alarm(const rtc_alarm_t *alarm)
+
+  \brief set and enable alarm A
+
+  \param[in]  alarm   alarm time and masks
+
+  configure alarm A with interrupt. Masked fields are ignored, e.g. mask
+  RTC_ALARM_MASK_DAY | RTC_ALARM_MASK_HOUR | RTC_ALARM_MASK_MINUTE with second=0
+  triggers every minute. Sub-seconds are ignored. Flag g_rtcAlarm is set on each event.
+*/
+void rtc_set_alarm(const rtc_alarm_t *alarm) {
+
+  RTC_UNLOCK();
+
+  // disable alarm and wait until alarm registers are writable
+  sfr_RTC.CR2.ALRAE = 0;
+  while (!sfr_RTC.ISR1.ALRAWF);
+
+  // set alarm fields incl. mask bits (MSKx = bit 7)
+  sfr_RTC.ALRMAR1.byte = (uint8_t) (bin2bcd(alarm->second) | ((alarm->mask & RTC_ALARM_MASK_SECOND) ? 0x80 : 0x00));
+  sfr_RTC.ALRMAR2.byte = (uint8_t) (bin2bcd(alarm->minute) | ((alarm->mask & RTC_ALARM_MASK_MINUTE) ? 0x80 : 0x00));
+  sfr_RTC.ALRMAR3.byte = (uint8_t) (bin2bcd(alarm->hour)   | ((alarm->mask & RTC_ALARM_MASK_HOUR)   ? 0x80 : 0x00));
+  sfr_RTC.ALRMAR4.byte = (uint8_t) (bin2bcd(alarm->day)    | ((alarm->mask & RTC_ALARM_MASK_DAY)    ? 0x80 : 0x00) | (alarm->weekday ? 0x40 : 0x00));
+
+  // ignore sub-seconds
+  #if RTC_HAS_SUBSECOND
+    sfr_RTC.ALRMASSMSKR.byte = 0x00;
+  #endif
+
+  // clear pending event, enable interrupt and alarm
+  sfr_RTC.ISR2.byte  = (uint8_t) ~RTC_FLAG_ALRAF;
+  sfr_RTC.CR2.ALRAIE = 1;
+  sfr_RTC.CR2.ALRAE  = 1;
+
+  RTC_LOCK();
+
+} // rtc_set_alarm
+
+
+
+/**
+  \fn void rtc_stop_alarm(void)
+
+  \brief disable alarm A
+
+  disable alarm A and its interrupt.
+*/
+void rtc_stop_alarm(void) {
+
+  RTC_UNLOCK();
+  sfr_RTC.CR2.ALRAE  = 0;
+  sfr_RTC.CR2.ALRAIE = 0;
+  RTC_LOCK();
+
+} // rtc_stop_alarm
+
+
+
+#if RTC_HAS_SUBSECOND
+
+/**
+  \fn void rtc_calibrate(int16_t ppm)
+
+  \brief smooth calibration
+
+  \param[in]  ppm   correction [ppm] within -487..+488. Positive value speeds up RTC
+
+  set smooth calibration. Within each 32s cycle (2^20 RTCCLK at 32.768kHz)
+  CALP inserts 512 pulses and CALM masks 0..511 pulses, i.e. 1ppm = 1.048576
+  pulses. Correction is spread over the cycle, no jitter of the calendar.
+*/
+void rtc_calibrate(int16_t ppm) {
+
+  uint16_t  calm;
+  uint8_t   calp = 0;
+
+  // clip to valid range
+  if (ppm > 488)
+    ppm = 488;
+  else if (ppm < -487)
+    ppm = -487;
+
+  // positive correction: insert 512 pulses, mask remainder. Negative: only mask pulses
+  if (ppm > 0) {
+    calp = 0x80;
+    calm = (uint16_t) (512 - (uint16_t) (((uint32_t) ppm * 1049L) / 1000L));
+  }
+  else
+    calm = (uint16_t) (((uint32_t) (-ppm) * 1049L) / 1000L);
+
+  // wait until previous calibration is applied, then write CALRH first
+  RTC_UNLOCK();
+  while (sfr_RTC.ISR1.RECALPF);
+  sfr_RTC.CALRH.byte = (uint8_t) (calp | (uint8_t) (calm >> 8));
+  sfr_RTC.CALRL.byte = (uint8_t) (calm);
+  RTC_LOCK();
+
+} // rtc_calibrate
+
+
+
+/**
+  \fn void rtc_shift(uint8_t add1s, uint16_t subfs)
+
+  \brief shift calendar by fraction of a second
+
+  \param[in]  add1s   1 = add 1s
+  \param[in]  subfs   sub-second ticks to subtract (0..PREDIV_S)
+
+  shift calendar by (add1s - subfs/(PREDIV_S+1)) seconds, e.g. to synchronize
+  to an external time reference w/o stopping the calendar.
+*/
+void rtc_shift(uint8_t add1s, uint16_t subfs) {
+
+  RTC_UNLOCK();
+  while (sfr_RTC.ISR1.SHPF);
+  sfr_RTC.SHIFTRH.byte = (uint8_t) ((add1s ? 0x80 : 0x00) | (uint8_t) ((subfs >> 8) & 0x7F));
+  sfr_RTC.SHIFTRL.byte = (uint8_t) (subfs);
+  RTC_LOCK();
+
+} // rtc_shift
+
+#endif // RTC_HAS_SUBSECOND
+
+
+
+/**
+  \fn uint32_t rtc_sleep(uint32_t ms)
+
+  \brief enter active-halt and return elapsed time
+
+  \param[in]  ms    max. sleep time [ms]. Below RTC_SLEEP_MIN return immediately
+
+  \return elapsed time [ms], e.g. for Tasks_Advance()
+
+  program wake-up timer and enter active-halt. Only the RTC keeps running.
+    - up to 32s the wake-up timer runs with RTCCLK/16 (~0.5ms), above with 1Hz
+    - if woken by the wake-up timer, elapsed time is the programmed time. The
+      remainder of the conversion to ms is carried to the next call, i.e.
+      millis() doesn't drift against the RTC
+    - if woken early by another interrupt, elapsed time is measured via the
+      calendar (resolution ~1ms with sub-second register, else 1s)
+
+  \note TIM4 and other peripherals are stopped in halt
+*/
+uint32_t rtc_sleep(uint32_t ms) {
+
+  uint32_t  start, now, ticks, elapsed;
+  uint16_t  rest;
+  uint8_t   clock;
+
+  // too short for halt
+  if (ms < RTC_SLEEP_MIN)
+    return(0);
+
+  // wake-up clock and reload. Sleep is rounded down to full ticks, remainder of ms is carried to next call
+  if (ms <= 32000L) {
+    clock   = RTC_WUCK_DIV16;
+    ticks   = (ms * (RTC_CLK_HZ/16)) / 1000L;
+    if (ticks > 65536L)
+      ticks = 65536L;
+    elapsed = ticks * 1000L + m_sleepRest;
+    rest    = (uint16_t) (elapsed % (RTC_CLK_HZ/16));
+    elapsed = elapsed / (RTC_CLK_HZ/16);
+  }
+  else {
+    clock   = RTC_WUCK_1HZ;
+    ticks   = ms / 1000L;
+    if (ticks > 65536L)
+      ticks = 65536L;
+    elapsed = ticks * 1000L;
+    rest    = m_sleepRest;
+  }
+
+  // remember start time and start wake-up timer
+  start = rtc_timestamp();
+  g_rtcWakeup = 0;
+  rtc_set_wakeup(clock, (uint16_t) (ticks - 1));
+
+  // enter active-halt with main regulator off (SAHALT)
+  sfr_CLK.ICKCR.SAHALT = 1;
+  ENTER_HALT();
+
+  // stop wake-up timer and update calendar shadow registers
+  rtc_stop_wakeup();
+  rtc_sync();
+
+  // woken early by other interrupt -> measure via calendar (handle midnight)
+  if (!g_rtcWakeup) {
+    now = rtc_timestamp();
+    if (now < start)
+      now += 86400000L;
+    elapsed = now - start;
+  }
+
+  // woken by wake-up timer -> keep remainder for next call
+  else
+    m_sleepRest = rest;
+
+  return(elapsed);
+
+} // rtc_sleep
+
+
+
+/**
+  \fn void RTC_ISR(void)
+
+  \brief ISR for RTC wake-up timer and alarm A
+
+  clear event flags and set global flags g_rtcWakeup and g_rtcAlarm.
+*/
+ISR_HANDLER(RTC_ISR, _RTC_WAKEUP_VECTOR_) {
+
+  uint8_t   flags = sfr_RTC.ISR2.byte;
+
+  // wake-up timer event
+  if (flags & RTC_FLAG_WUTF) {
+    sfr_RTC.ISR2.byte = (uint8_t) ~RTC_FLAG_WUTF;
+    g_rtcWakeup = 1;
+  }
+
+  // alarm A event
+  if (flags & RTC_FLAG_ALRAF) {
+    sfr_RTC.ISR2.byte = (uint8_t) ~RTC_FLAG_ALRAF;
+    g_rtcAlarm = 1;
+  }
+
+} // RTC_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,178 @@
+/**
+  \file rtc.h
+
+  \author G. Icking-Konert
+  \date 2021-07-31
+  \version 0.1
+
+  \brief declaration of RTC driver for STM8L with calendar, wake-up timer, alarm and calibration
+
+  declaration of functions for the STM8L real-time clock:
+    - calendar read/write. Read is consistent, i.e. time and date belong to the same second
+    - periodic wake-up timer, also from active-halt
+    - alarm A with per-field masks, e.g. "every minute at second 0"
+    - smooth calibration and sub-second shift (devices with sub-second register)
+    - active-halt sleep with exact elapsed time for millis() and scheduler, see rtc_sleep()
+
+  Sub-second register, smooth calibration and shift register only exist on
+  some STM8L devices (e.g. STM8L152R8, not STM8L152C6). Their support is
+  selected automatically via RTC_HAS_SUBSECOND.
+
+  \note the RTC keeps running in active-halt, while the TIM4 1ms tick stops
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _RTC_H_
+#define _RTC_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// device has sub-second, shift and calibration registers
+#if defined(sfr_RTC_SSRL_RESET_VALUE)
+  #define RTC_HAS_SUBSECOND     1
+#else
+  #define RTC_HAS_SUBSECOND     0
+#endif
+
+// RTC clock source for rtc_init()
+#define RTC_CLK_LSI             0x04          ///< CLK_CRTCR.RTCSEL: LSI (~38kHz, uncalibrated)
+#define RTC_CLK_LSE             0x10          ///< CLK_CRTCR.RTCSEL: LSE (32.768kHz crystal)
+
+// RTC clock frequency [Hz]; can be overwritten via compiler option
+#ifndef RTC_CLK_HZ
+  #define RTC_CLK_HZ            32768L
+#endif
+
+// prescalers for 1Hz calendar clock. With sub-second register use ~1ms resolution, else min. power
+#if RTC_HAS_SUBSECOND
+  #define RTC_PREDIV_A          31                                          ///< 32768Hz/32 = 1024Hz
+  #define RTC_PREDIV_S          ((uint16_t) (RTC_CLK_HZ/32 - 1))            ///< 1024Hz/1024 = 1Hz
+#else
+  #define RTC_PREDIV_A          127                                         ///< 32768Hz/128 = 256Hz
+  #define RTC_PREDIV_S          ((uint16_t) (RTC_CLK_HZ/128 - 1))           ///< 256Hz/256 = 1Hz
+#endif
+
+// wake-up timer clock for rtc_set_wakeup() (-> RTC_CR1.WUCKSEL)
+#define RTC_WUCK_DIV16          0             ///< RTCCLK/16 (LSE: 488us resolution, max. 32s)
+#define RTC_WUCK_DIV8           1             ///< RTCCLK/8
+#define RTC_WUCK_DIV4           2             ///< RTCCLK/4
+#define RTC_WUCK_DIV2           3             ///< RTCCLK/2
+#define RTC_WUCK_1HZ            4             ///< 1Hz calendar clock (max. 18h)
+#define RTC_WUCK_1HZ_EXT        6             ///< 1Hz calendar clock, reload + 2^16 (max. 36h)
+
+// alarm masks for rtc_alarm_t.mask. Masked fields are "don't care"
+#define RTC_ALARM_MASK_SECOND   0x01          ///< ignore seconds
+#define RTC_ALARM_MASK_MINUTE   0x02          ///< ignore minutes
+#define RTC_ALARM_MASK_HOUR     0x04          ///< ignore hours
+#define RTC_ALARM_MASK_DAY      0x08          ///< ignore day / weekday
+
+/// min. sleep time [ms] for rtc_sleep(). Below, the wake-up overhead is not worth it
+#define RTC_SLEEP_MIN           5
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// calendar time and date (binary, not BCD)
+typedef struct {
+  uint8_t   year;                     ///< year 0..99 (2000..2099)
+  uint8_t   month;                    ///< month 1..12
+  uint8_t   day;                      ///< day of month 1..31
+  uint8_t   weekday;                  ///< weekday 1..7 (1=monday)
+  uint8_t   hour;                     ///< hour 0..23
+  uint8_t   minute;                   ///< minute 0..59
+  uint8_t   second;                   ///< second 0..59
+  uint16_t  millis;                   ///< millisecond 0..999 (0 w/o sub-second register)
+} rtc_time_t;
+
+
+/// alarm A setting
+typedef struct {
+  uint8_t   day;                      ///< day of month 1..31, or weekday 1..7 if 'weekday'=1
+  uint8_t   weekday;                  ///< 1 = 'day' is weekday
+  uint8_t   hour;                     ///< hour 0..23
+  uint8_t   minute;                   ///< minute 0..59
+  uint8_t   second;                   ///< second 0..59
+  uint8_t   mask;                     ///< ignored fields (RTC_ALARM_MASK_xxx)
+} rtc_alarm_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint8_t  g_rtcWakeup;                  ///< set in RTC ISR on wake-up timer event
+  volatile uint8_t  g_rtcAlarm;                   ///< set in RTC ISR on alarm A event
+#else // _MAIN_
+  extern volatile uint8_t  g_rtcWakeup;
+  extern volatile uint8_t  g_rtcAlarm;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// initialize RTC clock and prescalers. Calendar is only reset if RTC is not yet initialized
+void      rtc_init(uint8_t clockSource);
+
+/// set calendar time and date
+void      rtc_set_time(const rtc_time_t *time);
+
+/// read calendar time and date consistently
+void      rtc_get_time(rtc_time_t *time);
+
+/// wait until calendar shadow registers are updated, e.g. after wake from halt
+void      rtc_sync(void);
+
+/// return milliseconds since midnight (resolution 1s w/o sub-second register)
+uint32_t  rtc_timestamp(void);
+
+/// start periodic wake-up timer with clock 'clock' (RTC_WUCK_xxx) and period reload+1
+void      rtc_set_wakeup(uint8_t clock, uint16_t reload);
+
+/// stop wake-up timer
+void      rtc_stop_wakeup(void);
+
+/// set and enable alarm A
+void      rtc_set_alarm(const rtc_alarm_t *alarm);
+
+/// disable alarm A
+void      rtc_stop_alarm(void);
+
+#if RTC_HAS_SUBSECOND
+
+  /// smooth calibration by 'ppm' (-487..+488, positive = RTC runs faster)
+  void    rtc_calibrate(int16_t ppm);
+
+  /// shift calendar by -'subfs' sub-second ticks, and optionally +1s
+  void    rtc_shift(uint8_t add1s, uint16_t subfs);
+
+#endif // RTC_HAS_SUBSECOND
+
+/// enter active-halt for max. 'ms' and return elapsed time [ms]. Wake via RTC or other interrupt
+uint32_t  rtc_sleep(uint32_t ms);
+
+/// ISR for RTC wake-up timer and alarm A
+ISR_HANDLER(RTC_ISR, _RTC_WAKEUP_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _RTC_H_
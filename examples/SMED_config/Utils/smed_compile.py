@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+"""
+SMED configuration compiler for STLUX / STNRG / STWBC devices
+
+Reads a declarative SMED description (JSON) with states, events, timer
+thresholds and output levels, validates all register fields against the
+device XML description (../../XML/<device>.xml) and writes a C header
+with a const register image. The image is programmed via smed_load(),
+see ../smed.h.
+
+usage:
+  python3 smed_compile.py pwm_dimmer.json [-o smed_image.h] [-x ../../../XML]
+
+description format:
+  {
+    "name":    "pwm_dimmer",              C identifier of image
+    "device":  "STLUX385A",               device, selects XML file
+    "smed":    0,                         SMED instance 0..5
+    "timers":  { "T0": 1600, "T1": 400 }, 16-bit time thresholds T0..T3
+    "states":  {                          fields of PRM_xx0..2 per state IDLE, S0..S3
+      "S0": { "NX_STAT": "S1", "PULS_CMP": 1, "CNT_RSTC": 1 }, ...
+    },
+    "registers": {                        fields of other registers, or raw byte value
+      "CTR": { "FSM_ENA": 1, "START_CNT": 1 }, "CFG": { "TIM_NUM": 1 }, "IMR": 0
+    }
+  }
+
+Field names are the bitfield names of the XML file. Consecutive bitfields
+with the same name prefix and a trailing index form one multi-bit field,
+e.g. NX_STAT0/NX_STAT1 -> NX_STAT (2 bits). Single bits (NX_STAT0) are
+accepted as well. Values are checked against the field width, and raw
+register values against the bits defined in the XML file.
+
+The validation bits of CTR_TMR (TIME_Tx_VAL) are set automatically for
+all thresholds given in "timers".
+"""
+
+import sys
+import os
+import re
+import json
+import argparse
+import xml.etree.ElementTree as ET
+
+
+# register offsets expected by the loader (smed.c). Checked against XML
+LOADER_LAYOUT = {
+  0x00: 'CTR',      0x01: 'CTR_TMR',  0x02: 'CTR_INP',  0x03: 'CTR_DTHR',
+  0x04: 'TMR_T0L',  0x05: 'TMR_T0H',  0x06: 'TMR_T1L',  0x07: 'TMR_T1H',
+  0x08: 'TMR_T2L',  0x09: 'TMR_T2H',  0x0A: 'TMR_T3L',  0x0B: 'TMR_T3H',
+  0x1B: 'CFG',      0x1C: 'DMP_L',    0x1D: 'DMP_H',    0x1E: 'GSTS',
+  0x1F: 'ISR',      0x20: 'IMR',      0x21: 'ISEL',     0x22: 'DMP',
+  0x23: 'FSM_STS'
+}
+
+# status registers, which are not part of the image
+READ_ONLY = ('DMP_L', 'DMP_H', 'GSTS', 'ISR', 'FSM_STS')
+
+# register name prefix of parameter registers per state
+STATE_PREFIX = { 'IDLE': 'PRM_ID', 'S0': 'PRM_S0', 'S1': 'PRM_S1', 'S2': 'PRM_S2', 'S3': 'PRM_S3' }
+
+# symbolic values for state fields
+STATE_VALUES = { 'S0': 0, 'S1': 1, 'S2': 2, 'S3': 3 }
+
+# number of SMED registers
+NUM_REGS = 0x24
+
+
+class SmedError(Exception):
+  pass
+
+
+def read_layout(xml_file, smed):
+  """
+  read register layout of SMED<smed> from device XML file
+  return list of (offset, name, {field: (lsb, width)}, defined_mask)
+  """
+  root = ET.parse(xml_file).getroot()
+  module = None
+  for m in root.iter('module'):
+    if m.get('name') == 'SMED%d' % smed:
+      module = m
+  if module is None:
+    raise SmedError('%s: no module SMED%d' % (xml_file, smed))
+
+  sfrs = module.findall('SFR')
+  base = int(sfrs[0].get('address'), 16)
+  layout = []
+  for s in sfrs:
+    reg = s.find('register')
+    bits = {}
+    fields = {}
+    mask = 0
+    for b in reg.findall('bitfield'):
+      lo, _, hi = b.get('bits').partition('-')
+      lo = int(lo)
+      width = int(hi) - lo + 1 if hi else 1
+      fields[b.get('name')] = (lo, width)
+      mask |= ((1 << width) - 1) << lo
+      if width == 1:
+        bits[b.get('name')] = lo
+
+    # group single bits NAME0..NAMEn at consecutive positions to multi-bit field NAME
+    groups = {}
+    for n, bit in bits.items():
+      m = re.match(r'^(.*?)(\d+)$', n)
+      if m:
+        groups.setdefault(m.group(1), []).append((int(m.group(2)), bit))
+    for prefix, lst in groups.items():
+      lst.sort()
+      if len(lst) < 2 or prefix in fields:
+        continue
+      if all(idx == i and bit == lst[0][1] + i for i, (idx, bit) in enumerate(lst)):
+        fields[prefix] = (lst[0][1], len(lst))
+
+    layout.append((int(s.get('address'), 16) - base, reg.get('name'), fields, mask))
+
+  return base, layout
+
+
+def check_layout(layout):
+  """ check that XML layout matches register offsets used by loader """
+  names = { off: name for off, name, _, _ in layout }
+  for off, name in LOADER_LAYOUT.items():
+    if names.get(off) != name:
+      raise SmedError('XML layout mismatch at offset 0x%02X: expected %s, found %s' % (off, name, names.get(off)))
+  if len(layout) != NUM_REGS:
+    raise SmedError('XML layout has %d registers, expected %d' % (len(layout), NUM_REGS))
+
+
+def set_fields(image, comments, reg, values, where, label=None):
+  """ set fields of register 'reg'=(offset, name, fields, mask) from dict or raw value """
+  off, name, fields, mask = reg
+
+  # raw register value
+  if isinstance(values, int):
+    if values & ~mask & 0xFF or values > 0xFF or values < 0:
+      raise SmedError('%s: value 0x%02X of %s sets undefined bits (defined 0x%02X)' % (where, values, name, mask))
+    image[off] = values
+    comments[off].append(label or '0x%02X' % values)
+    return
+
+  # named fields
+  for field, val in values.items():
+    if field not in fields:
+      raise SmedError('%s: register %s has no field %s (valid: %s)' % (where, name, field, ', '.join(sorted(fields))))
+    lsb, width = fields[field]
+    if isinstance(val, str):
+      if val not in STATE_VALUES:
+        raise SmedError('%s: unknown value %s for %s.%s' % (where, val, name, field))
+      val = STATE_VALUES[val]
+    if not isinstance(val, int) or val < 0 or val >= (1 << width):
+      raise SmedError('%s: value %s exceeds %d-bit field %s.%s' % (where, val, width, name, field))
+    fmask = ((1 << width) - 1) << lsb
+    image[off] = (image[off] & ~fmask) | (val << lsb)
+    comments[off].append('%s=%d' % (field, val))
+
+
+def compile_smed(desc, xml_dir):
+  """ compile description to register image. Return (image, comments, base) """
+  device = desc['device']
+  smed   = int(desc.get('smed', 0))
+  if not 0 <= smed <= 5:
+    raise SmedError('SMED instance must be 0..5')
+  xml_file = os.path.join(xml_dir, device + '.xml')
+  if not os.path.isfile(xml_file):
+    raise SmedError('XML file %s not found' % xml_file)
+
+  base, layout = read_layout(xml_file, smed)
+  check_layout(layout)
+  regs = { name: r for r in layout for name in [r[1]] }
+
+  image    = [0x00] * NUM_REGS
+  comments = [[] for _ in range(NUM_REGS)]
+
+  # states -> PRM_xx0..2. Each field is searched in the 3 parameter registers of the state
+  for state, values in desc.get('states', {}).items():
+    if state not in STATE_PREFIX:
+      raise SmedError('unknown state %s (valid: %s)' % (state, ', '.join(STATE_PREFIX)))
+    prm = [regs[STATE_PREFIX[state] + str(i)] for i in range(3)]
+    for field, val in values.items():
+      reg = [r for r in prm if field in r[2]]
+      if not reg:
+        raise SmedError('state %s: no field %s in %s' % (state, field, ', '.join(r[1] for r in prm)))
+      set_fields(image, comments, reg[0], { field: val }, 'state ' + state)
+
+  # thresholds -> TMR_TxL/H, set validation bit
+  for t, val in desc.get('timers', {}).items():
+    m = re.match(r'^T([0-3])$', t)
+    if not m:
+      raise SmedError('unknown timer %s (valid: T0..T3)' % t)
+    if not 0 <= val <= 0xFFFF:
+      raise SmedError('timer %s: value %s exceeds 16 bit' % (t, val))
+    i = int(m.group(1))
+    set_fields(image, comments, regs['TMR_T%dL' % i], val & 0xFF, 'timer ' + t, '%s=%d (LSB)' % (t, val))
+    set_fields(image, comments, regs['TMR_T%dH' % i], val >> 8,   'timer ' + t, '%s=%d (MSB)' % (t, val))
+    set_fields(image, comments, regs['CTR_TMR'], { 'TIME_T%d_VAL' % i: 1 }, 'timer ' + t)
+
+  # other registers
+  for name, values in desc.get('registers', {}).items():
+    if name not in regs:
+      raise SmedError('unknown register %s' % name)
+    if name in READ_ONLY:
+      raise SmedError('register %s is a status register and cannot be configured' % name)
+    if name.startswith('TMR_T') or name.startswith('PRM_'):
+      raise SmedError('register %s: use "timers" or "states" instead' % name)
+    set_fields(image, comments, regs[name], values, 'register ' + name)
+
+  return image, comments, base, layout
+
+
+def write_header(f, desc, src, image, comments, base, layout):
+  """ write C header with const register image """
+  name  = desc['name']
+  guard = '_SMED_IMAGE_%s_H_' % name.upper()
+  smed  = int(desc.get('smed', 0))
+  names = { off: n for off, n, _, _ in layout }
+
+  f.write('/**\n')
+  f.write('  \\file smed_image_%s.h\n\n' % name)
+  f.write('  \\brief SMED register image \'%s\' (generated, do not edit)\n\n' % name)
+  f.write('  register image for %s SMED%d, generated by Utils/smed_compile.py\n' % (desc['device'], smed))
+  f.write('  from %s and validated against XML/%s.xml.\n' % (os.path.basename(src), desc['device']))
+  f.write('  Program via smed_load(). Status registers are not written.\n')
+  f.write('*/\n\n')
+  f.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+  f.write('#include "smed.h"\n\n')
+  f.write('/// SMED instance of image \'%s\'\n' % name)
+  f.write('#define SMED_IMAGE_%s_SMED   %d\n\n' % (name.upper(), smed))
+  f.write('/// register image \'%s\', index = register offset from SMED%d base 0x%04X\n' % (name, smed, base))
+  f.write('static const smed_image_t smed_image_%s = {{\n' % name)
+  for off in range(NUM_REGS):
+    note = ', '.join(comments[off]) if comments[off] else ''
+    if names[off] in READ_ONLY:
+      note = 'status, not written'
+    f.write(('  0x%02X,   // 0x%02X %-9s %s' % (image[off], off, names[off], note)).rstrip() + '\n')
+  f.write('}};\n\n')
+  f.write('#endif // %s\n' % guard)
+
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  parser = argparse.ArgumentParser(description='compile SMED description to C register image')
+  parser.add_argument('description', help='SMED description (JSON)')
+  parser.add_argument('-o', '--output', help='output header (default: smed_image_<name>.h)')
+  parser.add_argument('-x', '--xml', default=os.path.join(here, '..', '..', '..', 'XML'), help='directory of device XML files')
+  args = parser.parse_args()
+
+  with open(args.description) as f:
+    desc = json.load(f)
+
+  try:
+    image, comments, base, layout = compile_smed(desc, args.xml)
+  except (SmedError, KeyError) as e:
+    sys.stderr.write('error: %s\n' % e)
+    sys.exit(1)
+
+  out = args.output or 'smed_image_%s.h' % desc['name']
+  with open(out, 'w') as f:
+    write_header(f, desc, args.description, image, comments, base, layout)
+  print('%s: SMED%d image written to %s' % (desc['device'], int(desc.get('smed', 0)), out))
+
+
+if __name__ == '__main__':
+  main()
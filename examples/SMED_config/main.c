@@ -0,0 +1,88 @@
+/**********************
+  Program SMED PWM generator from generated register image and retune at runtime
+
+  supported hardware:
+    - STLUX385A (STLUX, STNRG and STWBC devices have identical SMEDs)
+
+  Functionality:
+    - register image is generated from pwm_dimmer.json via Utils/smed_compile.py
+    - program SMED0 with image in one pass
+    - ramp duty (T0) up and down by atomic threshold hot-swap
+    - periodically change duty and period together, w/o glitch
+    - SMED clock (CLK_SMED0) and output routing (MSC) keep reset values
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "smed.h"
+#include "smed_image_pwm_dimmer.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// SMED instance and period from image
+#define PWM_SMED      SMED_IMAGE_PWM_DIMMER_SMED
+#define PWM_PERIOD    1600
+#define PWM_STEP      16
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint16_t  t[4] = { PWM_STEP, PWM_PERIOD, 0, 0 };    // T0=duty, T1=period
+  uint8_t   up = 1;
+  uint8_t   count = 0;
+  uint16_t  i;
+
+  // program SMED from image and start it
+  smed_load(PWM_SMED, &smed_image_pwm_dimmer);
+
+  // main loop
+  while (1) {
+
+    // ramp duty up and down within current period
+    if (up)
+      t[0] += PWM_STEP;
+    else
+      t[0] -= PWM_STEP;
+    if (t[0] >= t[1] - PWM_STEP)
+      up = 0;
+    else if (t[0] <= PWM_STEP)
+      up = 1;
+
+    // every 256 steps toggle period between 1x and 2x and scale duty -> change both thresholds together
+    if (++count == 0) {
+      if (t[1] == PWM_PERIOD) {
+        t[1] = 2*PWM_PERIOD;
+        t[0] = 2*t[0];
+      }
+      else {
+        t[1] = PWM_PERIOD;
+        t[0] = t[0]/2;
+      }
+      smed_set_thresholds(PWM_SMED, t, SMED_T0 | SMED_T1);
+    }
+
+    // only change duty
+    else
+      smed_set_thresholds(PWM_SMED, t, SMED_T0);
+
+    // wait a bit
+    for (i=0; i<2000; i++)
+      NOP();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
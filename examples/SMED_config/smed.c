@@ -0,0 +1,114 @@
+/**
+  \file smed.c
+
+  \author G. Icking-Konert
+  \date 2021-07-17
+  \version 0.1
+
+  \brief implementation of SMED loader for STLUX / STNRG / STWBC devices
+
+  implementation of functions to program a SMED from a const register
+  image and to change its time thresholds atomically. For details see smed.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "smed.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void smed_load(uint8_t n, const smed_image_t *image)
+
+  \brief program SMED from register image
+
+  \param[in]  n       SMED instance (0..5)
+  \param[in]  image   register image, see Utils/smed_compile.py
+
+  program SMED in one pass:
+    1. stop FSM and counter (CTR=0)
+    2. copy CTR_INP..CFG and IMR..DMP from image. Status registers are skipped
+    3. validate all thresholds with one write to CTR_TMR
+    4. enable FSM / start counter as set in image CTR
+*/
+void smed_load(uint8_t n, const smed_image_t *image) {
+
+  volatile uint8_t  *smed = &SMED_REG(n, 0);
+  const uint8_t     *src  = image->reg;
+  uint8_t           i;
+
+  // stop SMED
+  smed[SMED_CTR] = 0x00;
+
+  // copy configuration and thresholds, skip status registers DMP_L..ISR
+  for (i=SMED_CTR_TMR+1; i<SMED_DMP_L; i++)
+    smed[i] = src[i];
+  for (i=SMED_IMR; i<SMED_FSM_STS; i++)
+    smed[i] = src[i];
+
+  // take over all thresholds together
+  smed[SMED_CTR_TMR] = src[SMED_CTR_TMR];
+
+  // start SMED
+  smed[SMED_CTR] = src[SMED_CTR];
+
+} // smed_load
+
+
+
+/**
+  \fn void smed_stop(uint8_t n)
+
+  \brief stop SMED
+
+  \param[in]  n       SMED instance (0..5)
+
+  stop SMED FSM and counter. Configuration is kept.
+*/
+void smed_stop(uint8_t n) {
+
+  SMED_REG(n, SMED_CTR) = 0x00;
+
+} // smed_stop
+
+
+
+/**
+  \fn void smed_set_thresholds(uint8_t n, const uint16_t t[4], uint8_t mask)
+
+  \brief change SMED thresholds atomically
+
+  \param[in]  n       SMED instance (0..5)
+  \param[in]  t       new thresholds T0..T3. Only entries selected by mask are used
+  \param[in]  mask    thresholds to change, e.g. SMED_T0 | SMED_T1
+
+  change thresholds while SMED is running. All selected thresholds are written
+  first and then validated together with one write to CTR_TMR, so the SMED
+  never uses a mix of old and new values (e.g. new duty with old period).
+  Not re-entrant, i.e. do not update the same SMED from main and an ISR.
+*/
+void smed_set_thresholds(uint8_t n, const uint16_t t[4], uint8_t mask) {
+
+  volatile uint8_t  *tmr = &SMED_REG(n, SMED_TMR_T0L);
+  uint8_t           bit;
+
+  // write new values (LSB, MSB). Inactive until validated
+  for (bit=SMED_T0; bit<=SMED_T3; bit <<= 1, t++, tmr+=2) {
+    if (mask & bit) {
+      tmr[0] = (uint8_t) (*t);
+      tmr[1] = (uint8_t) (*t >> 8);
+    }
+  }
+
+  // validate all changed thresholds at once
+  SMED_REG(n, SMED_CTR_TMR) = (uint8_t) (mask & (SMED_T0 | SMED_T1 | SMED_T2 | SMED_T3));
+
+} // smed_set_thresholds
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,91 @@
+/**
+  \file smed.h
+
+  \author G. Icking-Konert
+  \date 2021-07-17
+  \version 0.1
+
+  \brief declaration of SMED loader for STLUX / STNRG / STWBC devices
+
+  declaration of functions to program a SMED (State Machine Event Driven)
+  PWM generator from a const register image and to change its time
+  thresholds at runtime. The register images are generated by the host tool
+  Utils/smed_compile.py from a declarative description, see README.md.
+
+  Threshold hot-swap: new values are written to TMR_TxL/H of all changed
+  thresholds first. Then the validation bits CTR_TMR.TIME_Tx_VAL of all of
+  them are set with a single write, so the SMED takes over all new thresholds
+  together and never runs with a mix of old and new values. When the values
+  take effect is selected via CFG.TIM_UPD, see reference manual RM0380.
+
+  \note all 6 SMEDs have identical register layout with 0x40 address spacing
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _SMED_H_
+#define _SMED_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+#define SMED_BASE_ADDR        0x5500          ///< address of SMED0
+#define SMED_ADDR_STEP        0x40            ///< address offset between SMEDs
+#define SMED_NUM_REGS         0x24            ///< number of registers per SMED
+
+// register offsets used by loader. Checked against XML by smed_compile.py
+#define SMED_CTR              0x00            ///< control register (FSM_ENA, START_CNT)
+#define SMED_CTR_TMR          0x01            ///< threshold validation register
+#define SMED_TMR_T0L          0x04            ///< first threshold register. Tx at 0x04+2*x (LSB), 0x05+2*x (MSB)
+#define SMED_DMP_L            0x1C            ///< first status register (DMP_L, DMP_H, GSTS, ISR)
+#define SMED_IMR              0x20            ///< interrupt mask, first register after status block
+#define SMED_FSM_STS          0x23            ///< FSM status register
+
+// threshold masks for smed_set_thresholds()
+#define SMED_T0               0x01            ///< threshold T0
+#define SMED_T1               0x02            ///< threshold T1
+#define SMED_T2               0x04            ///< threshold T2
+#define SMED_T3               0x08            ///< threshold T3
+
+/// access register 'offset' of SMED 'n' (0..5)
+#define SMED_REG(n, offset)   (*((volatile uint8_t*) (SMED_BASE_ADDR + (uint16_t) (n) * SMED_ADDR_STEP + (offset))))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// SMED register image, index = register offset. Generated by Utils/smed_compile.py
+typedef struct {
+  uint8_t   reg[SMED_NUM_REGS];
+} smed_image_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// program SMED 'n' from register image in one pass and start it as configured in image
+void smed_load(uint8_t n, const smed_image_t *image);
+
+/// stop SMED 'n' (FSM and counter)
+void smed_stop(uint8_t n);
+
+/// change thresholds 'mask' (SMED_T0..SMED_T3) of SMED 'n' atomically. t[] holds T0..T3
+void smed_set_thresholds(uint8_t n, const uint16_t t[4], uint8_t mask);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _SMED_H_
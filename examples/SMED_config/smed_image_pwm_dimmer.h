@@ -0,0 +1,59 @@
+/**
+  \file smed_image_pwm_dimmer.h
+
+  \brief SMED register image 'pwm_dimmer' (generated, do not edit)
+
+  register image for STLUX385A SMED0, generated by Utils/smed_compile.py
+  from pwm_dimmer.json and validated against XML/STLUX385A.xml.
+  Program via smed_load(). Status registers are not written.
+*/
+
+#ifndef _SMED_IMAGE_PWM_DIMMER_H_
+#define _SMED_IMAGE_PWM_DIMMER_H_
+
+#include "smed.h"
+
+/// SMED instance of image 'pwm_dimmer'
+#define SMED_IMAGE_PWM_DIMMER_SMED   0
+
+/// register image 'pwm_dimmer', index = register offset from SMED0 base 0x5500
+static const smed_image_t smed_image_pwm_dimmer = {{
+  0x03,   // 0x00 CTR       FSM_ENA=1, START_CNT=1
+  0x03,   // 0x01 CTR_TMR   TIME_T0_VAL=1, TIME_T1_VAL=1
+  0x00,   // 0x02 CTR_INP
+  0x00,   // 0x03 CTR_DTHR
+  0x90,   // 0x04 TMR_T0L   T0=400 (LSB)
+  0x01,   // 0x05 TMR_T0H   T0=400 (MSB)
+  0x40,   // 0x06 TMR_T1L   T1=1600 (LSB)
+  0x06,   // 0x07 TMR_T1H   T1=1600 (MSB)
+  0x00,   // 0x08 TMR_T2L
+  0x00,   // 0x09 TMR_T2H
+  0x00,   // 0x0A TMR_T3L
+  0x00,   // 0x0B TMR_T3H
+  0x00,   // 0x0C PRM_ID0
+  0x00,   // 0x0D PRM_ID1
+  0x00,   // 0x0E PRM_ID2
+  0x01,   // 0x0F PRM_S00   NX_STAT=1
+  0x00,   // 0x10 PRM_S01   PULS_CMP=0, CNT_RSTC=0
+  0x00,   // 0x11 PRM_S02
+  0x00,   // 0x12 PRM_S10   NX_STAT=0
+  0x30,   // 0x13 PRM_S11   PULS_CMP=1, CNT_RSTC=1
+  0x00,   // 0x14 PRM_S12
+  0x00,   // 0x15 PRM_S20
+  0x00,   // 0x16 PRM_S21
+  0x00,   // 0x17 PRM_S22
+  0x00,   // 0x18 PRM_S30
+  0x00,   // 0x19 PRM_S31
+  0x00,   // 0x1A PRM_S32
+  0x02,   // 0x1B CFG       TIM_NUM=1
+  0x00,   // 0x1C DMP_L     status, not written
+  0x00,   // 0x1D DMP_H     status, not written
+  0x00,   // 0x1E GSTS      status, not written
+  0x00,   // 0x1F ISR       status, not written
+  0x00,   // 0x20 IMR
+  0x00,   // 0x21 ISEL
+  0x00,   // 0x22 DMP
+  0x00,   // 0x23 FSM_STS   status, not written
+}};
+
+#endif // _SMED_IMAGE_PWM_DIMMER_H_
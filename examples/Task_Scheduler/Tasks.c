@@ -14,12 +14,9 @@
 /**************************************/
 /// @cond INTERNAL
 
-// macro to pause / resume interrupt (interrupts are only reactivated in case they have been active in the beginning)
-//uint8_t oldISR = 0;
-//#define PAUSE_INTERRUPTS    { oldISR = SREG; noInterrupts(); }
-//#define RESUME_INTERRUPTS   { SREG = oldISR; interrupts();     }
-#define PAUSE_INTERRUPTS    DISABLE_INTERRUPTS()
-#define RESUME_INTERRUPTS   ENABLE_INTERRUPTS()
+// Accesses to the scheduler table are protected via ENTER_CRITICAL_LEVEL(1)/EXIT_CRITICAL_LEVEL(),
+// which save/restore the interrupt state (nestable) and only mask the TIM4 ISR (priority 1, see Tasks_Init()).
+// ISRs with higher priority stay live. Don't leave these sections via return or break!
 
 
 // task container
@@ -98,8 +95,8 @@ void Scheduler_update_nexttime(void)
 {
     uint8_t i;
 		
-		// stop interrupts, store old setting
-    PAUSE_INTERRUPTS;
+    // mask scheduler interrupt, store old setting
+    ENTER_CRITICAL_LEVEL(1);
     
     // find time of next task execution    
     _nexttime = _timebase + INT16_MAX; // Max. possible delay of the next time
@@ -122,8 +119,8 @@ void Scheduler_update_nexttime(void)
 
     //Serial.print(_timebase); Serial.print("    "); Serial.println(_nexttime - _timebase);
     
-    // resume stored interrupt setting
-    RESUME_INTERRUPTS;
+    // restore stored interrupt setting
+    EXIT_CRITICAL_LEVEL();
 
 } // Scheduler_update_nexttime()
 
@@ -159,6 +156,15 @@ void Tasks_Init(void)
   // set autoreload value for 1ms (=250*4us)
   sfr_TIM4.ARR.byte  = 250;
 
+  // set lowest priority of timer 4 interrupt, i.e. ENTER_CRITICAL_LEVEL(1) only masks the scheduler. ITC can only be written with interrupts disabled
+  ENTER_CRITICAL();
+  #if defined(_TIM4_OVR_UIF_VECTOR_)
+    ISR_SET_PRIORITY(_TIM4_OVR_UIF_VECTOR_, 1);
+  #elif defined(_TIM4_UIF_VECTOR_)
+    ISR_SET_PRIORITY(_TIM4_UIF_VECTOR_, 1);
+  #endif
+  EXIT_CRITICAL();
+
   // enable timer 4 interrupt
   sfr_TIM4.IER.UIE = 1;
   
@@ -173,8 +179,8 @@ void Tasks_Clear(void)
 {
     uint8_t i;
     
-    // stop interrupts, store old setting
-    PAUSE_INTERRUPTS;
+    // mask scheduler interrupt, store old setting
+    ENTER_CRITICAL_LEVEL(1);
     
     // init scheduler
     SchedulingActive = false;
@@ -191,8 +197,8 @@ void Tasks_Clear(void)
         SchedulingTable[i].time = 0;
     } // loop over scheduler slots
     
-    // resume stored interrupt setting
-    RESUME_INTERRUPTS;
+    // restore stored interrupt setting
+    EXIT_CRITICAL_LEVEL();
     
 } // Tasks_Clear()
 
@@ -201,16 +207,17 @@ void Tasks_Clear(void)
 bool Tasks_Add(Task func, int16_t period, int16_t delay)
 {
     uint8_t i;
+    bool    found = false;
     
     // Check range of period and delay
     if ((period < 0) || (delay < 0))
         return false;
     
     // Check if task already exists and update it in this case
-    for(i = 0; i < _lasttask; i++)
+    for(i = 0; (i < _lasttask) && (found == false); i++)
     {
-        // stop interrupts when accessing any element within the scheduler (also neccessary for if checks!), store old setting
-        PAUSE_INTERRUPTS;
+        // mask scheduler interrupt when accessing any element within the scheduler (also neccessary for if checks!), store old setting
+        ENTER_CRITICAL_LEVEL(1);
 
         // same function found
         if (SchedulingTable[i].func == func)
@@ -219,27 +226,19 @@ bool Tasks_Add(Task func, int16_t period, int16_t delay)
             SchedulingTable[i].running = false;
             SchedulingTable[i].period    = period;
             SchedulingTable[i].time        = _timebase + delay;
-            
-            // resume stored interrupt setting
-            RESUME_INTERRUPTS;
-
-            // find time for next task execution
-            Scheduler_update_nexttime();
-
-            // return success        
-            return true;
+            found = true;
         }
 
-        // resume stored interrupt setting
-        RESUME_INTERRUPTS;
+        // restore stored interrupt setting
+        EXIT_CRITICAL_LEVEL();
 
     } // loop over scheduler slots
     
     // find free scheduler slot
-    for (i = 0; i < MAX_TASK_CNT; i++)
+    for (i = 0; (i < MAX_TASK_CNT) && (found == false); i++)
     {
-        // stop interrupts when accessing any element within the scheduler (also neccessary for if checks!), store old setting
-        PAUSE_INTERRUPTS;
+        // mask scheduler interrupt when accessing any element within the scheduler (also neccessary for if checks!), store old setting
+        ENTER_CRITICAL_LEVEL(1);
 
         // free slot found    
         if (SchedulingTable[i].func == NULL)
@@ -255,25 +254,24 @@ bool Tasks_Add(Task func, int16_t period, int16_t delay)
             if (i >= _lasttask)
                 _lasttask = i + 1;
 
-            // resume stored interrupt setting
-            RESUME_INTERRUPTS;
-
-            // find time for next task execution
-            Scheduler_update_nexttime();
-
-            // return success            
-            return true;
+            found = true;
 
         } // if free slot found
 
-        // resume stored interrupt setting
-        RESUME_INTERRUPTS;
+        // restore stored interrupt setting
+        EXIT_CRITICAL_LEVEL();
 
     } // loop over scheduler slots
 
-    // did not change anything, thus no scheduler_update_nexttime neccessary
-    // no free slot found -> error
-    return false;
+    // no free slot found -> error. Did not change anything, thus no scheduler_update_nexttime neccessary
+    if (found == false)
+        return false;
+
+    // find time for next task execution
+    Scheduler_update_nexttime();
+
+    // return success
+    return true;
 
 } // Tasks_Add()
 
@@ -282,12 +280,13 @@ bool Tasks_Add(Task func, int16_t period, int16_t delay)
 bool Tasks_Remove(Task func)
 {
     uint8_t i;
+    bool    found = false;
     
     // find function in scheduler table
-    for (i = 0; i < _lasttask; i++)
+    for (i = 0; (i < _lasttask) && (found == false); i++)
     {
-        // stop interrupts when accessing any element within the scheduler (also neccessary for if checks!), store old setting
-        PAUSE_INTERRUPTS;
+        // mask scheduler interrupt when accessing any element within the scheduler (also neccessary for if checks!), store old setting
+        ENTER_CRITICAL_LEVEL(1);
     
         // function pointer found in list    
         if (SchedulingTable[i].func == func)
@@ -303,35 +302,30 @@ bool Tasks_Remove(Task func)
             if (i == (_lasttask - 1))
             {
                 _lasttask--;
-                while(_lasttask != 0)
+                while((_lasttask != 0) && (SchedulingTable[_lasttask - 1].func == NULL))
                 {
-                    if(SchedulingTable[_lasttask - 1].func != NULL)
-                    {
-                        break;
-                    }
                     _lasttask--;
                 }
             }
 
-            // resume stored interrupt setting
-            RESUME_INTERRUPTS;
-
-            // find time for next task execution
-            Scheduler_update_nexttime();
-
-            // return success
-            return true;
+            found = true;
 
         } // if function found
 
-        // resume stored interrupt setting
-        RESUME_INTERRUPTS;
+        // restore stored interrupt setting
+        EXIT_CRITICAL_LEVEL();
 
     } // loop over scheduler slots
 
-    // did not change anything, thus no scheduler_update_nexttime neccessary
-    // function not in scheduler -> error
-    return false;
+    // function not in scheduler -> error. Did not change anything, thus no scheduler_update_nexttime neccessary
+    if (found == false)
+        return false;
+
+    // find time for next task execution
+    Scheduler_update_nexttime();
+
+    // return success
+    return true;
 
 } // Tasks_Remove()
 
@@ -340,16 +334,17 @@ bool Tasks_Remove(Task func)
 bool Tasks_Delay(Task func, int16_t delay)
 {
     uint8_t i;
+    bool    found = false;
     
     // Check range of delay
     if (delay < 0)
         return false;
     
     // find function in scheduler table
-    for (i = 0; i < _lasttask; i++)
+    for (i = 0; (i < _lasttask) && (found == false); i++)
     {
-        // stop interrupts, store old setting
-        PAUSE_INTERRUPTS;
+        // mask scheduler interrupt, store old setting
+        ENTER_CRITICAL_LEVEL(1);
         
         // function pointer found in list
         if (SchedulingTable[i].func == func)
@@ -361,25 +356,24 @@ bool Tasks_Delay(Task func, int16_t delay)
             // set time to next execution
             SchedulingTable[i].time = _timebase + delay;
 
-            // resume stored interrupt setting
-            RESUME_INTERRUPTS;
-
-            // find time for next task execution
-            Scheduler_update_nexttime();
-
-            // return success
-            return true;
+            found = true;
 
         } // if function found
 
-        // resume stored interrupt setting
-        RESUME_INTERRUPTS;
+        // restore stored interrupt setting
+        EXIT_CRITICAL_LEVEL();
 
     } // loop over scheduler slots
     
-    // did not change anything, thus no scheduler_update_nexttime neccessary
-    // function not in scheduler -> error
-    return false;
+    // function not in scheduler -> error. Did not change anything, thus no scheduler_update_nexttime neccessary
+    if (found == false)
+        return false;
+
+    // find time for next task execution
+    Scheduler_update_nexttime();
+
+    // return success
+    return true;
     
 } // Tasks_Delay()
 
@@ -388,12 +382,13 @@ bool Tasks_Delay(Task func, int16_t delay)
 bool Tasks_SetState(Task func, bool state)
 {
     uint8_t i;
+    bool    found = false;
     
     // find function in scheduler table
-    for (i = 0; i < _lasttask; i++)
+    for (i = 0; (i < _lasttask) && (found == false); i++)
     {
-        // stop interrupts when accessing any element within the scheduler (also neccessary for if checks!), store old setting
-        PAUSE_INTERRUPTS;
+        // mask scheduler interrupt when accessing any element within the scheduler (also neccessary for if checks!), store old setting
+        ENTER_CRITICAL_LEVEL(1);
             
         // function pointer found in list        
         if(SchedulingTable[i].func == func)
@@ -402,25 +397,24 @@ bool Tasks_SetState(Task func, bool state)
             SchedulingTable[i].active = state;
             SchedulingTable[i].time = _timebase + SchedulingTable[i].period;
 
-            // resume stored interrupt setting
-            RESUME_INTERRUPTS;
-
-            // find time for next task execution
-            Scheduler_update_nexttime();
-
-            // return success            
-            return true;
+            found = true;
 
         } // if function found
         
-        // resume stored interrupt setting
-        RESUME_INTERRUPTS;
+        // restore stored interrupt setting
+        EXIT_CRITICAL_LEVEL();
 	
     } // loop over scheduler slots
     
-    // did not change anything, thus no scheduler_update_nexttime neccessary
-    // function not in scheduler -> error
-    return false;
+    // function not in scheduler -> error. Did not change anything, thus no scheduler_update_nexttime neccessary
+    if (found == false)
+        return false;
+
+    // find time for next task execution
+    Scheduler_update_nexttime();
+
+    // return success
+    return true;
     
 } // Tasks_SetState()
 
@@ -471,6 +465,7 @@ void Tasks_Pause(void)
 #endif
 {
     uint8_t i;
+    Task    func;
     
     // clear timer 4 interrupt flag
     #if defined(FAMILY_STM8S)
@@ -501,8 +496,11 @@ void Tasks_Pause(void)
     // loop over scheduler slots
     for(i = 0; i < _lasttask; i++)
     {
-        // disable interrupts
-        DISABLE_INTERRUPTS();
+        // no task to execute yet
+        func = NULL;
+
+        // mask scheduler interrupt, store old setting
+        ENTER_CRITICAL_LEVEL(1);
 
         // function pointer found in list, function is active and not running (arguments ordered to provide maximum speed
         if ((SchedulingTable[i].active == true) && (SchedulingTable[i].running == false) && (SchedulingTable[i].func != NULL))
@@ -510,36 +508,40 @@ void Tasks_Pause(void)
             // function period has passed
             if((int16_t)(SchedulingTable[i].time - _timebase) <= 0)
             {
-                // execute task
+                // mark task for execution
                 SchedulingTable[i].running = true;                                  // avoid dual function call
                 SchedulingTable[i].time = _timebase + SchedulingTable[i].period;    // set time of next call
-                
-                // re-enable interrupts
-                ENABLE_INTERRUPTS();
-
-                // execute function
-                SchedulingTable[i].func();
-                
-                // disable interrupts
-                DISABLE_INTERRUPTS();
-                
-                // re-allow function call by scheduler                     
-                SchedulingTable[i].running = false;
-                
-                // if function period is 0, remove it from scheduler after execution                     
-                if(SchedulingTable[i].period == 0)
-                {
-                    SchedulingTable[i].func = NULL;
-                }
-                
-                // re-enable interrupts
-                ENABLE_INTERRUPTS();
+                func = SchedulingTable[i].func;
 
             } // if function period has passed
         } // if function found
         
-        // re-enable interrupts
-        ENABLE_INTERRUPTS();
+        // restore stored interrupt setting
+        EXIT_CRITICAL_LEVEL();
+
+        // execute task
+        if (func != NULL)
+        {
+            // execute function with interrupts enabled, i.e. also the 1ms timebase continues
+            ENABLE_INTERRUPTS();
+            func();
+            
+            // mask scheduler interrupt, store old setting
+            ENTER_CRITICAL_LEVEL(1);
+            
+            // re-allow function call by scheduler                     
+            SchedulingTable[i].running = false;
+            
+            // if function period is 0, remove it from scheduler after execution                     
+            if(SchedulingTable[i].period == 0)
+            {
+                SchedulingTable[i].func = NULL;
+            }
+            
+            // restore stored interrupt setting
+            EXIT_CRITICAL_LEVEL();
+
+        } // if task to execute
     
     } // loop over scheduler slots
 
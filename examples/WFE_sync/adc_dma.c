@@ -0,0 +1,209 @@
+/**
+  \file adc_dma.c
+
+  \author G. Icking-Konert
+  \date 2021-09-04
+  \version 0.1
+
+  \brief implementation of continuous ADC1 sampling via DMA with WFE consumer for STM8L
+
+  implementation of ADC1 continuous mode with circular DMA into a double
+  buffer and event or interrupt based consumer. For details see adc_dma.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stddef.h>
+#include "adc_dma.h"
+#include "wfe.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// bits in DMA1_C0CR
+#define DMA_CR_EN             0x01            ///< enable channel
+#define DMA_CR_TCIE           0x02            ///< transfer complete interrupt
+#define DMA_CR_HTIE           0x04            ///< half transfer interrupt
+#define DMA_CR_CIRC           0x10            ///< circular mode
+#define DMA_CR_MINC           0x20            ///< increment memory address
+
+// bits in DMA1_C0SPR
+#define DMA_SPR_TCIF          0x02            ///< transfer complete flag
+#define DMA_SPR_HTIF          0x04            ///< half transfer flag
+#define DMA_SPR_TSIZE         0x08            ///< 16-bit transfer
+#define DMA_SPR_PL_HIGH       0x20            ///< priority high
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// sample buffer (2 halves). Written by DMA
+static uint16_t           m_buf[2*ADC_DMA_HALF];
+
+/// DMA flags stored by fallback ISR
+static volatile uint8_t   m_pending = 0;
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void adc_dma_init(uint8_t channel)
+
+  \brief start continuous ADC sampling via DMA
+
+  \param[in]  channel   ADC channel 0..29, e.g. ADC_CH_VREFINT
+
+  enable clocks of ADC1 and DMA1. Start DMA1 channel 0 in circular mode from
+  ADC1_DRH/L (16-bit, MSB first) into sample buffer with half/full transfer
+  interrupt, which is selected as WFE event. Start ADC1 in continuous
+  12-bit mode at 16MHz ADC clock. Sample rate = 16MHz / (sampling time + 12).
+*/
+void adc_dma_init(uint8_t channel) {
+
+  uint8_t   i;
+
+  // enable clocks of ADC1 and DMA1
+  sfr_CLK.PCKENR2.PCKEN20 = 1;
+  sfr_CLK.PCKENR2.PCKEN24 = 1;
+
+  // DMA1 channel 0: ADC1_DRH -> buffer, 16-bit, circular, half/full transfer interrupt
+  sfr_DMA1.C0CR.byte    = 0x00;
+  sfr_DMA1.C0SPR.byte   = DMA_SPR_TSIZE | DMA_SPR_PL_HIGH;
+  sfr_DMA1.C0PARH.byte  = (uint8_t) (((uint16_t) &(sfr_ADC1.DRH)) >> 8);
+  sfr_DMA1.C0PARL.byte  = (uint8_t) ((uint16_t) &(sfr_ADC1.DRH));
+  sfr_DMA1.C0M0ARH.byte = (uint8_t) (((uint16_t) m_buf) >> 8);
+  sfr_DMA1.C0M0ARL.byte = (uint8_t) ((uint16_t) m_buf);
+  sfr_DMA1.C0NDTR.byte  = 2*ADC_DMA_HALF;
+  sfr_DMA1.C0CR.byte    = DMA_CR_EN | DMA_CR_CIRC | DMA_CR_MINC | DMA_CR_HTIE | DMA_CR_TCIE;
+  sfr_DMA1.GCSR.GEN     = 1;
+
+  // DMA interrupts are WFE events
+  m_pending = 0;
+  wfe_enable(WFE_DMA1_CH01);
+
+  // ADC1: select channel via SQRx (SQR1 = channels 24-29, SQR4 = channels 0-7)
+  (&(sfr_ADC1.SQR1.byte))[3 - (channel >> 3)] = (uint8_t) (1 << (channel & 0x07));
+  if (channel == ADC_CH_VREFINT)
+    sfr_ADC1.TRIGR1.VREFINTON = 1;
+  else if (channel == ADC_CH_TS)
+    sfr_ADC1.TRIGR1.TSON = 1;
+
+  // ADC1: 12-bit continuous mode, DMA enabled (SQR1.DMAOFF=0), ADC clock = fSYS
+  sfr_ADC1.CR2.byte  = ADC_DMA_SMTP;
+  sfr_ADC1.CR3.SMTP2 = ADC_DMA_SMTP;
+  sfr_ADC1.CR1.byte  = 0x00;
+  sfr_ADC1.CR1.CONT  = 1;
+  sfr_ADC1.CR1.ADON  = 1;
+
+  // wait >3us for ADC power-up, then start conversions
+  for (i=0; i<50; i++)
+    NOP();
+  sfr_ADC1.CR1.START = 1;
+
+} // adc_dma_init
+
+
+
+/**
+  \fn const uint16_t *adc_dma_get(void)
+
+  \brief get next full buffer half
+
+  \return pointer to ADC_DMA_HALF samples, or NULL if no half is complete
+
+  collect DMA flags (WFE path) and flags stored by fallback ISR. Flags are
+  cleared by writing 0, other flags are written as 1, i.e. are not affected.
+  If both halves are complete, the consumer was too slow and one half is lost.
+  The returned half must be processed before the DMA wraps to it again.
+*/
+const uint16_t *adc_dma_get(void) {
+
+  uint8_t   spr, flags;
+
+  // collect and clear flags
+  DISABLE_INTERRUPTS();
+  spr   = sfr_DMA1.C0SPR.byte;
+  flags = (uint8_t) (spr & (DMA_SPR_HTIF | DMA_SPR_TCIF));
+  if (flags) {
+    sfr_DMA1.C0SPR.byte = (uint8_t) ((spr | DMA_SPR_HTIF | DMA_SPR_TCIF) & ~flags);
+    g_adcEvents++;
+  }
+  flags |= m_pending;
+  m_pending = 0;
+  ENABLE_INTERRUPTS();
+
+  // no half complete
+  if (!flags)
+    return(NULL);
+
+  // both halves complete -> one is lost. Return 2nd half (latest in most cases)
+  if (flags == (DMA_SPR_HTIF | DMA_SPR_TCIF)) {
+    g_adcLost++;
+    return(m_buf + ADC_DMA_HALF);
+  }
+
+  // 1st half after half transfer, 2nd half after transfer complete
+  if (flags & DMA_SPR_HTIF)
+    return(m_buf);
+  return(m_buf + ADC_DMA_HALF);
+
+} // adc_dma_get
+
+
+
+/**
+  \fn const uint16_t *adc_dma_wait(void)
+
+  \brief wait for next full buffer half
+
+  \return pointer to ADC_DMA_HALF samples
+
+  wait in WFE mode until a buffer half is complete. Other interrupts, e.g.
+  scheduler tick, are served meanwhile.
+*/
+const uint16_t *adc_dma_wait(void) {
+
+  const uint16_t  *buf;
+
+  while ((buf = adc_dma_get()) == NULL)
+    WAIT_FOR_EVENT();
+
+  return(buf);
+
+} // adc_dma_wait
+
+
+
+/**
+  \fn void ADC_DMA_ISR(void)
+
+  \brief fallback ISR for DMA1 channel 0
+
+  called if a DMA half/full transfer occurs while the CPU is not in WFE mode.
+  Store and clear flags for adc_dma_get().
+
+  Note: vector is shared with DMA1 channel 1
+*/
+ISR_HANDLER(ADC_DMA_ISR, _DMA1_CH0_TC_VECTOR_) {
+
+  uint8_t   spr = sfr_DMA1.C0SPR.byte;
+  uint8_t   flags = (uint8_t) (spr & (DMA_SPR_HTIF | DMA_SPR_TCIF));
+
+  // store and clear flags
+  if (flags) {
+    sfr_DMA1.C0SPR.byte = (uint8_t) ((spr | DMA_SPR_HTIF | DMA_SPR_TCIF) & ~flags);
+    m_pending |= flags;
+    g_adcIsr++;
+  }
+
+} // ADC_DMA_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
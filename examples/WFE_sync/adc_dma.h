@@ -0,0 +1,97 @@
+/**
+  \file adc_dma.h
+
+  \author G. Icking-Konert
+  \date 2021-09-04
+  \version 0.1
+
+  \brief declaration of continuous ADC1 sampling via DMA with WFE consumer for STM8L
+
+  declaration of an ADC1 sampler for STM8L15x/16x. ADC1 converts one channel
+  continuously, each result is moved by DMA1 channel 0 (circular mode) into a
+  RAM buffer of 2 halves. The half/full transfer interrupts of the DMA are
+  selected as WFE events, i.e. the consumer waits in WFE mode and processes
+  a half while the DMA fills the other half, w/o ISR:
+
+    while (1) {
+      buf = adc_dma_wait();                       // WFE until a half is full
+      process(buf, ADC_DMA_HALF);                 // must be done before DMA wraps
+    }
+
+  If a DMA interrupt occurs while the CPU is not in WFE mode, it is served by
+  the fallback ISR, which stores the pending half. Both paths are counted for
+  evaluation.
+
+  \note ADC1 is served by DMA1 channel 0, which shares its interrupt vector and WFE event with channel 1
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _ADC_DMA_H_
+#define _ADC_DMA_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// samples per buffer half, max. 127; can be overwritten via compiler option
+#ifndef ADC_DMA_HALF
+  #define ADC_DMA_HALF          32
+#endif
+
+// ADC sampling time (0..7, 4..384 ADC cycles, see ADC1_CR2.SMTP1); can be overwritten via compiler option
+#ifndef ADC_DMA_SMTP
+  #define ADC_DMA_SMTP          7
+#endif
+
+// internal ADC channels
+#define ADC_CH_VREFINT          28            ///< internal reference voltage (1.224V)
+#define ADC_CH_TS               29            ///< temperature sensor
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint16_t g_adcEvents;                  ///< number of halves taken directly from DMA flags (WFE path)
+  volatile uint16_t g_adcIsr;                     ///< number of halves taken by fallback ISR
+  volatile uint16_t g_adcLost;                    ///< number of halves overwritten before processing
+#else // _MAIN_
+  extern volatile uint16_t g_adcEvents;
+  extern volatile uint16_t g_adcIsr;
+  extern volatile uint16_t g_adcLost;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// start continuous conversion of ADC 'channel' (0..29) via DMA1 channel 0 and select DMA as WFE event
+void      adc_dma_init(uint8_t channel);
+
+/// return next full buffer half (ADC_DMA_HALF samples, 12-bit) or NULL
+const uint16_t *adc_dma_get(void);
+
+/// wait in WFE mode for next full buffer half and return it
+const uint16_t *adc_dma_wait(void);
+
+/// fallback ISR for DMA1 channel 0 half/full transfer
+ISR_HANDLER(ADC_DMA_ISR, _DMA1_CH0_TC_VECTOR_);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _ADC_DMA_H_
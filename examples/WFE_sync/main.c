@@ -0,0 +1,363 @@
+/**********************
+  Wait-for-event (WFE) synchronisation of scheduler, UART and ADC/DMA with latency benchmark
+
+  supported hardware:
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - scheduler idle loop waits in WFE mode instead of WFI. It is woken by
+      the 1ms scheduler tick (interrupt) and by UART/DMA events (no ISR)
+    - ADC1 samples VREFINT continuously via DMA. Each full buffer half
+      (event DMA1 channel 0) is averaged in the main loop
+    - UART receive (event USART1) is read directly from the data register
+    - every 1s the ADC average and number of halves via event/fallback ISR are printed
+    - send 'b' via UART (19.2kBaud) to start latency benchmark WFE vs. WFI+ISR
+    - green LED is toggled by scheduler task every 500ms
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#include "Tasks.h"
+#include "wfe.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "adc_dma.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED_GREEN     sfr_PORTE.ODR.ODR7      // scheduler task
+#define LED_BLUE      sfr_PORTC.ODR.ODR7      // toggled on each ADC block
+
+#define BENCH_DELAY   200                     // TIM2 ticks from arming to compare event
+#define BENCH_RUNS    16                      // number of measurements per mode
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// report request. Set by scheduler task, printed in main loop
+volatile uint8_t    g_report = 0;
+
+/// TIM2 counter at ISR entry and number of ISR calls in benchmark
+volatile uint16_t   g_benchIsrTime;
+volatile uint8_t    g_benchIsrCount;
+
+
+/*----------------------------------------------------------
+    TASKS
+----------------------------------------------------------*/
+
+/// toggle green LED. Call every 500ms
+void led_toggle(void) {
+
+  LED_GREEN ^= 1;
+
+} // led_toggle
+
+
+/// request status report in main loop (tasks run in ISR context). Call every 1s
+void report(void) {
+
+  g_report = 1;
+
+} // report
+
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/**
+  \fn uint8_t get_key(void)
+
+  \brief get received byte
+
+  \return received byte or 0
+
+  read byte directly from UART (woken by WFE event) or from fallback ISR.
+*/
+uint8_t get_key(void) {
+
+  uint8_t   c;
+
+  DISABLE_INTERRUPTS();
+  if (UART_available())
+    c = UART_read();
+  else {
+    c = g_key;
+    g_key = 0;
+  }
+  ENABLE_INTERRUPTS();
+
+  return(c);
+
+} // get_key
+
+
+
+/**
+  \fn uint16_t bench_time(void)
+
+  \brief read TIM2 counter
+
+  \return TIM2 counter [CPU cycles]
+
+  reading the high byte latches the low byte, i.e. the value is consistent.
+*/
+uint16_t bench_time(void) {
+
+  uint8_t   h = sfr_TIM2.CNTRH.byte;
+
+  return(((uint16_t) h << 8) | sfr_TIM2.CNTRL.byte);
+
+} // bench_time
+
+
+
+/**
+  \fn uint16_t bench_arm(void)
+
+  \brief arm TIM2 compare event
+
+  \return TIM2 counter of compare event
+
+  set TIM2 compare 1 to BENCH_DELAY ticks in the future and clear its flag.
+*/
+uint16_t bench_arm(void) {
+
+  uint16_t  t = bench_time() + BENCH_DELAY;
+
+  sfr_TIM2.CCR1H.byte = (uint8_t) (t >> 8);
+  sfr_TIM2.CCR1L.byte = (uint8_t) t;
+  sfr_TIM2.SR1.CC1IF  = 0;
+
+  return(t);
+
+} // bench_arm
+
+
+
+/**
+  \fn void bench_print(const char *name, uint16_t min, uint16_t max, uint16_t sum)
+
+  \brief print benchmark result
+
+  \param[in]  name    name of measurement
+  \param[in]  min     min. latency [cycles]
+  \param[in]  max     max. latency [cycles]
+  \param[in]  sum     sum of BENCH_RUNS latencies [cycles]
+*/
+void bench_print(const char *name, uint16_t min, uint16_t max, uint16_t sum) {
+
+  printf("  %s: min %u, avg %u, max %u cycles\n", name, min, sum / BENCH_RUNS, max);
+
+} // bench_print
+
+
+
+/**
+  \fn void benchmark(void)
+
+  \brief latency benchmark WFE vs. WFI + ISR
+
+  TIM2 runs at CPU clock (16MHz). A compare event is armed, then the CPU
+  waits for it. Latency = TIM2 counter after wake-up - compare value, i.e.
+  incl. a few cycles for reading the counter. Measured are:
+    - WFI: ISR entry (counter read in ISR) and resume in main after iret
+    - WFE: resume in main, compare interrupt selected as event (no ISR)
+  During the benchmark, the scheduler tick and other WFE events are disabled.
+*/
+void benchmark(void) {
+
+  uint16_t  t, dt, i;
+  uint16_t  isrMin = 0xFFFF, isrMax = 0, isrSum = 0;
+  uint16_t  wfiMin = 0xFFFF, wfiMax = 0, wfiSum = 0;
+  uint16_t  wfeMin = 0xFFFF, wfeMax = 0, wfeSum = 0;
+  uint16_t  isrCalls = 0;
+
+  // TIM2: free running at 16MHz with compare 1 interrupt
+  sfr_CLK.PCKENR1.PCKEN10 = 1;
+  sfr_TIM2.CR1.byte  = 0x00;
+  sfr_TIM2.PSCR.byte = 0;
+  sfr_TIM2.ARRH.byte = 0xFF;
+  sfr_TIM2.ARRL.byte = 0xFF;
+  sfr_TIM2.EGR.UG    = 1;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // disable scheduler tick and other WFE events
+  sfr_TIM4.IER.UIE = 0;
+  wfe_disable(WFE_DMA1_CH01 | WFE_USART1);
+  sfr_TIM2.IER.CC1IE = 1;
+
+  // WFI: wake via ISR
+  for (i=0; i<BENCH_RUNS; i++) {
+    g_benchIsrCount = 0;
+    t = bench_arm();
+    while (!g_benchIsrCount)
+      WAIT_FOR_INTERRUPT();
+    dt = bench_time() - t;
+    if (dt < wfiMin) wfiMin = dt;
+    if (dt > wfiMax) wfiMax = dt;
+    wfiSum += dt;
+    dt = g_benchIsrTime - t;
+    if (dt < isrMin) isrMin = dt;
+    if (dt > isrMax) isrMax = dt;
+    isrSum += dt;
+  }
+
+  // WFE: compare interrupt is event, i.e. no ISR
+  wfe_enable(WFE_TIM2_EV1);
+  for (i=0; i<BENCH_RUNS; i++) {
+    g_benchIsrCount = 0;
+    t = bench_arm();
+    WFE_WAIT_UNTIL(sfr_TIM2.SR1.CC1IF || g_benchIsrCount);
+    dt = bench_time() - t;
+    sfr_TIM2.SR1.CC1IF = 0;
+    isrCalls += g_benchIsrCount;
+    if (dt < wfeMin) wfeMin = dt;
+    if (dt > wfeMax) wfeMax = dt;
+    wfeSum += dt;
+  }
+  wfe_disable(WFE_TIM2_EV1);
+
+  // restore scheduler tick and WFE events, stop TIM2
+  sfr_TIM2.IER.CC1IE = 0;
+  sfr_TIM2.CR1.CEN   = 0;
+  wfe_enable(WFE_DMA1_CH01 | WFE_USART1);
+  sfr_TIM4.IER.UIE = 1;
+
+  // print result
+  printf("latency benchmark (%d runs):\n", BENCH_RUNS);
+  bench_print("WFI, ISR entry    ", isrMin, isrMax, isrSum);
+  bench_print("WFI, resume in main", wfiMin, wfiMax, wfiSum);
+  bench_print("WFE, resume in main", wfeMin, wfeMax, wfeSum);
+  printf("  ISR calls during WFE: %u\n", isrCalls);
+
+} // benchmark
+
+
+
+/**
+  \fn void BENCH_ISR(void)
+
+  \brief ISR for TIM2 compare 1 in benchmark
+
+  store TIM2 counter at ISR entry and clear flag. Only called in WFI mode.
+*/
+ISR_HANDLER(BENCH_ISR, _TIM2_CAPCOM_CC1IF_VECTOR_) {
+
+  g_benchIsrTime = bench_time();
+  sfr_TIM2.SR1.CC1IF = 0;
+  g_benchIsrCount++;
+
+} // BENCH_ISR
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  const uint16_t  *buf;
+  uint32_t        sum;
+  uint16_t        avg = 0;
+  uint8_t         i;
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pins as push-pull outputs
+  sfr_PORTE.DDR.DDR7 = 1;
+  sfr_PORTE.CR1.C17  = 1;
+  sfr_PORTC.DDR.DDR7 = 1;
+  sfr_PORTC.CR1.C17  = 1;
+
+  // init UART for 19.2kBaud. Receive interrupt is WFE event, ISR is fallback
+  UART_begin(19200);
+  wfe_enable(WFE_USART1);
+
+  // start ADC sampling of VREFINT via DMA. DMA interrupt is WFE event
+  adc_dma_init(ADC_CH_VREFINT);
+
+  // init scheduler and add tasks
+  Tasks_Init();
+  Tasks_Clear();
+  Tasks_Add(led_toggle, 500, 0);
+  Tasks_Add(report, 1000, 0);
+  Tasks_Start();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  // main loop
+  while (1) {
+
+    // ADC half complete -> average w/o ISR
+    if ((buf = adc_dma_get()) != NULL) {
+      sum = 0;
+      for (i=0; i<ADC_DMA_HALF; i++)
+        sum += buf[i];
+      avg = (uint16_t) (sum / ADC_DMA_HALF);
+      LED_BLUE ^= 1;
+    }
+
+    // command received via UART
+    if (get_key() == 'b')
+      benchmark();
+
+    // periodic report
+    if (g_report) {
+      g_report = 0;
+      printf("ADC %u, halves: %u event, %u ISR, %u lost\n", avg, g_adcEvents, g_adcIsr, g_adcLost);
+    }
+
+    // idle: wait for event (UART, DMA) or interrupt (scheduler tick)
+    WAIT_FOR_EVENT();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
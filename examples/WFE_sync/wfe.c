@@ -0,0 +1,112 @@
+/**
+  \file wfe.c
+
+  \author G. Icking-Konert
+  \date 2021-09-04
+  \version 0.1
+
+  \brief implementation of wait-for-event (WFE) synchronisation for STM8L
+
+  implementation of event source selection via WFE_CRx. For details see wfe.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "wfe.h"
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void wfe_enable(uint32_t sources)
+
+  \brief select wake-up events
+
+  \param[in]  sources   event sources (WFE_xxx, or'ed)
+
+  set bits in WFE_CRx. The peripheral interrupt must be enabled in the
+  peripheral to generate the event.
+*/
+void wfe_enable(uint32_t sources) {
+
+  sfr_WFE.CR1.byte |= (uint8_t) sources;
+  sfr_WFE.CR2.byte |= (uint8_t) (sources >> 8);
+  sfr_WFE.CR3.byte |= (uint8_t) (sources >> 16);
+  #if WFE_HAS_CR4
+    sfr_WFE.CR4.byte |= (uint8_t) (sources >> 24);
+  #endif
+
+} // wfe_enable
+
+
+
+/**
+  \fn void wfe_disable(uint32_t sources)
+
+  \brief deselect wake-up events
+
+  \param[in]  sources   event sources (WFE_xxx, or'ed)
+
+  clear bits in WFE_CRx. The peripheral interrupts are served as ISR again.
+*/
+void wfe_disable(uint32_t sources) {
+
+  sfr_WFE.CR1.byte &= (uint8_t) ~sources;
+  sfr_WFE.CR2.byte &= (uint8_t) ~(sources >> 8);
+  sfr_WFE.CR3.byte &= (uint8_t) ~(sources >> 16);
+  #if WFE_HAS_CR4
+    sfr_WFE.CR4.byte &= (uint8_t) ~(sources >> 24);
+  #endif
+
+} // wfe_disable
+
+
+
+/**
+  \fn void wfe_wait(uint32_t sources)
+
+  \brief wait for event
+
+  \param[in]  sources   event sources (WFE_xxx, or'ed)
+
+  select only 'sources' as wake-up events, wait once in WFE mode and restore
+  the previous selection. Returns on event or interrupt, i.e. the caller has
+  to check the peripheral flags. For hot loops select the sources once via
+  wfe_enable() and use WFE_WAIT_UNTIL() to avoid the register setup.
+*/
+void wfe_wait(uint32_t sources) {
+
+  uint8_t   cr1 = sfr_WFE.CR1.byte;
+  uint8_t   cr2 = sfr_WFE.CR2.byte;
+  uint8_t   cr3 = sfr_WFE.CR3.byte;
+  #if WFE_HAS_CR4
+    uint8_t cr4 = sfr_WFE.CR4.byte;
+  #endif
+
+  // select event sources
+  sfr_WFE.CR1.byte = (uint8_t) sources;
+  sfr_WFE.CR2.byte = (uint8_t) (sources >> 8);
+  sfr_WFE.CR3.byte = (uint8_t) (sources >> 16);
+  #if WFE_HAS_CR4
+    sfr_WFE.CR4.byte = (uint8_t) (sources >> 24);
+  #endif
+
+  // wait for event or interrupt
+  WAIT_FOR_EVENT();
+
+  // restore selection
+  sfr_WFE.CR1.byte = cr1;
+  sfr_WFE.CR2.byte = cr2;
+  sfr_WFE.CR3.byte = cr3;
+  #if WFE_HAS_CR4
+    sfr_WFE.CR4.byte = cr4;
+  #endif
+
+} // wfe_wait
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,144 @@
+/**
+  \file wfe.h
+
+  \author G. Icking-Konert
+  \date 2021-09-04
+  \version 0.1
+
+  \brief declaration of wait-for-event (WFE) synchronisation for STM8L
+
+  declaration of an event-wait API for STM8L15x/16x. In WFE mode the CPU
+  stops until an event occurs. Events are peripheral interrupt requests
+  selected in WFE_CRx (timer, DMA, EXTI, USART, ...). Unlike WFI, the CPU
+  resumes directly after the wfe instruction, i.e. without ISR entry and
+  exit (context save and restore, iret). This is used for tight
+  producer/consumer loops, e.g. waiting for a DMA half buffer or a received
+  byte. Usage:
+
+    - enable the peripheral interrupt (e.g. DMA1_CxCR.TCIE), which is the event source
+    - select the event source via wfe_enable(WFE_xxx)
+    - wait via WFE_WAIT_UNTIL(flag), then clear the peripheral flag by software
+
+  An enabled interrupt also ends WFE and is served as usual, e.g. the 1ms
+  scheduler tick. If a selected peripheral interrupt occurs while the CPU
+  is not in WFE mode, it is served as interrupt, i.e. an ISR for the event
+  source is required as fallback path.
+
+  Example:
+    wfe_enable(WFE_USART1);
+    sfr_USART1.CR2.RIEN = 1;
+    WFE_WAIT_UNTIL(sfr_USART1.SR.RXNE);
+    c = sfr_USART1.DR.byte;
+
+  \note the event flag must be cleared before the next wait, else WFE returns immediately
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _WFE_H_
+#define _WFE_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// stop code execution and wait for event or interrupt, see WAIT_FOR_INTERRUPT() in device header
+#if defined(__CSMC__)
+  #define WAIT_FOR_EVENT()      _asm("wfe")
+#elif defined(__ICCSTM8__)
+  #define WAIT_FOR_EVENT()      __asm("wfe")
+#elif defined(__SDCC)
+  #define WAIT_FOR_EVENT()      __asm__("wfe")
+#else
+  #error WFE not defined for compiler
+#endif
+
+/// wait in WFE mode until condition is true, e.g. a peripheral flag
+#define WFE_WAIT_UNTIL(cond)    while (!(cond)) WAIT_FOR_EVENT()
+
+// WFE_CR2 bit 7 is EXTI port E on these devices, else ADC1 and comparators (see WFE_CR2 in device header)
+#if defined(DEVICE_STM8AL3188) || defined(DEVICE_STM8AL3189) || defined(DEVICE_STM8AL318A) || defined(DEVICE_STM8AL31E88) || \
+    defined(DEVICE_STM8AL31E89) || defined(DEVICE_STM8AL31E8A) || defined(DEVICE_STM8AL3L88) || defined(DEVICE_STM8AL3L89) || \
+    defined(DEVICE_STM8AL3L8A) || defined(DEVICE_STM8AL3LE88) || defined(DEVICE_STM8AL3LE89) || defined(DEVICE_STM8AL3LE8A) || \
+    defined(DEVICE_STM8L052C6) || defined(DEVICE_STM8L052R8) || defined(DEVICE_STM8L151C8) || defined(DEVICE_STM8L151M8) || \
+    defined(DEVICE_STM8L151R6) || defined(DEVICE_STM8L151R8) || defined(DEVICE_STM8L152C8) || defined(DEVICE_STM8L152M8) || \
+    defined(DEVICE_STM8L152R6) || defined(DEVICE_STM8L152R8) || defined(DEVICE_STM8L162M8) || defined(DEVICE_STM8L162R8)
+  #define WFE_CR2_EXTI_EVE      1
+#else
+  #define WFE_CR2_EXTI_EVE      0
+#endif
+
+// device has WFE_CR4 (TIM5, USART2/3, SPI2, AES)
+#if defined(sfr_WFE_CR4_RESET_VALUE)
+  #define WFE_HAS_CR4           1
+#else
+  #define WFE_HAS_CR4           0
+#endif
+
+// event sources for wfe_enable()/wfe_disable(). Bits 0-7 = WFE_CR1, 8-15 = WFE_CR2, 16-23 = WFE_CR3, 24-31 = WFE_CR4
+#define WFE_TIM2_EV0            0x00000001L   ///< TIM2 update, trigger and break
+#define WFE_TIM2_EV1            0x00000002L   ///< TIM2 capture/compare
+#define WFE_TIM1_EV0            0x00000004L   ///< TIM1 update, trigger and break
+#define WFE_TIM1_EV1            0x00000008L   ///< TIM1 capture/compare
+#define WFE_EXTI_EV0            0x00000010L   ///< EXTI pin 0
+#define WFE_EXTI_EV1            0x00000020L   ///< EXTI pin 1
+#define WFE_EXTI_EV2            0x00000040L   ///< EXTI pin 2
+#define WFE_EXTI_EV3            0x00000080L   ///< EXTI pin 3
+#define WFE_EXTI_EV4            0x00000100L   ///< EXTI pin 4
+#define WFE_EXTI_EV5            0x00000200L   ///< EXTI pin 5
+#define WFE_EXTI_EV6            0x00000400L   ///< EXTI pin 6
+#define WFE_EXTI_EV7            0x00000800L   ///< EXTI pin 7
+#define WFE_EXTI_EVB            0x00001000L   ///< EXTI port B
+#define WFE_EXTI_EVD            0x00002000L   ///< EXTI port D
+#define WFE_EXTI_EVF            0x00004000L   ///< EXTI port F
+#if WFE_CR2_EXTI_EVE
+  #define WFE_EXTI_EVE          0x00008000L   ///< EXTI port E
+#else
+  #define WFE_ADC1_COMP         0x00008000L   ///< ADC1 and comparators
+#endif
+#define WFE_TIM3_EV0            0x00010000L   ///< TIM3 update, trigger and break
+#define WFE_TIM3_EV1            0x00020000L   ///< TIM3 capture/compare
+#define WFE_TIM4                0x00040000L   ///< TIM4 update and trigger
+#define WFE_SPI1                0x00080000L   ///< SPI1 RX/TX
+#define WFE_I2C1                0x00100000L   ///< I2C1
+#define WFE_USART1              0x00200000L   ///< USART1 RX/TX
+#define WFE_DMA1_CH01           0x00400000L   ///< DMA1 channel 0 and 1
+#define WFE_DMA1_CH23           0x00800000L   ///< DMA1 channel 2 and 3
+#if WFE_HAS_CR4
+  #define WFE_RTC_CSSLSE        0x01000000L   ///< RTC and LSE clock security
+  #define WFE_SPI2              0x02000000L   ///< SPI2
+  #define WFE_USART2            0x04000000L   ///< USART2
+  #define WFE_USART3            0x08000000L   ///< USART3
+  #define WFE_TIM5_EV0          0x10000000L   ///< TIM5 update, trigger and break
+  #define WFE_TIM5_EV1          0x20000000L   ///< TIM5 capture/compare
+  #define WFE_AES               0x40000000L   ///< AES
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// select peripheral interrupts 'sources' (WFE_xxx, or'ed) as wake-up events
+void      wfe_enable(uint32_t sources);
+
+/// deselect peripheral interrupts 'sources' (WFE_xxx, or'ed) as wake-up events
+void      wfe_disable(uint32_t sources);
+
+/// select 'sources' as only wake-up events, execute wfe once and restore previous selection
+void      wfe_wait(uint32_t sources);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _WFE_H_
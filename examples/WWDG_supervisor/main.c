@@ -0,0 +1,211 @@
+/**********************
+  Supervise tasks of task scheduler with window watchdog WWDG
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - after reset print ID of task which caused last WWDG reset (if any)
+    - run 2 scheduler tasks and main loop, each supervised by WWDG supervisor:
+      - task 0: toggle LED every 100ms, deadline 200ms
+      - task 1: count seconds every 500ms, deadline 1000ms
+      - task 2 (=main loop): print time every 1s, deadline 100ms
+    - WWDG is only refreshed (inside its window) if all tasks have reported in time
+    - if '0', '1' or '2' received via UART, block respective task --> WWDG reset
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#include "Tasks.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "wwdg.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// IDs of supervised tasks
+#define ID_TASK_LED     0
+#define ID_TASK_COUNT   1
+#define ID_TASK_MAIN    2
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+volatile uint8_t    g_blockTask = WWDG_NO_TASK;   ///< ID of task to block for testing
+volatile uint16_t   g_seconds = 0;                ///< seconds counter. Increased in task 1
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Use send routine set via putchar_attach()
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+// first scheduler task: toggle LED. Call every 100ms
+void task_LED(void) {
+
+  // for test block task
+  while (g_blockTask == ID_TASK_LED);
+
+  // toggle LED
+  #if defined(STM8L_DISCOVERY)
+    sfr_PORTE.ODR.ODR7 ^= 1;
+  #elif defined(SDUINO)
+    sfr_PORTC.ODR.ODR5 ^= 1;
+  #endif
+
+  // report alive to supervisor
+  WWDG_CHECKIN(ID_TASK_LED);
+
+} // task_LED()
+
+
+
+// second scheduler task: count seconds. Call every 500ms
+void task_count(void) {
+
+  static uint8_t  toggle = 0;
+
+  // for test block task
+  while (g_blockTask == ID_TASK_COUNT);
+
+  // increase seconds counter every 2nd call
+  if (toggle ^= 1)
+    g_seconds++;
+
+  // report alive to supervisor
+  WWDG_CHECKIN(ID_TASK_COUNT);
+
+} // task_count()
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  wwdg_record_t   record;
+  uint32_t        nextPrint = 0;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz). Required for WWDG timing, see wwdg.h
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // configure LED pin as output
+  #if defined(STM8L_DISCOVERY)
+    sfr_PORTE.DDR.DDR7 = 1;     // input(=0) or output(=1)
+    sfr_PORTE.CR1.C17  = 1;     // input: 0=float, 1=pull-up; output: 0=open-drain, 1=push-pull
+    sfr_PORTE.CR2.C27  = 1;     // input: 0=no exint, 1=exint; output: 0=2MHz slope, 1=10MHz slope
+  #elif defined(SDUINO)
+    sfr_PORTC.DDR.DDR5 = 1;     // input(=0) or output(=1)
+    sfr_PORTC.CR1.C15  = 1;     // input: 0=float, 1=pull-up; output: 0=open-drain, 1=push-pull
+    sfr_PORTC.CR2.C25  = 1;     // input: 0=no exint, 1=exint; output: 0=2MHz slope, 1=10MHz slope
+  #endif
+
+  // init WWDG supervisor. Saves crash record of last reset
+  wwdg_init();
+
+  // init 1ms clock and task scheduler
+  Tasks_Init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // print reason for last reset
+  if (wwdg_get_record(&record)) {
+    if (record.task != WWDG_NO_TASK)
+      printf("\nWWDG reset #%d by task %d at %ldms\n", (int) record.count, (int) record.task, (long) record.millis);
+    else
+      printf("\nWWDG reset by window violation\n");
+  }
+  else
+    printf("\nno WWDG reset\n");
+
+  // print instruction
+  printf("press '0'..'2' to block task\n\n");
+
+  // add tasks (up to MAX_TASK_CNT) and register to supervisor
+  wwdg_register(ID_TASK_LED,   200);
+  wwdg_register(ID_TASK_COUNT, 1000);
+  wwdg_register(ID_TASK_MAIN,  100);
+  Tasks_Add((Task) task_LED,   100, 0);
+  Tasks_Add((Task) task_count, 500, 0);
+
+  // start task scheduler
+  Tasks_Start();
+
+  // main loop
+  while(1) {
+
+    // for test block main loop
+    while (g_blockTask == ID_TASK_MAIN);
+
+    // report alive to supervisor
+    WWDG_CHECKIN(ID_TASK_MAIN);
+
+    // print time every 1s
+    if (millis() >= nextPrint) {
+      nextPrint += 1000;
+      printf("  time: %ds\n", (int) g_seconds);
+    }
+
+    // received a byte via UART (stored in receive ISR)
+    if (g_key) {
+
+      // on '0'..'2' block respective task --> reset
+      if ((g_key >= '0') && (g_key <= '2')) {
+        printf("block task %c...\n", g_key);
+        g_blockTask = g_key - '0';
+      }
+
+      g_key = 0;
+    } // byte received
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,239 @@
+/**
+  \file wwdg.c
+
+  \author G. Icking-Konert
+  \date 2021-06-12
+  \version 0.1
+
+  \brief implementation of WWDG task supervisor functions/macros
+
+  implementation of a task supervisor using the window watchdog (WWDG).
+  For details see wwdg.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "wwdg.h"
+#include "Tasks.h"
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// crash record in no-init RAM. Not touched by compiler startup code -> survives reset
+WWDG_NOINIT wwdg_record_t   m_record;
+
+/// compile-time check that crash record fits into area reserved in linker (SDCC: --data-loc)
+typedef char _wwdg_record_check[(sizeof(wwdg_record_t) <= WWDG_RECORD_RESERVED) ? 1 : -1];
+
+/// copy of crash record at startup
+wwdg_record_t               m_lastRecord;
+
+/// bitmask of registered tasks
+uint8_t                     m_registered;
+
+/// max. number of refresh slots without check-in per task
+uint8_t                     m_budget[WWDG_MAX_TASKS];
+
+/// remaining number of refresh slots without check-in per task
+uint8_t                     m_remain[WWDG_MAX_TASKS];
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void wwdg_init(void)
+
+  \brief init supervisor and start WWDG
+
+  Init task supervisor and start window watchdog (WWDG). Actions:
+    - save crash record of previous WWDG reset (if any)
+    - clear list of supervised tasks
+    - start WWDG with window as described in wwdg.h
+
+  \note call with interrupts disabled. Once started, WWDG cannot be stopped by SW
+*/
+void wwdg_init(void) {
+
+  uint8_t   i;
+
+  // save crash record if last reset was caused by WWDG, and record is valid
+  m_lastRecord = m_record;
+  if ((m_record.magic != WWDG_RECORD_MAGIC) || (sfr_RST.SR.WWDGF == 0))
+    m_lastRecord.magic = 0x0000;
+
+  // clear only WWDG reset flag (write 1 to clear). Other flags remain for application
+  sfr_RST.SR.byte = WWDG_RST_FLAG;
+
+  // after power-on RAM content is undefined -> init crash record
+  if (m_record.magic != WWDG_RECORD_MAGIC) {
+    m_record.magic = WWDG_RECORD_MAGIC;
+    m_record.count = 0;
+  }
+  m_record.task   = WWDG_NO_TASK;
+  m_record.millis = 0;
+
+  // no task supervised yet
+  m_registered = 0x00;
+  for (i=0; i<WWDG_MAX_TASKS; i++) {
+    m_budget[i] = 0;
+    m_remain[i] = 0;
+  }
+  g_wwdgAlive     = 0x00;
+  g_wwdgCountdown = WWDG_REFRESH_MS;
+
+  // set window, then start WWDG (WDGA=1, T6=1)
+  sfr_WWDG.WR.byte = (uint8_t) WWDG_WINDOW;
+  sfr_WWDG.CR.byte = (uint8_t) (0x80 | WWDG_COUNTER_INIT);
+
+} // wwdg_init
+
+
+
+/**
+  \fn uint8_t wwdg_register(uint8_t id, uint16_t deadline)
+
+  \brief add task to supervisor
+
+  \param[in]  id        task ID (0..WWDG_MAX_TASKS-1)
+  \param[in]  deadline  max. time between check-ins [ms]
+
+  \return 1=ok, 0=invalid ID
+
+  Add task to supervisor. Task has to call WWDG_CHECKIN(id) at least every
+  'deadline' ms, else a WWDG reset is triggered. Deadline is rounded up to
+  full refresh periods WWDG_REFRESH_MS.
+*/
+uint8_t wwdg_register(uint8_t id, uint16_t deadline) {
+
+  uint16_t  slots;
+
+  // check task ID
+  if (id >= WWDG_MAX_TASKS)
+    return(0);
+
+  // convert deadline to refresh slots (round up, clip to 1..255)
+  slots = (deadline + (WWDG_REFRESH_MS-1)) / WWDG_REFRESH_MS;
+  if (slots == 0)
+    slots = 1;
+  else if (slots > 255)
+    slots = 255;
+
+  // add task to supervisor. Is evaluated in TIM4 ISR
+  ENTER_CRITICAL();
+  m_budget[id] = (uint8_t) slots;
+  m_remain[id] = (uint8_t) slots;
+  m_registered |= (uint8_t) (1 << id);
+  EXIT_CRITICAL();
+
+  return(1);
+
+} // wwdg_register
+
+
+
+/**
+  \fn void wwdg_unregister(uint8_t id)
+
+  \brief remove task from supervisor
+
+  \param[in]  id        task ID (0..WWDG_MAX_TASKS-1)
+
+  Remove task from supervisor, e.g. if task is paused via Tasks_Pause_Task()
+*/
+void wwdg_unregister(uint8_t id) {
+
+  // check task ID
+  if (id >= WWDG_MAX_TASKS)
+    return;
+
+  // remove task from supervisor
+  ENTER_CRITICAL();
+  m_registered &= (uint8_t) ~(1 << id);
+  EXIT_CRITICAL();
+
+} // wwdg_unregister
+
+
+
+/**
+  \fn void wwdg_check(void)
+
+  \brief check task check-ins and refresh WWDG
+
+  Called via wwdg_tick() every WWDG_REFRESH_MS. Actions:
+    - for all tasks with check-in reload budget, else decrease it
+    - if a task budget expired, store its ID in crash record and reset via WWDG
+    - else refresh WWDG (now inside window)
+
+  \note must be called at the beginning of the TIM4 ISR, i.e. before scheduler
+    re-enables interrupts. Then read & clear of g_wwdgAlive is atomic
+*/
+void wwdg_check(void) {
+
+  uint8_t   alive, mask, i;
+
+  // get and clear check-ins since last refresh slot
+  alive = g_wwdgAlive;
+  g_wwdgAlive = 0x00;
+
+  // loop over supervised tasks
+  mask = 0x01;
+  for (i=0; i<WWDG_MAX_TASKS; i++, mask <<= 1) {
+
+    // task not supervised -> skip
+    if (!(m_registered & mask))
+      continue;
+
+    // task has reported -> reload budget
+    if (alive & mask)
+      m_remain[i] = m_budget[i];
+
+    // task missed deadline -> store guilty task and reset immediately (T6=0)
+    else if (--(m_remain[i]) == 0) {
+      m_record.task   = i;
+      m_record.millis = g_millis;
+      m_record.count++;
+      sfr_WWDG.CR.byte = (uint8_t) 0x80;
+      while(1);
+    }
+
+  } // loop over tasks
+
+  // refresh WWDG (we are inside window) and restart countdown
+  sfr_WWDG.CR.byte = (uint8_t) (0x80 | WWDG_COUNTER_INIT);
+  g_wwdgCountdown  = WWDG_REFRESH_MS;
+
+} // wwdg_check
+
+
+
+/**
+  \fn uint8_t wwdg_get_record(wwdg_record_t *record)
+
+  \brief get crash record of last supervisor reset
+
+  \param[out] record    crash record of last reset
+
+  \return 1=last reset was a WWDG reset, 0=other reset source
+
+  Get crash record of last supervisor reset, which was stored in no-init RAM.
+  If last reset was a WWDG window violation (not supervisor), task ID is WWDG_NO_TASK.
+*/
+uint8_t wwdg_get_record(wwdg_record_t *record) {
+
+  // copy record saved in wwdg_init()
+  *record = m_lastRecord;
+
+  // return 1 if record is valid
+  return(m_lastRecord.magic == WWDG_RECORD_MAGIC);
+
+} // wwdg_get_record
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
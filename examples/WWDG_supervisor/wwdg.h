@@ -0,0 +1,151 @@
+/**
+  \file wwdg.h
+
+  \author G. Icking-Konert
+  \date 2021-06-12
+  \version 0.1
+
+  \brief declaration of WWDG task supervisor functions/macros
+
+  declaration of a task supervisor using the window watchdog (WWDG).
+  Each supervised task reports via WWDG_CHECKIN(). The 1ms scheduler tick
+  calls wwdg_tick(), which refreshes the WWDG inside its window only if all
+  registered tasks have reported within their deadline. Otherwise the ID of
+  the guilty task is stored in no-init RAM and a WWDG reset is forced.
+
+  WWDG timing (fCPU=16MHz, WWDG clock = fCPU/12288 = 768us per count):
+    - refresh loads T=0x7F, reset occurs at T=0x3F -> 64*768us = 49.2ms
+    - refresh is allowed only for T < W=0x60 -> >32*768us = 24.6ms after refresh
+    - supervisor refreshes every WWDG_REFRESH_MS=32ms, i.e. in the middle of the window
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _WWDG_H_
+#define _WWDG_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+#define WWDG_MAX_TASKS        8               ///< max. number of supervised tasks (1 bit each in check-in mask)
+#define WWDG_REFRESH_MS       32              ///< WWDG refresh period [ms]. Must be within window, see above
+#define WWDG_COUNTER_INIT     0x7F            ///< WWDG counter reload value (T6 must be set)
+#define WWDG_WINDOW           0x60            ///< WWDG window. Refresh only allowed for counter < window
+#define WWDG_RECORD_MAGIC     0xA55A          ///< marker for valid crash record in no-init RAM
+#define WWDG_NO_TASK          0xFF            ///< task ID if no task is guilty (e.g. after power-on)
+
+/// WWDG reset flag in RST_SR. Register is write-1-to-clear -> clear by byte write, bit write (BSET) clears all flags
+#if defined(FAMILY_STM8L)
+  #define WWDG_RST_FLAG       PIN4
+#else
+  #define WWDG_RST_FLAG       PIN0
+#endif
+
+/// RAM reserved for crash record at start of RAM [B]. For SDCC must match linker option --data-loc, see Makefile
+#if !defined(WWDG_RECORD_RESERVED)
+  #define WWDG_RECORD_RESERVED  0x10
+#endif
+
+/// address of no-init crash record for SDCC. Linker places DATA behind reserved area -> no overlap with variables or stack
+#if !defined(WWDG_RECORD_ADDR)
+  #define WWDG_RECORD_ADDR    RAM_ADDR_START
+#endif
+
+/// keyword for variables which are not initialized by compiler startup code
+#if defined(__CSMC__)
+  #define WWDG_NOINIT         @near @nostartup
+#elif defined(__ICCSTM8__)
+  #define WWDG_NOINIT         __no_init
+#elif defined(__SDCC)
+  #define WWDG_NOINIT         __at(WWDG_RECORD_ADDR)
+#endif
+
+/// report alive of task 'id'. Single bit-set instruction (BSET) for constant 'id' -> atomic
+#define WWDG_CHECKIN(id)      ( g_wwdgAlive |= (uint8_t) (1 << (id)) )
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// crash record in no-init RAM. Survives WWDG reset for post-mortem analysis
+typedef struct {
+  uint16_t  magic;        ///< WWDG_RECORD_MAGIC if record is valid
+  uint8_t   task;         ///< ID of task which missed its deadline
+  uint8_t   count;        ///< number of supervisor resets since power-on
+  uint32_t  millis;       ///< time of reset [ms]
+} wwdg_record_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint8_t            g_wwdgAlive;              ///< check-in mask of supervised tasks. Set by tasks, cleared by supervisor
+  volatile uint8_t            g_wwdgCountdown;          ///< ms until next WWDG refresh slot
+#else // _MAIN_
+  extern volatile uint8_t     g_wwdgAlive;
+  extern volatile uint8_t     g_wwdgCountdown;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init supervisor and start WWDG
+void wwdg_init(void);
+
+/// add task to supervisor with deadline in [ms]
+uint8_t wwdg_register(uint8_t id, uint16_t deadline);
+
+/// remove task from supervisor
+void wwdg_unregister(uint8_t id);
+
+/// check task check-ins and refresh WWDG. Called via wwdg_tick()
+void wwdg_check(void);
+
+/// get crash record of last supervisor reset. Return 0 if none
+uint8_t wwdg_get_record(wwdg_record_t *record);
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL INLINE FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/**
+  \fn void wwdg_tick(void)
+
+  \brief supervisor tick. Call from 1ms scheduler ISR
+
+  Count down to next refresh slot. Only every WWDG_REFRESH_MS the
+  check-ins are evaluated, else cost is a decrement and branch.
+*/
+INLINE void wwdg_tick(void) {
+
+  // refresh slot not yet reached -> return immediately
+  if (--g_wwdgCountdown)
+    return;
+
+  // check task check-ins and refresh WWDG
+  wwdg_check();
+
+} // wwdg_tick
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif  // _WWDG_H_
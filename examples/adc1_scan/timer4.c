@@ -139,15 +139,8 @@ ISR_HANDLER(TIM4_UPD_ISR, _TIM4_OVR_UIF_VECTOR_)
   g_millis++;
   g_flagMilli = 1;
 
-  // read ADC results (0..3)
-  g_ADC_result[0]  =  (uint16_t) sfr_ADC1.DB0RL.byte;
-  g_ADC_result[0] += ((uint16_t) sfr_ADC1.DB0RH.byte) << 8;
-  g_ADC_result[1]  =  (uint16_t) sfr_ADC1.DB1RL.byte;
-  g_ADC_result[1] += ((uint16_t) sfr_ADC1.DB1RH.byte) << 8;
-  g_ADC_result[2]  =  (uint16_t) sfr_ADC1.DB2RL.byte;
-  g_ADC_result[2] += ((uint16_t) sfr_ADC1.DB2RH.byte) << 8;
-  g_ADC_result[3]  =  (uint16_t) sfr_ADC1.DB3RL.byte;
-  g_ADC_result[3] += ((uint16_t) sfr_ADC1.DB3RH.byte) << 8;
+  // read ADC results (0..3). Right aligned -> LSB first
+  READ16_BUF(g_ADC_result, sfr_ADC1, DB0R, 4);
 
   // start next ADC scan
   ADC1_start();
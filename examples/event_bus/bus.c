@@ -0,0 +1,88 @@
+/**
+  \file bus.c
+
+  \author G. Icking-Konert
+  \date 2021-10-11
+  \version 0.1
+
+  \brief implementation of event queues with zero-copy publish/subscribe dispatch
+
+  implementation of the consumer side of the event queues. For details see bus.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "bus.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void bus_init(bus_queue_t *q, const bus_sub_t *subs)
+
+  \brief init queue
+
+  \param[in]  q       queue
+  \param[in]  subs    const subscriber table, terminated by handler NULL
+
+  clear queue and statistics. Call before the producer is enabled
+*/
+void bus_init(bus_queue_t *q, const bus_sub_t *subs) {
+
+  q->subs = subs;
+  q->head = 0;
+  q->tail = 0;
+  q->lost = 0;
+  q->peak = 0;
+
+} // bus_init
+
+
+
+/**
+  \fn uint8_t bus_dispatch(bus_queue_t *q, uint8_t num)
+
+  \brief dispatch pending messages
+
+  \param[in]  q       queue
+  \param[in]  num     max. number of messages, 0 = all pending
+
+  \return number of dispatched messages
+
+  pass each pending message in place to all subscribers of its type (and of
+  BUS_EVENT_ANY) in the order of the table, then free the slot
+*/
+uint8_t bus_dispatch(bus_queue_t *q, uint8_t num) {
+
+  uint8_t           count = 0;
+  const bus_msg_t   *msg;
+  const bus_sub_t   *sub;
+
+  while (q->tail != q->head) {
+
+    // call subscribers with message in place
+    msg = &(q->slot[q->tail & (BUS_SLOTS - 1)]);
+    for (sub = q->subs; sub->handler != NULL; sub++) {
+      if ((sub->type == msg->type) || (sub->type == BUS_EVENT_ANY))
+        sub->handler(msg);
+    }
+
+    // free slot
+    q->tail++;
+
+    // limit number of messages
+    if (++count == num)
+      break;
+
+  }
+
+  return(count);
+
+} // bus_dispatch
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
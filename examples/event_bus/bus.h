@@ -0,0 +1,176 @@
+/**
+  \file bus.h
+
+  \author G. Icking-Konert
+  \date 2021-10-11
+  \version 0.1
+
+  \brief declaration of event queues with zero-copy publish/subscribe dispatch
+
+  declaration of fixed-size event queues as replacement for volatile flags and
+  globals polled in the main loop (e.g. g_key, g_flagMilli). Each queue has
+  BUS_SLOTS preallocated message slots:
+
+    - the producer (typically an ISR) reserves the next free slot with
+      bus_reserve(), fills the payload in place and publishes it with bus_commit()
+    - the consumer (main loop) calls bus_dispatch(), which passes each message
+      in place to all subscribers of its type from a const table, then frees the slot
+
+  Messages are not copied, and bursts up to BUS_SLOTS messages are buffered.
+  The queue is lock-free for a single producer and a single consumer: head is
+  only written by the producer, tail only by the consumer, and both are 8-bit
+  (atomic). The head is written last, i.e. the consumer only sees complete messages.
+
+  Example:
+    const bus_sub_t m_subs[] = { {EVT_KEY, on_key}, {BUS_EVENT_ANY, on_log}, {0, NULL} };
+    bus_init(&g_busKey, m_subs);
+
+    ISR:  msg = bus_reserve(&g_busKey, EVT_KEY);
+          if (msg) { msg->data.b[0] = sfr_UART2.DR.byte; bus_commit(&g_busKey); }
+
+    main: bus_dispatch(&g_busKey, 0);
+
+  \note use one queue per producer. Several producers per queue require that they
+    can't interrupt each other, e.g. ISRs with same priority, and main code must
+    enclose bus_reserve() ... bus_commit() in ENTER_CRITICAL()/EXIT_CRITICAL()
+  \note subscribers are called from the consumer context and must not call bus_dispatch() for the same queue
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _BUS_H_
+#define _BUS_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// message slots per queue (2^n, 2..128); can be overwritten via compiler option
+#ifndef BUS_SLOTS
+  #define BUS_SLOTS             8
+#endif
+
+// payload per message [B] (even); can be overwritten via compiler option
+#ifndef BUS_DATA_SIZE
+  #define BUS_DATA_SIZE         6
+#endif
+
+#define BUS_EVENT_ANY           0xFF          ///< subscriber type for all events
+
+/// number of messages in queue
+#define bus_pending(q)          ((uint8_t) ((q)->head - (q)->tail))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// message slot
+typedef struct {
+  uint8_t             type;                     ///< event type, defined by application
+  union {
+    uint8_t           b[BUS_DATA_SIZE];         ///< payload as bytes
+    uint16_t          w[BUS_DATA_SIZE/2];       ///< payload as words
+  } data;
+} bus_msg_t;
+
+/// subscriber. Is called with message in place, i.e. must not keep the pointer
+typedef void (*bus_handler_t)(const bus_msg_t *msg);
+
+/// const subscription of a handler to an event type (or BUS_EVENT_ANY)
+typedef struct {
+  uint8_t             type;                     ///< event type
+  bus_handler_t       handler;                  ///< handler, NULL terminates table
+} bus_sub_t;
+
+/// event queue
+typedef struct {
+  const bus_sub_t     *subs;                    ///< const subscriber table
+  volatile uint8_t    head;                     ///< write index. Changed by producer
+  volatile uint8_t    tail;                     ///< read index. Changed by consumer
+  volatile uint8_t    lost;                     ///< number of dropped messages (saturated). Changed by producer
+  volatile uint8_t    peak;                     ///< max. number of pending messages. Changed by producer
+  bus_msg_t           slot[BUS_SLOTS];          ///< preallocated message slots
+} bus_queue_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init queue with const subscriber table
+void      bus_init(bus_queue_t *q, const bus_sub_t *subs);
+
+/// dispatch max. 'num' pending messages (0 = all) to subscribers. Return number of dispatched messages
+uint8_t   bus_dispatch(bus_queue_t *q, uint8_t num);
+
+
+/**
+  \fn bus_msg_t *bus_reserve(bus_queue_t *q, uint8_t type)
+
+  \brief reserve message slot
+
+  \param[in]  q       queue
+  \param[in]  type    event type
+
+  \return slot to fill in place, or NULL if queue is full
+
+  reserve the next free slot and set its type. The message is invisible to
+  the consumer until bus_commit(). If the queue is full, the message is
+  dropped and counted in 'lost'
+*/
+INLINE bus_msg_t *bus_reserve(bus_queue_t *q, uint8_t type) {
+
+  uint8_t     num = bus_pending(q);
+  bus_msg_t   *msg;
+
+  // queue full -> drop message
+  if (num >= BUS_SLOTS) {
+    if (q->lost != 0xFF)
+      q->lost++;
+    return(NULL);
+  }
+
+  // update high-water mark
+  if (num >= q->peak)
+    q->peak = num + 1;
+
+  // next free slot
+  msg = &(q->slot[q->head & (BUS_SLOTS - 1)]);
+  msg->type = type;
+
+  return(msg);
+
+} // bus_reserve
+
+
+/**
+  \fn void bus_commit(bus_queue_t *q)
+
+  \brief publish reserved message
+
+  \param[in]  q       queue
+
+  publish message of last successful bus_reserve() by advancing the write index
+*/
+INLINE void bus_commit(bus_queue_t *q) {
+
+  q->head++;
+
+} // bus_commit
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _BUS_H_
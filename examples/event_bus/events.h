@@ -0,0 +1,53 @@
+/**
+  \file events.h
+
+  \author G. Icking-Konert
+  \date 2021-10-11
+  \version 0.1
+
+  \brief event types and queues of the application
+
+  event types and event queues with one producer each, see bus.h
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _EVENTS_H_
+#define _EVENTS_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "bus.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+#define EVT_SAMPLE              1             ///< TIM3 sample. w[0]: TIM2 timestamp, w[1]: sequence number
+#define EVT_KEY                 2             ///< byte received via UART. b[0]: byte
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  bus_queue_t         g_busSample;              ///< event queue. Producer: TIM3 ISR
+  bus_queue_t         g_busKey;                 ///< event queue. Producer: UART receive ISR
+#else // _MAIN_
+  extern bus_queue_t  g_busSample;
+  extern bus_queue_t  g_busKey;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _EVENTS_H_
@@ -0,0 +1,368 @@
+/**********************
+  Event queues with zero-copy publish/subscribe dispatch: latency and throughput
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - TIM2 runs free at 16MHz as time base, i.e. 1 tick = 1 CPU cycle
+    - TIM3 ISR publishes EVT_SAMPLE {timestamp, sequence} to g_busSample with adjustable rate
+    - UART receive ISR publishes EVT_KEY to g_busKey ('+'/'-' doubles/halves sample rate)
+    - main loop dispatches both queues via const subscriber tables and sleeps (WFI) if both are empty
+    - subscribers measure latency from publish in ISR to dispatch, count messages and echo keys
+    - every 1s print latency [cycles], dispatch cost, throughput, lost messages and queue high-water mark
+      via UART (19.2kBaud). While waiting for the UART, samples are dispatched
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "timer4.h"
+  #include "events.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define SAMPLE_PERIOD_MIN   8           // min. sample period [us]
+#define SAMPLE_PERIOD_MAX   32768       // max. sample period [us]
+#define REPORT_PERIOD       1000        // print period [ms]
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// sample period [us]
+static uint16_t           m_period = 1000;
+
+/// sequence number of samples. Set in TIM3 ISR
+static uint16_t           m_sequence;
+
+/// expected next sequence number, number of missing samples
+static uint16_t           m_expected, m_missing;
+
+/// latency publish -> dispatch [cycles]
+static uint16_t           m_latMin, m_latMax;
+static uint32_t           m_latSum;
+
+/// dispatch cost incl. subscribers [cycles], number of dispatched samples
+static uint32_t           m_costSum;
+static uint16_t           m_costNum;
+
+/// number of events per type
+static uint16_t           m_count[3];
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint16_t bench_time(void)
+
+  \brief read TIM2 counter
+
+  \return  TIM2 counter [cycles]
+*/
+static uint16_t bench_time(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM2, CNTR);
+
+  return(t);
+
+} // bench_time
+
+
+
+/**
+  \fn void sample_period(uint16_t us)
+
+  \brief set TIM3 sample period
+
+  \param[in]  us    period [us]
+*/
+static void sample_period(uint16_t us) {
+
+  WRITE16(sfr_TIM3, ARR, us - 1);
+
+} // sample_period
+
+
+
+/**
+  \fn void on_sample(const bus_msg_t *msg)
+
+  \brief subscriber for EVT_SAMPLE
+
+  \param[in]  msg   message in queue slot
+
+  measure latency from publish in TIM3 ISR and check sequence number
+*/
+static void on_sample(const bus_msg_t *msg) {
+
+  uint16_t  lat = (uint16_t) (bench_time() - msg->data.w[0]);
+
+  // latency statistics
+  if ((m_count[EVT_SAMPLE] == 0) || (lat < m_latMin))
+    m_latMin = lat;
+  if (lat > m_latMax)
+    m_latMax = lat;
+  m_latSum += lat;
+
+  // samples dropped by producer
+  m_missing += (uint16_t) (msg->data.w[1] - m_expected);
+  m_expected = msg->data.w[1] + 1;
+
+} // on_sample
+
+
+
+/**
+  \fn void on_key(const bus_msg_t *msg)
+
+  \brief subscriber for EVT_KEY
+
+  \param[in]  msg   message in queue slot
+
+  '+' doubles, '-' halves the sample rate
+*/
+static void on_key(const bus_msg_t *msg) {
+
+  if ((msg->data.b[0] == '+') && (m_period > SAMPLE_PERIOD_MIN))
+    m_period >>= 1;
+  else if ((msg->data.b[0] == '-') && (m_period < SAMPLE_PERIOD_MAX))
+    m_period <<= 1;
+  sample_period(m_period);
+
+} // on_key
+
+
+
+/**
+  \fn void on_echo(const bus_msg_t *msg)
+
+  \brief second subscriber for EVT_KEY
+
+  \param[in]  msg   message in queue slot
+
+  echo received byte
+*/
+static void on_echo(const bus_msg_t *msg) {
+
+  UART_write(msg->data.b[0]);
+
+} // on_echo
+
+
+
+/**
+  \fn void on_count(const bus_msg_t *msg)
+
+  \brief subscriber for all events
+
+  \param[in]  msg   message in queue slot
+
+  count events per type
+*/
+static void on_count(const bus_msg_t *msg) {
+
+  if (msg->type < sizeof(m_count)/sizeof(m_count[0]))
+    m_count[msg->type]++;
+
+} // on_count
+
+
+/// const subscriber tables. Subscribers are called in table order
+const bus_sub_t  m_subsSample[] = { {EVT_SAMPLE, on_sample}, {BUS_EVENT_ANY, on_count}, {0, NULL} };
+const bus_sub_t  m_subsKey[]    = { {EVT_KEY, on_key}, {EVT_KEY, on_echo}, {BUS_EVENT_ANY, on_count}, {0, NULL} };
+
+
+
+/**
+  \fn void dispatch_samples(uint8_t num)
+
+  \brief dispatch samples and measure cost
+
+  \param[in]  num   max. number of messages, 0 = all pending
+*/
+static void dispatch_samples(uint8_t num) {
+
+  uint16_t  start = bench_time();
+  uint8_t   n;
+
+  n = bus_dispatch(&g_busSample, num);
+  if (n) {
+    m_costSum += (uint16_t) (bench_time() - start);
+    m_costNum += n;
+  }
+
+} // dispatch_samples
+
+
+
+/**
+  \fn void TIM3_UPD_ISR(void)
+
+  \brief ISR for timer 3 (sample producer)
+
+  publish EVT_SAMPLE with timestamp and sequence number. The payload is written
+  directly into the queue slot.
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: requires additional entry in file stm8_interrupt_vector.c
+    IAR: no additional measures
+*/
+ISR_HANDLER(TIM3_UPD_ISR, _TIM3_OVR_UIF_VECTOR_) {
+
+  bus_msg_t   *msg;
+
+  // clear timer 3 interrupt flag
+  sfr_TIM3.SR1.UIF = 0;
+
+  // fill slot in place and publish
+  msg = bus_reserve(&g_busSample, EVT_SAMPLE);
+  if (msg != NULL) {
+    msg->data.w[0] = bench_time();
+    msg->data.w[1] = m_sequence;
+    bus_commit(&g_busSample);
+  }
+  m_sequence++;
+
+} // TIM3_UPD_ISR
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  While the UART is busy, dispatch samples, i.e. printing doesn't block the queue.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // dispatch samples while waiting
+  while (!UART_ready())
+    dispatch_samples(1);
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint32_t  lastReport = 0;
+  uint16_t  num, cnt, lat, latMin, latMax, cost, missing;
+  uint8_t   lost, peak;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init event queues before producers are enabled
+  bus_init(&g_busSample, m_subsSample);
+  bus_init(&g_busKey, m_subsKey);
+
+  // init UART for 19.2kBaud, receive interrupt publishes EVT_KEY
+  UART_begin(19200);
+
+  // init 1ms interrupt
+  TIM4_init();
+
+  // TIM2 runs free at 16MHz as time base
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+    sfr_CLK.PCKENR1.PCKEN11 = 1;
+  #endif
+  sfr_TIM2.PSCR.byte = 0x00;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // TIM3 at 1MHz, interrupt every m_period us
+  sfr_TIM3.PSCR.byte = 0x04;
+  sample_period(m_period);
+  sfr_TIM3.IER.UIE   = 1;
+  sfr_TIM3.CR1.CEN   = 1;
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  printf("\nevent bus, %u slots x %uB payload. '+'/'-': sample rate x2 / x0.5\n", (uint16_t) BUS_SLOTS, (uint16_t) BUS_DATA_SIZE);
+
+
+  // main loop
+  while(1) {
+
+    // dispatch all pending events
+    dispatch_samples(0);
+    bus_dispatch(&g_busKey, 0);
+
+    // print statistics
+    if ((millis() - lastReport) >= REPORT_PERIOD) {
+      lastReport += REPORT_PERIOD;
+
+      // copy and reset statistics before printing. putchar() dispatches samples, i.e. updates them while printing
+      cnt     = m_count[EVT_SAMPLE];
+      lat     = cnt ? (uint16_t) (m_latSum / cnt) : 0;
+      latMin  = m_latMin;
+      latMax  = m_latMax;
+      num     = m_costNum;
+      cost    = num ? (uint16_t) (m_costSum / num) : 0;
+      missing = m_missing;
+      m_count[EVT_SAMPLE] = 0;
+      m_latMax = m_latSum = 0;
+      m_costSum = m_costNum = 0;
+      m_missing = 0;
+      DISABLE_INTERRUPTS();
+      lost = g_busSample.lost;
+      peak = g_busSample.peak;
+      g_busSample.lost = 0;
+      g_busSample.peak = 0;
+      ENABLE_INTERRUPTS();
+      printf("period %5uus: %5u samples/s, latency min/avg/max %u/%u/%u cycles, dispatch %u cycles/msg, peak %u/%u, lost %u (%u)\n",
+        m_period, cnt, latMin, lat, latMax, cost, (uint16_t) peak, (uint16_t) BUS_SLOTS, (uint16_t) lost, missing);
+    }
+
+    // sleep until next interrupt if no event is pending. WFI enables interrupts, i.e. no event is missed
+    DISABLE_INTERRUPTS();
+    if (!bus_pending(&g_busSample) && !bus_pending(&g_busKey))
+      WAIT_FOR_INTERRUPT();
+    ENABLE_INTERRUPTS();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+decoder for binary event trace of ../trace.h
+
+Reads the raw UART stream of trace_drain() from a file or serial port,
+maps the event IDs to names via ../trace_ids.h, unwraps the 16-bit
+timestamps and writes a Chrome trace JSON file. Open the result in
+chrome://tracing or https://ui.perfetto.dev
+
+usage:
+  python3 trace_decode.py capture.bin [-o trace.json] [-i ../trace_ids.h] [-u 1.0]
+  python3 trace_decode.py -p /dev/ttyUSB0 [-b 115200] [-t 10] [-o trace.json]
+
+stream format (5 bytes per record):
+  0xA5, id, arg, timestamp high, timestamp low
+
+ID description in trace_ids.h (one line per ID):
+  #define TRACE_<name>  <value>  // <type> <track> <description>
+
+  type:   B = begin of duration, E = end of duration, i = instant, C = counter (value = arg)
+  track:  row in the viewer, e.g. isr, task, driver, main
+  '{arg}' in the description is replaced by the argument. The argument of
+  end records w/o '{arg}' is shown as result, e.g. of a computation.
+
+Timestamps wrap every 65536 ticks. Unwrapping requires at least one record
+per wrap period. Raw capture without decoding: -p <port> -r capture.bin
+"""
+
+import sys
+import os
+import re
+import json
+import time
+import argparse
+
+
+# sync byte preceding each record, see trace.h
+TRACE_SYNC = 0xA5
+
+# record length on UART incl. sync byte
+RECORD_LEN = 5
+
+# line in trace_ids.h
+ID_PATTERN = re.compile(r'#define\s+TRACE_(\w+)\s+(0x[0-9A-Fa-f]+|\d+)\s*//\s*([BEiC])\s+(\S+)\s+(.*)')
+
+
+class TraceError(Exception):
+  pass
+
+
+def read_ids(ids_file):
+  """
+  read ID descriptions from trace_ids.h. Return dict id -> (name, type, track, text)
+  """
+  ids = {}
+  with open(ids_file) as f:
+    for line in f:
+      m = ID_PATTERN.match(line.strip())
+      if not m:
+        continue
+      value = int(m.group(2), 0)
+      if value in ids:
+        raise TraceError('duplicate ID 0x%02X (%s, %s)' % (value, ids[value][0], m.group(1)))
+      ids[value] = (m.group(1), m.group(3), m.group(4), m.group(5).strip())
+  if not ids:
+    raise TraceError('no IDs found in %s' % ids_file)
+  return ids
+
+
+def capture(port, baud, duration):
+  """
+  read raw stream from serial port for 'duration' seconds
+  """
+  try:
+    import serial
+  except ImportError:
+    raise TraceError('serial capture requires pyserial (pip install pyserial)')
+  data = bytearray()
+  with serial.Serial(port, baud, timeout=0.1) as ser:
+    stop = time.time() + duration
+    while time.time() < stop:
+      data += ser.read(4096)
+  return bytes(data)
+
+
+def parse(data):
+  """
+  split raw stream into records (id, arg, ts). Resync after corrupted records.
+  Return list of records and number of skipped bytes
+  """
+  records = []
+  skipped = 0
+  i = 0
+  while i + RECORD_LEN <= len(data):
+    # sync byte must be followed by another sync byte (or end of stream)
+    if data[i] != TRACE_SYNC or (i + RECORD_LEN < len(data) and data[i + RECORD_LEN] != TRACE_SYNC):
+      i += 1
+      skipped += 1
+      continue
+    records.append((data[i+1], data[i+2], (data[i+3] << 8) | data[i+4]))
+    i += RECORD_LEN
+  return records, skipped
+
+
+def decode(records, ids, unit):
+  """
+  convert records to Chrome trace events. 'unit' is the timestamp tick in us
+  """
+  events = []
+  tracks = {}
+  last = None
+  base = 0
+  unknown = 0
+  lost = 0
+
+  for (id, arg, ts) in records:
+    # unwrap 16-bit timestamp
+    if last is not None and ts < last:
+      base += 0x10000
+    last = ts
+    t = (base + ts) * unit
+
+    if id not in ids:
+      unknown += 1
+      continue
+    (name, typ, track, text) = ids[id]
+    if name == 'LOST':
+      lost += arg
+
+    # one thread per track
+    if track not in tracks:
+      tracks[track] = len(tracks) + 1
+      events.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': tracks[track], 'args': {'name': track}})
+
+    label = text.replace('{arg}', str(arg))
+    event = {'name': label, 'ph': typ, 'ts': t, 'pid': 1, 'tid': tracks[track]}
+    if typ == 'C':
+      event['args'] = {label: arg}
+    elif typ == 'i':
+      event['s'] = 't'
+      event['args'] = {'arg': arg}
+    elif typ == 'E' and '{arg}' not in text:
+      # end argument is a result, e.g. computed value
+      event['args'] = {'arg': arg}
+    events.append(event)
+
+  return events, unknown, lost
+
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  parser = argparse.ArgumentParser(description='decode binary event trace to Chrome trace JSON')
+  parser.add_argument('input', nargs='?', help='raw capture file (alternative to -p)')
+  parser.add_argument('-p', '--port', help='serial port for live capture, e.g. /dev/ttyUSB0 or COM3')
+  parser.add_argument('-b', '--baud', type=int, default=115200, help='baudrate (default: 115200)')
+  parser.add_argument('-t', '--time', type=float, default=5.0, help='capture duration [s] (default: 5)')
+  parser.add_argument('-r', '--raw', help='save raw capture to file')
+  parser.add_argument('-i', '--ids', default=os.path.join(here, '..', 'trace_ids.h'), help='ID description (default: ../trace_ids.h)')
+  parser.add_argument('-u', '--unit', type=float, default=1.0, help='timestamp tick [us] (default: 1.0)')
+  parser.add_argument('-o', '--output', default='trace.json', help='output file (default: trace.json)')
+  args = parser.parse_args()
+
+  if (args.input is None) == (args.port is None):
+    parser.error('specify either capture file or serial port')
+
+  try:
+    ids = read_ids(args.ids)
+    if args.port:
+      data = capture(args.port, args.baud, args.time)
+      if args.raw:
+        with open(args.raw, 'wb') as f:
+          f.write(data)
+    else:
+      with open(args.input, 'rb') as f:
+        data = f.read()
+  except (TraceError, IOError) as e:
+    sys.stderr.write('error: %s\n' % e)
+    sys.exit(1)
+
+  records, skipped = parse(data)
+  events, unknown, lost = decode(records, ids, args.unit)
+
+  with open(args.output, 'w') as f:
+    json.dump({'traceEvents': events}, f)
+  print('%d records, %d bytes skipped, %d unknown IDs, %d records lost on target -> %s' % (len(records), skipped, unknown, lost, args.output))
+
+
+if __name__ == '__main__':
+  main()
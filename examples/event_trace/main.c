@@ -0,0 +1,169 @@
+/**********************
+  Binary event trace of ISRs, scheduler tasks and drivers with UART streaming.
+  Replaces debug printf(), which distorts the timing to measure (see adc1_scan).
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+
+  Functionality:
+    - scheduler task starts an ADC1 scan of AIN0..AIN3 every 10ms
+    - ADC1 end-of-scan ISR reads results, main loop averages AIN0
+    - ISRs, tasks and driver calls are traced with 1us timestamps (TIM2)
+    - records are streamed via UART (115.2kBaud) in the idle loop
+    - decode on host: python3 Utils/trace_decode.py -p /dev/ttyUSB0 -t 5 -o trace.json
+    - LED toggles every 500ms
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "Tasks.h"
+#define _MAIN_          // required for global variables
+  #include "adc1.h"
+  #include "uart2.h"
+  #include "trace.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LED           sfr_PORTC.ODR.ODR5      // LED (D13)
+
+#define AVG_SIZE      16                      // number of AIN0 results for average
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// new ADC result available. Set in ADC1 ISR
+volatile uint8_t    g_adcNew = 0;
+
+
+/*----------------------------------------------------------
+    TASKS
+----------------------------------------------------------*/
+
+/// start ADC1 scan. Call every 10ms
+void adc_task(void) {
+
+  ADC1_start();
+
+} // adc_task
+
+
+/// toggle LED. Call every 500ms
+void led_task(void) {
+
+  LED ^= 1;
+
+} // led_task
+
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void ADC1_EOC_ISR(void)
+
+  \brief ISR for ADC1 end of scan
+
+  read results AIN0..AIN3 from data buffer registers (right aligned, read
+  low byte first) and trace AIN0 as counter (8 MSB of 10-bit result).
+*/
+ISR_HANDLER(ADC1_EOC_ISR, _ADC1_EOC_VECTOR_) {
+
+  TRACE_ISR(TRACE_ADC_BEGIN, 0);
+
+  // clear flag
+  sfr_ADC1.CSR.EOC = 0;
+
+  // read ADC results (0..3)
+  g_ADC_result[0]  =  (uint16_t) sfr_ADC1.DB0RL.byte;
+  g_ADC_result[0] += ((uint16_t) sfr_ADC1.DB0RH.byte) << 8;
+  g_ADC_result[1]  =  (uint16_t) sfr_ADC1.DB1RL.byte;
+  g_ADC_result[1] += ((uint16_t) sfr_ADC1.DB1RH.byte) << 8;
+  g_ADC_result[2]  =  (uint16_t) sfr_ADC1.DB2RL.byte;
+  g_ADC_result[2] += ((uint16_t) sfr_ADC1.DB2RH.byte) << 8;
+  g_ADC_result[3]  =  (uint16_t) sfr_ADC1.DB3RL.byte;
+  g_ADC_result[3] += ((uint16_t) sfr_ADC1.DB3RH.byte) << 8;
+  g_adcNew = 1;
+
+  TRACE_ISR(TRACE_ADC_RESULT, (uint8_t) (g_ADC_result[0] >> 2));
+  TRACE_ISR(TRACE_ADC_END, 0);
+
+} // ADC1_EOC_ISR
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint16_t  buf[AVG_SIZE];
+  uint32_t  sum;
+  uint8_t   idx = 0, i;
+  uint16_t  avg = 0;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pin PC5 as push-pull output
+  sfr_PORTC.DDR.DDR5 = 1;
+  sfr_PORTC.CR1.C15  = 1;
+
+  // init UART2 for 115.2kBaud trace streaming and start trace timestamp
+  UART2_begin(115200);
+  trace_init();
+
+  // init scheduler and add tasks
+  Tasks_Init();
+  Tasks_Clear();
+  Tasks_Add(adc_task, 10, 0);
+  Tasks_Add(led_task, 500, 0);
+  Tasks_Start();
+
+  // clear average buffer
+  for (i=0; i<AVG_SIZE; i++)
+    buf[i] = 0;
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  // main loop
+  while (1) {
+
+    // new ADC result -> moving average of AIN0
+    if (g_adcNew) {
+      g_adcNew = 0;
+      TRACE(TRACE_AVG_BEGIN, 0);
+      buf[idx] = g_ADC_result[0];
+      idx = (idx + 1) & (AVG_SIZE - 1);
+      sum = 0;
+      for (i=0; i<AVG_SIZE; i++)
+        sum += buf[i];
+      avg = (uint16_t) (sum / AVG_SIZE);
+      TRACE(TRACE_AVG_END, (uint8_t) (avg >> 2));
+    }
+
+    // stream trace records with lowest priority
+    trace_drain();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,130 @@
+/**
+  \file trace.c
+
+  \author G. Icking-Konert
+  \date 2021-09-11
+  \version 0.1
+
+  \brief implementation of binary event trace with UART streaming
+
+  implementation of timestamp timer and non-blocking UART drain of trace
+  records. Records are written via inline trace_put(). For details see trace.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "trace.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// UART for streaming. UART must be initialized by application
+#if defined(sfr_UART2)
+  #define TRACE_UART          sfr_UART2
+#elif defined(sfr_UART1)
+  #define TRACE_UART          sfr_UART1
+#elif defined(sfr_USART1)
+  #define TRACE_UART          sfr_USART1
+#else
+  #error no UART for trace
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// byte of current record to send: 0 = sync, 1..4 = record bytes
+static uint8_t      m_pos = 0;
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void trace_init(void)
+
+  \brief init event trace
+
+  start TIM2 as free-running 16-bit timestamp with prescaler 2^TRACE_TIM_PSC
+  and clear ring buffer. TIM2 is used exclusively.
+*/
+void trace_init(void) {
+
+  // STM8L: enable TIM2 clock
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+  #endif
+
+  // TIM2: free-running 16-bit timestamp
+  sfr_TIM2.CR1.byte  = 0x00;
+  sfr_TIM2.PSCR.byte = TRACE_TIM_PSC;
+  sfr_TIM2.ARRH.byte = 0xFF;
+  sfr_TIM2.ARRL.byte = 0xFF;
+  sfr_TIM2.EGR.UG    = 1;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // clear ring buffer
+  DISABLE_INTERRUPTS();
+  g_traceHead = 0;
+  g_traceTail = 0;
+  g_traceLost = 0;
+  m_pos       = 0;
+  ENABLE_INTERRUPTS();
+
+} // trace_init
+
+
+
+/**
+  \fn void trace_drain(void)
+
+  \brief send pending records via UART
+
+  send bytes of pending records as long as the UART transmit register is
+  empty, i.e. w/o blocking. Each record is preceded by TRACE_SYNC. The read
+  index is advanced after the last byte of a record, i.e. the record cannot
+  be overwritten while it is sent. Dropped records are reported as
+  TRACE_LOST record as soon as the ring has space.
+*/
+void trace_drain(void) {
+
+  uint8_t   lost;
+
+  // report dropped records
+  if (g_traceLost) {
+    DISABLE_INTERRUPTS();
+    if (((g_traceHead + 4) & (TRACE_SIZE - 1)) != g_traceTail) {
+      lost = g_traceLost;
+      g_traceLost = 0;
+      trace_put(TRACE_LOST, lost);
+    }
+    ENABLE_INTERRUPTS();
+  }
+
+  // send while UART is ready and records are pending
+  while ((TRACE_UART.SR.TXE) && (g_traceTail != g_traceHead)) {
+
+    // sync byte, then record bytes
+    if (m_pos == 0)
+      TRACE_UART.DR.byte = TRACE_SYNC;
+    else
+      TRACE_UART.DR.byte = g_traceBuf[g_traceTail + m_pos - 1];
+
+    // record complete -> release it
+    if (++m_pos > 4) {
+      m_pos = 0;
+      g_traceTail = (uint8_t) ((g_traceTail + 4) & (TRACE_SIZE - 1));
+    }
+
+  } // while UART ready
+
+} // trace_drain
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,144 @@
+/**
+  \file trace.h
+
+  \author G. Icking-Konert
+  \date 2021-09-11
+  \version 0.1
+
+  \brief declaration of binary event trace with UART streaming
+
+  declaration of a lightweight event trace as replacement for debug printf().
+  TRACE(id, arg) writes a 4-byte record {id, arg, timestamp} into a RAM ring
+  buffer. The timestamp is the 16-bit counter of TIM2 (1us at 16MHz). Writing
+  a record takes ~30 cycles (inline), interrupts are disabled only for the
+  record write. trace_drain() is called in the idle loop and sends pending
+  records via UART w/o blocking, i.e. with lowest priority.
+
+  On the UART each record is preceded by a sync byte:
+
+    0xA5, id, arg, timestamp high, timestamp low
+
+  The host decoder (Utils/trace_decode.py) maps IDs to names via trace_ids.h,
+  unwraps the 16-bit timestamps and writes a Chrome trace JSON file (open in
+  chrome://tracing or https://ui.perfetto.dev).
+
+  Example:
+    TRACE_ISR(TRACE_TIM4_BEGIN, 0);         // in ISR (interrupts already disabled)
+    TRACE(TRACE_TASK_BEGIN, 3);             // in main or interrupted task
+    ...
+    while (1) {
+      trace_drain();                        // in idle loop
+    }
+
+  \note timestamps wrap every 65.5ms. For correct unwrapping at least 1 record per 65ms is required, e.g. from a 1ms tick
+  \note if the ring is full, records are dropped and reported as TRACE_LOST record
+  \note TRACE_ISR() requires that the ISR cannot be interrupted, i.e. default interrupt priorities
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "trace_ids.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// ring buffer size [bytes] (2^n, 16..256, 4 bytes per record); can be overwritten via compiler option
+#ifndef TRACE_SIZE
+  #define TRACE_SIZE            256
+#endif
+
+// TIM2 prescaler 2^n for timestamps; can be overwritten via compiler option. Default 16MHz/16 = 1us
+#ifndef TRACE_TIM_PSC
+  #define TRACE_TIM_PSC         4
+#endif
+
+// sync byte preceding each record on UART
+#define TRACE_SYNC              0xA5
+
+/// write trace record from any context. Interrupts are disabled during write and the previous state is restored
+#define TRACE(id, arg)          do { ENTER_CRITICAL(); trace_put(id, arg); EXIT_CRITICAL(); } while (0)
+
+/// write trace record from ISR w/o nesting, i.e. interrupts are already disabled
+#define TRACE_ISR(id, arg)      trace_put(id, arg)
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  uint8_t           g_traceBuf[TRACE_SIZE];       ///< ring buffer of records
+  volatile uint8_t  g_traceHead = 0;              ///< write index. Changed by trace_put()
+  volatile uint8_t  g_traceTail = 0;              ///< read index. Changed by trace_drain()
+  volatile uint8_t  g_traceLost = 0;              ///< number of dropped records (saturated)
+#else // _MAIN_
+  extern uint8_t           g_traceBuf[TRACE_SIZE];
+  extern volatile uint8_t  g_traceHead;
+  extern volatile uint8_t  g_traceTail;
+  extern volatile uint8_t  g_traceLost;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// start TIM2 timestamp and clear ring buffer
+void      trace_init(void);
+
+/// send pending records via UART w/o blocking. Call in idle loop
+void      trace_drain(void);
+
+
+/**
+  \fn void trace_put(uint8_t id, uint8_t arg)
+
+  \brief write trace record
+
+  \param[in]  id    event ID, see trace_ids.h
+  \param[in]  arg   8-bit argument
+
+  write record {id, arg, TIM2 counter} into ring buffer. Reading TIM2_CNTRH
+  latches CNTRL. The write index is updated last, i.e. trace_drain() only
+  sees complete records. Must not be interrupted by another trace_put(),
+  use via TRACE() or TRACE_ISR().
+*/
+INLINE void trace_put(uint8_t id, uint8_t arg) {
+
+  uint8_t   i = g_traceHead;
+  uint8_t   next = (uint8_t) ((i + 4) & (TRACE_SIZE - 1));
+
+  // ring full -> drop record
+  if (next == g_traceTail) {
+    if (g_traceLost != 0xFF)
+      g_traceLost++;
+    return;
+  }
+
+  // store record, then commit
+  g_traceBuf[i]   = id;
+  g_traceBuf[i+1] = arg;
+  g_traceBuf[i+2] = sfr_TIM2.CNTRH.byte;
+  g_traceBuf[i+3] = sfr_TIM2.CNTRL.byte;
+  g_traceHead = next;
+
+} // trace_put
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _TRACE_H_
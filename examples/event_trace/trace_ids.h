@@ -0,0 +1,61 @@
+/**
+  \file trace_ids.h
+
+  \author G. Icking-Konert
+  \date 2021-09-11
+  \version 0.1
+
+  \brief trace event IDs of application
+
+  list of trace event IDs for TRACE() and TRACE_ISR(). The host decoder
+  (Utils/trace_decode.py) reads this file to map IDs to names, i.e. the
+  names are not stored in the device. Each ID is defined in one line:
+
+    #define TRACE_<name>   <value>    // <type> <track> <description>
+
+    - value: 1..255 (0 is reserved for lost records)
+    - type: B = begin of duration, E = end of duration, i = instant event,
+      C = counter (value = argument)
+    - track: timeline row, e.g. isr, task, main
+    - description: name in timeline. "{arg}" is replaced by the argument.
+      Begin and end of a duration must have the same description
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _TRACE_IDS_H_
+#define _TRACE_IDS_H_
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF TRACE IDS
+-----------------------------------------------------------------------------*/
+
+// reserved
+#define TRACE_LOST              0x00          // i trace   records lost ({arg})
+
+// ISRs
+#define TRACE_TIM4_BEGIN        0x01          // B isr     scheduler tick
+#define TRACE_TIM4_END          0x02          // E isr     scheduler tick
+#define TRACE_ADC_BEGIN         0x03          // B isr     ADC1 EOC
+#define TRACE_ADC_END           0x04          // E isr     ADC1 EOC
+#define TRACE_RX                0x05          // i isr     UART2 Rx ({arg})
+
+// scheduler
+#define TRACE_TASK_BEGIN        0x10          // B task    task {arg}
+#define TRACE_TASK_END          0x11          // E task    task {arg}
+
+// drivers
+#define TRACE_ADC_START         0x20          // i driver  ADC1 start
+#define TRACE_ADC_RESULT        0x21          // C driver  AIN0
+
+// main loop
+#define TRACE_AVG_BEGIN         0x30          // B main    average
+#define TRACE_AVG_END           0x31          // E main    average
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _TRACE_IDS_H_
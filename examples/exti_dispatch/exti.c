@@ -0,0 +1,155 @@
+/**
+  \file exti.c
+
+  \author G. Icking-Konert
+  \date 2021-07-03
+  \version 0.1
+
+  \brief implementation of EXTI service with per-pin callbacks and debouncing
+
+  implementation of EXTI dispatch via IDR XOR edge detection and 
+  debouncing in 1ms timer tick. For details see exti.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stddef.h>
+#include "exti.h"
+#include "timer4.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void exti_init(exti_port_t *port, const exti_pin_t *pins, uint8_t idr)
+
+  \brief initialize port state
+
+  \param[in]  port    port state
+  \param[in]  pins    const pin table with 8 entries, index = pin number
+  \param[in]  idr     current input state of port, e.g. sfr_PORTD.IDR.byte
+
+  initialize port state from const pin table. Pins without callback
+  are ignored by dispatch. Call with interrupts disabled.
+*/
+void exti_init(exti_port_t *port, const exti_pin_t *pins, uint8_t idr) {
+
+  uint8_t   i;
+
+  port->pins     = pins;
+  port->mask     = 0x00;
+  port->state    = idr;
+  port->bouncing = 0x00;
+  for (i=0; i<8; i++) {
+    port->timer[i] = 0;
+    if (pins[i].callback != NULL)
+      port->mask |= (uint8_t) (1 << i);
+  }
+
+} // exti_init
+
+
+
+/**
+  \fn void exti_dispatch(exti_port_t *port, uint8_t idr)
+
+  \brief dispatch pin changes of port
+
+  \param[in]  port    port state
+  \param[in]  idr     input state of port, read once at ISR entry
+
+  Call from port EXTI ISR. Changed pins are detected by XOR of 'idr' with
+  the last reported state. For each changed pin either the callback is called
+  directly, or the debounce timer is started.
+  Worst case (8 pins changed w/o debounce) see README.md.
+*/
+void exti_dispatch(exti_port_t *port, uint8_t idr) {
+
+  uint8_t             changed, bit, i;
+  uint16_t            time;
+  const exti_pin_t    *pin;
+
+  // get changed pins with callback, ignore pins with running debounce timer
+  changed = (uint8_t) ((idr ^ port->state) & port->mask & ~port->bouncing);
+  if (changed == 0)
+    return;
+
+  // timestamp of edge (low 16 bit of millis)
+  time = (uint16_t) g_millis;
+
+  // loop over changed pins. Stop after last changed pin
+  pin = port->pins;
+  for (i=0, bit=0x01; changed; i++, bit <<= 1, pin++) {
+    if (!(changed & bit))
+      continue;
+    changed &= (uint8_t) ~bit;
+
+    // start debounce timer, report after pin is stable
+    if (pin->debounce) {
+      port->bouncing |= bit;
+      port->timer[i] = pin->debounce;
+    }
+
+    // no debouncing -> report immediately
+    else {
+      port->state ^= bit;
+      pin->callback(i, (idr & bit) ? EXTI_EDGE_RISING : EXTI_EDGE_FALLING, time);
+    }
+
+  } // loop over pins
+
+} // exti_dispatch
+
+
+
+/**
+  \fn void exti_debounce(exti_port_t *port, uint8_t idr)
+
+  \brief handle debounce timers of port
+
+  \param[in]  port    port state
+  \param[in]  idr     current input state of port
+
+  Call every 1ms from exti_tick(), i.e. from TIM4 ISR. Decrement running
+  debounce timers. On expiry the pin is sampled and, if it differs from the
+  last reported state, the callback is called. The timestamp is the time of
+  the first edge (+/-1ms).
+*/
+void exti_debounce(exti_port_t *port, uint8_t idr) {
+
+  uint8_t             bit, i, pending;
+  const exti_pin_t    *pin;
+
+  // fast exit if no debounce timer is running
+  pending = port->bouncing;
+  if (pending == 0)
+    return;
+
+  // loop over pins with running debounce timer
+  pin = port->pins;
+  for (i=0, bit=0x01; pending; i++, bit <<= 1, pin++) {
+    if (!(pending & bit))
+      continue;
+    pending &= (uint8_t) ~bit;
+
+    // debounce time not yet passed
+    if (--(port->timer[i]))
+      continue;
+
+    // debounce time passed -> report if stable state differs from last reported
+    port->bouncing &= (uint8_t) ~bit;
+    if ((idr ^ port->state) & bit) {
+      port->state ^= bit;
+      pin->callback(i, (idr & bit) ? EXTI_EDGE_RISING : EXTI_EDGE_FALLING, (uint16_t) g_millis - pin->debounce);
+    }
+
+  } // loop over pins
+
+} // exti_debounce
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
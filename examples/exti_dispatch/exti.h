@@ -0,0 +1,98 @@
+/**
+  \file exti.h
+
+  \author G. Icking-Konert
+  \date 2021-07-03
+  \version 0.1
+
+  \brief declaration of EXTI service with per-pin callbacks and debouncing
+
+  declaration of a generic external interrupt service. Per port, a const table
+  holds for each pin a callback and a debounce time. On port interrupt the
+  service
+    - snapshots IDR once and XORs it with the last reported state -> changed pins
+    - calls the callback of each changed pin with edge type and timestamp, or
+    - for pins with debounce time, starts a debounce timer instead
+
+  Debouncing is done in the 1ms timer tick via exti_tick(), i.e. w/o busy-wait.
+  While a pin debounces, further edges of this pin are ignored. After the
+  debounce time the pin is sampled again and the callback is called from
+  the tick context if the level differs from the last reported state.
+
+  \note pins must be configured as input with interrupt (CR2=1) and edge
+    sensitivity "rising and falling" (EXTI_CRx.PxIS=3), else edges are lost
+  \note callbacks are called from ISR context and must be short
+  \note EXTI and TIM4 ISR must have the same priority (default), else port state may be corrupted
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _EXTI_H_
+#define _EXTI_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+#define EXTI_EDGE_FALLING     0             ///< pin changed from high to low
+#define EXTI_EDGE_RISING      1             ///< pin changed from low to high
+
+/// EXTI sensitivity "rising and falling" for EXTI_CRx.PxIS
+#define EXTI_BOTH_EDGES       3
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// callback for pin change. Parameters: pin number (0..7), edge (EXTI_EDGE_xxx), timestamp [ms] of edge
+typedef void (*exti_callback_t)(uint8_t pin, uint8_t edge, uint16_t time);
+
+
+/// const configuration of one pin
+typedef struct {
+  exti_callback_t   callback;         ///< function called on pin change, or NULL for unused pin
+  uint8_t           debounce;         ///< debounce time [ms], 0=no debouncing (call from ISR)
+} exti_pin_t;
+
+
+/// runtime state of one port
+typedef struct {
+  const exti_pin_t  *pins;            ///< const table with 8 entries, index = pin number
+  uint8_t           mask;             ///< pins with callback
+  uint8_t           state;            ///< last reported pin state
+  uint8_t           bouncing;         ///< pins with running debounce timer
+  uint8_t           timer[8];         ///< remaining debounce time [ms] per pin
+} exti_port_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// initialize port state from const pin table and current input state
+void exti_init(exti_port_t *port, const exti_pin_t *pins, uint8_t idr);
+
+/// dispatch pin changes of port. Call from port EXTI ISR with fresh IDR value
+void exti_dispatch(exti_port_t *port, uint8_t idr);
+
+/// decrement debounce timers of port and report stable changes. Call from exti_tick()
+void exti_debounce(exti_port_t *port, uint8_t idr);
+
+/// 1ms tick hook, called from TIM4 ISR. Implemented by application, calls exti_debounce() for each port
+void exti_tick(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _EXTI_H_
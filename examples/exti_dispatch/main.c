@@ -0,0 +1,341 @@
+/**********************
+  EXTI dispatch with per-pin callbacks, IDR XOR edge detection and debouncing in timer tick
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - const per-pin callback table for key port
+    - key pin with 20ms debouncing in 1ms TIM4 tick, 2nd pin without debouncing
+    - callbacks toggle LED on key press and store event; events are printed via UART
+    - test pin is high during EXTI ISR -> measure ISR duration with scope
+    - ISR duration is also measured with TIM2 (16MHz) and printed with each event
+    - at startup the worst case of exti_dispatch() (8 pins changed, no debounce) is measured with TIM2
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "timer4.h"
+#undef _MAIN_
+#include "exti.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#if defined(STM8L_DISCOVERY)
+  #define LED           sfr_PORTE.ODR.ODR7      // LED green
+  #define TEST          sfr_PORTC.ODR.ODR7      // LED blue
+  #define KEY_PORT      sfr_PORTC               // PC1 = user button, PC2 = 2nd input
+  #define KEY_PRESSED   EXTI_EDGE_RISING        // user button has external pull-down
+#elif defined(SDUINO)
+  #define LED           sfr_PORTC.ODR.ODR5      // D13/LED
+  #define TEST          sfr_PORTC.ODR.ODR7      // D12
+  #define KEY_PORT      sfr_PORTD               // PD4 (D2) = key, PD2 = 2nd input
+  #define KEY_PRESSED   EXTI_EDGE_FALLING       // key to GND with pull-up
+#endif
+
+// start / stop ISR time measurement via TIM2 (16MHz)
+#define ISR_START()     do { TEST = 1; READ16(g_isrStart, sfr_TIM2, CNTR); } while (0)
+#define ISR_STOP()      do { isr_time(); TEST = 0; } while (0)
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+// last event reported by callbacks. Printed in main loop
+volatile uint8_t    g_eventFlag = 0;
+volatile uint8_t    g_eventPin, g_eventEdge;
+volatile uint16_t   g_eventTime;
+
+// ISR duration [cycles]. Start of current ISR, max. of all ISRs
+uint16_t            g_isrStart;
+volatile uint16_t   g_isrMax = 0;
+
+/// timer overhead [cycles]
+uint16_t            m_overhead;
+
+
+/*----------------------------------------------------------
+    EXTI CALLBACKS AND PIN TABLE
+----------------------------------------------------------*/
+
+/// callback for key pin (debounced). Toggle LED on press
+void key_pressed(uint8_t pin, uint8_t edge, uint16_t time) {
+  if (edge == KEY_PRESSED)
+    LED ^= 1;
+  g_eventPin  = pin;
+  g_eventEdge = edge;
+  g_eventTime = time;
+  g_eventFlag = 1;
+}
+
+/// callback for 2nd pin (not debounced)
+void input_changed(uint8_t pin, uint8_t edge, uint16_t time) {
+  g_eventPin  = pin;
+  g_eventEdge = edge;
+  g_eventTime = time;
+  g_eventFlag = 1;
+}
+
+/// const callback table of key port, index = pin number
+#if defined(STM8L_DISCOVERY)
+  const exti_pin_t  m_keyPins[8] = {
+    { NULL, 0 }, { key_pressed, 20 }, { input_changed, 0 }, { NULL, 0 },
+    { NULL, 0 }, { NULL, 0 },         { NULL, 0 },          { NULL, 0 }
+  };
+#elif defined(SDUINO)
+  const exti_pin_t  m_keyPins[8] = {
+    { NULL, 0 }, { NULL, 0 },         { input_changed, 0 }, { NULL, 0 },
+    { key_pressed, 20 }, { NULL, 0 }, { NULL, 0 },          { NULL, 0 }
+  };
+#endif
+
+/// runtime state of key port
+exti_port_t         m_keyPort;
+
+/// all 8 pins with callback and w/o debounce for worst case benchmark of exti_dispatch()
+const exti_pin_t    m_benchPins[8] = {
+  { input_changed, 0 }, { input_changed, 0 }, { input_changed, 0 }, { input_changed, 0 },
+  { input_changed, 0 }, { input_changed, 0 }, { input_changed, 0 }, { input_changed, 0 }
+};
+
+/// runtime state of benchmark port
+exti_port_t         m_benchPort;
+
+
+
+/**
+  \fn uint16_t bench_dispatch(uint8_t idr)
+
+  \brief measure one call of exti_dispatch() for benchmark port
+
+  \param[in]  idr     simulated input state of port
+
+  \return  execution time [cycles]
+*/
+uint16_t bench_dispatch(uint8_t idr) {
+
+  uint16_t  start, stop;
+
+  READ16(start, sfr_TIM2, CNTR);
+  exti_dispatch(&m_benchPort, idr);
+  READ16(stop, sfr_TIM2, CNTR);
+
+  return((uint16_t) (stop - start - m_overhead));
+
+} // bench_dispatch
+
+
+
+/**
+  \fn void isr_time(void)
+
+  \brief update max. ISR duration. Called at end of EXTI ISRs
+*/
+void isr_time(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM2, CNTR);
+  t = (uint16_t) (t - g_isrStart - m_overhead);
+  if (t > g_isrMax)
+    g_isrMax = t;
+
+} // isr_time
+
+
+
+/**
+  \fn void exti_tick(void)
+
+  \brief 1ms tick hook for EXTI debouncing
+
+  called every 1ms from TIM4 ISR. Handle debounce timers of all used ports.
+*/
+void exti_tick(void) {
+
+  exti_debounce(&m_keyPort, KEY_PORT.IDR.byte);
+
+} // exti_tick
+
+
+
+/**
+  \fn void KEY_ISR(void)
+
+  \brief ISR for key port external interrupt
+
+  interrupt service routine for key port. Read IDR once and dispatch
+  changes to pin callbacks. Test pin is high for ISR duration.
+
+  Note:
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: interrupt service table is defined in file "stm8_interrupt_vector.c"
+*/
+#if defined(STM8L_DISCOVERY)
+
+  // STM8L: EXTI per pin number -> 1 ISR per used pin. Clear flag of pin
+  ISR_HANDLER(EXTI1_ISR, _EXTI1_VECTOR_)
+  {
+    ISR_START();
+    sfr_ITC_EXTI.SR1.byte = PIN1;
+    exti_dispatch(&m_keyPort, KEY_PORT.IDR.byte);
+    ISR_STOP();
+    return;
+  } // EXTI1_ISR
+
+  ISR_HANDLER(EXTI2_ISR, _EXTI2_VECTOR_)
+  {
+    ISR_START();
+    sfr_ITC_EXTI.SR1.byte = PIN2;
+    exti_dispatch(&m_keyPort, KEY_PORT.IDR.byte);
+    ISR_STOP();
+    return;
+  } // EXTI2_ISR
+
+#elif defined(SDUINO)
+
+  // STM8S: EXTI per port, no flag to clear
+  ISR_HANDLER(PORTD_ISR, _EXTI3_VECTOR_)
+  {
+    ISR_START();
+    exti_dispatch(&m_keyPort, KEY_PORT.IDR.byte);
+    ISR_STOP();
+    return;
+  } // PORTD_ISR
+
+#endif
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint8_t   pin, edge;
+  uint16_t  time, start, isrMax, tNone, tOne, tAll;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // init 1ms timer
+  TIM4_init();
+
+  // TIM2 runs free at 16MHz for time measurement
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+  #endif
+  sfr_TIM2.PSCR.byte = 0;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // measure timer overhead
+  m_overhead = 0;
+  READ16(start, sfr_TIM2, CNTR);
+  READ16(time, sfr_TIM2, CNTR);
+  m_overhead = (uint16_t) (time - start);
+
+  // worst case of exti_dispatch(): no change, 1 pin and all 8 pins changed w/o debounce (incl. callbacks)
+  exti_init(&m_benchPort, m_benchPins, 0x00);
+  tNone = bench_dispatch(0x00);
+  tOne  = bench_dispatch(0x01);
+  tAll  = bench_dispatch(0xFE);
+  g_eventFlag = 0;
+
+  // configure LED and test pin as push-pull outputs, key pins as pull-up inputs with interrupt
+  #if defined(STM8L_DISCOVERY)
+    sfr_PORTE.DDR.DDR7 = 1;       // input(=0) or output(=1)
+    sfr_PORTE.CR1.C17  = 1;       // input: 0=float, 1=pull-up; output: 0=open-drain, 1=push-pull
+    sfr_PORTC.DDR.DDR7 = 1;
+    sfr_PORTC.CR1.C17  = 1;
+    sfr_PORTC.CR2.C27  = 1;       // input: 0=no exint, 1=exint; output: 0=2MHz slope, 1=10MHz slope
+    sfr_ITC_EXTI.CR1.P1IS = EXTI_BOTH_EDGES;
+    sfr_ITC_EXTI.CR1.P2IS = EXTI_BOTH_EDGES;
+    sfr_PORTC.CR1.byte |= PIN2;   // user button PC1 has external pull-down
+    sfr_PORTC.CR2.byte |= PIN1 | PIN2;
+  #elif defined(SDUINO)
+    sfr_PORTC.DDR.byte |= PIN5 | PIN7;
+    sfr_PORTC.CR1.byte |= PIN5 | PIN7;
+    sfr_PORTC.CR2.byte |= PIN7;
+    sfr_ITC_EXTI.CR1.PDIS = EXTI_BOTH_EDGES;
+    sfr_PORTD.CR1.byte |= PIN2 | PIN4;
+    sfr_PORTD.CR2.byte |= PIN2 | PIN4;
+  #endif
+
+  // init EXTI service with current pin state
+  exti_init(&m_keyPort, m_keyPins, KEY_PORT.IDR.byte);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // print benchmark. ISR adds interrupt entry/exit and flag handling
+  printf("\nexti_dispatch() [cycles]: no change %u, 1 pin %u, 8 pins %u\n", tNone, tOne, tAll);
+
+
+  // main loop
+  while (1) {
+
+    // print last event
+    if (g_eventFlag) {
+      DISABLE_INTERRUPTS();
+      pin  = g_eventPin;
+      edge = g_eventEdge;
+      time = g_eventTime;
+      isrMax = g_isrMax;
+      g_eventFlag = 0;
+      ENABLE_INTERRUPTS();
+      printf("pin %d %s at %u ms, max. EXTI ISR %u cycles\n", (int) pin, (edge == EXTI_EDGE_RISING) ? "rising" : "falling", time, isrMax);
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+estimate reset-to-main time of SDCC builds
+
+Reads the size of the RAM areas DATA (.bss, cleared) and INITIALIZER
+(initialized data, copied) from the .map file of each example and estimates
+the time of the RAM initialization before main():
+
+  - crt0:  SDCC default, 2MHz, 1 byte per loop (clear 4, copy 5 cycles/byte)
+  - fast:  startup.c of this example, 16MHz, 4 bytes per loop (clear 2, copy 3 cycles/byte)
+
+The hardware reset delay and the init sequences in main() (clock, UART,
+timers) are not included. Measured values are printed by ../main.c.
+
+usage:
+  python3 boot_time.py [DIR ...]      SDCC output folders (default: all ../../*/SDCC)
+"""
+
+import sys
+import os
+import re
+import glob
+import argparse
+
+
+# area size in .map: DATA  00000001  0000002A =  42. bytes (REL,CON)
+MAP_AREA = re.compile(r'^(\w+)\s+(?:0x)?[0-9A-Fa-f]+\s+(?:0x)?[0-9A-Fa-f]+\s*=\s*(\d+)\.\s*bytes')
+
+# cycles of crt0 RAM initialization at 2MHz: overhead, per cleared byte, per copied byte
+CRT0_MHZ = 2
+CRT0_CYCLES = (20, 4, 5)
+
+# cycles of fast RAM initialization at 16MHz: overhead, per 4 cleared bytes, per cleared remainder byte, per 4 copied bytes, per copied remainder byte
+FAST_MHZ = 16
+FAST_CYCLES = (40, 8, 5, 12, 7)
+
+
+def read_map(filename):
+  """
+  read size of areas DATA and INITIALIZER from .map file
+  """
+  size = {'DATA': 0, 'INITIALIZER': 0}
+  with open(filename, errors='replace') as f:
+    for line in f:
+      m = MAP_AREA.match(line.strip())
+      if m and m.group(1) in size:
+        size[m.group(1)] += int(m.group(2))
+  return size['DATA'], size['INITIALIZER']
+
+
+def time_crt0(data, init):
+  """
+  estimated time of crt0 RAM initialization [us]
+  """
+  cycles = CRT0_CYCLES[0] + data * CRT0_CYCLES[1] + init * CRT0_CYCLES[2]
+  return cycles / CRT0_MHZ
+
+
+def time_fast(data, init):
+  """
+  estimated time of fast RAM initialization [us]
+  """
+  cycles = FAST_CYCLES[0] + (data // 4) * FAST_CYCLES[1] + (data % 4) * FAST_CYCLES[2] + (init // 4) * FAST_CYCLES[3] + (init % 4) * FAST_CYCLES[4]
+  return cycles / FAST_MHZ
+
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  parser = argparse.ArgumentParser(description='estimate reset-to-main time of SDCC builds')
+  parser.add_argument('dirs', nargs='*', help='SDCC output folders (default: all examples)')
+  args = parser.parse_args()
+
+  dirs = args.dirs or sorted(glob.glob(os.path.join(here, '..', '..', '*', 'SDCC')))
+  rows = []
+  for d in dirs:
+    maps = sorted(glob.glob(os.path.join(d, '*.map')))
+    if not maps:
+      continue
+    try:
+      data, init = read_map(maps[0])
+    except IOError as e:
+      sys.stderr.write('error: %s\n' % e)
+      sys.exit(1)
+    name = os.path.basename(os.path.dirname(os.path.abspath(d)))
+    rows.append((name, data, init))
+  if not rows:
+    sys.stderr.write('error: no .map files found, build examples first (make)\n')
+    sys.exit(1)
+
+  print('%-32s %6s %6s %12s %12s' % ('example', 'DATA', 'INIT', 'crt0 [us]', 'fast [us]'))
+  for name, data, init in rows:
+    print('%-32s %6d %6d %12.1f %12.1f' % (name, data, init, time_crt0(data, init), time_fast(data, init)))
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,147 @@
+/**********************
+  Fast startup with no-init RAM, measure reset-to-main time
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - RAM is initialized by startup.c at 16MHz (STARTUP_FAST=1) or by compiler at 2MHz (STARTUP_FAST=0)
+    - measure time from startup hook to main()
+    - log reset reason and startup time in no-init RAM, which survives reset
+    - FIFO buffer in no-init RAM is filled once after power-on and checked after each reset
+    - print log via UART (19.2kBaud), then stop servicing the IWDG -> reset after 1s
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "timer4.h"
+  #include "iwdg.h"
+  #include "startup.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define RUN_TIME        1000          // time until IWDG reset [ms]
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint16_t  time, i, err;
+  uint8_t   reason, valid, idx;
+
+  // get startup time first
+  time = startup_time();
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // get and clear reset reason (flags are cleared by writing 1)
+  reason = sfr_RST.SR.byte;
+  sfr_RST.SR.byte = 0xFF;
+
+  // check no-init RAM. After power-on fill FIFO with test pattern
+  valid = startup_noinit_valid();
+  if (!valid) {
+    for (i=0; i<NOINIT_FIFO_SIZE; i++)
+      g_noinit.fifo[i] = (uint8_t) i;
+  }
+
+  // log reset
+  idx = (uint8_t) (g_noinit.resets % NOINIT_LOG_SIZE);
+  g_noinit.log[idx].reason  = reason;
+  g_noinit.log[idx].startup = time;
+  g_noinit.resets++;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // init 1ms interrupt
+  TIM4_init();
+
+  // init IWDG watchdog with 100ms period and start
+  iwdg_init(100);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // print startup info
+  printf("\nreset %u, RST_SR 0x%02x, startup %uus (%s), no-init RAM %s\n",
+    g_noinit.resets, (int) reason, time, (STARTUP_FAST) ? "fast" : "compiler", valid ? "valid" : "cleared");
+
+  // check FIFO in no-init RAM
+  err = 0;
+  for (i=0; i<NOINIT_FIFO_SIZE; i++) {
+    if (g_noinit.fifo[i] != (uint8_t) i)
+      err++;
+  }
+  printf("  FIFO %uB: %u errors\n", (uint16_t) NOINIT_FIFO_SIZE, err);
+
+  // print log of last resets
+  for (i=0; (i<NOINIT_LOG_SIZE) && (i<g_noinit.resets); i++) {
+    idx = (uint8_t) ((g_noinit.resets - 1 - i) % NOINIT_LOG_SIZE);
+    printf("  -%u: RST_SR 0x%02x, startup %uus\n", i, (int) g_noinit.log[idx].reason, g_noinit.log[idx].startup);
+  }
+
+
+  // main loop
+  while(1) {
+
+    // service IWDG for RUN_TIME, then reset
+    if (g_millis < RUN_TIME)
+      iwdg_service();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,60 @@
+/**
+  \file noinit.h
+
+  \author G. Icking-Konert
+  \date 2021-10-09
+  \version 0.1
+
+  \brief content of no-init RAM for this application
+
+  data type of the no-init block g_noinit (see startup.h). It is not touched
+  by the startup code, i.e. survives IWDG, WWDG or software resets. Put large
+  buffers here which don't need to be cleared at startup.
+
+  \note first member must be uint16_t 'magic' (see startup_noinit_valid())
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _NOINIT_H_
+#define _NOINIT_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+#define NOINIT_LOG_SIZE       8               ///< number of logged resets
+#define NOINIT_FIFO_SIZE      256             ///< size of FIFO buffer [B]
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// reset log entry
+typedef struct {
+  uint8_t   reason;                           ///< RST_SR of reset
+  uint16_t  startup;                          ///< reset-to-main time [us]
+} noinit_log_t;
+
+/// content of no-init RAM
+typedef struct {
+  uint16_t      magic;                        ///< STARTUP_NOINIT_MAGIC if content is valid. Must be first
+  uint16_t      resets;                       ///< number of resets since power-on
+  noinit_log_t  log[NOINIT_LOG_SIZE];         ///< log of last resets
+  uint8_t       fifo[NOINIT_FIFO_SIZE];       ///< large buffer, e.g. UART FIFO. Not cleared at startup
+} noinit_t;
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _NOINIT_H_
@@ -0,0 +1,266 @@
+/**
+  \file startup.c
+
+  \author G. Icking-Konert
+  \date 2021-10-09
+  \version 0.1
+
+  \brief implementation of fast startup code with no-init RAM
+
+  implementation of a replacement for the RAM initialization of the compiler
+  startup code. For details see startup.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "startup.h"
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void startup_timer(void)
+
+  \brief start TIM2 as free running timer
+
+  start TIM2 with prescaler 1, i.e. at CPU clock. Called from startup hook
+  before RAM is initialized -> must not use global variables
+*/
+static void startup_timer(void) {
+
+  // for low-power device enable clock gating to TIM2
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+  #endif
+
+  // start TIM2 at CPU clock
+  sfr_TIM2.PSCR.byte = 0x00;
+  sfr_TIM2.CR1.CEN   = 1;
+
+} // startup_timer
+
+
+
+#if defined(__SDCC)
+
+/**
+  \fn uint8_t __sdcc_external_startup(void)
+
+  \brief SDCC startup hook
+
+  \return  1: skip crt0 RAM initialization, 0: use crt0 initialization
+
+  called by SDCC crt0 before RAM initialization. Switches to 16MHz and
+  initializes RAM faster than crt0 (2MHz, 1 byte per loop):
+    - clear area DATA (.bss), 4 bytes per loop (2 cycles/byte)
+    - copy area INITIALIZER (flash) to INITIALIZED (RAM), 4 bytes per loop (3 cycles/byte)
+  The no-init block (__at) is not part of DATA and therefore not touched.
+  Is called before RAM initialization -> must not use global variables
+*/
+uint8_t __sdcc_external_startup(void) {
+
+  #if (STARTUP_FAST)
+
+    // switch to 16MHz (default is 2MHz)
+    sfr_CLK.CKDIVR.byte = 0x00;
+
+    // start timer for measurement of startup time
+    startup_timer();
+
+    // clear DATA and copy INITIALIZER -> INITIALIZED from end of area
+    __asm
+      ; clear remaining l_DATA%4 bytes byte-wise
+      ldw   x, #l_DATA
+      ld    a, xl
+      and   a, #3
+      jreq  0002$
+    0001$:
+      clr   (s_DATA-1, x)
+      decw  x
+      dec   a
+      jrne  0001$
+    0002$:
+      ; clear 4 bytes per loop
+      tnzw  x
+      jreq  0004$
+    0003$:
+      clr   (s_DATA-1, x)
+      clr   (s_DATA-2, x)
+      clr   (s_DATA-3, x)
+      clr   (s_DATA-4, x)
+      subw  x, #4
+      jrne  0003$
+    0004$:
+
+      ; copy remaining l_INITIALIZER%4 bytes byte-wise. Counter in y
+      ldw   x, #l_INITIALIZER
+      ld    a, xl
+      and   a, #3
+      jreq  0006$
+      clrw  y
+      ld    yl, a
+    0005$:
+      ld    a, (s_INITIALIZER-1, x)
+      ld    (s_INITIALIZED-1, x), a
+      decw  x
+      decw  y
+      jrne  0005$
+    0006$:
+      ; copy 4 bytes per loop
+      tnzw  x
+      jreq  0008$
+    0007$:
+      ld    a, (s_INITIALIZER-1, x)
+      ld    (s_INITIALIZED-1, x), a
+      ld    a, (s_INITIALIZER-2, x)
+      ld    (s_INITIALIZED-2, x), a
+      ld    a, (s_INITIALIZER-3, x)
+      ld    (s_INITIALIZED-3, x), a
+      ld    a, (s_INITIALIZER-4, x)
+      ld    (s_INITIALIZED-4, x), a
+      subw  x, #4
+      jrne  0007$
+    0008$:
+    __endasm;
+
+    // skip crt0 RAM initialization
+    return(1);
+
+  #else // STARTUP_FAST
+
+    // start timer for measurement of startup time
+    startup_timer();
+
+    // use crt0 RAM initialization at 2MHz
+    return(0);
+
+  #endif // STARTUP_FAST
+
+} // __sdcc_external_startup
+
+#elif defined(__ICCSTM8__)
+
+/**
+  \fn int __low_level_init(void)
+
+  \brief IAR startup hook
+
+  \return  1: initialize segments by cstartup
+
+  called by IAR cstartup before segment initialization. Switches to 16MHz,
+  i.e. segment initialization is 8x faster. __no_init variables are not touched.
+  Is called before RAM initialization -> must not use global variables
+*/
+int __low_level_init(void) {
+
+  // switch to 16MHz (default is 2MHz)
+  #if (STARTUP_FAST)
+    sfr_CLK.CKDIVR.byte = 0x00;
+  #endif
+
+  // start timer for measurement of startup time
+  startup_timer();
+
+  // initialize segments
+  return(1);
+
+} // __low_level_init
+
+#endif // __ICCSTM8__
+
+
+
+/**
+  \fn uint16_t startup_time(void)
+
+  \brief return startup time
+
+  \return time from startup hook to call [us]. 0 if no hook
+
+  read TIM2 (started in startup hook), then stop TIM2 and restore reset state.
+  Call first in main(), i.e. before clock is changed
+*/
+uint16_t startup_time(void) {
+
+  uint16_t  ticks;
+
+  // read timer
+  READ16(ticks, sfr_TIM2, CNTR);
+
+  // restore TIM2 reset state
+  sfr_TIM2.CR1.CEN = 0;
+  WRITE16(sfr_TIM2, CNTR, 0x0000);
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 0;
+  #endif
+
+  // convert to us
+  return(ticks / STARTUP_TIM_MHZ);
+
+} // startup_time
+
+
+
+/**
+  \fn uint8_t startup_noinit_valid(void)
+
+  \brief check no-init RAM
+
+  \return 1 if no-init RAM is valid, 0 if it was cleared
+
+  check marker of no-init RAM. After power-on the content is undefined ->
+  clear the whole block and set marker
+*/
+uint8_t startup_noinit_valid(void) {
+
+  // content valid -> keep
+  if (g_noinit.magic == STARTUP_NOINIT_MAGIC)
+    return(1);
+
+  // clear and mark valid
+  startup_clear(&g_noinit, sizeof(g_noinit));
+  g_noinit.magic = STARTUP_NOINIT_MAGIC;
+
+  return(0);
+
+} // startup_noinit_valid
+
+
+
+/**
+  \fn void startup_clear(void *addr, uint16_t len)
+
+  \brief fast clear of RAM block
+
+  \param[in]  addr   start address
+  \param[in]  len    number of bytes
+
+  clear RAM block with 4 bytes per loop
+*/
+void startup_clear(void *addr, uint16_t len) {
+
+  uint8_t   *p = (uint8_t*) addr;
+
+  // clear remaining len%4 bytes
+  while (len & 0x03) {
+    *(p++) = 0;
+    len--;
+  }
+
+  // clear 4 bytes per loop
+  for (len >>= 2; len; len--) {
+    p[0] = 0;
+    p[1] = 0;
+    p[2] = 0;
+    p[3] = 0;
+    p += 4;
+  }
+
+} // startup_clear
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
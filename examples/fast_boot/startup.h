@@ -0,0 +1,114 @@
+/**
+  \file startup.h
+
+  \author G. Icking-Konert
+  \date 2021-10-09
+  \version 0.1
+
+  \brief declaration of fast startup code with no-init RAM
+
+  declaration of a replacement for the RAM initialization of the compiler
+  startup code, which is called before main():
+
+    - switch to 16MHz HSI before RAM is initialized (default is 2MHz)
+    - SDCC: clear .bss (area DATA) and copy initialized data with unrolled loops
+    - no-init block g_noinit (type noinit_t, see noinit.h) is not touched and
+      survives resets. Large buffers (FIFOs, logs, crash records) placed there
+      are not cleared at each startup
+    - start TIM2 as free running timer for measurement of the startup time,
+      see startup_time()
+
+  Hooks of the compiler startup code:
+    - SDCC: __sdcc_external_startup() is called by crt0 before data initialization.
+      Return value !=0 skips the crt0 initialization
+    - IAR: __low_level_init() is called by cstartup before segment initialization.
+      The IAR initialization is kept
+    - Cosmic: no hook. Only the no-init block is supported
+
+  \note STARTUP_FAST=0 keeps the compiler initialization at 2MHz for comparison
+  \note TIM2 is used for measurement of startup time. Can be re-used after startup_time()
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _STARTUP_H_
+#define _STARTUP_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "noinit.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// fast RAM initialization at 16MHz (=1) or compiler initialization at 2MHz (=0); can be overwritten via compiler option
+#if !defined(STARTUP_FAST)
+  #define STARTUP_FAST          1
+#endif
+
+// reserved stack size at end of RAM [B]; can be overwritten via compiler option
+#if !defined(STARTUP_STACK_SIZE)
+  #define STARTUP_STACK_SIZE    0x200
+#endif
+
+#define STARTUP_NOINIT_MAGIC    0x5AA5        ///< marker for valid no-init RAM
+
+/// address of no-init block for SDCC (just below the stack at end of RAM)
+#if !defined(STARTUP_NOINIT_ADDR)
+  #define STARTUP_NOINIT_ADDR   (RAM_ADDR_END - STARTUP_STACK_SIZE - sizeof(noinit_t) + 1)
+#endif
+
+/// keyword for variables which are not initialized by startup code
+#if defined(__CSMC__)
+  #define STARTUP_NOINIT        @near @nostartup
+#elif defined(__ICCSTM8__)
+  #define STARTUP_NOINIT        __no_init
+#elif defined(__SDCC)
+  #define STARTUP_NOINIT        __at(STARTUP_NOINIT_ADDR)
+#endif
+
+/// TIM2 clock during startup [MHz]
+#if (STARTUP_FAST)
+  #define STARTUP_TIM_MHZ       16
+#else
+  #define STARTUP_TIM_MHZ       2
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  STARTUP_NOINIT noinit_t     g_noinit;                 ///< no-init RAM. Not touched by startup code -> survives reset
+#else // _MAIN_
+  extern noinit_t             g_noinit;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// return time from startup hook to call [us] and stop TIM2. Call first in main(). Return 0 if no hook (Cosmic)
+uint16_t  startup_time(void);
+
+/// check no-init RAM. If invalid (e.g. after power-on) clear it and return 0, else return 1
+uint8_t   startup_noinit_valid(void);
+
+/// fast clear of RAM block
+void      startup_clear(void *addr, uint16_t len);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _STARTUP_H_
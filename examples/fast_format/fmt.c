@@ -0,0 +1,417 @@
+/**
+  \file fmt.c
+
+  \author G. Icking-Konert
+  \date 2021-07-10
+  \version 0.1
+
+  \brief implementation of lightweight, non-blocking formatted output
+
+  implementation of integer, hex and fixed-point formatting into a line
+  buffer without division, and non-blocking output of the line to the
+  UART Tx FIFO. For details see fmt.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "fmt.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+/// append byte to line buffer. If buffer is full, drop byte and set truncated flag
+#define FMT_PUT(f, c)     { if ((f)->len < FMT_LINE_SIZE) (f)->buf[(f)->len++] = (uint8_t) (c); else (f)->truncated = 1; }
+
+
+/*-----------------------------------------------------------------------------
+    MODULE VARIABLES (for clarity module internal variables start with "m_")
+-----------------------------------------------------------------------------*/
+
+/// powers of 10 for 16-bit decimal conversion via subtraction
+static const uint16_t   m_pow10_16[4] = { 10000, 1000, 100, 10 };
+
+/// powers of 10 for 32-bit decimal conversion via subtraction
+static const uint32_t   m_pow10_32[9] = { 1000000000L, 100000000L, 10000000L, 1000000L, 100000L, 10000L, 1000L, 100L, 10L };
+
+/// hex digits for nibble conversion
+static const char       m_hex[16] = { '0','1','2','3','4','5','6','7','8','9','A','B','C','D','E','F' };
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void fmt_init(fmt_t *f)
+
+  \brief clear line buffer
+
+  \param[in]  f   line buffer
+
+  clear line buffer and truncated flag.
+*/
+void fmt_init(fmt_t *f) {
+
+  f->len       = 0;
+  f->truncated = 0;
+
+} // fmt_init
+
+
+
+/**
+  \fn void fmt_char(fmt_t *f, char c)
+
+  \brief append character
+
+  \param[in]  f   line buffer
+  \param[in]  c   character to append
+
+  append single character to line buffer.
+*/
+void fmt_char(fmt_t *f, char c) {
+
+  FMT_PUT(f, c);
+
+} // fmt_char
+
+
+
+/**
+  \fn void fmt_str(fmt_t *f, const char *s)
+
+  \brief append string
+
+  \param[in]  f   line buffer
+  \param[in]  s   zero terminated string
+
+  append zero terminated string to line buffer. Stop if buffer is full.
+*/
+void fmt_str(fmt_t *f, const char *s) {
+
+  while (*s) {
+    if (f->len >= FMT_LINE_SIZE) {
+      f->truncated = 1;
+      return;
+    }
+    f->buf[f->len++] = (uint8_t) *(s++);
+  }
+
+} // fmt_str
+
+
+
+/**
+  \fn void fmt_u16(fmt_t *f, uint16_t val, uint8_t digits)
+
+  \brief append unsigned 16-bit as decimal
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+  \param[in]  digits  min. number of digits, padded with '0'. Use 0 for no padding
+
+  append unsigned 16-bit as decimal. Each digit is found by repeated
+  subtraction of the respective power of 10, i.e. max. 9 16-bit subtractions
+  per digit and no division.
+*/
+void fmt_u16(fmt_t *f, uint16_t val, uint8_t digits) {
+
+  uint8_t   i, d, lead = 1;
+
+  // padding beyond 5 digits
+  while (digits > 5) {
+    FMT_PUT(f, '0');
+    digits--;
+  }
+
+  // digits 5..2 via subtraction. Skip leading zeros unless padding is requested
+  for (i=0; i<4; i++) {
+    d = '0';
+    while (val >= m_pow10_16[i]) {
+      val -= m_pow10_16[i];
+      d++;
+    }
+    if ((d != '0') || (digits >= (uint8_t) (5-i)))
+      lead = 0;
+    if (!lead)
+      FMT_PUT(f, d);
+  }
+
+  // last digit is remainder
+  FMT_PUT(f, '0' + (uint8_t) val);
+
+} // fmt_u16
+
+
+
+/**
+  \fn void fmt_i16(fmt_t *f, int16_t val, uint8_t digits)
+
+  \brief append signed 16-bit as decimal
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+  \param[in]  digits  min. number of digits w/o sign, padded with '0'
+
+  append signed 16-bit as decimal, see fmt_u16().
+*/
+void fmt_i16(fmt_t *f, int16_t val, uint8_t digits) {
+
+  if (val < 0) {
+    FMT_PUT(f, '-');
+    fmt_u16(f, (uint16_t) 0 - (uint16_t) val, digits);
+  }
+  else
+    fmt_u16(f, (uint16_t) val, digits);
+
+} // fmt_i16
+
+
+
+/**
+  \fn void fmt_u32(fmt_t *f, uint32_t val, uint8_t digits)
+
+  \brief append unsigned 32-bit as decimal
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+  \param[in]  digits  min. number of digits, padded with '0'. Use 0 for no padding
+
+  append unsigned 32-bit as decimal via repeated subtraction of powers of 10.
+  Values <65536 use the faster 16-bit path.
+*/
+void fmt_u32(fmt_t *f, uint32_t val, uint8_t digits) {
+
+  uint8_t   i, d, lead = 1;
+
+  // fast 16-bit path
+  if ((val <= 0xFFFF) && (digits <= 5)) {
+    fmt_u16(f, (uint16_t) val, digits);
+    return;
+  }
+
+  // padding beyond 10 digits
+  while (digits > 10) {
+    FMT_PUT(f, '0');
+    digits--;
+  }
+
+  // digits 10..2 via subtraction. Skip leading zeros unless padding is requested
+  for (i=0; i<9; i++) {
+    d = '0';
+    while (val >= m_pow10_32[i]) {
+      val -= m_pow10_32[i];
+      d++;
+    }
+    if ((d != '0') || (digits >= (uint8_t) (10-i)))
+      lead = 0;
+    if (!lead)
+      FMT_PUT(f, d);
+  }
+
+  // last digit is remainder
+  FMT_PUT(f, '0' + (uint8_t) val);
+
+} // fmt_u32
+
+
+
+/**
+  \fn void fmt_i32(fmt_t *f, int32_t val, uint8_t digits)
+
+  \brief append signed 32-bit as decimal
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+  \param[in]  digits  min. number of digits w/o sign, padded with '0'
+
+  append signed 32-bit as decimal, see fmt_u32().
+*/
+void fmt_i32(fmt_t *f, int32_t val, uint8_t digits) {
+
+  if (val < 0) {
+    FMT_PUT(f, '-');
+    fmt_u32(f, (uint32_t) 0 - (uint32_t) val, digits);
+  }
+  else
+    fmt_u32(f, (uint32_t) val, digits);
+
+} // fmt_i32
+
+
+
+/**
+  \fn void fmt_hex8(fmt_t *f, uint8_t val)
+
+  \brief append 8-bit as hex
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+
+  append 8-bit as 2 upper-case hex digits via nibble table.
+*/
+void fmt_hex8(fmt_t *f, uint8_t val) {
+
+  FMT_PUT(f, m_hex[val >> 4]);
+  FMT_PUT(f, m_hex[val & 0x0F]);
+
+} // fmt_hex8
+
+
+
+/**
+  \fn void fmt_hex16(fmt_t *f, uint16_t val)
+
+  \brief append 16-bit as hex
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+
+  append 16-bit as 4 upper-case hex digits.
+*/
+void fmt_hex16(fmt_t *f, uint16_t val) {
+
+  fmt_hex8(f, (uint8_t) (val >> 8));
+  fmt_hex8(f, (uint8_t) val);
+
+} // fmt_hex16
+
+
+
+/**
+  \fn void fmt_hex32(fmt_t *f, uint32_t val)
+
+  \brief append 32-bit as hex
+
+  \param[in]  f       line buffer
+  \param[in]  val     value to append
+
+  append 32-bit as 8 upper-case hex digits.
+*/
+void fmt_hex32(fmt_t *f, uint32_t val) {
+
+  fmt_hex16(f, (uint16_t) (val >> 16));
+  fmt_hex16(f, (uint16_t) val);
+
+} // fmt_hex32
+
+
+
+/**
+  \fn void fmt_fix(fmt_t *f, int32_t val, uint8_t frac, uint8_t decimals)
+
+  \brief append binary fixed-point value
+
+  \param[in]  f         line buffer
+  \param[in]  val       fixed-point value with 'frac' fractional bits
+  \param[in]  frac      number of fractional bits (0..28), e.g. 15 for Q15
+  \param[in]  decimals  number of decimals to print
+
+  append binary fixed-point value, e.g. Q8 value 0x0380 with 2 decimals -> "3.50".
+  Integer part is printed via fmt_u32(), each decimal is obtained by multiplying
+  the fraction by 10 (shift & add) and taking the integer part. Decimals are
+  truncated, not rounded.
+*/
+void fmt_fix(fmt_t *f, int32_t val, uint8_t frac, uint8_t decimals) {
+
+  uint32_t  u, mask;
+
+  // print sign and get absolute value
+  if (val < 0) {
+    FMT_PUT(f, '-');
+    u = (uint32_t) 0 - (uint32_t) val;
+  }
+  else
+    u = (uint32_t) val;
+
+  // integer part
+  fmt_u32(f, u >> frac, 0);
+  if (decimals == 0)
+    return;
+
+  // fractional part: multiply by 10, integer part is next decimal
+  FMT_PUT(f, '.');
+  mask = ((uint32_t) 1 << frac) - 1;
+  u &= mask;
+  while (decimals--) {
+    u = (u << 3) + (u << 1);
+    FMT_PUT(f, '0' + (uint8_t) (u >> frac));
+    u &= mask;
+  }
+
+} // fmt_fix
+
+
+
+/**
+  \fn void fmt_dp(fmt_t *f, int32_t val, uint8_t decimals)
+
+  \brief append decimal scaled value
+
+  \param[in]  f         line buffer
+  \param[in]  val       value in units of 10^-decimals, e.g. centi-degree
+  \param[in]  decimals  number of decimals
+
+  append decimal scaled value with decimal point, e.g. 2345 with 2 decimals
+  -> "23.45", -5 with 2 decimals -> "-0.05". Value is printed via fmt_u32()
+  with at least decimals+1 digits, then the decimal point is inserted.
+*/
+void fmt_dp(fmt_t *f, int32_t val, uint8_t decimals) {
+
+  uint8_t   i;
+
+  // print sign and value with at least decimals+1 digits
+  if (val < 0) {
+    FMT_PUT(f, '-');
+    fmt_u32(f, (uint32_t) 0 - (uint32_t) val, decimals+1);
+  }
+  else
+    fmt_u32(f, (uint32_t) val, decimals+1);
+
+  // insert decimal point. Skip if number was truncated
+  if ((decimals == 0) || (f->truncated))
+    return;
+  if (f->len >= FMT_LINE_SIZE) {
+    f->truncated = 1;
+    return;
+  }
+  for (i=f->len; i>(uint8_t) (f->len-decimals); i--)
+    f->buf[i] = f->buf[i-1];
+  f->buf[i] = '.';
+  f->len++;
+
+} // fmt_dp
+
+
+
+/**
+  \fn uint8_t fmt_send(fmt_t *f)
+
+  \brief write line buffer to output
+
+  \param[in]  f   line buffer
+
+  \return number of written bytes
+
+  write line buffer to output via FMT_WRITE() (default: UART2 Tx FIFO)
+  w/o blocking and clear buffer. Bytes not fitting into the FIFO are dropped
+  and counted by the output function.
+*/
+uint8_t fmt_send(fmt_t *f) {
+
+  uint8_t   num;
+
+  num = FMT_WRITE(f->len, f->buf);
+  f->len       = 0;
+  f->truncated = 0;
+
+  return(num);
+
+} // fmt_send
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
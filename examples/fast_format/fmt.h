@@ -0,0 +1,119 @@
+/**
+  \file fmt.h
+
+  \author G. Icking-Konert
+  \date 2021-07-10
+  \version 0.1
+
+  \brief declaration of lightweight, non-blocking formatted output
+
+  declaration of a small replacement for printf(). Output is collected in
+  a line buffer and is written to the UART Tx FIFO in one span via
+  fmt_send(), i.e. w/o per-character function calls and w/o blocking:
+    fmt_t   f;
+    fmt_init(&f);
+    fmt_str(&f, "time: ");
+    fmt_u32(&f, g_millis, 0);
+    fmt_str(&f, "ms, T=");
+    fmt_fix(&f, temp_q8, 8, 2);       // Q8 fixed-point with 2 decimals
+    fmt_char(&f, '\n');
+    fmt_send(&f);
+
+  Implementation:
+    - decimal via subtraction of powers of 10 (no division), 16-bit path for small values
+    - hex via nibble table
+    - binary (Qn) and decimal scaled fixed-point without division
+    - if the line buffer is full, further characters are dropped and fmt_t.truncated is set
+    - if the Tx FIFO is full, the tail is dropped and counted, see UART2_get_dropped()
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _FMT_H_
+#define _FMT_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#include "uart2.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// default line buffer size in bytes; can be overwritten via compiler option
+#ifndef FMT_LINE_SIZE
+  #define FMT_LINE_SIZE       64
+#endif
+
+// output function for a span of bytes; can be overwritten via compiler option
+#ifndef FMT_WRITE
+  #define FMT_WRITE(num, buf)   UART2_write_span(num, buf)
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// line buffer for formatted output
+typedef struct {
+  uint8_t   len;                      ///< number of bytes in buffer
+  uint8_t   truncated;                ///< 1 = characters were dropped due to full buffer
+  uint8_t   buf[FMT_LINE_SIZE];       ///< line data (not zero terminated)
+} fmt_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// clear line buffer
+void    fmt_init(fmt_t *f);
+
+/// append character
+void    fmt_char(fmt_t *f, char c);
+
+/// append zero terminated string
+void    fmt_str(fmt_t *f, const char *s);
+
+/// append unsigned 16-bit as decimal with min. number of digits (zero padded)
+void    fmt_u16(fmt_t *f, uint16_t val, uint8_t digits);
+
+/// append signed 16-bit as decimal with min. number of digits (zero padded)
+void    fmt_i16(fmt_t *f, int16_t val, uint8_t digits);
+
+/// append unsigned 32-bit as decimal with min. number of digits (zero padded)
+void    fmt_u32(fmt_t *f, uint32_t val, uint8_t digits);
+
+/// append signed 32-bit as decimal with min. number of digits (zero padded)
+void    fmt_i32(fmt_t *f, int32_t val, uint8_t digits);
+
+/// append 8-bit as 2 hex digits
+void    fmt_hex8(fmt_t *f, uint8_t val);
+
+/// append 16-bit as 4 hex digits
+void    fmt_hex16(fmt_t *f, uint16_t val);
+
+/// append 32-bit as 8 hex digits
+void    fmt_hex32(fmt_t *f, uint32_t val);
+
+/// append binary fixed-point value with 'frac' fractional bits (Qn) and 'decimals' decimals (truncated)
+void    fmt_fix(fmt_t *f, int32_t val, uint8_t frac, uint8_t decimals);
+
+/// append decimal scaled value, e.g. centi-degree 2345 with decimals=2 -> "23.45"
+void    fmt_dp(fmt_t *f, int32_t val, uint8_t decimals);
+
+/// write line buffer to output w/o blocking and clear it. Return number of written bytes
+uint8_t fmt_send(fmt_t *f);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _FMT_H_
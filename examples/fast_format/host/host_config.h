@@ -0,0 +1,30 @@
+/**
+  \file host_config.h
+
+  \brief configuration stub for host test of fmt.c
+
+  replaces config.h and uart2.h of the target, i.e. no device header is
+  included. Output of fmt_send() goes to a buffer of the test.
+  Included via compiler option '-include host_config.h', see Makefile.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _HOST_CONFIG_H_
+#define _HOST_CONFIG_H_
+
+// skip target headers
+#define _CONFIG_H_
+#define _UART2_H_
+
+#include <stdint.h>
+
+// output of fmt_send() to test buffer
+#define FMT_WRITE(num, buf)   host_write(num, buf)
+uint8_t host_write(uint8_t num, uint8_t *buf);
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _HOST_CONFIG_H_
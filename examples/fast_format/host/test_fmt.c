@@ -0,0 +1,236 @@
+/**********************
+  Host test of fmt.c: compare output with printf()
+
+  Functionality:
+    - format random and corner case values via fmt.c and via snprintf()
+    - decimal 16/32-bit signed & unsigned with and without zero padding
+    - hex 8/16/32-bit
+    - binary fixed-point fmt_fix() vs. exact 64-bit reference (truncated)
+    - decimal scaled fmt_dp() vs. snprintf() of integer and fraction
+    - line buffer overflow sets truncated flag, fmt_send() writes buffer
+    - print number of tests and mismatches. Exit code 1 on mismatch
+
+  build & run: make
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "fmt.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define NUM_RANDOM      200000        // number of random values per function
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// output of fmt_send()
+uint8_t         m_out[256];
+uint8_t         m_outLen;
+
+/// number of tests and mismatches
+unsigned long   m_tests, m_errors;
+
+/// state of pseudo-random generator
+uint32_t        m_random = 0x12345678;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/// output function of fmt_send(), see host_config.h
+uint8_t host_write(uint8_t num, uint8_t *buf) {
+  memcpy(m_out, buf, num);
+  m_outLen = num;
+  return(num);
+}
+
+
+/// 32-bit xorshift pseudo-random generator. Every 8th value is small to test the 16-bit path and padding
+static uint32_t random32(void) {
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  if ((m_random & 0x07) == 0)
+    return(m_random >> (m_random % 32));
+  return(m_random);
+}
+
+
+/// compare line buffer with reference string and report mismatch
+static void compare(const fmt_t *f, const char *ref, const char *name, int64_t val, int param) {
+
+  m_tests++;
+  if ((f->len != strlen(ref)) || (memcmp(f->buf, ref, f->len) != 0) || (f->truncated)) {
+    m_errors++;
+    if (m_errors <= 20)
+      printf("  mismatch %s(%" PRId64 ", %d): '%.*s' vs. '%s'\n", name, val, param, (int) f->len, (const char*) f->buf, ref);
+  }
+
+} // compare
+
+
+/// test decimal and hex output of one 32-bit value
+static void test_value(uint32_t u, uint8_t digits) {
+
+  fmt_t     f;
+  char      ref[64];
+  uint16_t  u16 = (uint16_t) u;
+  int16_t   i16 = (int16_t) u16;
+  int32_t   i32 = (int32_t) u;
+
+  fmt_init(&f); fmt_u16(&f, u16, digits);
+  snprintf(ref, sizeof(ref), "%0*u", digits, (unsigned) u16);
+  compare(&f, ref, "fmt_u16", u16, digits);
+
+  fmt_init(&f); fmt_i16(&f, i16, digits);
+  snprintf(ref, sizeof(ref), "%s%0*u", (i16 < 0) ? "-" : "", digits, (unsigned) ((i16 < 0) ? -(int32_t) i16 : i16));
+  compare(&f, ref, "fmt_i16", i16, digits);
+
+  fmt_init(&f); fmt_u32(&f, u, digits);
+  snprintf(ref, sizeof(ref), "%0*" PRIu32, digits, u);
+  compare(&f, ref, "fmt_u32", u, digits);
+
+  fmt_init(&f); fmt_i32(&f, i32, digits);
+  snprintf(ref, sizeof(ref), "%s%0*" PRIu64, (i32 < 0) ? "-" : "", digits, (uint64_t) llabs((int64_t) i32));
+  compare(&f, ref, "fmt_i32", i32, digits);
+
+  fmt_init(&f); fmt_hex8(&f, (uint8_t) u);
+  snprintf(ref, sizeof(ref), "%02X", (unsigned) (uint8_t) u);
+  compare(&f, ref, "fmt_hex8", (uint8_t) u, 0);
+
+  fmt_init(&f); fmt_hex16(&f, u16);
+  snprintf(ref, sizeof(ref), "%04X", (unsigned) u16);
+  compare(&f, ref, "fmt_hex16", u16, 0);
+
+  fmt_init(&f); fmt_hex32(&f, u);
+  snprintf(ref, sizeof(ref), "%08" PRIX32, u);
+  compare(&f, ref, "fmt_hex32", u, 0);
+
+} // test_value
+
+
+/// test fixed-point output of one value
+static void test_fix(int32_t val, uint8_t frac, uint8_t decimals) {
+
+  fmt_t     f;
+  char      ref[64];
+  uint64_t  u = (uint64_t) llabs((int64_t) val), p10 = 1;
+  uint8_t   i;
+
+  // binary fixed-point: integer part, then fraction * 10^decimals / 2^frac (truncated)
+  for (i=0; i<decimals; i++)
+    p10 *= 10;
+  if (decimals)
+    snprintf(ref, sizeof(ref), "%s%" PRIu64 ".%0*" PRIu64, (val < 0) ? "-" : "", u >> frac, decimals,
+      ((u & (((uint64_t) 1 << frac) - 1)) * p10) >> frac);
+  else
+    snprintf(ref, sizeof(ref), "%s%" PRIu64, (val < 0) ? "-" : "", u >> frac);
+  fmt_init(&f); fmt_fix(&f, val, frac, decimals);
+  compare(&f, ref, "fmt_fix", val, frac * 100 + decimals);
+
+  // decimal scaled: integer and fraction of val / 10^decimals
+  if (decimals)
+    snprintf(ref, sizeof(ref), "%s%" PRIu64 ".%0*" PRIu64, (val < 0) ? "-" : "", u / p10, decimals, u % p10);
+  else
+    snprintf(ref, sizeof(ref), "%s%" PRIu64, (val < 0) ? "-" : "", u);
+  fmt_init(&f); fmt_dp(&f, val, decimals);
+  compare(&f, ref, "fmt_dp", val, decimals);
+
+} // test_fix
+
+
+/// test line buffer overflow and fmt_send()
+static void test_buffer(void) {
+
+  fmt_t     f;
+  uint8_t   i;
+
+  // fill buffer exactly, then one more character -> truncated
+  fmt_init(&f);
+  for (i=0; i<FMT_LINE_SIZE; i++)
+    fmt_char(&f, 'a');
+  m_tests++;
+  if ((f.len != FMT_LINE_SIZE) || (f.truncated))
+    m_errors++;
+  fmt_u32(&f, 12345678, 0);
+  m_tests++;
+  if ((f.len != FMT_LINE_SIZE) || (!f.truncated))
+    m_errors++;
+
+  // fmt_dp() at end of buffer must not write beyond buffer
+  fmt_init(&f);
+  for (i=0; i<FMT_LINE_SIZE-3; i++)
+    fmt_char(&f, 'a');
+  fmt_dp(&f, 123, 2);
+  m_tests++;
+  if ((f.len != FMT_LINE_SIZE) || (!f.truncated))
+    m_errors++;
+
+  // send writes buffer and clears it
+  fmt_init(&f);
+  fmt_str(&f, "t=");
+  fmt_i32(&f, -42, 3);
+  fmt_char(&f, '\n');
+  m_tests++;
+  if ((fmt_send(&f) != 7) || (m_outLen != 7) || (memcmp(m_out, "t=-042\n", 7) != 0) || (f.len != 0))
+    m_errors++;
+
+} // test_buffer
+
+
+
+/////////////////
+//    main routine
+/////////////////
+int main(void) {
+
+  static const uint32_t corner[] = { 0, 1, 9, 10, 99, 100, 9999, 10000, 32767, 32768, 65535, 65536,
+    99999, 100000, 999999999UL, 1000000000UL, 2147483647UL, 2147483648UL, 4294967295UL };
+  long      n;
+  uint8_t   i, digits;
+
+  // corner cases with all paddings
+  for (i=0; i<sizeof(corner)/sizeof(corner[0]); i++) {
+    for (digits=0; digits<=12; digits++) {
+      test_value(corner[i], digits);
+      test_value((uint32_t) 0 - corner[i], digits);
+    }
+  }
+
+  // random values
+  for (n=0; n<NUM_RANDOM; n++)
+    test_value(random32(), (uint8_t) (n % 12));
+
+  // fixed-point: corner cases and random values, frac 0..28, decimals 0..6
+  for (i=0; i<sizeof(corner)/sizeof(corner[0]); i++)
+    test_fix((int32_t) corner[i], 15, 4);
+  test_fix(INT32_MIN, 16, 5);
+  test_fix(-5, 0, 2);
+  test_fix(0x0380, 8, 2);
+  for (n=0; n<NUM_RANDOM; n++)
+    test_fix((int32_t) random32(), (uint8_t) (n % 29), (uint8_t) (n % 7));
+
+  // line buffer
+  test_buffer();
+
+  printf("fmt.c vs. printf(): %lu tests, %lu mismatches\n", m_tests, m_errors);
+
+  return((m_errors == 0) ? 0 : 1);
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
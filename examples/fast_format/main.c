@@ -0,0 +1,128 @@
+/**********************
+  Lightweight non-blocking formatted output vs. printf()
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+
+  Functionality:
+    - every 100ms print a line with time, signed value, hex and fixed-point value
+    - output is formatted via fmt.c (USE_PRINTF=0) or sprintf() (USE_PRINTF=1)
+    - line is written to UART2 Tx FIFO w/o blocking. Overflow is counted, not waited for
+    - test pin PC7 (D12) is high during formatting -> measure duration with scope
+    - for code size compare the map files of both variants, see README.md
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart2.h"
+  #include "timer4.h"
+#undef _MAIN_
+#include "fmt.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// 0 = use fmt.c, 1 = use sprintf() for comparison
+#define USE_PRINTF    0
+
+#if USE_PRINTF
+  #include <stdio.h>
+  #include <string.h>
+#endif
+
+// test pin PC7 (=Sduino D12) for scope
+#define TEST          sfr_PORTC.ODR.ODR7
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint32_t  nextPrint = 0;
+  int32_t   value = -123456L;
+  int16_t   temp_q8 = 0x1780;           // 23.5 in Q8
+#if USE_PRINTF
+  char      line[FMT_LINE_SIZE];
+#else
+  fmt_t     line;
+#endif
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART2 for 115.2kBaud
+  UART2_begin(115200);
+
+  // configure pin 13 (=PC5=LED) and pin 12 (=PC7) as output
+  sfr_PORTC.DDR.byte = (uint8_t) ((1<<5) | (1<<7));     // input(=0) or output(=1)
+  sfr_PORTC.CR1.byte = (uint8_t) ((1<<5) | (1<<7));     // input: 0=float, 1=pull-up; output: 0=open-drain, 1=push-pull
+  sfr_PORTC.CR2.byte = (uint8_t) ((1<<5) | (1<<7));     // input: 0=no exint, 1=exint; output: 0=2MHz slope, 1=10MHz slope
+
+  // init 1ms interrupt
+  TIM4_init();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // main loop
+  while(1) {
+
+    // print line every 100ms
+    if (g_millis >= nextPrint) {
+      nextPrint += 100;
+
+      // toggle pin 13 / LED
+      sfr_PORTC.ODR.ODR5 ^= 1;
+
+      // format line with test pin high. Fixed-point as integer/fraction for sprintf() w/o float support
+      TEST = 1;
+      #if USE_PRINTF
+        sprintf(line, "t=%lu v=%ld h=0x%08lX T=%d.%02d drop=%u\n", g_millis, value, (uint32_t) value,
+          temp_q8 >> 8, (int) ((((uint16_t) temp_q8 & 0xFF) * 100) >> 8), UART2_get_dropped());
+      #else
+        fmt_init(&line);
+        fmt_str(&line, "t=");
+        fmt_u32(&line, g_millis, 0);
+        fmt_str(&line, " v=");
+        fmt_i32(&line, value, 0);
+        fmt_str(&line, " h=0x");
+        fmt_hex32(&line, (uint32_t) value);
+        fmt_str(&line, " T=");
+        fmt_fix(&line, temp_q8, 8, 2);
+        fmt_str(&line, " drop=");
+        fmt_u16(&line, UART2_get_dropped(), 0);
+        fmt_char(&line, '\n');
+      #endif
+      TEST = 0;
+
+      // write line to Tx FIFO w/o blocking
+      #if USE_PRINTF
+        UART2_write_span((uint8_t) strlen(line), (uint8_t*) line);
+      #else
+        fmt_send(&line);
+      #endif
+
+      // change values
+      value += 1001;
+      temp_q8 += 3;
+
+    } // 100ms loop
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
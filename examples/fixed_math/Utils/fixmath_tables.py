@@ -0,0 +1,338 @@
+#!/usr/bin/env python3
+"""
+generate tables of ../fixmath.c and check accuracy on the host
+
+Writes the interpolation tables for sin, atan, log2 and exp2 to a C header
+(default ../fixmath_tables.h). With option -c the integer algorithms of
+fixmath.c are evaluated bit-exact in Python and compared with the float
+results of the math module:
+
+  - sin/cos, Q15:    all 65536 angles
+  - atan2, angle:    all angles of a circle with radius 30000, plus random vectors
+  - isqrt:           all powers of 2 +/-1 and random 32-bit values
+  - sqrt, Q16:       error relative to result (absolute for results < 1.0)
+  - log2, Q16:       all powers of 2 +/-1 and random values
+  - exp2, Q16:       -17..15 in steps of 1/256, error relative to result (absolute for results < 1.0)
+  - mul_q15:         random factors and corner cases
+
+The model must be kept in sync with fixmath.c. Exit code is 1 if an error
+exceeds its limit.
+
+usage:
+  python3 fixmath_tables.py [-o ../fixmath_tables.h]
+  python3 fixmath_tables.py -c [-n 100000]
+"""
+
+import sys
+import os
+import math
+import random
+import argparse
+
+
+# segments of tables: (name, segments, function(x in [0,1]) -> value, comment)
+TABLES = [
+  ('Sin',  64, lambda x: round(math.sin(x * math.pi / 2) * 32768),                  'sin(i/64 * 90deg), Q15'),
+  ('Atan', 32, lambda x: round(math.atan(x) / (2 * math.pi) * 65536),              'atan(i/32), angle (65536 = 360deg)'),
+  ('Log2', 64, lambda x: round(math.log2(1 + x) * 32768),                          'log2(1 + i/64), Q15'),
+  ('Exp2', 64, lambda x: round(2 ** x * 16384),                                    '2^(i/64), Q14'),
+]
+
+# max. allowed errors [LSB] (relative errors in units of 2^-16)
+LIMITS = {'sin': 3, 'atan2': 2, 'isqrt': 0, 'sqrt': 2, 'log2': 4, 'exp2': 4, 'mul_q15': 0}
+
+HEADER = '''/**
+  \\file fixmath_tables.h
+
+  \\brief tables for fixed-point math functions
+
+  interpolation tables of fixmath.c with SEGMENTS+1 entries.
+  Generated by Utils/fixmath_tables.py, do not edit!
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _FIXMATH_TABLES_H_
+#define _FIXMATH_TABLES_H_
+
+#include <stdint.h>
+
+%s
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _FIXMATH_TABLES_H_
+'''
+
+
+def make_tables():
+  """
+  calculate all tables. Return dict name -> list of values
+  """
+  tables = {}
+  for name, segments, func, comment in TABLES:
+    tables[name] = [func(i / segments) for i in range(segments + 1)]
+  return tables
+
+
+def write_header(filename, tables):
+  """
+  write tables as const arrays to C header
+  """
+  body = ''
+  for name, segments, func, comment in TABLES:
+    values = tables[name]
+    body += '/// %s\n' % comment
+    body += '#define FIX_%s_SEGMENTS  %d\n' % (name.upper(), segments)
+    body += 'static const uint16_t  m_fix%s[FIX_%s_SEGMENTS+1] = {\n' % (name, name.upper())
+    for i in range(0, len(values), 8):
+      body += '  ' + ', '.join('%5d' % v for v in values[i:i+8]) + (',' if i + 8 < len(values) else '') + '\n'
+    body += '};\n\n'
+  with open(filename, 'w') as f:
+    f.write(HEADER % body)
+
+
+##########
+# integer model of fixmath.c
+##########
+
+def s32(x):
+  """
+  wrap to int32
+  """
+  x &= 0xFFFFFFFF
+  return x - (1 << 32) if x & 0x80000000 else x
+
+
+def interpolate(table, idx, frac):
+  y0 = table[idx]
+  if frac == 0:
+    return y0 << 16
+  return (y0 << 16) + (table[idx + 1] - y0) * frac
+
+
+def mul_q15(a, b):
+  p = (0x4000 + a * b) >> 15
+  return min(p, 32767)
+
+
+def isqrt(x):
+  res, bit = 0, 0x40000000
+  while bit > x:
+    bit >>= 2
+  while bit:
+    if x >= res + bit:
+      x -= res + bit
+      res = (res >> 1) + bit
+    else:
+      res >>= 1
+    bit >>= 2
+  return res
+
+
+def sqrt_q16(x):
+  if x <= 0:
+    return 0
+  k = 0
+  while k < 8 and not (x & 0xC0000000):
+    x <<= 2
+    k += 1
+  return isqrt(x) << (8 - k)
+
+
+def sin_q15(t, angle):
+  x = angle & 0x3FFF
+  if angle & 0x4000:
+    x = 0x4000 - x
+  y = min((interpolate(t['Sin'], x >> 8, (x << 8) & 0xFFFF) + 0x8000) >> 16, 32767)
+  return -y if angle & 0x8000 else y
+
+
+def div_q15(n, d):
+  if n >= d:
+    return 32768
+  q = 0
+  for i in range(15):
+    n <<= 1
+    q <<= 1
+    if n >= d:
+      n -= d
+      q |= 1
+  if (n << 1) >= d:
+    q += 1
+  return q
+
+
+def atan2_angle(t, y, x):
+  ax, ay = abs(x), abs(y)
+  if ax == 0 and ay == 0:
+    return 0
+  if ay <= ax:
+    r = div_q15(ay, ax)
+    a = (interpolate(t['Atan'], r >> 10, (r << 6) & 0xFFFF) + 0x8000) >> 16
+  else:
+    r = div_q15(ax, ay)
+    a = 0x4000 - ((interpolate(t['Atan'], r >> 10, (r << 6) & 0xFFFF) + 0x8000) >> 16)
+  if x < 0:
+    a = (0x8000 - a) & 0xFFFF
+  if y < 0:
+    a = (-a) & 0xFFFF
+  return a
+
+
+def log2_q16(t, x):
+  if x <= 0:
+    return -(1 << 31)
+  m, e = x, 15
+  while not (m & 0xFF000000):
+    m = (m << 8) & 0xFFFFFFFF
+    e -= 8
+  while not (m & 0x80000000):
+    m = (m << 1) & 0xFFFFFFFF
+    e -= 1
+  y = interpolate(t['Log2'], (m >> 25) & 0x3F, (m >> 9) & 0xFFFF)
+  return s32((e << 16) + ((y + 0x4000) >> 15))
+
+
+def exp2_q16(t, x):
+  n, f = x >> 16, x & 0xFFFF
+  if n >= 15:
+    return 0x7FFFFFFF
+  if n < -17:
+    return 0
+  m = interpolate(t['Exp2'], f >> 10, (f << 6) & 0xFFFF)
+  s = n - 14
+  if s >= 0:
+    return s32(m << s)
+  s = -s
+  return (m + (1 << (s - 1))) >> s
+
+
+##########
+# accuracy checks
+##########
+
+def check(tables, num):
+  """
+  compare integer model with float. Return list of (name, max. error, worst argument)
+  """
+  rnd = random.Random(1)
+  res = []
+
+  # sin/cos: error [LSB Q15]
+  err, arg = 0, 0
+  for a in range(65536):
+    ref = min(round(math.sin(a * 2 * math.pi / 65536) * 32768), 32767)
+    e = abs(sin_q15(tables, a) - ref)
+    if e > err:
+      err, arg = e, a
+  res.append(('sin', err, arg))
+
+  # atan2: error [LSB angle], wrap around
+  err, arg = 0, 0
+  vectors = [(round(30000 * math.sin(a * 2 * math.pi / 65536)), round(30000 * math.cos(a * 2 * math.pi / 65536))) for a in range(0, 65536, 4)]
+  vectors += [(rnd.randint(-32768, 32767), rnd.randint(-32768, 32767)) for i in range(num)]
+  vectors += [(-32768, -32768), (-32768, 32767), (32767, -32768), (1, -32768), (-1, -32768), (0, -1), (-1, 0)]
+  for y, x in vectors:
+    if x == 0 and y == 0:
+      continue
+    ref = math.atan2(y, x) / (2 * math.pi) * 65536
+    e = abs((atan2_angle(tables, y, x) - ref + 32768) % 65536 - 32768)
+    if round(e, 6) > err:
+      err, arg = round(e, 6), (y, x)
+  res.append(('atan2', err, arg))
+
+  # isqrt: exact floor
+  err, arg = 0, 0
+  values = [v for k in range(32) for v in ((1 << k) - 1, 1 << k, (1 << k) + 1)] + [0xFFFFFFFF]
+  values += [rnd.randint(0, 0xFFFFFFFF) for i in range(num)]
+  for v in values:
+    v &= 0xFFFFFFFF
+    e = abs(isqrt(v) - math.isqrt(v))
+    if e > err:
+      err, arg = e, v
+  res.append(('isqrt', err, arg))
+
+  # sqrt Q16: error relative to result [2^-16], results < 1.0 absolute [LSB]
+  err, arg = 0, 0
+  values = [v for k in range(31) for v in ((1 << k) - 1, 1 << k, (1 << k) + 1)] + [0x7FFFFFFF]
+  values += [rnd.randint(1, 0x7FFFFFFF) for i in range(num)]
+  for v in values:
+    if v <= 0 or v > 0x7FFFFFFF:
+      continue
+    ref = math.sqrt(v / 65536) * 65536
+    e = abs(sqrt_q16(v) - ref) / ref * 65536 if ref >= 65536 else abs(sqrt_q16(v) - ref)
+    if round(e, 3) > err:
+      err, arg = round(e, 3), v
+  res.append(('sqrt', err, arg))
+
+  # log2 Q16: error [LSB Q16]
+  err, arg = 0, 0
+  values = [v for k in range(31) for v in ((1 << k) - 1, 1 << k, (1 << k) + 1)] + [0x7FFFFFFF]
+  values += [rnd.randint(1, 0x7FFFFFFF) for i in range(num)]
+  for v in values:
+    if v <= 0 or v > 0x7FFFFFFF:
+      continue
+    ref = math.log2(v / 65536) * 65536
+    e = abs(log2_q16(tables, v) - ref)
+    if round(e, 3) > err:
+      err, arg = round(e, 3), v
+  res.append(('log2', err, arg))
+
+  # exp2 Q16: error relative to result [2^-16], results >= 1.0 (smaller results have absolute error <= 1 LSB)
+  err, arg = 0, 0
+  for v in range(-17 << 16, 15 << 16, 256):
+    ref = 2 ** (v / 65536) * 65536
+    got = exp2_q16(tables, v)
+    e = abs(got - ref) / ref * 65536 if ref >= 65536 else abs(got - ref)
+    if round(e, 3) > err:
+      err, arg = round(e, 3), v
+  res.append(('exp2', err, arg))
+
+  # mul_q15: error [LSB Q15] vs. rounded product
+  err, arg = 0, 0
+  pairs = [(-32768, -32768), (-32768, 32767), (32767, 32767), (-1, 1), (-1, -1), (16384, -16384)]
+  pairs += [(rnd.randint(-32768, 32767), rnd.randint(-32768, 32767)) for i in range(num)]
+  for a, b in pairs:
+    ref = min(math.floor(a * b / 32768 + 0.5), 32767)
+    e = abs(mul_q15(a, b) - ref)
+    if e > err:
+      err, arg = e, (a, b)
+  res.append(('mul_q15', err, arg))
+
+  return res
+
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  parser = argparse.ArgumentParser(description='generate tables of fixmath.c and check accuracy on the host')
+  parser.add_argument('-o', '--output', default=os.path.join(here, '..', 'fixmath_tables.h'), help='output header (default ../fixmath_tables.h)')
+  parser.add_argument('-c', '--check', action='store_true', help='check accuracy of integer model instead of writing header')
+  parser.add_argument('-n', '--num', type=int, default=100000, help='number of random arguments per function (default 100000)')
+  args = parser.parse_args()
+
+  tables = make_tables()
+
+  # write header
+  if not args.check:
+    try:
+      write_header(args.output, tables)
+    except IOError as e:
+      sys.stderr.write('error: %s\n' % e)
+      sys.exit(1)
+    print('wrote %s' % args.output)
+    return
+
+  # check accuracy
+  failed = False
+  print('%-8s %10s %6s  %s' % ('function', 'max error', 'limit', 'worst argument'))
+  for name, err, arg in check(tables, args.num):
+    ok = err <= LIMITS[name]
+    failed |= not ok
+    print('%-8s %10s %6s  %s%s' % (name, err, LIMITS[name], arg, '' if ok else '  FAILED'))
+  sys.exit(1 if failed else 0)
+
+
+if __name__ == '__main__':
+  main()
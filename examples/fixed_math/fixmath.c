@@ -0,0 +1,550 @@
+/**
+  \file fixmath.c
+
+  \author G. Icking-Konert
+  \date 2021-10-13
+  \version 0.1
+
+  \brief implementation of fixed-point math functions
+
+  implementation of Q15/Q16 fixed-point functions. For details see fixmath.h.
+  The integer model in Utils/fixmath_tables.py must be kept in sync.
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "fixmath.h"
+#include "fixmath_tables.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// stack offset of parameters in assembler helpers (return address)
+#ifdef __SDCC_MODEL_LARGE
+  #define ASM_ARGS_SP_OFFSET 4
+  #define ASM_RETURN retf
+#else
+  #define ASM_ARGS_SP_OFFSET 3
+  #define ASM_RETURN ret
+#endif
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+#if (FIX_ASM)
+
+/**
+  \fn uint32_t fix_umul(uint16_t a, uint16_t b)
+
+  \brief unsigned 16x16->32 multiplication
+
+  \param[in]  a   factor 1
+  \param[in]  b   factor 2
+
+  \return a*b
+
+  sum of 4 partial products via 8x8 MUL. Result in Y (MSW) and X (LSW)
+*/
+uint32_t fix_umul(uint16_t a, uint16_t b) FIX_STACK_CALL __naked {
+
+  // avoid compiler warnings for unreferenced args
+  (void) a;
+  (void) b;
+
+  // a=ah:al at (OFS+4/5,sp), b=bh:bl at (OFS+6/7,sp) after 'sub sp, #4'. Result r3..r0 at (1..4,sp)
+  __asm
+    sub   sp, #4
+
+    ; r1:r0 = al*bl
+    ld    a, (ASM_ARGS_SP_OFFSET+5, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+7, sp)
+    mul   x, a
+    ldw   (3, sp), x
+
+    ; r3:r2 = ah*bh
+    ld    a, (ASM_ARGS_SP_OFFSET+4, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+6, sp)
+    mul   x, a
+    ldw   (1, sp), x
+
+    ; r3:r2:r1 += ah*bl
+    ld    a, (ASM_ARGS_SP_OFFSET+4, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+7, sp)
+    mul   x, a
+    addw  x, (2, sp)
+    jrnc  00001$
+    inc   (1, sp)
+  00001$:
+    ldw   (2, sp), x
+
+    ; r3:r2:r1 += al*bh
+    ld    a, (ASM_ARGS_SP_OFFSET+5, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+6, sp)
+    mul   x, a
+    addw  x, (2, sp)
+    jrnc  00002$
+    inc   (1, sp)
+  00002$:
+    ldw   (2, sp), x
+
+    ; return Y:X = r3r2:r1r0
+    ldw   x, (3, sp)
+    ldw   y, (1, sp)
+    addw  sp, #4
+    ASM_RETURN
+  __endasm;
+
+} // fix_umul
+
+
+
+/**
+  \fn int32_t fix_mac(int32_t acc, int16_t a, int16_t b)
+
+  \brief signed 16x16->32 multiply-accumulate
+
+  \param[in]  acc   accumulator
+  \param[in]  a     factor 1
+  \param[in]  b     factor 2
+
+  \return acc + a*b (modulo 2^32)
+
+  unsigned product of 4 partial products via 8x8 MUL, corrected for
+  negative factors by subtracting the other factor from the MSW
+*/
+int32_t fix_mac(int32_t acc, int16_t a, int16_t b) FIX_STACK_CALL __naked {
+
+  // avoid compiler warnings for unreferenced args
+  (void) acc;
+  (void) a;
+  (void) b;
+
+  // acc at (OFS+4..7,sp), a=ah:al at (OFS+8/9,sp), b=bh:bl at (OFS+10/11,sp) after 'sub sp, #4'. Product r3..r0 at (1..4,sp)
+  __asm
+    sub   sp, #4
+
+    ; r1:r0 = al*bl
+    ld    a, (ASM_ARGS_SP_OFFSET+9, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+11, sp)
+    mul   x, a
+    ldw   (3, sp), x
+
+    ; r3:r2 = ah*bh
+    ld    a, (ASM_ARGS_SP_OFFSET+8, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+10, sp)
+    mul   x, a
+    ldw   (1, sp), x
+
+    ; r3:r2:r1 += ah*bl
+    ld    a, (ASM_ARGS_SP_OFFSET+8, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+11, sp)
+    mul   x, a
+    addw  x, (2, sp)
+    jrnc  00001$
+    inc   (1, sp)
+  00001$:
+    ldw   (2, sp), x
+
+    ; r3:r2:r1 += al*bh
+    ld    a, (ASM_ARGS_SP_OFFSET+9, sp)
+    ld    xl, a
+    ld    a, (ASM_ARGS_SP_OFFSET+10, sp)
+    mul   x, a
+    addw  x, (2, sp)
+    jrnc  00002$
+    inc   (1, sp)
+  00002$:
+    ldw   (2, sp), x
+
+    ; signed correction of MSW: a<0 -> -b, b<0 -> -a
+    ldw   y, (1, sp)
+    tnz   (ASM_ARGS_SP_OFFSET+8, sp)
+    jrpl  00003$
+    subw  y, (ASM_ARGS_SP_OFFSET+10, sp)
+  00003$:
+    tnz   (ASM_ARGS_SP_OFFSET+10, sp)
+    jrpl  00004$
+    subw  y, (ASM_ARGS_SP_OFFSET+8, sp)
+  00004$:
+
+    ; return Y:X = product + acc
+    ldw   x, (3, sp)
+    addw  x, (ASM_ARGS_SP_OFFSET+6, sp)
+    jrnc  00005$
+    incw  y
+  00005$:
+    addw  y, (ASM_ARGS_SP_OFFSET+4, sp)
+    addw  sp, #4
+    ASM_RETURN
+  __endasm;
+
+} // fix_mac
+
+#else // FIX_ASM
+
+/**
+  \fn uint32_t fix_umul(uint16_t a, uint16_t b)
+
+  \brief unsigned 16x16->32 multiplication
+
+  \param[in]  a   factor 1
+  \param[in]  b   factor 2
+
+  \return a*b
+*/
+uint32_t fix_umul(uint16_t a, uint16_t b) {
+
+  return((uint32_t) a * b);
+
+} // fix_umul
+
+
+
+/**
+  \fn int32_t fix_mac(int32_t acc, int16_t a, int16_t b)
+
+  \brief signed 16x16->32 multiply-accumulate
+
+  \param[in]  acc   accumulator
+  \param[in]  a     factor 1
+  \param[in]  b     factor 2
+
+  \return acc + a*b (modulo 2^32)
+
+  sum in unsigned, i.e. wraps around like the assembler version. a*b fits into int32_t
+*/
+int32_t fix_mac(int32_t acc, int16_t a, int16_t b) {
+
+  return((int32_t) ((uint32_t) acc + (uint32_t) ((int32_t) a * b)));
+
+} // fix_mac
+
+#endif // FIX_ASM
+
+
+
+/**
+  \fn uint32_t interpolate(const uint16_t *table, uint8_t idx, uint16_t frac)
+
+  \brief linear interpolation in ascending table
+
+  \param[in]  table   ascending table
+  \param[in]  idx     index of segment
+  \param[in]  frac    position in segment [1/65536]
+
+  \return interpolated value with 16 additional fractional bits
+*/
+static uint32_t interpolate(const uint16_t *table, uint8_t idx, uint16_t frac) {
+
+  uint16_t  y0 = table[idx];
+
+  // exactly on table entry (incl. last entry)
+  if (frac == 0)
+    return((uint32_t) y0 << 16);
+
+  return(((uint32_t) y0 << 16) + fix_umul(table[idx+1] - y0, frac));
+
+} // interpolate
+
+
+
+/**
+  \fn q15_t fix_mul_q15(q15_t a, q15_t b)
+
+  \brief Q15 multiplication
+
+  \param[in]  a   factor 1
+  \param[in]  b   factor 2
+
+  \return a*b, rounded. -1*-1 saturates to 32767
+*/
+q15_t fix_mul_q15(q15_t a, q15_t b) {
+
+  int32_t   p = fix_mac(0x4000, a, b) >> 15;
+
+  if (p > 32767)
+    return(32767);
+  return((q15_t) p);
+
+} // fix_mul_q15
+
+
+
+/**
+  \fn uint16_t fix_isqrt(uint32_t x)
+
+  \brief integer square root
+
+  \param[in]  x   radicand
+
+  \return floor(sqrt(x))
+
+  bitwise method, 1 result bit per step
+*/
+uint16_t fix_isqrt(uint32_t x) {
+
+  uint32_t  res = 0;
+  uint32_t  bit = 0x40000000;
+
+  // highest power of 4 <= x
+  while (bit > x)
+    bit >>= 2;
+
+  // 1 result bit per step
+  while (bit != 0) {
+    if (x >= res + bit) {
+      x  -= res + bit;
+      res = (res >> 1) + bit;
+    }
+    else
+      res >>= 1;
+    bit >>= 2;
+  }
+
+  return((uint16_t) res);
+
+} // fix_isqrt
+
+
+
+/**
+  \fn q16_t fix_sqrt(q16_t x)
+
+  \brief Q16 square root
+
+  \param[in]  x   radicand (Q16)
+
+  \return sqrt(x) (Q16), 0 for x<=0
+
+  sqrt(x/2^16)*2^16 = isqrt(x*2^16). x is shifted left by 2k<=16 bits
+  w/o overflow, i.e. isqrt() returns sqrt(x)*2^k, which is shifted left
+  by the remaining 8-k bits
+*/
+q16_t fix_sqrt(q16_t x) {
+
+  uint32_t  u = (uint32_t) x;
+  uint8_t   k = 0;
+
+  if (x <= 0)
+    return(0);
+
+  // normalize
+  while ((k < 8) && !(u & 0xC0000000)) {
+    u <<= 2;
+    k++;
+  }
+
+  return((q16_t) fix_isqrt(u) << (8 - k));
+
+} // fix_sqrt
+
+
+
+/**
+  \fn q15_t fix_sin(uint16_t angle)
+
+  \brief Q15 sine
+
+  \param[in]  angle   angle (65536 = 360deg)
+
+  \return sin(angle) (Q15)
+
+  quarter-wave table with FIX_SIN_SEGMENTS segments, mirrored for quadrants 1..3
+*/
+q15_t fix_sin(uint16_t angle) {
+
+  uint16_t  x = angle & 0x3FFF;
+  uint16_t  y;
+
+  // quadrants 1 and 3: sin(90deg + x) = sin(90deg - x)
+  if (angle & 0x4000)
+    x = 0x4000 - x;
+
+  // interpolate in quarter wave (0..0x4000 -> segment 0..64, 8b fraction)
+  y = (uint16_t) ((interpolate(m_fixSin, (uint8_t) (x >> 8), x << 8) + 0x8000) >> 16);
+  if (y > 32767)
+    y = 32767;
+
+  // quadrants 2 and 3: negative
+  if (angle & 0x8000)
+    return(-(q15_t) y);
+  return((q15_t) y);
+
+} // fix_sin
+
+
+
+/**
+  \fn uint16_t div_q15(uint16_t n, uint16_t d)
+
+  \brief unsigned Q15 division n/d for n<=d
+
+  \param[in]  n   numerator
+  \param[in]  d   denominator (<=32768)
+
+  \return n/d (Q15, rounded), 0..32768
+
+  restoring division with 16-bit operations. Remainder < d <= 32768, i.e. no overflow
+*/
+static uint16_t div_q15(uint16_t n, uint16_t d) {
+
+  uint16_t  q = 0;
+  uint8_t   i;
+
+  if (n >= d)
+    return(32768);
+
+  for (i=0; i<15; i++) {
+    n <<= 1;
+    q <<= 1;
+    if (n >= d) {
+      n -= d;
+      q |= 1;
+    }
+  }
+
+  // round
+  if ((n << 1) >= d)
+    q++;
+
+  return(q);
+
+} // div_q15
+
+
+
+/**
+  \fn uint16_t fix_atan2(int16_t y, int16_t x)
+
+  \brief angle of vector
+
+  \param[in]  y   y-coordinate
+  \param[in]  x   x-coordinate
+
+  \return angle of (x,y) (65536 = 360deg), 0 for (0,0)
+
+  atan(min/max) from table in first octant, then mapped to the octant of (x,y)
+*/
+uint16_t fix_atan2(int16_t y, int16_t x) {
+
+  uint16_t  ax, ay, r, a;
+
+  // absolute values (-32768 -> 32768)
+  ax = (x < 0) ? (uint16_t) (-(int32_t) x) : (uint16_t) x;
+  ay = (y < 0) ? (uint16_t) (-(int32_t) y) : (uint16_t) y;
+  if ((ax == 0) && (ay == 0))
+    return(0);
+
+  // first octant: atan(r) with r<=1 (0..32768 -> segment 0..32, 10b fraction)
+  if (ay <= ax) {
+    r = div_q15(ay, ax);
+    a = (uint16_t) ((interpolate(m_fixAtan, (uint8_t) (r >> 10), r << 6) + 0x8000) >> 16);
+  }
+  else {
+    r = div_q15(ax, ay);
+    a = 0x4000 - (uint16_t) ((interpolate(m_fixAtan, (uint8_t) (r >> 10), r << 6) + 0x8000) >> 16);
+  }
+
+  // quadrant
+  if (x < 0)
+    a = 0x8000 - a;
+  if (y < 0)
+    a = -a;
+
+  return(a);
+
+} // fix_atan2
+
+
+
+/**
+  \fn q16_t fix_log2(q16_t x)
+
+  \brief Q16 logarithm to base 2
+
+  \param[in]  x   argument (Q16)
+
+  \return log2(x) (Q16), INT32_MIN for x<=0
+
+  normalize x to 2^e * (1+f), then log2(x) = e + log2(1+f) from table
+*/
+q16_t fix_log2(q16_t x) {
+
+  uint32_t  m = (uint32_t) x;
+  int8_t    e = 15;
+  uint32_t  y;
+
+  if (x <= 0)
+    return(INT32_MIN);
+
+  // normalize to bit 31 set, first bytewise. Q16 -> exponent = msb - 16
+  while (!(m & 0xFF000000)) {
+    m <<= 8;
+    e -= 8;
+  }
+  while (!(m & 0x80000000)) {
+    m <<= 1;
+    e--;
+  }
+
+  // log2(1+f) with f=bits 30..0 (segment 0..63, 16b fraction). Q15+16 -> Q16
+  y = interpolate(m_fixLog2, (uint8_t) ((m >> 25) & 0x3F), (uint16_t) (m >> 9));
+
+  // sum in unsigned, as shift of negative exponent is undefined in C
+  return((q16_t) (((uint32_t) (int32_t) e << 16) + ((y + 0x4000) >> 15)));
+
+} // fix_log2
+
+
+
+/**
+  \fn q16_t fix_exp2(q16_t x)
+
+  \brief Q16 power of 2
+
+  \param[in]  x   exponent (Q16)
+
+  \return 2^x (Q16), INT32_MAX for x>=15, 0 for x<-17
+
+  split x = n + f, then 2^x = 2^n * 2^f with 2^f from table
+*/
+q16_t fix_exp2(q16_t x) {
+
+  int16_t   n = (int16_t) (x >> 16);
+  uint16_t  f = (uint16_t) x;
+  uint32_t  m;
+  int8_t    s;
+
+  // range check
+  if (n >= 15)
+    return(INT32_MAX);
+  if (n < -17)
+    return(0);
+
+  // 2^f in [1,2) (segment 0..63, 10b fraction). Q14+16
+  m = interpolate(m_fixExp2, (uint8_t) (f >> 10), f << 6);
+
+  // Q30 * 2^n -> Q16
+  s = (int8_t) n - 14;
+  if (s >= 0)
+    return((q16_t) (m << s));
+  s = -s;
+  return((q16_t) ((m + ((uint32_t) 1 << (s - 1))) >> s));
+
+} // fix_exp2
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
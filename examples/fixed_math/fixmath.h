@@ -0,0 +1,116 @@
+/**
+  \file fixmath.h
+
+  \author G. Icking-Konert
+  \date 2021-10-13
+  \version 0.1
+
+  \brief declaration of fixed-point math functions
+
+  declaration of Q15/Q16 fixed-point functions as replacement for float:
+
+    - q15_t: signed 1.15 in [-1, 1), e.g. sin/cos, filter coefficients
+    - q16_t: signed 16.16, e.g. sqrt, log2/exp2
+    - angle: uint16_t with 65536 = 360deg, i.e. wraps around like the angle
+
+  sin/cos, atan2 and log2/exp2 use tables (fixmath_tables.h, generated by
+  Utils/fixmath_tables.py) with linear interpolation. Execution time is
+  independent of the argument (except normalization shifts of log2/exp2).
+
+  The 16x16->32 multiply(-accumulate) helpers are STM8 assembler for SDCC
+  (4 MUL instructions), else C.
+  Accuracy is checked on the host with Utils/fixmath_tables.py (option -c).
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _FIXMATH_H_
+#define _FIXMATH_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// multiply helpers in assembler (1=SDCC assembler, 0=C); can be overwritten via compiler option
+#ifndef FIX_ASM
+  #if defined(__SDCC)
+    #define FIX_ASM             1
+  #else
+    #define FIX_ASM             0
+  #endif
+#endif
+
+// assembler helpers expect parameters on stack (SDCC >=4.2 passes them in registers by default)
+#if (FIX_ASM) && (SDCC_VERSION >= 40200)
+  #define FIX_STACK_CALL        __sdcccall(0)
+#else
+  #define FIX_STACK_CALL
+#endif
+
+/// convert constant to Q15 / Q16 (compile time only)
+#define FIX_Q15(x)              ((q15_t) ((x) >= 0.99997 ? 32767 : (x) * 32768.0 + ((x) >= 0 ? 0.5 : -0.5)))
+#define FIX_Q16(x)              ((q16_t) ((x) * 65536.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/// convert angle [deg] to uint16_t (compile time only)
+#define FIX_DEG(x)              ((uint16_t) ((int32_t) ((x) * 65536.0 / 360.0 + 0.5)))
+
+/// signed 16x16->32 multiplication
+#define fix_mul(a, b)           fix_mac(0, (a), (b))
+
+/// cos via sin
+#define fix_cos(angle)          fix_sin((uint16_t) ((angle) + 0x4000))
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+typedef int16_t   q15_t;                        ///< signed 1.15 fixed-point
+typedef int32_t   q16_t;                        ///< signed 16.16 fixed-point
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// unsigned 16x16->32 multiplication
+uint32_t  fix_umul(uint16_t a, uint16_t b) FIX_STACK_CALL;
+
+/// signed 16x16->32 multiply-accumulate: acc + a*b
+int32_t   fix_mac(int32_t acc, int16_t a, int16_t b) FIX_STACK_CALL;
+
+/// Q15 multiplication with rounding and saturation
+q15_t     fix_mul_q15(q15_t a, q15_t b);
+
+/// integer square root floor(sqrt(x))
+uint16_t  fix_isqrt(uint32_t x);
+
+/// Q16 square root. Returns 0 for x<=0
+q16_t     fix_sqrt(q16_t x);
+
+/// Q15 sine of angle (65536 = 360deg)
+q15_t     fix_sin(uint16_t angle);
+
+/// angle of vector (x,y) (65536 = 360deg). Returns 0 for (0,0)
+uint16_t  fix_atan2(int16_t y, int16_t x);
+
+/// Q16 log2 of Q16 x. Returns INT32_MIN for x<=0
+q16_t     fix_log2(q16_t x);
+
+/// Q16 2^x of Q16 x. Saturates to INT32_MAX for x>=15
+q16_t     fix_exp2(q16_t x);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _FIXMATH_H_
@@ -0,0 +1,74 @@
+/**
+  \file fixmath_tables.h
+
+  \brief tables for fixed-point math functions
+
+  interpolation tables of fixmath.c with SEGMENTS+1 entries.
+  Generated by Utils/fixmath_tables.py, do not edit!
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _FIXMATH_TABLES_H_
+#define _FIXMATH_TABLES_H_
+
+#include <stdint.h>
+
+/// sin(i/64 * 90deg), Q15
+#define FIX_SIN_SEGMENTS  64
+static const uint16_t  m_fixSin[FIX_SIN_SEGMENTS+1] = {
+      0,   804,  1608,  2411,  3212,  4011,  4808,  5602,
+   6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+  12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+  18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+  23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+  27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+  30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+  32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+  32768
+};
+
+/// atan(i/32), angle (65536 = 360deg)
+#define FIX_ATAN_SEGMENTS  32
+static const uint16_t  m_fixAtan[FIX_ATAN_SEGMENTS+1] = {
+      0,   326,   651,   975,  1297,  1617,  1933,  2246,
+   2555,  2860,  3159,  3453,  3742,  4025,  4302,  4572,
+   4836,  5094,  5344,  5589,  5826,  6058,  6282,  6500,
+   6712,  6917,  7117,  7310,  7498,  7679,  7856,  8026,
+   8192
+};
+
+/// log2(1 + i/64), Q15
+#define FIX_LOG2_SEGMENTS  64
+static const uint16_t  m_fixLog2[FIX_LOG2_SEGMENTS+1] = {
+      0,   733,  1455,  2166,  2866,  3556,  4236,  4907,
+   5568,  6220,  6863,  7498,  8124,  8742,  9352,  9954,
+  10549, 11136, 11716, 12289, 12855, 13415, 13968, 14514,
+  15055, 15589, 16117, 16639, 17156, 17667, 18173, 18673,
+  19168, 19658, 20143, 20623, 21098, 21568, 22034, 22495,
+  22952, 23404, 23852, 24296, 24736, 25172, 25604, 26031,
+  26455, 26876, 27292, 27705, 28114, 28520, 28922, 29321,
+  29717, 30109, 30498, 30884, 31267, 31647, 32024, 32397,
+  32768
+};
+
+/// 2^(i/64), Q14
+#define FIX_EXP2_SEGMENTS  64
+static const uint16_t  m_fixExp2[FIX_EXP2_SEGMENTS+1] = {
+  16384, 16562, 16743, 16925, 17109, 17296, 17484, 17674,
+  17867, 18061, 18258, 18457, 18658, 18861, 19066, 19274,
+  19484, 19696, 19911, 20127, 20347, 20568, 20792, 21019,
+  21247, 21479, 21713, 21949, 22188, 22430, 22674, 22921,
+  23170, 23423, 23678, 23936, 24196, 24460, 24726, 24995,
+  25268, 25543, 25821, 26102, 26386, 26674, 26964, 27258,
+  27554, 27855, 28158, 28464, 28774, 29088, 29405, 29725,
+  30048, 30376, 30706, 31041, 31379, 31720, 32066, 32415,
+  32768
+};
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _FIXMATH_TABLES_H_
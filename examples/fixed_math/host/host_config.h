@@ -0,0 +1,28 @@
+/**
+  \file host_config.h
+
+  \brief configuration stub for host test of fixmath.c
+
+  replaces config.h of the target, i.e. no device header is included.
+  fixmath.c is compiled with the C multiplication (FIX_ASM=0).
+  Included via compiler option '-include host_config.h', see Makefile.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _HOST_CONFIG_H_
+#define _HOST_CONFIG_H_
+
+// skip target headers
+#define _CONFIG_H_
+
+#include <stdint.h>
+
+// C multiplication, the assembler version is emulated by the test
+#define FIX_ASM               0
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _HOST_CONFIG_H_
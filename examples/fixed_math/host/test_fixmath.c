@@ -0,0 +1,630 @@
+/**********************
+  Host test of fixmath.c: accuracy vs. float and assembler vs. C multiplication
+
+  Functionality:
+    - fixmath.c with C multiplication (FIX_ASM=0) vs. float results of the C library. Arguments
+      and error limits as Utils/fixmath_tables.py -c:
+        - sin/cos, Q15:    all 65536 angles
+        - atan2, angle:    all angles of a circle with radius 30000, random vectors and corner cases
+        - isqrt:           all powers of 2 +/-1 and random values, exact
+        - sqrt, Q16:       error relative to result (absolute for results < 1.0)
+        - log2, Q16:       all powers of 2 +/-1 and random values
+        - exp2, Q16:       -17..15 in steps of 1/256, error relative to result (absolute for results < 1.0)
+        - mul_q15:         random factors and corner cases, exact
+    - assembler of fix_umul() and fix_mac() is read from fixmath.c and executed by an emulator
+      of the used STM8 instructions, for the medium and large memory model. Result must be
+      identical to the C version for corner cases and random arguments, stack must be balanced
+    - print max. errors and number of mismatches. Exit code 1 on error
+
+  build & run: make
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "fixmath.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define NUM_RANDOM      100000        // number of random arguments per function
+#define NUM_ASM         1000000       // number of random arguments for assembler
+#define ASM_MAX_INSTR   100           // max. number of instructions per function
+#define PI              3.14159265358979323846
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// decoded STM8 instructions used by the assembler helpers
+typedef enum { I_LABEL, I_SUB_SP, I_ADDW_SP, I_LD_A, I_LD_XL_A, I_MUL, I_LDW_TO_SP, I_LDW_X, I_LDW_Y,
+               I_ADDW_X, I_ADDW_Y, I_SUBW_Y, I_INC, I_TNZ, I_INCW_Y, I_JRNC, I_JRPL, I_RET } opcode_t;
+
+/// instruction with stack offset or immediate, resp. label number
+typedef struct {
+  opcode_t  op;
+  int       arg;
+} instr_t;
+
+/// assembler function
+typedef struct {
+  instr_t   code[ASM_MAX_INSTR];
+  int       num;
+} asm_t;
+
+/// state of pseudo-random generator
+uint32_t        m_random = 0x12345678;
+
+/// number of errors
+unsigned long   m_errors;
+
+/// source of fixmath.c
+char            *m_source;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/// 32-bit xorshift pseudo-random generator
+static uint32_t random32(void) {
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return(m_random);
+}
+
+
+/// print result of accuracy check and count errors. Argument of atan2 and mul_q15 is (y<<16)|x, resp. (a<<16)|b
+static void report(const char *name, double err, double limit, long arg) {
+
+  int fail = (err > limit);
+
+  printf("  %-8s %10.3f %6.0f  0x%08lX%s\n", name, err, limit, (unsigned long) arg & 0xFFFFFFFF, fail ? "  FAILED" : "");
+  if (fail)
+    m_errors++;
+
+} // report
+
+
+
+/////////////////
+//    accuracy of fixmath.c vs. float
+/////////////////
+
+/// sin: all angles [LSB Q15]
+static void check_sin(void) {
+
+  double    err = 0, e, ref;
+  long      arg = 0, a;
+
+  for (a=0; a<65536; a++) {
+    ref = nearbyint(sin(a * 2 * PI / 65536) * 32768);
+    if (ref > 32767)
+      ref = 32767;
+    e = fabs(fix_sin((uint16_t) a) - ref);
+    if (e > err) { err = e; arg = a; }
+    e = fabs(fix_cos((uint16_t) a) - fmin(nearbyint(cos(a * 2 * PI / 65536) * 32768), 32767));
+    if (e > err) { err = e; arg = a; }
+  }
+  report("sin/cos", err, 3, arg);
+
+} // check_sin
+
+
+/// atan2 of one vector: error [LSB angle] with wrap-around
+static void atan2_error(int16_t y, int16_t x, double *err, long *arg) {
+
+  double    ref, e;
+
+  if ((x == 0) && (y == 0))
+    return;
+  ref = atan2(y, x) / (2 * PI) * 65536;
+  e = fmod(fix_atan2(y, x) - ref + 32768 + 65536, 65536) - 32768;
+  e = fabs(e);
+  if (e > *err) { *err = e; *arg = (long) (((uint32_t) (uint16_t) y << 16) | (uint16_t) x); }
+
+} // atan2_error
+
+
+/// atan2: circle, random vectors and corner cases [LSB angle]
+static void check_atan2(void) {
+
+  static const int16_t  corner[][2] = { {-32768,-32768}, {-32768,32767}, {32767,-32768}, {1,-32768}, {-1,-32768}, {0,-1}, {-1,0}, {0,1}, {1,0} };
+  double    err = 0;
+  long      arg = 0, a, i;
+
+  for (a=0; a<65536; a+=4)
+    atan2_error((int16_t) lround(30000 * sin(a * 2 * PI / 65536)), (int16_t) lround(30000 * cos(a * 2 * PI / 65536)), &err, &arg);
+  for (i=0; i<NUM_RANDOM; i++)
+    atan2_error((int16_t) random32(), (int16_t) random32(), &err, &arg);
+  for (i=0; i<(long) (sizeof(corner)/sizeof(corner[0])); i++)
+    atan2_error(corner[i][0], corner[i][1], &err, &arg);
+  report("atan2", err, 2, arg);
+
+} // check_atan2
+
+
+/// isqrt: exact floor
+static void check_isqrt(void) {
+
+  double    err = 0;
+  long      arg = 0, i;
+  int       k, d;
+  uint32_t  v;
+  uint64_t  r;
+
+  for (i=-3*32-1; i<NUM_RANDOM; i++) {
+    if (i == -1)
+      v = 0xFFFFFFFF;
+    else if (i < 0) {
+      k = (int) ((-i - 2) / 3);
+      d = (int) ((-i - 2) % 3) - 1;
+      v = (uint32_t) (((uint64_t) 1 << k) + d);
+    }
+    else
+      v = random32();
+    r = fix_isqrt(v);
+    if ((r * r > v) || ((r + 1) * (r + 1) <= v)) {
+      err = 1;
+      arg = (long) v;
+    }
+  }
+  report("isqrt", err, 0, arg);
+
+} // check_isqrt
+
+
+/// argument list for sqrt and log2: powers of 2 +/-1, max and random values in 1..0x7FFFFFFF
+static q16_t positive_arg(long i) {
+
+  int   k, d;
+
+  if (i < 3*31) {
+    k = (int) (i / 3);
+    d = (int) (i % 3) - 1;
+    return((q16_t) (((int64_t) 1 << k) + d));
+  }
+  if (i == 3*31)
+    return(0x7FFFFFFF);
+  return((q16_t) (1 + random32() % 0x7FFFFFFF));
+
+} // positive_arg
+
+
+/// sqrt: error relative to result [2^-16], results < 1.0 absolute [LSB]
+static void check_sqrt(void) {
+
+  double    err = 0, e, ref;
+  long      arg = 0, i;
+  q16_t     v;
+
+  for (i=0; i<3*31+1+NUM_RANDOM; i++) {
+    v = positive_arg(i);
+    if (v <= 0)
+      continue;
+    ref = sqrt(v / 65536.0) * 65536;
+    e = fabs(fix_sqrt(v) - ref);
+    if (ref >= 65536)
+      e = e / ref * 65536;
+    if (e > err) { err = e; arg = v; }
+  }
+  if ((fix_sqrt(0) != 0) || (fix_sqrt(-1) != 0)) {
+    err = 99;
+    arg = 0;
+  }
+  report("sqrt", err, 2, arg);
+
+} // check_sqrt
+
+
+/// log2: error [LSB Q16]
+static void check_log2(void) {
+
+  double    err = 0, e;
+  long      arg = 0, i;
+  q16_t     v;
+
+  for (i=0; i<3*31+1+NUM_RANDOM; i++) {
+    v = positive_arg(i);
+    if (v <= 0)
+      continue;
+    e = fabs(fix_log2(v) - log2(v / 65536.0) * 65536);
+    if (e > err) { err = e; arg = v; }
+  }
+  if ((fix_log2(0) != INT32_MIN) || (fix_log2(-1) != INT32_MIN)) {
+    err = 99;
+    arg = 0;
+  }
+  report("log2", err, 4, arg);
+
+} // check_log2
+
+
+/// exp2: -17..15 in steps of 1/256, error relative to result [2^-16], results < 1.0 absolute [LSB]
+static void check_exp2(void) {
+
+  double    err = 0, e, ref;
+  long      arg = 0;
+  q16_t     v;
+
+  for (v=-17*65536; v<15*65536; v+=256) {
+    ref = exp2(v / 65536.0) * 65536;
+    e = fabs(fix_exp2(v) - ref);
+    if (ref >= 65536)
+      e = e / ref * 65536;
+    if (e > err) { err = e; arg = v; }
+  }
+  if ((fix_exp2(15*65536) != INT32_MAX) || (fix_exp2(-18*65536) != 0)) {
+    err = 99;
+    arg = 0;
+  }
+  report("exp2", err, 4, arg);
+
+} // check_exp2
+
+
+/// mul_q15: exact vs. rounded product, -1*-1 saturated
+static void check_mul_q15(void) {
+
+  static const int16_t  corner[][2] = { {-32768,-32768}, {-32768,32767}, {32767,32767}, {-1,1}, {-1,-1}, {16384,-16384} };
+  double    err = 0, e, ref;
+  long      arg = 0, i;
+  int16_t   a, b;
+
+  for (i=0; i<NUM_RANDOM+(long) (sizeof(corner)/sizeof(corner[0])); i++) {
+    if (i < (long) (sizeof(corner)/sizeof(corner[0]))) {
+      a = corner[i][0];
+      b = corner[i][1];
+    }
+    else {
+      a = (int16_t) random32();
+      b = (int16_t) random32();
+    }
+    ref = fmin(floor(a * (double) b / 32768 + 0.5), 32767);
+    e = fabs(fix_mul_q15(a, b) - ref);
+    if (e > err) { err = e; arg = (long) (((uint32_t) (uint16_t) a << 16) | (uint16_t) b); }
+  }
+  report("mul_q15", err, 0, arg);
+
+} // check_mul_q15
+
+
+
+/////////////////
+//    emulation of assembler helpers
+/////////////////
+
+/// value of operand expression 'ASM_ARGS_SP_OFFSET+5', '#4' or '4' with given offset
+static int asm_value(const char *s, int offset) {
+
+  int   val = 0;
+
+  if (*s == '#')
+    s++;
+  while (*s) {
+    if (strncmp(s, "ASM_ARGS_SP_OFFSET", 18) == 0) {
+      val += offset;
+      s += 18;
+    }
+    else if (isdigit((unsigned char) *s))
+      val += (int) strtol(s, (char**) &s, 0);
+    else
+      return(-1);
+    if (*s == '+')
+      s++;
+  }
+  return(val);
+
+} // asm_value
+
+
+/// stack offset of operand '(EXPR,sp)' with given offset, -1 on error
+static int asm_sp(const char *s, int offset) {
+
+  char  buf[64];
+  int   len = (int) strlen(s);
+
+  if ((len < 6) || (s[0] != '(') || (strcmp(s + len - 4, ",sp)") != 0) || (len - 5 >= (int) sizeof(buf)))
+    return(-1);
+  memcpy(buf, s + 1, len - 5);
+  buf[len - 5] = 0;
+  return(asm_value(buf, offset));
+
+} // asm_sp
+
+
+/// read assembler of function 'name' from fixmath.c and decode it. Return 0 on error
+static int asm_load(asm_t *f, const char *name, int offset) {
+
+  const char  *p, *end, *attr, *line;
+  char        buf[128], mnem[16], ops[112];
+  char        *s, *d;
+  int         len, arg;
+  opcode_t    op;
+
+  // function with __naked attribute, then __asm ... __endasm
+  snprintf(buf, sizeof(buf), "%s(", name);
+  p = m_source;
+  while ((p = strstr(p, buf)) != NULL) {
+    end  = strchr(p, '{');
+    attr = strstr(p, "__naked");
+    if ((end != NULL) && (attr != NULL) && (attr < end))
+      break;
+    p++;
+  }
+  if ((p == NULL) || ((p = strstr(p, "__asm")) == NULL) || ((end = strstr(p, "__endasm")) == NULL))
+    return(0);
+  p = strchr(p, '\n') + 1;
+  while ((end > p) && (end[-1] != '\n'))
+    end--;
+
+  f->num = 0;
+  for (line=p; line<end; line=p) {
+    p = strchr(line, '\n') + 1;
+    len = (int) (p - line);
+    if (len >= (int) sizeof(buf))
+      return(0);
+    memcpy(buf, line, len);
+    buf[len] = 0;
+    if ((s = strchr(buf, ';')) != NULL)
+      *s = 0;
+
+    // mnemonic and operands w/o whitespace
+    mnem[0] = ops[0] = 0;
+    sscanf(buf, " %15s", mnem);
+    if (mnem[0] == 0)
+      continue;
+    s = strstr(buf, mnem) + strlen(mnem);
+    for (d=ops; *s; s++)
+      if (!isspace((unsigned char) *s))
+        *d++ = *s;
+    *d = 0;
+
+    // decode
+    arg = 0;
+    if (mnem[strlen(mnem)-1] == ':') {
+      op = I_LABEL;
+      arg = atoi(mnem);
+    }
+    else if ((strcmp(mnem, "ASM_RETURN") == 0) || (strcmp(mnem, "ret") == 0) || (strcmp(mnem, "retf") == 0))
+      op = I_RET;
+    else if ((strcmp(mnem, "sub") == 0) && (strncmp(ops, "sp,", 3) == 0))
+      op = I_SUB_SP, arg = asm_value(ops + 3, offset);
+    else if ((strcmp(mnem, "addw") == 0) && (strncmp(ops, "sp,", 3) == 0))
+      op = I_ADDW_SP, arg = asm_value(ops + 3, offset);
+    else if ((strcmp(mnem, "ld") == 0) && (strcmp(ops, "xl,a") == 0))
+      op = I_LD_XL_A;
+    else if ((strcmp(mnem, "ld") == 0) && (strncmp(ops, "a,", 2) == 0))
+      op = I_LD_A, arg = asm_sp(ops + 2, offset);
+    else if ((strcmp(mnem, "mul") == 0) && (strcmp(ops, "x,a") == 0))
+      op = I_MUL;
+    else if ((strcmp(mnem, "ldw") == 0) && (strncmp(ops, "x,", 2) == 0))
+      op = I_LDW_X, arg = asm_sp(ops + 2, offset);
+    else if ((strcmp(mnem, "ldw") == 0) && (strncmp(ops, "y,", 2) == 0))
+      op = I_LDW_Y, arg = asm_sp(ops + 2, offset);
+    else if ((strcmp(mnem, "ldw") == 0) && (strcmp(ops + strlen(ops) - 2, ",x") == 0)) {
+      ops[strlen(ops) - 2] = 0;
+      op = I_LDW_TO_SP, arg = asm_sp(ops, offset);
+    }
+    else if ((strcmp(mnem, "addw") == 0) && (strncmp(ops, "x,", 2) == 0))
+      op = I_ADDW_X, arg = asm_sp(ops + 2, offset);
+    else if ((strcmp(mnem, "addw") == 0) && (strncmp(ops, "y,", 2) == 0))
+      op = I_ADDW_Y, arg = asm_sp(ops + 2, offset);
+    else if ((strcmp(mnem, "subw") == 0) && (strncmp(ops, "y,", 2) == 0))
+      op = I_SUBW_Y, arg = asm_sp(ops + 2, offset);
+    else if (strcmp(mnem, "inc") == 0)
+      op = I_INC, arg = asm_sp(ops, offset);
+    else if (strcmp(mnem, "tnz") == 0)
+      op = I_TNZ, arg = asm_sp(ops, offset);
+    else if ((strcmp(mnem, "incw") == 0) && (strcmp(ops, "y") == 0))
+      op = I_INCW_Y;
+    else if (strcmp(mnem, "jrnc") == 0)
+      op = I_JRNC, arg = atoi(ops);
+    else if (strcmp(mnem, "jrpl") == 0)
+      op = I_JRPL, arg = atoi(ops);
+    else {
+      printf("  %s: instruction not emulated: %s %s\n", name, mnem, ops);
+      return(0);
+    }
+    if ((arg < 0) || (f->num >= ASM_MAX_INSTR)) {
+      printf("  %s: operand not emulated: %s %s\n", name, mnem, ops);
+      return(0);
+    }
+    f->code[f->num].op  = op;
+    f->code[f->num].arg = arg;
+    f->num++;
+  }
+
+  return(f->num > 0);
+
+} // asm_load
+
+
+/// execute function with parameters 'args' (big endian) on stack after return address of 'retSize' bytes. Return Y:X, or error flag
+static uint32_t asm_run(const asm_t *f, const uint8_t *args, int numArgs, int retSize, int *error) {
+
+  uint8_t   mem[256];
+  int       sp = 128, sp0, pc, i, n, N = 0, Z = 0, C = 0;
+  uint16_t  x = 0x5A5A, y = 0xA5A5, w;
+  uint8_t   a = 0x3C;
+  uint32_t  r;
+
+  // random stack content, return address, then parameters
+  for (i=0; i<(int) sizeof(mem); i++)
+    mem[i] = (uint8_t) random32();
+  memcpy(mem + sp + 1 + retSize, args, numArgs);
+  sp0 = sp;
+
+  for (pc=0; pc<f->num; pc++) {
+    n = f->code[pc].arg;
+    w = (uint16_t) ((mem[(sp + n) & 0xFF] << 8) | mem[(sp + n + 1) & 0xFF]);
+    switch (f->code[pc].op) {
+      case I_LABEL:     break;
+      case I_SUB_SP:    sp -= n; break;
+      case I_ADDW_SP:   sp += n; break;
+      case I_LD_A:      a = mem[(sp + n) & 0xFF]; N = a >> 7; Z = (a == 0); break;
+      case I_LD_XL_A:   x = (uint16_t) ((x & 0xFF00) | a); break;
+      case I_MUL:       x = (uint16_t) ((x & 0xFF) * a); C = 0; break;
+      case I_LDW_TO_SP: mem[(sp + n) & 0xFF] = (uint8_t) (x >> 8); mem[(sp + n + 1) & 0xFF] = (uint8_t) x; N = x >> 15; Z = (x == 0); break;
+      case I_LDW_X:     x = w; N = x >> 15; Z = (x == 0); break;
+      case I_LDW_Y:     y = w; N = y >> 15; Z = (y == 0); break;
+      case I_ADDW_X:    r = (uint32_t) x + w; C = (r > 0xFFFF); x = (uint16_t) r; N = x >> 15; Z = (x == 0); break;
+      case I_ADDW_Y:    r = (uint32_t) y + w; C = (r > 0xFFFF); y = (uint16_t) r; N = y >> 15; Z = (y == 0); break;
+      case I_SUBW_Y:    C = (w > y); y = (uint16_t) (y - w); N = y >> 15; Z = (y == 0); break;
+      case I_INC:       mem[(sp + n) & 0xFF]++; N = mem[(sp + n) & 0xFF] >> 7; Z = (mem[(sp + n) & 0xFF] == 0); break;
+      case I_TNZ:       N = mem[(sp + n) & 0xFF] >> 7; Z = (mem[(sp + n) & 0xFF] == 0); break;
+      case I_INCW_Y:    y++; N = y >> 15; Z = (y == 0); break;
+      case I_JRNC:
+      case I_JRPL:
+        if (((f->code[pc].op == I_JRNC) && !C) || ((f->code[pc].op == I_JRPL) && !N)) {
+          for (i=0; i<f->num; i++)
+            if ((f->code[i].op == I_LABEL) && (f->code[i].arg == n))
+              break;
+          if (i == f->num) {
+            *error = 1;
+            return(0);
+          }
+          pc = i;
+        }
+        break;
+      case I_RET:
+        *error = (sp != sp0);
+        return(((uint32_t) y << 16) | x);
+    }
+  }
+  (void) Z;
+
+  // no return
+  *error = 1;
+  return(0);
+
+} // asm_run
+
+
+/// compare assembler fix_umul() and fix_mac() with C version for medium (retSize=2) and large (retSize=3) model
+static void check_asm(void) {
+
+  static const uint16_t corner16[] = { 0, 1, 0x7F, 0x80, 0xFF, 0x100, 0x7FFF, 0x8000, 0x8001, 0xFF00, 0xFFFF };
+  static const uint32_t corner32[] = { 0, 1, 0xFFFF, 0x10000, 0x7FFFFFFF, 0x80000000, 0xFFFFFFFF, 0xFFFF0000 };
+  asm_t         umul, mac;
+  uint8_t       args[8];
+  uint16_t      a, b;
+  uint32_t      acc, res, ref;
+  unsigned long tests = 0, mismatch = 0;
+  long          i;
+  int           retSize, error;
+  size_t        n1 = sizeof(corner16)/sizeof(corner16[0]), n2 = sizeof(corner32)/sizeof(corner32[0]);
+
+  for (retSize=2; retSize<=3; retSize++) {
+
+    // ASM_ARGS_SP_OFFSET: return address + 1
+    if (!asm_load(&umul, "fix_umul", retSize + 1) || !asm_load(&mac, "fix_mac", retSize + 1)) {
+      printf("  assembler of fix_umul()/fix_mac() not found in fixmath.c\n");
+      m_errors++;
+      return;
+    }
+
+    for (i=-(long) (n1*n1*n2); i<NUM_ASM; i++) {
+
+      // corner cases, then random
+      if (i < 0) {
+        a   = corner16[(-i - 1) % n1];
+        b   = corner16[((-i - 1) / n1) % n1];
+        acc = corner32[(-i - 1) / (n1 * n1)];
+      }
+      else {
+        a   = (uint16_t) random32();
+        b   = (uint16_t) random32();
+        acc = random32();
+      }
+
+      // fix_umul(a, b)
+      args[0] = (uint8_t) (a >> 8); args[1] = (uint8_t) a;
+      args[2] = (uint8_t) (b >> 8); args[3] = (uint8_t) b;
+      res = asm_run(&umul, args, 4, retSize, &error);
+      ref = fix_umul(a, b);
+      tests++;
+      if (error || (res != ref)) {
+        if (mismatch++ < 10)
+          printf("  mismatch fix_umul(0x%04X, 0x%04X): asm 0x%08lX, C 0x%08lX%s\n", a, b, (unsigned long) res, (unsigned long) ref, error ? ", stack/branch error" : "");
+      }
+
+      // fix_mac(acc, a, b)
+      args[0] = (uint8_t) (acc >> 24); args[1] = (uint8_t) (acc >> 16); args[2] = (uint8_t) (acc >> 8); args[3] = (uint8_t) acc;
+      args[4] = (uint8_t) (a >> 8); args[5] = (uint8_t) a;
+      args[6] = (uint8_t) (b >> 8); args[7] = (uint8_t) b;
+      res = asm_run(&mac, args, 8, retSize, &error);
+      ref = (uint32_t) fix_mac((int32_t) acc, (int16_t) a, (int16_t) b);
+      tests++;
+      if (error || (res != ref)) {
+        if (mismatch++ < 10)
+          printf("  mismatch fix_mac(0x%08lX, %d, %d): asm 0x%08lX, C 0x%08lX%s\n", (unsigned long) acc, (int16_t) a, (int16_t) b, (unsigned long) res, (unsigned long) ref, error ? ", stack/branch error" : "");
+      }
+
+    } // loop over arguments
+
+  } // loop over memory models
+
+  printf("assembler vs. C (fix_umul, fix_mac; medium and large model): %lu tests, %lu mismatches\n", tests, mismatch);
+  if (mismatch)
+    m_errors++;
+
+} // check_asm
+
+
+
+/////////////////
+//    main routine
+/////////////////
+int main(int argc, char *argv[]) {
+
+  FILE    *fp;
+  long    len;
+
+  // read fixmath.c for assembler emulation
+  if ((argc < 2) || ((fp = fopen(argv[1], "rb")) == NULL)) {
+    printf("usage: %s ../fixmath.c\n", argv[0]);
+    return(1);
+  }
+  fseek(fp, 0, SEEK_END);
+  len = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+  m_source = calloc(len + 1, 1);
+  if ((m_source == NULL) || (fread(m_source, 1, len, fp) != (size_t) len)) {
+    printf("error reading %s\n", argv[1]);
+    return(1);
+  }
+  fclose(fp);
+
+  // accuracy of fixmath.c with C multiplication
+  printf("fixmath.c (FIX_ASM=0) vs. float:\n");
+  printf("  %-8s %10s %6s  %s\n", "function", "max error", "limit", "worst argument");
+  check_sin();
+  check_atan2();
+  check_isqrt();
+  check_sqrt();
+  check_log2();
+  check_exp2();
+  check_mul_q15();
+
+  // assembler helpers
+  check_asm();
+
+  free(m_source);
+
+  return((m_errors == 0) ? 0 : 1);
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,388 @@
+/**********************
+  Fixed-point math vs. float: execution time and accuracy
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - call each function of fixmath.c and the respective float function of the compiler library
+      with NUM_ARGS arguments
+    - measure avg/max time per call in CPU cycles (TIM2 at 16MHz)
+    - max. deviation of fixed-point result from float result [LSB]
+    - 16-tap FIR filter via fix_mac(), C with 32-bit multiplication and float
+    - print results via UART (19.2kBaud)
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+#undef _MAIN_
+#include "fixmath.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define NUM_ARGS        64            // number of arguments per function
+#define NUM_TAPS        16            // number of FIR filter taps
+#define PI_F            3.14159265f
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// execution time [cycles]
+typedef struct {
+  uint32_t  sum;
+  uint16_t  max;
+} cycles_t;
+
+/// result of one function
+typedef struct {
+  cycles_t  fix;                      ///< time of fixed-point function
+  cycles_t  flt;                      ///< time of float function
+  uint32_t  err;                      ///< max. deviation [LSB]
+} result_t;
+
+/// state of pseudo-random generator
+uint16_t        m_random = 0xACE1;
+
+/// timer overhead [cycles]
+uint16_t        m_overhead;
+
+/// FIR coefficients and samples
+q15_t           m_coeff[NUM_TAPS], m_sample[NUM_TAPS];
+float           m_coeffF[NUM_TAPS], m_sampleF[NUM_TAPS];
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint16_t bench_time(void)
+
+  \brief read TIM2 counter
+
+  \return  TIM2 counter [cycles]
+*/
+static uint16_t bench_time(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM2, CNTR);
+
+  return(t);
+
+} // bench_time
+
+
+
+/**
+  \fn uint16_t random16(void)
+
+  \brief 16-bit xorshift pseudo-random generator
+
+  \return  next pseudo-random number
+*/
+static uint16_t random16(void) {
+
+  m_random ^= m_random << 7;
+  m_random ^= m_random >> 9;
+  m_random ^= m_random << 8;
+
+  return(m_random);
+
+} // random16
+
+
+
+/**
+  \fn void cycles_add(cycles_t *c, uint16_t start)
+
+  \brief add execution time to statistics
+
+  \param[in]  c       statistics
+  \param[in]  start   TIM2 counter before call
+*/
+static void cycles_add(cycles_t *c, uint16_t start) {
+
+  uint16_t  dt = (uint16_t) (bench_time() - start - m_overhead);
+
+  if (dt > c->max)
+    c->max = dt;
+  c->sum += dt;
+
+} // cycles_add
+
+
+
+/**
+  \fn void error_add(result_t *r, int32_t val, float ref)
+
+  \brief update max. deviation from float result
+
+  \param[in]  r       result
+  \param[in]  val     fixed-point result [LSB]
+  \param[in]  ref     float result [LSB]
+*/
+static void error_add(result_t *r, int32_t val, float ref) {
+
+  float     d = (float) val - ref;
+  uint32_t  e;
+
+  e = (uint32_t) ((d < 0) ? (-d + 0.5f) : (d + 0.5f));
+  if (e > r->err)
+    r->err = e;
+
+} // error_add
+
+
+
+/**
+  \fn void print_result(const char *name, const result_t *r, const char *unit)
+
+  \brief print result of one function
+
+  \param[in]  name    name of function
+  \param[in]  r       result
+  \param[in]  unit    unit of deviation
+*/
+static void print_result(const char *name, const result_t *r, const char *unit) {
+
+  printf("  %-10s %5u / %5u    %5u / %5u    %lu %s\n", name,
+    (uint16_t) (r->fix.sum / NUM_ARGS), r->fix.max, (uint16_t) (r->flt.sum / NUM_ARGS), r->flt.max,
+    (unsigned long) r->err, unit);
+
+} // print_result
+
+
+
+/**
+  \fn void clear_result(result_t *r)
+
+  \brief clear result
+
+  \param[out] r       result
+*/
+static void clear_result(result_t *r) {
+
+  r->fix.sum = r->flt.sum = 0;
+  r->fix.max = r->flt.max = 0;
+  r->err = 0;
+
+} // clear_result
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  result_t  r;
+  cycles_t  c;
+  uint16_t  start, angle;
+  uint8_t   i, j;
+  int16_t   x, y;
+  q15_t     a, b, q;
+  q16_t     v, w;
+  int32_t   acc, accC;
+  float     f, g, fr;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // TIM2 runs free at 16MHz as time base
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+  #endif
+  sfr_TIM2.PSCR.byte = 0x00;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // measure timer overhead
+  m_overhead = 0;
+  start = bench_time();
+  m_overhead = (uint16_t) (bench_time() - start);
+
+  printf("\nfixed-point vs. float, %u arguments, %s multiply\n", (uint16_t) NUM_ARGS, (FIX_ASM) ? "assembler" : "C");
+  printf("  function   fixed avg/max    float avg/max    max. deviation\n");
+
+
+  // sin: random angles, deviation [LSB Q15]
+  clear_result(&r);
+  for (i=0; i<NUM_ARGS; i++) {
+    angle = random16();
+    f = (float) angle * (2 * PI_F / 65536.0f);
+    start = bench_time(); q = fix_sin(angle); cycles_add(&r.fix, start);
+    start = bench_time(); g = sinf(f);        cycles_add(&r.flt, start);
+    error_add(&r, q, g * 32768.0f);
+  }
+  print_result("sin", &r, "LSB Q15");
+
+
+  // atan2: random vectors, deviation [LSB angle]
+  clear_result(&r);
+  for (i=0; i<NUM_ARGS; i++) {
+    x = (int16_t) random16();
+    y = (int16_t) random16();
+    start = bench_time(); angle = fix_atan2(y, x); cycles_add(&r.fix, start);
+    start = bench_time(); g = atan2f(y, x);        cycles_add(&r.flt, start);
+    fr = g * (65536.0f / (2 * PI_F));
+    if (fr < 0)
+      fr += 65536.0f;
+    if ((angle < 0x4000) && (fr > 0xC000))        // wrap-around at 0deg
+      fr -= 65536.0f;
+    else if ((angle > 0xC000) && (fr < 0x4000))
+      fr += 65536.0f;
+    error_add(&r, angle, fr);
+  }
+  print_result("atan2", &r, "LSB angle");
+
+
+  // sqrt: random arguments 0..256, deviation [LSB Q16]
+  clear_result(&r);
+  for (i=0; i<NUM_ARGS; i++) {
+    v = ((q16_t) random16() << 8) | (random16() & 0xFF);
+    f = (float) v / 65536.0f;
+    start = bench_time(); w = fix_sqrt(v); cycles_add(&r.fix, start);
+    start = bench_time(); g = sqrtf(f);    cycles_add(&r.flt, start);
+    error_add(&r, w, g * 65536.0f);
+  }
+  print_result("sqrt", &r, "LSB Q16");
+
+
+  // log2: random arguments 1/256..256, deviation [LSB Q16]. Float: log2(x) = ln(x)/ln(2)
+  clear_result(&r);
+  for (i=0; i<NUM_ARGS; i++) {
+    v = ((q16_t) random16() << 8) | 0x100;
+    f = (float) v / 65536.0f;
+    start = bench_time(); w = fix_log2(v);            cycles_add(&r.fix, start);
+    start = bench_time(); g = logf(f) * 1.44269504f;  cycles_add(&r.flt, start);
+    error_add(&r, w, g * 65536.0f);
+  }
+  print_result("log2", &r, "LSB Q16");
+
+
+  // exp2: random arguments -8..8, deviation [LSB Q16]. Float: 2^x = e^(x*ln(2))
+  clear_result(&r);
+  for (i=0; i<NUM_ARGS; i++) {
+    v = (q16_t) ((int16_t) random16()) << 4;
+    f = (float) v / 65536.0f;
+    start = bench_time(); w = fix_exp2(v);            cycles_add(&r.fix, start);
+    start = bench_time(); g = expf(f * 0.69314718f);  cycles_add(&r.flt, start);
+    error_add(&r, w, g * 65536.0f);
+  }
+  print_result("exp2", &r, "LSB Q16");
+
+
+  // Q15 multiplication: random factors, deviation [LSB Q15]
+  clear_result(&r);
+  for (i=0; i<NUM_ARGS; i++) {
+    a = (q15_t) random16();
+    b = (q15_t) random16();
+    f = (float) a / 32768.0f;
+    g = (float) b / 32768.0f;
+    start = bench_time(); q  = fix_mul_q15(a, b); cycles_add(&r.fix, start);
+    start = bench_time(); fr = f * g;             cycles_add(&r.flt, start);
+    error_add(&r, q, fr * 32768.0f);
+  }
+  print_result("mul_q15", &r, "LSB Q15");
+
+
+  // FIR filter with NUM_TAPS taps: fix_mac() vs. float, and C with 32-bit multiplication. Results of fix_mac() and C must be identical
+  clear_result(&r);
+  c.sum = c.max = 0;
+  for (i=0; i<NUM_ARGS; i++) {
+
+    // random coefficients and samples
+    for (j=0; j<NUM_TAPS; j++) {
+      m_coeff[j]   = (q15_t) random16() >> 4;
+      m_sample[j]  = (q15_t) random16();
+      m_coeffF[j]  = (float) m_coeff[j];
+      m_sampleF[j] = (float) m_sample[j];
+    }
+
+    // fixed-point MAC
+    start = bench_time();
+    acc = 0;
+    for (j=0; j<NUM_TAPS; j++)
+      acc = fix_mac(acc, m_coeff[j], m_sample[j]);
+    cycles_add(&r.fix, start);
+
+    // float MAC
+    start = bench_time();
+    fr = 0;
+    for (j=0; j<NUM_TAPS; j++)
+      fr += m_coeffF[j] * m_sampleF[j];
+    cycles_add(&r.flt, start);
+
+    // C MAC
+    start = bench_time();
+    accC = 0;
+    for (j=0; j<NUM_TAPS; j++)
+      accC += (int32_t) m_coeff[j] * m_sample[j];
+    cycles_add(&c, start);
+
+    // count mismatches
+    if (acc != accC)
+      r.err++;
+  }
+  print_result("FIR16", &r, "mismatches vs. C");
+  printf("  FIR16 with C 32-bit multiply: %u / %u cycles\n", (uint16_t) (c.sum / NUM_ARGS), c.max);
+
+
+  // main loop
+  while(1);
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
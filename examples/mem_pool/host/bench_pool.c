@@ -0,0 +1,307 @@
+/**********************
+  Host benchmark of pool.c: execution time and fragmentation vs. heap
+
+  Functionality:
+    - same pseudo-random sequence as ../main.c: 2000 allocations (1..32B) and frees,
+      max. 24 live objects, 3 pools (8B x 8, 16B x 8, 32B x 12)
+    - fragmentation: the sequence also runs on a first-fit heap with 2B block header
+      and the same memory as the pools (576B). Failed allocations are counted, and those
+      which failed although the total free memory was sufficient (fragmentation).
+      After each sequence the largest free heap block is compared with the total free memory
+    - execution time [ns/call] of pools_alloc()/pools_free() vs. malloc()/free() of the host.
+      Host times only show the relation, for STM8 cycles see ../main.c
+    - repeated for NUM_SEEDS sequences
+
+  build & run: make bench
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pool.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LIVE_MAX        24            // max. number of allocated objects (as ../main.c)
+#define ITERATIONS      2000          // number of allocations + frees per sequence (as ../main.c)
+#define OBJ_SIZE_MAX    32            // max. object size [B] (as ../main.c)
+#define NUM_SEEDS       1000          // number of sequences
+#define NUM_TIMING      50            // repetitions of each sequence for timing
+
+#define HEAP_SIZE       (8*8 + 16*8 + 32*12)    // heap with same memory as pools [B]
+#define HEAP_HEADER     2                       // block header: size and used flag (bit 15)
+#define HEAP_USED       0x8000
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// allocator of a sequence
+typedef enum { USE_POOLS, USE_HEAP, USE_MALLOC } alloc_t;
+
+/// result of sequences
+typedef struct {
+  unsigned long   fail;               ///< number of failed allocations
+  unsigned long   fragFail;           ///< failed although total free memory was sufficient
+  unsigned long   largestSum;         ///< sum of largest free block after sequence [B]
+  unsigned long   freeSum;            ///< sum of total free memory after sequence [B]
+  unsigned        searchMax;          ///< max. number of heap blocks searched per allocation
+} result_t;
+
+/// memory pools and table sorted by block size (as ../main.c)
+POOL_DEFINE(m_pool8,  8,  8);
+POOL_DEFINE(m_pool16, 16, 8);
+POOL_DEFINE(m_pool32, 32, 12);
+pool_t * const  m_pools[] = { &m_pool8, &m_pool16, &m_pool32 };
+#define NUM_POOLS   (sizeof(m_pools)/sizeof(m_pools[0]))
+
+/// first-fit heap
+uint8_t         m_heap[HEAP_SIZE];
+unsigned        m_heapSearch;
+
+/// allocated objects
+void            *m_live[LIVE_MAX];
+
+/// state of pseudo-random generator
+uint16_t        m_random;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/// 16-bit xorshift pseudo-random generator (as ../main.c)
+static uint16_t random16(void) {
+  m_random ^= m_random << 7;
+  m_random ^= m_random >> 9;
+  m_random ^= m_random << 8;
+  return(m_random);
+}
+
+
+/// read / write block header of heap
+static uint16_t heap_header(unsigned pos) {
+  return((uint16_t) (m_heap[pos] | (m_heap[pos+1] << 8)));
+}
+static void heap_set_header(unsigned pos, uint16_t h) {
+  m_heap[pos]   = (uint8_t) h;
+  m_heap[pos+1] = (uint8_t) (h >> 8);
+}
+
+
+/// init heap: one free block
+static void heap_init(void) {
+  heap_set_header(0, HEAP_SIZE - HEAP_HEADER);
+}
+
+
+/// first-fit allocation. Split block if remainder can hold header + 1B
+static void *heap_alloc(unsigned size) {
+
+  unsigned  pos = 0;
+  uint16_t  h, len;
+
+  m_heapSearch = 0;
+  while (pos < HEAP_SIZE) {
+    m_heapSearch++;
+    h   = heap_header(pos);
+    len = h & ~HEAP_USED;
+    if (!(h & HEAP_USED) && (len >= size)) {
+      if (len >= size + HEAP_HEADER + 1) {
+        heap_set_header(pos + HEAP_HEADER + size, (uint16_t) (len - size - HEAP_HEADER));
+        len = (uint16_t) size;
+      }
+      heap_set_header(pos, len | HEAP_USED);
+      return(m_heap + pos + HEAP_HEADER);
+    }
+    pos += HEAP_HEADER + len;
+  }
+
+  return(NULL);
+
+} // heap_alloc
+
+
+/// free block and merge all adjacent free blocks
+static void heap_free(void *ptr) {
+
+  unsigned  pos, next;
+  uint16_t  h;
+
+  if (ptr == NULL)
+    return;
+  pos = (unsigned) ((uint8_t*) ptr - m_heap) - HEAP_HEADER;
+  heap_set_header(pos, heap_header(pos) & ~HEAP_USED);
+
+  // merge free neighbours
+  for (pos=0; pos<HEAP_SIZE; pos+=HEAP_HEADER+(heap_header(pos) & ~HEAP_USED)) {
+    h = heap_header(pos);
+    if (h & HEAP_USED)
+      continue;
+    next = pos + HEAP_HEADER + h;
+    while ((next < HEAP_SIZE) && !(heap_header(next) & HEAP_USED)) {
+      h = (uint16_t) (h + HEAP_HEADER + heap_header(next));
+      heap_set_header(pos, h);
+      next = pos + HEAP_HEADER + h;
+    }
+  }
+
+} // heap_free
+
+
+/// largest free block and total free memory of heap
+static void heap_stats(unsigned *largest, unsigned *total) {
+
+  unsigned  pos;
+  uint16_t  h;
+
+  *largest = *total = 0;
+  for (pos=0; pos<HEAP_SIZE; pos+=HEAP_HEADER+(h & ~HEAP_USED)) {
+    h = heap_header(pos);
+    if (!(h & HEAP_USED)) {
+      *total += h;
+      if (h > *largest)
+        *largest = h;
+    }
+  }
+
+} // heap_stats
+
+
+/// run sequence of ../main.c with allocator, update result
+static void run_sequence(alloc_t use, uint16_t seed, result_t *res) {
+
+  uint16_t  i, r;
+  uint8_t   idx, size;
+  unsigned  largest, total;
+  void      *ptr;
+
+  m_random = seed;
+  for (i=0; i<LIVE_MAX; i++)
+    m_live[i] = NULL;
+
+  for (i=0; i<ITERATIONS; i++) {
+
+    // random object slot and size
+    r    = random16();
+    idx  = (uint8_t) ((r & 0xFF) % LIVE_MAX);
+    size = (uint8_t) (((r >> 8) % OBJ_SIZE_MAX) + 1);
+
+    // allocate object
+    if (m_live[idx] == NULL) {
+      if (use == USE_POOLS)
+        ptr = pools_alloc(m_pools, NUM_POOLS, size);
+      else if (use == USE_HEAP) {
+        ptr = heap_alloc(size);
+        if (m_heapSearch > res->searchMax)
+          res->searchMax = m_heapSearch;
+        if (ptr == NULL) {
+          heap_stats(&largest, &total);
+          if (total >= size)
+            res->fragFail++;
+        }
+      }
+      else
+        ptr = malloc(size);
+      if (ptr == NULL)
+        res->fail++;
+      m_live[idx] = ptr;
+    }
+
+    // free object
+    else {
+      if (use == USE_POOLS)
+        pools_free(m_pools, NUM_POOLS, m_live[idx]);
+      else if (use == USE_HEAP)
+        heap_free(m_live[idx]);
+      else
+        free(m_live[idx]);
+      m_live[idx] = NULL;
+    }
+
+  } // loop ITERATIONS
+
+  // fragmentation after sequence
+  if (use == USE_HEAP) {
+    heap_stats(&largest, &total);
+    res->largestSum += largest;
+    res->freeSum    += total;
+  }
+
+  // release remaining objects
+  for (i=0; i<LIVE_MAX; i++) {
+    if (use == USE_POOLS)
+      pools_free(m_pools, NUM_POOLS, m_live[i]);
+    else if (use == USE_HEAP)
+      heap_free(m_live[i]);
+    else
+      free(m_live[i]);
+  }
+
+} // run_sequence
+
+
+/// time of NUM_TIMING runs of each sequence [ns/call]
+static double run_timing(alloc_t use) {
+
+  struct timespec t0, t1;
+  result_t        res;
+  unsigned        s, n;
+
+  memset(&res, 0, sizeof(res));
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for (s=0; s<NUM_SEEDS; s++)
+    for (n=0; n<NUM_TIMING; n++)
+      run_sequence(use, (uint16_t) (0xACE1 + s), &res);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+
+  return(((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double) NUM_SEEDS * NUM_TIMING * (ITERATIONS + LIVE_MAX)));
+
+} // run_timing
+
+
+
+/////////////////
+//    main routine
+/////////////////
+int main(void) {
+
+  result_t  resPool, resHeap;
+  unsigned  s;
+
+  // fragmentation: pools vs. first-fit heap with same memory
+  memset(&resPool, 0, sizeof(resPool));
+  memset(&resHeap, 0, sizeof(resHeap));
+  for (s=0; s<NUM_SEEDS; s++) {
+    run_sequence(USE_POOLS, (uint16_t) (0xACE1 + s), &resPool);
+    heap_init();
+    run_sequence(USE_HEAP, (uint16_t) (0xACE1 + s), &resHeap);
+  }
+  printf("%u sequences of %u alloc/free (1..%uB, max. %u live), %uB memory:\n",
+    NUM_SEEDS, ITERATIONS, OBJ_SIZE_MAX, LIVE_MAX, HEAP_SIZE);
+  printf("  pools            %6lu failed\n", resPool.fail);
+  printf("  first-fit heap   %6lu failed, %lu of them by fragmentation, max. %u blocks searched\n",
+    resHeap.fail, resHeap.fragFail, resHeap.searchMax);
+  printf("  heap after sequence: avg. largest free block %luB of %luB free\n",
+    resHeap.largestSum / NUM_SEEDS, resHeap.freeSum / NUM_SEEDS);
+
+  // execution time on host
+  printf("host time per call (alloc or free):\n");
+  printf("  pools            %6.1f ns\n", run_timing(USE_POOLS));
+  printf("  host malloc()    %6.1f ns\n", run_timing(USE_MALLOC));
+
+  return(0);
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,29 @@
+/**
+  \file host_config.h
+
+  \brief configuration stub for host test of pool.c
+
+  replaces config.h of the target, i.e. no device header is included.
+  Critical sections are empty blocks, because the host test is single-threaded.
+  Included via compiler option '-include host_config.h', see Makefile.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _HOST_CONFIG_H_
+#define _HOST_CONFIG_H_
+
+// skip target headers
+#define _CONFIG_H_
+
+#include <stdint.h>
+
+// critical sections open and close a block like on the target
+#define ENTER_CRITICAL()      {
+#define EXIT_CRITICAL()       }
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _HOST_CONFIG_H_
@@ -0,0 +1,368 @@
+/**********************
+  Host test of pool.c: compare with reference model
+
+  Functionality:
+    - random pool configurations (block size 1..128 as power of 2, 1..64 blocks) incl. corner cases
+    - random sequence of pool_alloc() / pool_free() incl. free of unused blocks and NULL,
+      compared with a reference model (first free block, statistics)
+    - blocks are filled with a pattern, which is checked on free, i.e. detects overlapping
+      blocks. Memory behind the pool is checked for overwrites
+    - table of 3 pools: pools_alloc() / pools_free() vs. reference (smallest sufficient pool
+      with free block), incl. too large requests and foreign pointers
+    - fragmentation: after a random sequence, a pool with n free blocks must serve exactly
+      n allocations of any order of previous frees
+    - print number of tests and mismatches. Exit code 1 on mismatch
+
+  build & run: make
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "pool.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define NUM_CONFIGS     2000          // number of random pool configurations
+#define NUM_OPS         2000          // number of alloc/free per configuration
+#define NUM_POOLS       3             // number of pools in table
+#define GUARD_SIZE      16            // canary bytes behind pool memory
+#define GUARD_BYTE      0xA5          // canary value
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// reference model of one pool
+typedef struct {
+  uint8_t   used[POOL_MAX_BLOCKS];    ///< block is used
+  uint8_t   num;                      ///< number of used blocks
+  uint8_t   peak;                     ///< max. number of used blocks
+  uint8_t   fail;                     ///< number of failed allocations (saturated)
+} ref_t;
+
+/// pool memory incl. guard, and bitmaps
+uint8_t         m_mem[NUM_POOLS][128 * POOL_MAX_BLOCKS + GUARD_SIZE];
+uint8_t         m_map[NUM_POOLS][(POOL_MAX_BLOCKS + 7) / 8];
+
+/// pools and reference models
+pool_t          m_pool[NUM_POOLS];
+ref_t           m_ref[NUM_POOLS];
+
+/// number of tests and mismatches
+unsigned long   m_tests, m_errors;
+
+/// state of pseudo-random generator
+uint32_t        m_random = 0x12345678;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/// 32-bit xorshift pseudo-random generator
+static uint32_t random32(void) {
+  m_random ^= m_random << 13;
+  m_random ^= m_random >> 17;
+  m_random ^= m_random << 5;
+  return(m_random);
+}
+
+
+/// count test and report mismatch
+static void check(int ok, const char *msg, unsigned cfg, unsigned op) {
+
+  m_tests++;
+  if (!ok) {
+    m_errors++;
+    if (m_errors <= 20)
+      printf("  mismatch config %u, op %u: %s\n", cfg, op, msg);
+  }
+
+} // check
+
+
+/// init pool 'k' and its reference model
+static void init_pool(uint8_t k, uint8_t size, uint8_t num) {
+
+  m_pool[k].mem   = m_mem[k];
+  m_pool[k].map   = m_map[k];
+  m_pool[k].size  = size;
+  m_pool[k].shift = POOL_LOG2(size);
+  m_pool[k].num   = num;
+  memset(m_map[k], 0x5A, sizeof(m_map[k]));        // pool_init() must clear bitmap
+  pool_init(&m_pool[k]);
+  memset(m_mem[k] + (size_t) size * num, GUARD_BYTE, GUARD_SIZE);
+  memset(&m_ref[k], 0, sizeof(m_ref[k]));
+
+} // init_pool
+
+
+/// block index of pointer
+static unsigned block_index(uint8_t k, const void *ptr) {
+  return((unsigned) (((const uint8_t*) ptr - m_mem[k]) / m_pool[k].size));
+}
+
+
+/// fill block with pattern of its index
+static void fill_block(uint8_t k, unsigned idx) {
+  memset(m_mem[k] + idx * m_pool[k].size, (int) (idx ^ 0x3C), m_pool[k].size);
+}
+
+
+/// check pattern of block
+static int check_block(uint8_t k, unsigned idx) {
+
+  const uint8_t *p = m_mem[k] + idx * m_pool[k].size;
+  unsigned      i;
+
+  for (i=0; i<m_pool[k].size; i++)
+    if (p[i] != (uint8_t) (idx ^ 0x3C))
+      return(0);
+  return(1);
+
+} // check_block
+
+
+/// compare pool state with reference: statistics, bitmaps, guard
+static void check_state(uint8_t k, unsigned cfg, unsigned op) {
+
+  pool_t    *p = &m_pool[k];
+  unsigned  i, ok = 1;
+
+  for (i=0; i<p->num; i++)
+    if (((p->map[i >> 3] >> (i & 7)) & 1) != m_ref[k].used[i])
+      ok = 0;
+  for (i=0; i<(unsigned) ((p->num + 7) >> 3); i++)
+    if (((p->full >> i) & 1) != (p->map[i] == 0xFF))
+      ok = 0;
+  check(ok, "bitmap", cfg, op);
+  check((p->used == m_ref[k].num) && (p->peak == m_ref[k].peak) && (p->fail == m_ref[k].fail), "statistics", cfg, op);
+  for (i=0; i<GUARD_SIZE; i++)
+    if (m_mem[k][(size_t) p->size * p->num + i] != GUARD_BYTE)
+      ok = 0;
+  check(ok, "memory behind pool overwritten", cfg, op);
+
+} // check_state
+
+
+/// reference of pool_alloc(): first free block or -1. Updates model
+static int ref_alloc(uint8_t k) {
+
+  unsigned  i;
+
+  for (i=0; i<m_pool[k].num; i++) {
+    if (!m_ref[k].used[i]) {
+      m_ref[k].used[i] = 1;
+      if (++m_ref[k].num > m_ref[k].peak)
+        m_ref[k].peak = m_ref[k].num;
+      return((int) i);
+    }
+  }
+  if (m_ref[k].fail != 0xFF)
+    m_ref[k].fail++;
+  return(-1);
+
+} // ref_alloc
+
+
+/// reference of pool_free(). Updates model
+static void ref_free(uint8_t k, unsigned idx) {
+
+  if (m_ref[k].used[idx]) {
+    m_ref[k].used[idx] = 0;
+    m_ref[k].num--;
+  }
+
+} // ref_free
+
+
+/// random used (or any) block of pool, -1 if none
+static int random_block(uint8_t k, int usedOnly) {
+
+  unsigned  i, start = random32() % m_pool[k].num;
+
+  if (!usedOnly)
+    return((int) start);
+  for (i=0; i<m_pool[k].num; i++)
+    if (m_ref[k].used[(start + i) % m_pool[k].num])
+      return((int) ((start + i) % m_pool[k].num));
+  return(-1);
+
+} // random_block
+
+
+/// random alloc/free sequence on single pool, then fragmentation check
+static void test_single(unsigned cfg, uint8_t size, uint8_t num) {
+
+  unsigned  op, n, freeBlocks;
+  int       idx, pAlloc;
+  void      *ptr;
+
+  init_pool(0, size, num);
+  check_state(0, cfg, 0);
+
+  // probability of alloc varies per configuration, i.e. both empty and full pools occur
+  pAlloc = 30 + (int) (random32() % 41);
+
+  for (op=1; op<=NUM_OPS; op++) {
+
+    // allocate and compare with first free block
+    if ((int) (random32() % 100) < pAlloc) {
+      ptr = pool_alloc(&m_pool[0]);
+      idx = ref_alloc(0);
+      if (idx < 0)
+        check(ptr == NULL, "alloc from full pool", cfg, op);
+      else {
+        check(ptr == m_mem[0] + (size_t) idx * size, "alloc address", cfg, op);
+        if (ptr != NULL)
+          fill_block(0, block_index(0, ptr));
+      }
+    }
+
+    // free used block (check pattern), unused block or NULL
+    else {
+      n = random32() % 16;
+      if (n == 0)
+        pool_free(&m_pool[0], NULL);
+      else {
+        idx = random_block(0, n > 1);
+        if (idx >= 0) {
+          if (m_ref[0].used[idx])
+            check(check_block(0, (unsigned) idx), "block overwritten", cfg, op);
+          pool_free(&m_pool[0], m_mem[0] + (size_t) idx * size);
+          ref_free(0, (unsigned) idx);
+        }
+      }
+    }
+
+    check_state(0, cfg, op);
+
+  } // loop over operations
+
+  // fragmentation: all free blocks can be allocated, then pool is full
+  freeBlocks = num - m_ref[0].num;
+  for (n=0; n<freeBlocks; n++) {
+    ptr = pool_alloc(&m_pool[0]);
+    check(ptr != NULL, "free block not allocatable (fragmentation)", cfg, n);
+    if (ptr != NULL)
+      ref_alloc(0);
+  }
+  check(pool_alloc(&m_pool[0]) == NULL, "alloc from full pool", cfg, n);
+  ref_alloc(0);
+  check_state(0, cfg, n);
+
+  // free all blocks in random order, then all blocks allocatable again
+  while ((idx = random_block(0, 1)) >= 0) {
+    pool_free(&m_pool[0], m_mem[0] + (size_t) idx * size);
+    ref_free(0, (unsigned) idx);
+  }
+  check(m_pool[0].used == 0, "pool not empty after free of all blocks", cfg, 0);
+  for (n=0; n<num; n++) {
+    check(pool_alloc(&m_pool[0]) != NULL, "free block not allocatable (fragmentation)", cfg, n);
+    ref_alloc(0);
+  }
+  check_state(0, cfg, n);
+
+} // test_single
+
+
+/// random pools_alloc() / pools_free() sequence on table of pools
+static void test_table(unsigned cfg) {
+
+  pool_t * const  pools[NUM_POOLS] = { &m_pool[0], &m_pool[1], &m_pool[2] };
+  uint8_t         size[NUM_POOLS], k, tmp;
+  unsigned        op, req;
+  int             idx, expK, expIdx;
+  void            *ptr;
+  uint8_t         foreign[4];
+
+  // random block sizes, sorted ascending
+  for (k=0; k<NUM_POOLS; k++)
+    size[k] = (uint8_t) (1 << (random32() % 7));
+  for (k=1; k<NUM_POOLS; k++)
+    for (tmp=k; (tmp > 0) && (size[tmp-1] > size[tmp]); tmp--) {
+      uint8_t s = size[tmp]; size[tmp] = size[tmp-1]; size[tmp-1] = s;
+    }
+  for (k=0; k<NUM_POOLS; k++)
+    init_pool(k, size[k], (uint8_t) (1 + random32() % POOL_MAX_BLOCKS));
+
+  for (op=1; op<=NUM_OPS; op++) {
+
+    // allocate 1..max+8 bytes, compare with smallest sufficient pool with free block
+    if (random32() % 2) {
+      req = 1 + random32() % (size[NUM_POOLS-1] + 8);
+      ptr = pools_alloc(pools, NUM_POOLS, (uint8_t) req);
+      expK = -1;
+      expIdx = -1;
+      for (k=0; (k<NUM_POOLS) && (expK < 0); k++) {
+        if (size[k] >= req) {
+          expIdx = ref_alloc(k);
+          if (expIdx >= 0)
+            expK = k;
+        }
+      }
+      if (expK < 0)
+        check(ptr == NULL, "pools_alloc without free block", cfg, op);
+      else
+        check(ptr == m_mem[expK] + (size_t) expIdx * size[expK], "pools_alloc address", cfg, op);
+    }
+
+    // free used block of random pool
+    else {
+      k = (uint8_t) (random32() % NUM_POOLS);
+      idx = random_block(k, 1);
+      if (idx >= 0) {
+        check(pools_free(pools, NUM_POOLS, m_mem[k] + (size_t) idx * size[k]) == 1, "pools_free result", cfg, op);
+        ref_free(k, (unsigned) idx);
+      }
+    }
+
+    for (k=0; k<NUM_POOLS; k++)
+      check_state(k, cfg, op);
+
+  } // loop over operations
+
+  // NULL and foreign pointers
+  check(pools_free(pools, NUM_POOLS, NULL) == 1, "pools_free(NULL)", cfg, 0);
+  check(pools_free(pools, NUM_POOLS, foreign) == 0, "pools_free of foreign pointer", cfg, 0);
+
+} // test_table
+
+
+
+/////////////////
+//    main routine
+/////////////////
+int main(void) {
+
+  static const uint8_t  corner[][2] = { {1,1}, {1,64}, {128,1}, {128,64}, {16,7}, {16,8}, {16,9}, {2,63}, {8,56}, {4,57} };
+  unsigned              cfg;
+
+  // corner cases
+  for (cfg=0; cfg<sizeof(corner)/sizeof(corner[0]); cfg++)
+    test_single(cfg, corner[cfg][0], corner[cfg][1]);
+
+  // random configurations
+  for (cfg=0; cfg<NUM_CONFIGS; cfg++)
+    test_single(cfg, (uint8_t) (1 << (random32() % 8)), (uint8_t) (1 + random32() % POOL_MAX_BLOCKS));
+
+  // table of pools
+  for (cfg=0; cfg<NUM_CONFIGS/10; cfg++)
+    test_table(cfg);
+
+  printf("pool.c vs. reference: %lu tests, %lu mismatches\n", m_tests, m_errors);
+
+  return((m_errors == 0) ? 0 : 1);
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
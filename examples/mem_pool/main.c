@@ -0,0 +1,393 @@
+/**********************
+  Fixed-block memory pools vs. malloc(): execution time and fragmentation
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - 3 pools with 8B, 16B and 32B blocks, combined to a table sorted by block size
+    - identical pseudo-random sequence of allocations (1..32B) and frees, once via pools_alloc()/pools_free()
+      and once via malloc()/free()
+    - measure min/avg/max time per call in CPU cycles (TIM2 at 16MHz)
+    - after the sequence, find largest possible malloc() block (fragmentation) and print pool statistics
+    - print results via UART (19.2kBaud). Any key repeats the test with a new sequence
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+#undef _MAIN_
+#include "pool.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define LIVE_MAX        24            // max. number of allocated objects
+#define ITERATIONS      2000          // number of allocations + frees per test
+#define OBJ_SIZE_MAX    32            // max. object size [B]
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// timing statistics [cycles]
+typedef struct {
+  uint16_t  min;
+  uint16_t  max;
+  uint32_t  sum;
+  uint16_t  num;
+} timing_t;
+
+/// result of one test
+typedef struct {
+  timing_t  alloc;                    ///< time of alloc calls
+  timing_t  free;                     ///< time of free calls
+  uint16_t  fail;                     ///< number of failed allocations
+  uint8_t   live;                     ///< objects allocated after sequence
+  uint16_t  bytes;                    ///< requested bytes allocated after sequence
+} result_t;
+
+/// memory pools and table sorted by block size
+POOL_DEFINE(m_pool8,  8,  8);
+POOL_DEFINE(m_pool16, 16, 8);
+POOL_DEFINE(m_pool32, 32, 12);
+pool_t * const  m_pools[] = { &m_pool8, &m_pool16, &m_pool32 };
+#define NUM_POOLS   (sizeof(m_pools)/sizeof(m_pools[0]))
+
+/// allocated objects and their size
+void            *m_live[LIVE_MAX];
+uint8_t         m_size[LIVE_MAX];
+
+/// state of pseudo-random generator
+uint16_t        m_random;
+
+/// timer overhead [cycles]
+uint16_t        m_overhead;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint16_t bench_time(void)
+
+  \brief read TIM2 counter
+
+  \return  TIM2 counter [cycles]
+*/
+static uint16_t bench_time(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM2, CNTR);
+
+  return(t);
+
+} // bench_time
+
+
+
+/**
+  \fn uint16_t random16(void)
+
+  \brief 16-bit xorshift pseudo-random generator
+
+  \return  next pseudo-random number
+*/
+static uint16_t random16(void) {
+
+  m_random ^= m_random << 7;
+  m_random ^= m_random >> 9;
+  m_random ^= m_random << 8;
+
+  return(m_random);
+
+} // random16
+
+
+
+/**
+  \fn void timing_add(timing_t *t, uint16_t start)
+
+  \brief add execution time to statistics
+
+  \param[in]  t       statistics
+  \param[in]  start   TIM2 counter before call
+*/
+static void timing_add(timing_t *t, uint16_t start) {
+
+  uint16_t  dt = (uint16_t) (bench_time() - start - m_overhead);
+
+  if ((t->num == 0) || (dt < t->min))
+    t->min = dt;
+  if (dt > t->max)
+    t->max = dt;
+  t->sum += dt;
+  t->num++;
+
+} // timing_add
+
+
+
+/**
+  \fn void run_test(result_t *res, uint8_t usePools, uint16_t seed)
+
+  \brief run allocation sequence
+
+  \param[out] res       result
+  \param[in]  usePools  1=pools_alloc()/pools_free(), 0=malloc()/free()
+  \param[in]  seed      start of pseudo-random sequence
+
+  pick a random object slot. If it is empty allocate 1..OBJ_SIZE_MAX bytes,
+  else free it. Objects are kept after the sequence, see release_all()
+*/
+static void run_test(result_t *res, uint8_t usePools, uint16_t seed) {
+
+  uint16_t  i, r, start;
+  uint8_t   idx, size;
+  void      *ptr;
+
+  // init
+  m_random = seed;
+  for (i=0; i<LIVE_MAX; i++)
+    m_live[i] = NULL;
+  res->alloc.num = res->free.num = 0;
+  res->alloc.max = res->free.max = 0;
+  res->alloc.sum = res->free.sum = 0;
+  res->fail = 0;
+
+  for (i=0; i<ITERATIONS; i++) {
+
+    // random object slot and size
+    r    = random16();
+    idx  = (uint8_t) ((r & 0xFF) % LIVE_MAX);
+    size = (uint8_t) (((r >> 8) % OBJ_SIZE_MAX) + 1);
+
+    // allocate object
+    if (m_live[idx] == NULL) {
+      start = bench_time();
+      if (usePools)
+        ptr = pools_alloc(m_pools, NUM_POOLS, size);
+      else
+        ptr = malloc(size);
+      timing_add(&(res->alloc), start);
+      if (ptr == NULL)
+        res->fail++;
+      m_live[idx] = ptr;
+      m_size[idx] = size;
+    }
+
+    // free object
+    else {
+      ptr = m_live[idx];
+      start = bench_time();
+      if (usePools)
+        pools_free(m_pools, NUM_POOLS, ptr);
+      else
+        free(ptr);
+      timing_add(&(res->free), start);
+      m_live[idx] = NULL;
+    }
+
+  } // loop ITERATIONS
+
+  // count remaining objects
+  res->live  = 0;
+  res->bytes = 0;
+  for (i=0; i<LIVE_MAX; i++) {
+    if (m_live[i] != NULL) {
+      res->live++;
+      res->bytes += m_size[i];
+    }
+  }
+
+} // run_test
+
+
+
+/**
+  \fn void release_all(uint8_t usePools)
+
+  \brief free remaining objects of run_test()
+
+  \param[in]  usePools  1=pools_free(), 0=free()
+*/
+static void release_all(uint8_t usePools) {
+
+  uint8_t   i;
+
+  for (i=0; i<LIVE_MAX; i++) {
+    if (usePools)
+      pools_free(m_pools, NUM_POOLS, m_live[i]);
+    else
+      free(m_live[i]);
+    m_live[i] = NULL;
+  }
+
+} // release_all
+
+
+
+/**
+  \fn uint16_t malloc_largest(void)
+
+  \brief find largest possible malloc() block
+
+  \return  size of largest free heap block [B]
+
+  bisection via malloc()/free(), i.e. independent of heap implementation
+*/
+static uint16_t malloc_largest(void) {
+
+  uint16_t  lo = 0, hi = 4096, mid;
+  void      *ptr;
+
+  while (lo < hi) {
+    mid = (lo + hi + 1) >> 1;
+    ptr = malloc(mid);
+    if (ptr != NULL) {
+      free(ptr);
+      lo = mid;
+    }
+    else
+      hi = mid - 1;
+  }
+
+  return(lo);
+
+} // malloc_largest
+
+
+
+/**
+  \fn void print_result(const char *name, const result_t *res)
+
+  \brief print result of run_test()
+
+  \param[in]  name    name of allocator
+  \param[in]  res     result
+*/
+static void print_result(const char *name, const result_t *res) {
+
+  printf("  %-7s alloc min/avg/max %3u/%3u/%4u, free %3u/%3u/%4u cycles, %u failed, %u objects (%uB) live\n", name,
+    res->alloc.min, (uint16_t) (res->alloc.sum / res->alloc.num), res->alloc.max,
+    res->free.min, (uint16_t) (res->free.sum / res->free.num), res->free.max,
+    res->fail, (uint16_t) res->live, res->bytes);
+
+} // print_result
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  result_t  resPool, resHeap;
+  uint16_t  seed = 0xACE1, start, largest;
+  uint8_t   i;
+  pool_t    *pool;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // TIM2 runs free at 16MHz as time base
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+  #endif
+  sfr_TIM2.PSCR.byte = 0x00;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // measure timer overhead
+  m_overhead = 0;
+  start = bench_time();
+  m_overhead = (uint16_t) (bench_time() - start);
+
+  printf("\nmemory pools vs. malloc(), %u calls, objects 1..%uB, max. %u live\n", (uint16_t) ITERATIONS, (uint16_t) OBJ_SIZE_MAX, (uint16_t) LIVE_MAX);
+
+
+  // main loop
+  while(1) {
+
+    // same sequence for both allocators. Largest heap block with objects of sequence still allocated
+    run_test(&resPool, 1, seed);
+    release_all(1);
+    run_test(&resHeap, 0, seed);
+    largest = malloc_largest();
+    release_all(0);
+
+    // print results
+    printf("seed 0x%04x:\n", seed);
+    print_result("pools", &resPool);
+    print_result("malloc", &resHeap);
+    printf("  heap: largest free block %uB\n", largest);
+    for (i=0; i<NUM_POOLS; i++) {
+      pool = m_pools[i];
+      printf("  pool %2uB x %2u: peak %2u, failed %3u\n", (uint16_t) pool->size, (uint16_t) pool->num,
+        (uint16_t) pool->peak, (uint16_t) pool->fail);
+    }
+
+    // reset pool statistics
+    for (i=0; i<NUM_POOLS; i++)
+      pool_init(m_pools[i]);
+
+    // wait for key, then repeat with new sequence
+    g_key = 0;
+    while (g_key == 0);
+    seed = random16() | 0x0001;
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,239 @@
+/**
+  \file pool.c
+
+  \author G. Icking-Konert
+  \date 2021-10-12
+  \version 0.1
+
+  \brief implementation of fixed-block memory pools
+
+  implementation of memory pools with blocks of fixed size and constant
+  execution time. For details see pool.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "pool.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+/// index of first clear bit in byte (8 if none). Two nibble lookups instead of a loop
+#define FIRST_FREE(x)   ( (((x) & 0x0F) != 0x0F) ? m_poolFirstFree[(x) & 0x0F] : (uint8_t) (4 + m_poolFirstFree[(x) >> 4]) )
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// index of first clear bit in nibble (4 if none)
+static const uint8_t  m_poolFirstFree[16] = { 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0, 4 };
+
+/// bit masks. Variable shifts are loops on STM8
+static const uint8_t  m_poolMask[8] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80 };
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void pool_init(pool_t *pool)
+
+  \brief free all blocks
+
+  \param[in]  pool    memory pool
+
+  free all blocks and clear statistics. Not required after C startup
+*/
+void pool_init(pool_t *pool) {
+
+  uint8_t   i;
+
+  ENTER_CRITICAL();
+    for (i=0; i<(uint8_t) ((pool->num + 7) >> 3); i++)
+      pool->map[i] = 0x00;
+    pool->full = 0x00;
+    #if (POOL_STATS)
+      pool->used = 0;
+      pool->peak = 0;
+      pool->fail = 0;
+    #endif
+  EXIT_CRITICAL();
+
+} // pool_init
+
+
+
+/**
+  \fn void *pool_alloc(pool_t *pool)
+
+  \brief allocate block
+
+  \param[in]  pool    memory pool
+
+  \return pointer to block, or NULL if pool is empty
+
+  find first free block via bitmaps and mark it as used. Constant time, can
+  be called from ISRs
+*/
+void *pool_alloc(pool_t *pool) {
+
+  uint8_t   *ptr = NULL;
+  uint8_t   i, b, idx;
+
+  ENTER_CRITICAL();
+
+    // first bitmap byte with a free block. Skip if beyond last block
+    i = FIRST_FREE(pool->full);
+    if ((uint8_t) (i << 3) < pool->num) {
+
+      // first free block in bitmap byte. Skip if beyond last block
+      b = FIRST_FREE(pool->map[i]);
+      idx = (uint8_t) (i << 3) + b;
+      if (idx < pool->num) {
+
+        // mark block as used
+        pool->map[i] |= m_poolMask[b];
+        if (pool->map[i] == 0xFF)
+          pool->full |= m_poolMask[i];
+        ptr = pool->mem + (uint16_t) idx * pool->size;
+
+        // update statistics
+        #if (POOL_STATS)
+          if (++(pool->used) > pool->peak)
+            pool->peak = pool->used;
+        #endif
+      }
+    }
+
+    // count failed allocations
+    #if (POOL_STATS)
+      if ((ptr == NULL) && (pool->fail != 0xFF))
+        pool->fail++;
+    #endif
+
+  EXIT_CRITICAL();
+
+  return((void*) ptr);
+
+} // pool_alloc
+
+
+
+/**
+  \fn void pool_free(pool_t *pool, void *ptr)
+
+  \brief return block to pool
+
+  \param[in]  pool    memory pool
+  \param[in]  ptr     block from pool_alloc() of same pool, or NULL
+
+  mark block as free. The block index is the offset shifted right by log2 of
+  the block size, i.e. max. 7 shift steps instead of a 16/8 division. Can be
+  called from ISRs. Freeing an unused block is ignored
+*/
+void pool_free(pool_t *pool, void *ptr) {
+
+  uint8_t   i, b, idx;
+
+  // ignore NULL like free()
+  if (ptr == NULL)
+    return;
+
+  // block index from address
+  idx = (uint8_t) ((uint16_t) ((uint8_t*) ptr - pool->mem) >> pool->shift);
+  i = idx >> 3;
+  b = idx & 0x07;
+
+  ENTER_CRITICAL();
+
+    // mark block as free
+    if (pool->map[i] & m_poolMask[b]) {
+      pool->map[i] &= (uint8_t) ~m_poolMask[b];
+      pool->full   &= (uint8_t) ~m_poolMask[i];
+      #if (POOL_STATS)
+        pool->used--;
+      #endif
+    }
+
+  EXIT_CRITICAL();
+
+} // pool_free
+
+
+
+/**
+  \fn void *pools_alloc(pool_t * const *pools, uint8_t num, uint8_t size)
+
+  \brief allocate block from table of pools
+
+  \param[in]  pools   table of pools, sorted by ascending block size
+  \param[in]  num     number of pools in table
+  \param[in]  size    min. block size [B]
+
+  \return pointer to block, or NULL if no pool has a free block of sufficient size
+
+  allocate from the smallest pool with sufficient block size. If it is empty,
+  fall back to the next larger pool. Time is max. 'num' times pool_alloc()
+*/
+void *pools_alloc(pool_t * const *pools, uint8_t num, uint8_t size) {
+
+  void      *ptr;
+  uint8_t   i;
+
+  for (i=0; i<num; i++) {
+    if (pools[i]->size >= size) {
+      ptr = pool_alloc(pools[i]);
+      if (ptr != NULL)
+        return(ptr);
+    }
+  }
+
+  return(NULL);
+
+} // pools_alloc
+
+
+
+/**
+  \fn uint8_t pools_free(pool_t * const *pools, uint8_t num, void *ptr)
+
+  \brief return block to its pool in table
+
+  \param[in]  pools   table of pools
+  \param[in]  num     number of pools in table
+  \param[in]  ptr     block from pools_alloc() of same table, or NULL
+
+  \return 1 if block was returned (or NULL), 0 if no pool contains ptr
+
+  find pool by address range and return block to it
+*/
+uint8_t pools_free(pool_t * const *pools, uint8_t num, void *ptr) {
+
+  uint8_t   i;
+  pool_t    *pool;
+
+  // ignore NULL like free()
+  if (ptr == NULL)
+    return(1);
+
+  // find pool containing block
+  for (i=0; i<num; i++) {
+    pool = pools[i];
+    if (((uint8_t*) ptr >= pool->mem) && ((uint8_t*) ptr < pool->mem + (uint16_t) pool->size * pool->num)) {
+      pool_free(pool, ptr);
+      return(1);
+    }
+  }
+
+  return(0);
+
+} // pools_free
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
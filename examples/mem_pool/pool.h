@@ -0,0 +1,141 @@
+/**
+  \file pool.h
+
+  \author G. Icking-Konert
+  \date 2021-10-12
+  \version 0.1
+
+  \brief declaration of fixed-block memory pools
+
+  declaration of memory pools with blocks of fixed size as deterministic
+  replacement for malloc()/free(). Each pool has up to 64 blocks, which are
+  managed by a two-level bitmap (1=used):
+
+    - map[i] contains the state of blocks 8*i..8*i+7
+    - bit i of 'full' is set if map[i] is 0xFF
+
+  pool_alloc() finds the first free block via 2 table lookups, pool_free()
+  calculates the block index from the address by a right shift, because the
+  block size is a power of 2 (max. 7 shift steps, no division). Both have a
+  bounded execution time and are enclosed in ENTER_CRITICAL()/EXIT_CRITICAL(),
+  i.e. can be used in ISRs.
+  Blocks can't fragment, and the bitmap needs 1 bit per block (vs. 2-4B
+  header per malloc() block).
+
+  Example:
+    POOL_DEFINE(m_poolMsg, 16, 24);       // 24 blocks with 16B
+
+    uint8_t *buf = pool_alloc(&m_poolMsg);
+    ...
+    pool_free(&m_poolMsg, buf);
+
+  Pools of different block size can be combined to a const table sorted by
+  block size. pools_alloc() returns a block from the smallest pool with
+  sufficient size and free blocks, pools_free() finds the pool by address.
+
+  \note an all-zero bitmap is empty, i.e. pools defined via POOL_DEFINE()
+    are ready after C startup without pool_init()
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _POOL_H_
+#define _POOL_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// usage statistics (1=on, 0=off); can be overwritten via compiler option
+#ifndef POOL_STATS
+  #define POOL_STATS            1
+#endif
+
+#define POOL_MAX_BLOCKS         64            ///< max. number of blocks per pool
+
+/// log2 of block size (1..128) as constant expression for POOL_DEFINE()
+#define POOL_LOG2(n)            ( ((n) >= 128) ? 7 : ((n) >= 64) ? 6 : ((n) >= 32) ? 5 : ((n) >= 16) ? 4 : \
+                                  ((n) >= 8) ? 3 : ((n) >= 4) ? 2 : ((n) >= 2) ? 1 : 0 )
+
+// initial statistics for POOL_DEFINE()
+#if (POOL_STATS)
+  #define _POOL_STATS_INIT      , 0, 0, 0
+#else
+  #define _POOL_STATS_INIT
+#endif
+
+
+/**
+  \def POOL_DEFINE(name, blockSize, numBlocks)
+
+  \brief define pool with static storage
+
+  \param  name        name of pool (pool_t)
+  \param  blockSize   block size [B] (power of 2, 1..128)
+  \param  numBlocks   number of blocks (1..POOL_MAX_BLOCKS)
+
+  define block memory, bitmap and pool descriptor. Use 'static' prefix for local pools.
+  Other block sizes or numbers give a compile error
+*/
+#define POOL_DEFINE(name, blockSize, numBlocks) \
+  uint8_t name##_mem[(uint16_t) (blockSize) * (numBlocks)]; \
+  typedef char name##_check[(((blockSize) >= 1) && ((blockSize) <= 128) && (((blockSize) & ((blockSize) - 1)) == 0) && \
+                             ((numBlocks) >= 1) && ((numBlocks) <= POOL_MAX_BLOCKS)) ? 1 : -1]; \
+  uint8_t name##_map[((numBlocks) + 7) / 8]; \
+  pool_t  name = { name##_mem, name##_map, (blockSize), POOL_LOG2(blockSize), (numBlocks), 0x00 _POOL_STATS_INIT }
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// memory pool descriptor
+typedef struct {
+  uint8_t             *mem;                     ///< block memory
+  uint8_t             *map;                     ///< bitmap of used blocks (1=used)
+  uint8_t             size;                     ///< block size [B] (power of 2)
+  uint8_t             shift;                    ///< log2(size)
+  uint8_t             num;                      ///< number of blocks
+  uint8_t             full;                     ///< bit i: map[i] is full
+  #if (POOL_STATS)
+    uint8_t           used;                     ///< number of used blocks
+    uint8_t           peak;                     ///< max. number of used blocks
+    uint8_t           fail;                     ///< number of failed allocations (saturated)
+  #endif
+} pool_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// free all blocks and clear statistics
+void      pool_init(pool_t *pool);
+
+/// allocate block. Return NULL if pool is empty
+void      *pool_alloc(pool_t *pool);
+
+/// return block to pool. NULL is ignored
+void      pool_free(pool_t *pool, void *ptr);
+
+/// allocate block of min. 'size' bytes from table of pools, sorted by block size
+void      *pools_alloc(pool_t * const *pools, uint8_t num, uint8_t size);
+
+/// return block to its pool in table. Return 0 if no pool contains ptr
+uint8_t   pools_free(pool_t * const *pools, uint8_t num, void *ptr);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _POOL_H_
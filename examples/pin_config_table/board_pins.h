@@ -0,0 +1,87 @@
+/**
+  \file board_pins.h
+
+  \author G. Icking-Konert
+  \date 2021-06-26
+  \version 0.1
+
+  \brief pin configuration table of board
+
+  Table of all used pins in the form X(id, reg, port, mask, mode). The first two
+  parameters are passed through, port is PORTA..PORTI, mask is one or more PINx
+  of the device header, mode is one of the PIN_INPUT_xxx / PIN_OUTPUT_xxx modes
+  in gpio_config.h. The table is applied via GPIO_CONFIG_APPLY(BOARD_PINS).
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _BOARD_PINS_H_
+#define _BOARD_PINS_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "config.h"
+#include "gpio_config.h"
+
+
+/*-----------------------------------------------------------------------------
+    PIN CONFIGURATION TABLES
+-----------------------------------------------------------------------------*/
+
+#if defined(STM8L_DISCOVERY)
+
+  // LEDs on PC7 (blue) and PE7 (green), user button on PC1 (with external pull-down), LCD pins unused
+  #define BOARD_PINS(X, id, reg) \
+    X(id, reg, PORTC, PIN7,                 PIN_OUTPUT_PP_LOW) \
+    X(id, reg, PORTE, PIN7,                 PIN_OUTPUT_PP_LOW) \
+    X(id, reg, PORTC, PIN1,                 PIN_INPUT_FLOAT_EXTI) \
+    X(id, reg, PORTC, PIN2,                 PIN_INPUT_PULLUP) \
+    X(id, reg, PORTC, PIN3,                 PIN_OUTPUT_PP_HIGH) \
+    X(id, reg, PORTA, PIN2 | PIN3,          PIN_OUTPUT_PP_LOW) \
+    X(id, reg, PORTB, 0xFF,                 PIN_INPUT_PULLUP) \
+    X(id, reg, PORTD, 0xFF,                 PIN_INPUT_PULLUP) \
+    X(id, reg, PORTE, 0x7F,                 PIN_INPUT_PULLUP) \
+    X(id, reg, PORTF, PIN0,                 PIN_INPUT_PULLUP)
+
+  // EXTI edge sensitivity of pin 1 (STM8L: per pin number). 0=falling & low, 1=rising, 2=falling, 3=both
+  #define BOARD_EXTI_INIT()     { sfr_ITC_EXTI.CR1.P1IS = 1; }
+
+#elif defined(SDUINO)
+
+  // LED on PC5 (D13), test pin PC7 (D12), key on PD4 (D2) with interrupt, UART2 on PD5/PD6, rest pull-up
+  #define BOARD_PINS(X, id, reg) \
+    X(id, reg, PORTC, PIN5,                 PIN_OUTPUT_PP_FAST_LOW) \
+    X(id, reg, PORTC, PIN7,                 PIN_OUTPUT_PP_FAST_LOW) \
+    X(id, reg, PORTD, PIN4,                 PIN_INPUT_PULLUP_EXTI) \
+    X(id, reg, PORTD, PIN5,                 PIN_OUTPUT_PP_HIGH) \
+    X(id, reg, PORTD, PIN6,                 PIN_INPUT_PULLUP) \
+    X(id, reg, PORTA, PIN1 | PIN2,          PIN_INPUT_PULLUP) \
+    X(id, reg, PORTB, 0xFF,                 PIN_INPUT_FLOAT) \
+    X(id, reg, PORTC, PIN1 | PIN2 | PIN3,   PIN_OUTPUT_PP_LOW) \
+    X(id, reg, PORTC, PIN4 | PIN6,          PIN_INPUT_PULLUP) \
+    X(id, reg, PORTD, PIN0 | PIN2 | PIN3,   PIN_OUTPUT_PP_LOW) \
+    X(id, reg, PORTE, PIN5,                 PIN_INPUT_PULLUP) \
+    X(id, reg, PORTF, PIN4,                 PIN_INPUT_FLOAT)
+
+  // EXTI edge sensitivity of port D (STM8S: per port). 0=falling & low, 1=rising, 2=falling, 3=both
+  #define BOARD_EXTI_INIT()     { sfr_ITC_EXTI.CR1.PDIS = 2; }
+
+#endif
+
+
+// compile-time check that no pin is listed twice
+GPIO_CONFIG_CHECK(BOARD_PINS, PORTA);
+GPIO_CONFIG_CHECK(BOARD_PINS, PORTB);
+GPIO_CONFIG_CHECK(BOARD_PINS, PORTC);
+GPIO_CONFIG_CHECK(BOARD_PINS, PORTD);
+GPIO_CONFIG_CHECK(BOARD_PINS, PORTE);
+GPIO_CONFIG_CHECK(BOARD_PINS, PORTF);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _BOARD_PINS_H_
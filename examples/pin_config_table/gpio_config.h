@@ -0,0 +1,211 @@
+/**
+  \file gpio_config.h
+
+  \author G. Icking-Konert
+  \date 2021-06-26
+  \version 0.1
+
+  \brief declarative pin configuration, folded to per-port register values at compile time
+
+  Pins are listed in a table macro with (port, mask, mode), e.g. in board_pins.h:
+
+    #define BOARD_PINS(X, id, reg) \
+      X(id, reg, PORTC, PIN5,        PIN_OUTPUT_PP_FAST_LOW) \
+      X(id, reg, PORTD, PIN7,        PIN_INPUT_PULLUP_EXTI)  \
+      X(id, reg, PORTB, PIN0 | PIN1, PIN_INPUT_FLOAT)
+
+  The compiler folds the table to one constant per port register. GPIO_CONFIG_APPLY()
+  then writes each register of each used port exactly once (plus one CR2 write for
+  ports with fast outputs or EXTI inputs) instead of 3 read-modify-write bit accesses per pin.
+
+  Write order per port (avoids output glitches and spurious EXTI triggers):
+    1. CR2 = 0 -> all port interrupts disabled. CR2 of a pin which is still an input
+       would enable its EXTI
+    2. ODR = output levels -> outputs start with correct level
+    3. DDR = directions
+    4. CR1 = pull-up / push-pull
+    5. CR2 = final value (slope of outputs, EXTI enable), only after direction and
+       input are stable
+
+  \note call GPIO_CONFIG_APPLY() with interrupts disabled and after configuring
+    the EXTI edge sensitivity (ITC_EXTI), which requires disabled interrupts anyway
+  \note pins not listed in the table keep their reset state (floating input)
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _GPIO_CONFIG_H_
+#define _GPIO_CONFIG_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// register bits of a pin mode
+#define PIN_DDR                   0x01        ///< mode bit: DDR set (output)
+#define PIN_CR1                   0x02        ///< mode bit: CR1 set (input: pull-up, output: push-pull)
+#define PIN_CR2                   0x04        ///< mode bit: CR2 set (input: EXTI, output: 10MHz slope)
+#define PIN_ODR                   0x08        ///< mode bit: ODR set (output high)
+
+// input modes
+#define PIN_INPUT_FLOAT           (0)                                 ///< floating input w/o interrupt
+#define PIN_INPUT_PULLUP          (PIN_CR1)                           ///< pull-up input w/o interrupt
+#define PIN_INPUT_FLOAT_EXTI      (PIN_CR2)                           ///< floating input with interrupt
+#define PIN_INPUT_PULLUP_EXTI     (PIN_CR1 | PIN_CR2)                 ///< pull-up input with interrupt
+
+// output modes
+#define PIN_OUTPUT_OD_LOW         (PIN_DDR)                           ///< open-drain output, low
+#define PIN_OUTPUT_OD_HIGH        (PIN_DDR | PIN_ODR)                 ///< open-drain output, released
+#define PIN_OUTPUT_PP_LOW         (PIN_DDR | PIN_CR1)                 ///< push-pull output, low
+#define PIN_OUTPUT_PP_HIGH        (PIN_DDR | PIN_CR1 | PIN_ODR)       ///< push-pull output, high
+#define PIN_OUTPUT_OD_FAST_LOW    (PIN_DDR | PIN_CR2)                 ///< open-drain output with 10MHz slope, low
+#define PIN_OUTPUT_OD_FAST_HIGH   (PIN_DDR | PIN_CR2 | PIN_ODR)       ///< open-drain output with 10MHz slope, released
+#define PIN_OUTPUT_PP_FAST_LOW    (PIN_DDR | PIN_CR1 | PIN_CR2)       ///< push-pull output with 10MHz slope, low
+#define PIN_OUTPUT_PP_FAST_HIGH   (PIN_DDR | PIN_CR1 | PIN_CR2 | PIN_ODR)  ///< push-pull output with 10MHz slope, high
+
+// port IDs for compile-time comparison
+#define GPIO_ID_PORTA             1
+#define GPIO_ID_PORTB             2
+#define GPIO_ID_PORTC             3
+#define GPIO_ID_PORTD             4
+#define GPIO_ID_PORTE             5
+#define GPIO_ID_PORTF             6
+#define GPIO_ID_PORTG             7
+#define GPIO_ID_PORTH             8
+#define GPIO_ID_PORTI             9
+
+
+/*-----------------------------------------------------------------------------
+    COMPILE-TIME FOLDING OF PIN TABLE
+-----------------------------------------------------------------------------*/
+
+/// table entry -> pin mask if entry belongs to port 'id' and has mode bit 'reg' set, else 0
+#define _GPIO_CFG_OR(id, reg, port, mask, mode)     | (((GPIO_ID_##port == (id)) && ((mode) & (reg))) ? (mask) : 0)
+
+/// table entry -> pin mask if entry belongs to port 'id', else 0. Combined via | (used pins) or + (overlap check)
+#define _GPIO_CFG_USED(id, reg, port, mask, mode)   | ((GPIO_ID_##port == (id)) ? (mask) : 0)
+#define _GPIO_CFG_SUM(id, reg, port, mask, mode)    + ((GPIO_ID_##port == (id)) ? (mask) : 0)
+
+/// value of register 'reg' (PIN_DDR, PIN_CR1, PIN_CR2 or PIN_ODR) of 'port' (e.g. PORTC). Constant expression
+#define GPIO_CONFIG_REG(table, port, reg)           ((uint8_t) (0 table(_GPIO_CFG_OR, GPIO_ID_##port, reg)))
+
+/// pins of 'port' used in table. Constant expression
+#define GPIO_CONFIG_USED(table, port)               ((uint8_t) (0 table(_GPIO_CFG_USED, GPIO_ID_##port, 0)))
+
+/// pins of 'port' configured as input with interrupt
+#define GPIO_CONFIG_EXTI(table, port)               ((uint8_t) (GPIO_CONFIG_REG(table, port, PIN_CR2) & ~GPIO_CONFIG_REG(table, port, PIN_DDR)))
+
+/// compile-time check that no pin of 'port' is listed twice in table (sum of masks equals OR of masks)
+#define GPIO_CONFIG_CHECK(table, port) \
+  typedef char _gpio_config_check_##port[((0 table(_GPIO_CFG_SUM, GPIO_ID_##port, 0)) == GPIO_CONFIG_USED(table, port)) ? 1 : -1]
+
+
+/// default target of GPIO_CONFIG_APPLY(): port registers of 'port'
+#define GPIO_CONFIG_SFR(port)                       sfr_##port
+
+
+/**
+  \brief configure one port from pin table
+
+  Configure pins of 'port' with one write per register, see top for write order.
+  Registers are target(port), e.g. GPIO_CONFIG_SFR(port).
+  Ports without pins in table are skipped at compile time.
+  Single statement, i.e. safe in if/else without braces.
+*/
+#define GPIO_CONFIG_PORT(table, port, target) \
+  do { \
+    if (GPIO_CONFIG_USED(table, port)) { \
+      target(port).CR2.byte = 0x00; \
+      target(port).ODR.byte = GPIO_CONFIG_REG(table, port, PIN_ODR); \
+      target(port).DDR.byte = GPIO_CONFIG_REG(table, port, PIN_DDR); \
+      target(port).CR1.byte = GPIO_CONFIG_REG(table, port, PIN_CR1); \
+      if (GPIO_CONFIG_REG(table, port, PIN_CR2)) \
+        target(port).CR2.byte = GPIO_CONFIG_REG(table, port, PIN_CR2); \
+    } \
+  } while (0)
+
+
+// configure ports which exist on the selected device
+#if defined(sfr_PORTA)
+  #define _GPIO_CONFIG_PORTA(table, target)   GPIO_CONFIG_PORT(table, PORTA, target)
+#else
+  #define _GPIO_CONFIG_PORTA(table, target)
+#endif
+#if defined(sfr_PORTB)
+  #define _GPIO_CONFIG_PORTB(table, target)   GPIO_CONFIG_PORT(table, PORTB, target)
+#else
+  #define _GPIO_CONFIG_PORTB(table, target)
+#endif
+#if defined(sfr_PORTC)
+  #define _GPIO_CONFIG_PORTC(table, target)   GPIO_CONFIG_PORT(table, PORTC, target)
+#else
+  #define _GPIO_CONFIG_PORTC(table, target)
+#endif
+#if defined(sfr_PORTD)
+  #define _GPIO_CONFIG_PORTD(table, target)   GPIO_CONFIG_PORT(table, PORTD, target)
+#else
+  #define _GPIO_CONFIG_PORTD(table, target)
+#endif
+#if defined(sfr_PORTE)
+  #define _GPIO_CONFIG_PORTE(table, target)   GPIO_CONFIG_PORT(table, PORTE, target)
+#else
+  #define _GPIO_CONFIG_PORTE(table, target)
+#endif
+#if defined(sfr_PORTF)
+  #define _GPIO_CONFIG_PORTF(table, target)   GPIO_CONFIG_PORT(table, PORTF, target)
+#else
+  #define _GPIO_CONFIG_PORTF(table, target)
+#endif
+#if defined(sfr_PORTG)
+  #define _GPIO_CONFIG_PORTG(table, target)   GPIO_CONFIG_PORT(table, PORTG, target)
+#else
+  #define _GPIO_CONFIG_PORTG(table, target)
+#endif
+#if defined(sfr_PORTH)
+  #define _GPIO_CONFIG_PORTH(table, target)   GPIO_CONFIG_PORT(table, PORTH, target)
+#else
+  #define _GPIO_CONFIG_PORTH(table, target)
+#endif
+#if defined(sfr_PORTI)
+  #define _GPIO_CONFIG_PORTI(table, target)   GPIO_CONFIG_PORT(table, PORTI, target)
+#else
+  #define _GPIO_CONFIG_PORTI(table, target)
+#endif
+
+
+/**
+  \brief configure all pins listed in 'table' in one pass
+
+  Write registers target(port) instead of the port registers, e.g. to a volatile
+  PORT_t variable in RAM for benchmarking without changing the pins. Uses the
+  same instructions as GPIO_CONFIG_APPLY(), i.e. one 'mov mem,#byte' per write.
+*/
+#define GPIO_CONFIG_APPLY_TO(table, target) { \
+  _GPIO_CONFIG_PORTA(table, target); \
+  _GPIO_CONFIG_PORTB(table, target); \
+  _GPIO_CONFIG_PORTC(table, target); \
+  _GPIO_CONFIG_PORTD(table, target); \
+  _GPIO_CONFIG_PORTE(table, target); \
+  _GPIO_CONFIG_PORTF(table, target); \
+  _GPIO_CONFIG_PORTG(table, target); \
+  _GPIO_CONFIG_PORTH(table, target); \
+  _GPIO_CONFIG_PORTI(table, target); \
+}
+
+/// configure all pins listed in 'table' in one pass. Call with interrupts disabled
+#define GPIO_CONFIG_APPLY(table)                    GPIO_CONFIG_APPLY_TO(table, GPIO_CONFIG_SFR)
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _GPIO_CONFIG_H_
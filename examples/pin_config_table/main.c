@@ -0,0 +1,119 @@
+/**********************
+  Configure all board pins from a declarative table in one pass (see gpio_config.h)
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - pin table in board_pins.h is folded to one constant per port register
+    - apply table with one write per register and port (CR2 ordering avoids spurious EXTI)
+    - toggle LED in key EXTI ISR
+    - apply table to a scratch copy of the port registers with test pin high -> measure init time with scope
+    - for expected size & timing see README.md
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "config.h"
+#include "gpio_config.h"
+#include "board_pins.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#if defined(STM8L_DISCOVERY)
+  #define LED           sfr_PORTE.ODR.ODR7      // LED green
+  #define TEST          sfr_PORTC.ODR.ODR7      // LED blue
+  #define KEY_VECTOR    _EXTI1_VECTOR_          // user button PC1
+  #define KEY_CLEAR()   { sfr_ITC_EXTI.SR1.byte = PIN1; }
+#elif defined(SDUINO)
+  #define LED           sfr_PORTC.ODR.ODR5      // D13/LED
+  #define TEST          sfr_PORTC.ODR.ODR7      // D12
+  #define KEY_VECTOR    _EXTI3_VECTOR_          // D2 = PD4
+  #define KEY_CLEAR()   { }
+#endif
+
+// all ports map to the same scratch registers for benchmark
+#define SCRATCH(port)   m_scratch
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// scratch copy of port registers for benchmark. Same write instructions as real ports, but pins are not touched
+volatile PORT_t   m_scratch;
+
+
+/**
+  \fn void KEY_ISR(void)
+
+  \brief ISR for key interrupt
+
+  interrupt service routine for key pin external interrupt.
+
+  Note:
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: interrupt service table is defined in file "stm8_interrupt_vector.c"
+*/
+ISR_HANDLER(KEY_ISR, KEY_VECTOR)
+{
+  // clear interrupt flag (STM8L only)
+  KEY_CLEAR();
+
+  // toggle LED state
+  LED ^= 1;
+
+  return;
+
+} // KEY_ISR
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint16_t  i;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // set EXTI edge sensitivity. Requires disabled interrupts and must precede CR2 enable
+  BOARD_EXTI_INIT();
+
+  // configure all pins in one pass
+  GPIO_CONFIG_APPLY(BOARD_PINS);
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+
+  // main loop
+  while (1) {
+
+    // apply pin table to scratch registers with test pin high -> measure duration with scope.
+    // Real port registers are only written once at startup, else LED state and test pulse would be overwritten
+    TEST = 1;
+    GPIO_CONFIG_APPLY_TO(BOARD_PINS, SCRATCH);
+    TEST = 0;
+
+    // wait a bit
+    for (i=0; i<1000; i++)
+      NOP();
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
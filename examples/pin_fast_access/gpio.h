@@ -0,0 +1,155 @@
+/**
+  \file gpio.h
+
+  \author G. Icking-Konert
+  \date 2021-06-19
+  \version 0.1
+
+  \brief fast pin access via compile-time constant port and pin
+
+  declaration of macros for single-instruction pin access. Port and pin
+  are compile-time constants and are passed as one argument, e.g.
+    #define LED   PORTC, 5
+    PIN_SET(LED);             // bset 0x500a, #5
+    PIN_CLR(LED);             // bres 0x500a, #5
+    PIN_TOGGLE(LED);          // bcpl 0x500a, #5
+    if (PIN_READ(LED)) ...    // btjt 0x500b, #5, ...
+
+  Implementation:
+    - SDCC: inline assembler -> guaranteed BSET/BRES/BCPL for all optimization options
+    - IAR & Cosmic: single-bit OR/AND/XOR on absolute address, which is
+      always compiled to BSET/BRES/BCPL (see listing files)
+    - PORT_WRITE() changes several pins of a port atomically, i.e. with
+      interrupts disabled. Interrupt state is saved and restored
+
+  \note port addresses are identical for all STM8 devices (see device headers)
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _GPIO_H_
+#define _GPIO_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// port base addresses (=ODR). Identical for all STM8 devices
+#define GPIO_ADDR_PORTA       0x5000          ///< port A base address
+#define GPIO_ADDR_PORTB       0x5005          ///< port B base address
+#define GPIO_ADDR_PORTC       0x500a          ///< port C base address
+#define GPIO_ADDR_PORTD       0x500f          ///< port D base address
+#define GPIO_ADDR_PORTE       0x5014          ///< port E base address
+#define GPIO_ADDR_PORTF       0x5019          ///< port F base address
+#define GPIO_ADDR_PORTG       0x501e          ///< port G base address
+#define GPIO_ADDR_PORTH       0x5023          ///< port H base address
+#define GPIO_ADDR_PORTI       0x5028          ///< port I base address
+
+// register offsets relative to port base address
+#define GPIO_ODR              0               ///< offset of output data register
+#define GPIO_IDR              1               ///< offset of input data register
+#define GPIO_DDR              2               ///< offset of data direction register
+#define GPIO_CR1              3               ///< offset of control register 1
+#define GPIO_CR2              4               ///< offset of control register 2
+
+// helper macros for stringification of expanded macros
+#define _GPIO_STR2(x)         #x
+#define _GPIO_STR(x)          _GPIO_STR2(x)
+
+
+// SDCC: use inline assembler with constant address and bit
+#if defined(__SDCC)
+
+  /// single bit instruction 'op' on register 'reg' of 'port'
+  #define _GPIO_BITOP(op, port, reg, bit) \
+    __asm__(#op " " _GPIO_STR(GPIO_ADDR_##port) "+" _GPIO_STR(reg) ", #" _GPIO_STR(bit))
+
+  /// write 'value' to pins 'mask' of 'port' atomically (with interrupts disabled). A is saved, as SDCC doesn't know it's used
+  #define _PORT_WRITE(port, mask, value) \
+    __asm__("push a\n" \
+            "push cc\n" \
+            "sim\n" \
+            "ld a, " _GPIO_STR(GPIO_ADDR_##port) "\n" \
+            "and a, #(0xFF ^ " _GPIO_STR(mask) ")\n" \
+            "or a, #(" _GPIO_STR(value) " & " _GPIO_STR(mask) ")\n" \
+            "ld " _GPIO_STR(GPIO_ADDR_##port) ", a\n" \
+            "pop cc\n" \
+            "pop a")
+
+// IAR: single bit C operation on absolute address -> BSET/BRES/BCPL
+#elif defined(__ICCSTM8__)
+
+  /// single bit instruction 'op' on register 'reg' of 'port'
+  #define _GPIO_BITOP(op, port, reg, bit)   _GPIO_BITOP_##op(port, reg, bit)
+
+  /// write 'value' to pins 'mask' of 'port' atomically (with interrupts disabled)
+  #define _PORT_WRITE(port, mask, value) do { \
+    __istate_t _s = __get_interrupt_state(); \
+    __disable_interrupt(); \
+    _GPIO_REG(port, GPIO_ODR) = (uint8_t) ((_GPIO_REG(port, GPIO_ODR) & (uint8_t) ~(mask)) | ((value) & (mask))); \
+    __set_interrupt_state(_s); \
+  } while (0)
+
+// Cosmic: single bit C operation on absolute address -> BSET/BRES/BCPL
+#elif defined(__CSMC__)
+
+  /// single bit instruction 'op' on register 'reg' of 'port'
+  #define _GPIO_BITOP(op, port, reg, bit)   _GPIO_BITOP_##op(port, reg, bit)
+
+  /// write 'value' to pins 'mask' of 'port' atomically (with interrupts disabled)
+  #define _PORT_WRITE(port, mask, value) do { \
+    uint8_t _s = _asm("push cc\n pop a"); \
+    _asm("sim"); \
+    _GPIO_REG(port, GPIO_ODR) = (uint8_t) ((_GPIO_REG(port, GPIO_ODR) & (uint8_t) ~(mask)) | ((value) & (mask))); \
+    _asm("push a\n pop cc", _s); \
+  } while (0)
+
+#endif
+
+// C implementation of single bit operations (IAR & Cosmic)
+#define _GPIO_REG(port, reg)                (*((volatile uint8_t*) (GPIO_ADDR_##port + (reg))))
+#define _GPIO_BITOP_bset(port, reg, bit)    (_GPIO_REG(port, reg) |= (uint8_t) (1 << (bit)))
+#define _GPIO_BITOP_bres(port, reg, bit)    (_GPIO_REG(port, reg) &= (uint8_t) ~(1 << (bit)))
+#define _GPIO_BITOP_bcpl(port, reg, bit)    (_GPIO_REG(port, reg) ^= (uint8_t) (1 << (bit)))
+
+// helpers to split pin definition "PORTx, n" into port and bit
+#define _PIN_SET(port, bit)                 _GPIO_BITOP(bset, port, GPIO_ODR, bit)
+#define _PIN_CLR(port, bit)                 _GPIO_BITOP(bres, port, GPIO_ODR, bit)
+#define _PIN_TOGGLE(port, bit)              _GPIO_BITOP(bcpl, port, GPIO_ODR, bit)
+#define _PIN_READ(port, bit)                (sfr_##port.IDR.byte & (uint8_t) (1 << (bit)))
+#define _PIN_OUTPUT(port, bit)              do { _GPIO_BITOP(bset, port, GPIO_DDR, bit); _GPIO_BITOP(bset, port, GPIO_CR1, bit); } while (0)
+#define _PIN_OUTPUT_FAST(port, bit)         do { _PIN_OUTPUT(port, bit); _GPIO_BITOP(bset, port, GPIO_CR2, bit); } while (0)
+#define _PIN_INPUT(port, bit)               do { _GPIO_BITOP(bres, port, GPIO_CR2, bit); _GPIO_BITOP(bres, port, GPIO_DDR, bit); _GPIO_BITOP(bres, port, GPIO_CR1, bit); } while (0)
+#define _PIN_INPUT_PULLUP(port, bit)        do { _GPIO_BITOP(bres, port, GPIO_CR2, bit); _GPIO_BITOP(bres, port, GPIO_DDR, bit); _GPIO_BITOP(bset, port, GPIO_CR1, bit); } while (0)
+
+
+/*-----------------------------------------------------------------------------
+    PUBLIC PIN ACCESS MACROS (pin = "PORTx, n", see top)
+-----------------------------------------------------------------------------*/
+
+#define PIN_SET(pin)                        _PIN_SET(pin)             ///< set pin output high (BSET)
+#define PIN_CLR(pin)                        _PIN_CLR(pin)             ///< set pin output low (BRES)
+#define PIN_TOGGLE(pin)                     _PIN_TOGGLE(pin)          ///< toggle pin output (BCPL)
+#define PIN_READ(pin)                       _PIN_READ(pin)            ///< read pin input state (0 or !=0)
+#define PIN_OUTPUT(pin)                     _PIN_OUTPUT(pin)          ///< configure pin as push-pull output, 2MHz slope
+#define PIN_OUTPUT_FAST(pin)                _PIN_OUTPUT_FAST(pin)     ///< configure pin as push-pull output, 10MHz slope
+#define PIN_INPUT(pin)                      _PIN_INPUT(pin)           ///< configure pin as floating input w/o interrupt
+#define PIN_INPUT_PULLUP(pin)               _PIN_INPUT_PULLUP(pin)    ///< configure pin as pull-up input w/o interrupt
+
+/// atomically write 'value' to pins 'mask' (e.g. PIN0|PIN3) of 'port' (e.g. PORTC). 'mask' and 'value' must be constants
+#define PORT_WRITE(port, mask, value)       _PORT_WRITE(port, mask, value)
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _GPIO_H_
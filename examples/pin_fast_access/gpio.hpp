@@ -0,0 +1,92 @@
+/**
+  \file gpio.hpp
+
+  \author G. Icking-Konert
+  \date 2021-06-19
+  \version 0.1
+
+  \brief fast pin access via C++ templates (IAR C++)
+
+  C++ counterpart of gpio.h. Port address and pin mask (PIN0..PIN7 from device
+  header) are template parameters, so all accesses compile to single
+  BSET/BRES/BCPL instructions on the absolute port address, e.g.
+    typedef Pin<GPIO_ADDR_PORTC, PIN5> Led;
+    Led::output();
+    Led::set();
+    Led::toggle();
+    Port<GPIO_ADDR_PORTC>::write<PIN5|PIN7>(PIN7);    // atomic multi-pin write
+
+  \note SDCC and Cosmic do not support C++. For these use gpio.h
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _GPIO_HPP_
+#define _GPIO_HPP_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include "gpio.h"
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF CLASSES
+-----------------------------------------------------------------------------*/
+
+/// access to all pins of a port with base address ADDR (e.g. GPIO_ADDR_PORTC)
+template <uint16_t ADDR>
+struct Port {
+
+  /// access to port registers
+  static PORT_t& regs() { return *reinterpret_cast<PORT_t*>(ADDR); }
+
+  /// atomically write 'value' to pins MASK. Interrupt state is saved and restored
+  template <uint8_t MASK>
+  static void write(uint8_t value) {
+    __istate_t s = __get_interrupt_state();
+    __disable_interrupt();
+    regs().ODR.byte = (uint8_t) ((regs().ODR.byte & (uint8_t) ~MASK) | (value & MASK));
+    __set_interrupt_state(s);
+  }
+
+  /// read input state of all port pins
+  static uint8_t read() { return regs().IDR.byte; }
+
+}; // Port
+
+
+/// access to single pin MASK (PIN0..PIN7) of port with base address ADDR
+template <uint16_t ADDR, uint8_t MASK>
+struct Pin {
+
+  // compile-time check: MASK must have exactly one bit set
+  typedef char mask_must_be_single_bit[(MASK && !(MASK & (MASK-1))) ? 1 : -1];
+
+  static void set()         { Port<ADDR>::regs().ODR.byte |= MASK; }                         ///< BSET
+  static void clear()       { Port<ADDR>::regs().ODR.byte &= (uint8_t) ~MASK; }              ///< BRES
+  static void toggle()      { Port<ADDR>::regs().ODR.byte ^= MASK; }                         ///< BCPL
+  static bool read()        { return (Port<ADDR>::regs().IDR.byte & MASK) != 0; }            ///< BTJT/BTJF
+
+  /// configure as push-pull output (2MHz slope)
+  static void output()      { Port<ADDR>::regs().DDR.byte |= MASK; Port<ADDR>::regs().CR1.byte |= MASK; }
+
+  /// configure as input, optionally with pull-up. Disable interrupt first
+  static void input(bool pullup=false) {
+    Port<ADDR>::regs().CR2.byte &= (uint8_t) ~MASK;
+    Port<ADDR>::regs().DDR.byte &= (uint8_t) ~MASK;
+    if (pullup)
+      Port<ADDR>::regs().CR1.byte |= MASK;
+    else
+      Port<ADDR>::regs().CR1.byte &= (uint8_t) ~MASK;
+  }
+
+}; // Pin
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _GPIO_HPP_
@@ -0,0 +1,111 @@
+/**********************
+  Fast pin access via compile-time constant port and pin (see gpio.h)
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - compare pin toggle via bitfield, byte XOR and PIN_TOGGLE() (=BCPL)
+    - each variant toggles the LED pin 8x while the test pin is high
+      -> measure test pin pulse width with scope, as in benchmark_biquad
+    - atomically write 2 pins of same port via PORT_WRITE()
+    - for expected timing see README.md
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "config.h"
+#include "gpio.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#if defined(STM8L_DISCOVERY)
+
+  // LED pin PE7 (=LED green)
+  #define LED           PORTE, 7
+  #define LED_BITFIELD  sfr_PORTE.ODR.ODR7
+  #define LED_BYTE      sfr_PORTE.ODR.byte
+  #define LED_MASK      PIN7
+
+  // test pin PC7 (=LED blue) for scope
+  #define TEST          PORTC, 7
+
+  // 2nd pin on port of LED for multi-pin write
+  #define MULTI_PORT    PORTE
+  #define MULTI_MASK    (PIN6 | PIN7)
+
+#elif defined(SDUINO)
+
+  // LED pin PC5 (=Sduino D13/LED)
+  #define LED           PORTC, 5
+  #define LED_BITFIELD  sfr_PORTC.ODR.ODR5
+  #define LED_BYTE      sfr_PORTC.ODR.byte
+  #define LED_MASK      PIN5
+
+  // test pin PC7 (=Sduino D12) for scope
+  #define TEST          PORTC, 7
+
+  // 2nd pin on port of LED for multi-pin write
+  #define MULTI_PORT    PORTC
+  #define MULTI_MASK    (PIN4 | PIN5)
+
+#endif
+
+// repeat statement 8x to minimize loop overhead
+#define REPEAT8(x)      { x; x; x; x; x; x; x; x; }
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED and test pin as fast push-pull outputs
+  PIN_OUTPUT_FAST(LED);
+  PIN_OUTPUT_FAST(TEST);
+
+  // main loop
+  while (1) {
+
+    // bitfield toggle (compiler dependent, e.g. ld/xor/ld or bcpl)
+    PIN_SET(TEST);
+    REPEAT8(LED_BITFIELD ^= 1);
+    PIN_CLR(TEST);
+
+    // byte XOR toggle (compiler dependent, e.g. ld/xor/ld or bcpl)
+    PIN_SET(TEST);
+    REPEAT8(LED_BYTE ^= LED_MASK);
+    PIN_CLR(TEST);
+
+    // toggle via macro (guaranteed bcpl)
+    PIN_SET(TEST);
+    REPEAT8(PIN_TOGGLE(LED));
+    PIN_CLR(TEST);
+
+    // set & clear via macro (guaranteed bset/bres)
+    PIN_SET(TEST);
+    REPEAT8({ PIN_SET(LED); PIN_CLR(LED); });
+    PIN_CLR(TEST);
+
+    // atomic multi-pin write (push a/push cc/sim/ld/and/or/ld/pop cc/pop a)
+    PIN_SET(TEST);
+    PORT_WRITE(MULTI_PORT, MULTI_MASK, MULTI_MASK);
+    PORT_WRITE(MULTI_PORT, MULTI_MASK, 0x00);
+    PIN_CLR(TEST);
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,746 @@
+/**
+  \file kernel.c
+
+  \author G. Icking-Konert
+  \date 2021-10-10
+  \version 0.1
+
+  \brief implementation of a minimal preemptive kernel
+
+  implementation of a minimal preemptive kernel with fixed-priority threads,
+  mutexes with priority inheritance and semaphores. For details see kernel.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "kernel.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// compiler specific part of context switch in KERNEL_TRAP_ISR:
+//   - push/pop pseudo registers, which are not saved by the compiler ISR prologue
+//   - save SP of current thread to m_kernelSp, load SP of next thread from m_kernelSp
+//   - start a new thread with empty stack via jump to kernel_entry()
+// IAR and Cosmic parts are not tested, i.e. must be enabled explicitly via compiler option -DKERNEL_UNTESTED_PORT
+#if (defined(__CSMC__) || defined(__ICCSTM8__)) && !defined(KERNEL_UNTESTED_PORT)
+  #error context switch for IAR/Cosmic is untested. Define KERNEL_UNTESTED_PORT to use it anyway
+#endif
+
+#if defined(__CSMC__)
+  #define _KERNEL_PUSH_REGS()     _asm("push c_lreg\n push c_lreg+1\n push c_lreg+2\n push c_lreg+3")
+  #define _KERNEL_POP_REGS()      _asm("pop c_lreg+3\n pop c_lreg+2\n pop c_lreg+1\n pop c_lreg")
+  #define _KERNEL_SAVE_SP()       _asm("ldw x,sp\n ldw _m_kernelSp,x")
+  #define _KERNEL_LOAD_SP()       _asm("ldw x,_m_kernelSp\n ldw sp,x")
+  #define _KERNEL_START()         _asm("jp _kernel_entry")
+#elif defined(__ICCSTM8__)
+  #define _KERNEL_PUSH_REGS()     __asm("PUSH ?b8\n PUSH ?b9\n PUSH ?b10\n PUSH ?b11\n PUSH ?b12\n PUSH ?b13\n PUSH ?b14\n PUSH ?b15")
+  #define _KERNEL_POP_REGS()      __asm("POP ?b15\n POP ?b14\n POP ?b13\n POP ?b12\n POP ?b11\n POP ?b10\n POP ?b9\n POP ?b8")
+  #define _KERNEL_SAVE_SP()       __asm("LDW X, SP\n LDW m_kernelSp, X")
+  #define _KERNEL_LOAD_SP()       __asm("LDW X, m_kernelSp\n LDW SP, X")
+  #define _KERNEL_START()         __asm("JP kernel_entry")
+#elif defined(__SDCC)
+  #define _KERNEL_PUSH_REGS()
+  #define _KERNEL_POP_REGS()
+  #define _KERNEL_SAVE_SP()       __asm__("ldw x, sp\n ldw _m_kernelSp, x")
+  #define _KERNEL_LOAD_SP()       __asm__("ldw x, _m_kernelSp\n ldw sp, x")
+  #if defined(__SDCC_MODEL_LARGE)
+    #define _KERNEL_START()       __asm__("jpf _kernel_entry")
+  #else
+    #define _KERNEL_START()       __asm__("jp _kernel_entry")
+  #endif
+#else
+  #error compiler not supported
+#endif
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// thread control blocks. Index 0 is the idle thread (main)
+static kernel_thread_t    m_kernelThread[KERNEL_THREADS+1];
+
+/// number of used thread control blocks incl. idle thread
+static uint8_t            m_kernelCount;
+
+/// ID of running thread
+static volatile uint8_t   m_kernelCurrent;
+
+/// stack pointer exchanged with KERNEL_TRAP_ISR
+static volatile uint16_t  m_kernelSp;
+
+/// flag for start of new thread. Set in kernel_schedule()
+static volatile uint8_t   m_kernelStart;
+
+/// flag for round-robin switch. Set in kernel_yield()
+static volatile uint8_t   m_kernelYield;
+
+
+/*----------------------------------------------------------
+    MODULE FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void kernel_ready(uint8_t id)
+
+  \brief make thread ready
+
+  \param[in]  id    thread ID
+
+  make thread ready and request a thread switch if it has a higher priority
+  than the running thread. Call with interrupts disabled
+*/
+static void kernel_ready(uint8_t id) {
+
+  m_kernelThread[id].state = KERNEL_READY;
+  if (m_kernelThread[id].prio > m_kernelThread[m_kernelCurrent].prio)
+    g_kernelPending = 1;
+
+} // kernel_ready
+
+
+
+/**
+  \fn uint8_t kernel_waiter(void *obj, uint8_t state)
+
+  \brief find thread with highest priority waiting for an object
+
+  \param[in]  obj     semaphore or mutex
+  \param[in]  state   KERNEL_WAIT_SEM or KERNEL_WAIT_MUTEX
+
+  \return ID of waiting thread, or KERNEL_NONE
+
+  Call with interrupts disabled
+*/
+static uint8_t kernel_waiter(void *obj, uint8_t state) {
+
+  uint8_t   i, id = KERNEL_NONE;
+
+  for (i=1; i<m_kernelCount; i++) {
+    if ((m_kernelThread[i].state == state) && (m_kernelThread[i].wait == obj)) {
+      if ((id == KERNEL_NONE) || (m_kernelThread[i].prio > m_kernelThread[id].prio))
+        id = i;
+    }
+  }
+
+  return(id);
+
+} // kernel_waiter
+
+
+
+/**
+  \fn uint8_t kernel_prio(uint8_t id)
+
+  \brief get effective priority of thread
+
+  \param[in]  id    thread ID
+
+  \return assigned priority, or highest priority of threads waiting for a mutex owned by thread
+
+  Call with interrupts disabled
+*/
+static uint8_t kernel_prio(uint8_t id) {
+
+  uint8_t   i, prio = m_kernelThread[id].base;
+
+  #if (KERNEL_INHERIT)
+    for (i=1; i<m_kernelCount; i++) {
+      if ((m_kernelThread[i].state == KERNEL_WAIT_MUTEX) && (((kernel_mutex_t*) m_kernelThread[i].wait)->owner == id)) {
+        if (m_kernelThread[i].prio > prio)
+          prio = m_kernelThread[i].prio;
+      }
+    }
+  #else
+    (void) i;
+  #endif
+
+  return(prio);
+
+} // kernel_prio
+
+
+
+/**
+  \fn void kernel_schedule(void)
+
+  \brief select next thread
+
+  store stack pointer of current thread and select the ready thread with the
+  highest priority. Threads of equal priority are selected round-robin on
+  kernel_yield(), else the current thread is preferred. Is called from
+  KERNEL_TRAP_ISR with interrupts disabled
+*/
+static void kernel_schedule(void) {
+
+  uint8_t   i, id, next;
+  uint8_t   prio;
+
+  // store stack pointer of current thread
+  m_kernelThread[m_kernelCurrent].sp = m_kernelSp;
+
+  // start search after current thread for kernel_yield(), else at current thread
+  id = m_kernelCurrent;
+  if (!m_kernelYield)
+    id = (id == 0) ? (m_kernelCount - 1) : (id - 1);
+  m_kernelYield   = 0;
+  g_kernelPending = 0;
+
+  // find ready thread with highest priority. Idle thread is always ready
+  next = 0;
+  prio = 0;
+  for (i=0; i<m_kernelCount; i++) {
+    if (++id >= m_kernelCount)
+      id = 0;
+    if ((m_kernelThread[id].state <= KERNEL_NEW) && (m_kernelThread[id].prio > prio)) {
+      next = id;
+      prio = m_kernelThread[id].prio;
+    }
+  }
+
+  // new thread -> start with empty stack
+  m_kernelStart = (m_kernelThread[next].state == KERNEL_NEW);
+  m_kernelThread[next].state = KERNEL_READY;
+
+  // load stack pointer of next thread
+  m_kernelCurrent = next;
+  m_kernelSp = m_kernelThread[next].sp;
+
+} // kernel_schedule
+
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void kernel_init(void)
+
+  \brief init kernel
+
+  init thread table and 1ms tick via TIM4. The caller (main) becomes the idle
+  thread with priority 0, which runs if no other thread is ready
+*/
+void kernel_init(void) {
+
+  // idle thread uses the main stack
+  m_kernelThread[0].base  = 0;
+  m_kernelThread[0].prio  = 0;
+  m_kernelThread[0].state = KERNEL_READY;
+  m_kernelThread[0].stack = NULL;
+  m_kernelCount   = 1;
+  m_kernelCurrent = 0;
+  g_kernelTicks   = 0;
+  g_kernelNest    = 0;
+  g_kernelPending = 0;
+
+  // for low-power device activate TIM4 clock
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN12 = 1;
+  #endif
+
+  // TIM4 with 16MHz/2^6 = 250kHz -> 4us, reload 250 -> 1ms
+  sfr_TIM4.CR1.CEN   = 0;
+  sfr_TIM4.CNTR.byte = 0x00;
+  sfr_TIM4.CR1.ARPE  = 1;
+  sfr_TIM4.PSCR.PSC  = 6;
+  sfr_TIM4.ARR.byte  = 250;
+  sfr_TIM4.IER.UIE   = 1;
+  sfr_TIM4.CR1.CEN   = 1;
+
+} // kernel_init
+
+
+
+/**
+  \fn uint8_t kernel_thread_create(kernel_func_t func, uint8_t prio, uint8_t *stack, uint16_t size)
+
+  \brief create thread
+
+  \param[in]  func    thread function
+  \param[in]  prio    priority 1..255 (higher value = higher priority)
+  \param[in]  stack   stack of thread
+  \param[in]  size    size of stack [B], see stacks.h
+
+  \return thread ID, or KERNEL_NONE if table is full or priority invalid
+
+  create thread, which is started at next thread switch. The stack is filled
+  with KERNEL_STACK_FILL for kernel_stack_used(). If 'func' returns, the thread
+  is terminated
+*/
+uint8_t kernel_thread_create(kernel_func_t func, uint8_t prio, uint8_t *stack, uint16_t size) {
+
+  uint8_t           id;
+  uint16_t          i;
+  kernel_thread_t   *t;
+
+  // check parameters
+  if ((m_kernelCount > KERNEL_THREADS) || (prio == 0))
+    return(KERNEL_NONE);
+
+  // fill stack for measurement of stack usage
+  for (i=0; i<size; i++)
+    stack[i] = KERNEL_STACK_FILL;
+
+  // init thread control block. SP points to first free byte
+  ENTER_CRITICAL();
+    id = m_kernelCount;
+    t = &(m_kernelThread[id]);
+    t->sp      = (uint16_t) (stack + size - 1);
+    t->func    = func;
+    t->stack   = stack;
+    t->size    = size;
+    t->base    = prio;
+    t->prio    = prio;
+    t->timeout = 0;
+    t->wait    = NULL;
+    t->state   = KERNEL_NEW;
+    m_kernelCount++;
+  EXIT_CRITICAL();
+
+  return(id);
+
+} // kernel_thread_create
+
+
+
+/**
+  \fn void kernel_start(void)
+
+  \brief start scheduling
+
+  enable interrupts and switch to the highest priority thread. Returns when
+  no other thread is ready, i.e. the caller continues as idle thread
+*/
+void kernel_start(void) {
+
+  ENABLE_INTERRUPTS();
+  TRIGGER_TRAP;
+
+} // kernel_start
+
+
+
+/**
+  \fn void kernel_yield(void)
+
+  \brief switch to next thread of same priority
+
+  switch to the next ready thread with the same priority (round-robin). If
+  there is none, the current thread continues
+*/
+void kernel_yield(void) {
+
+  m_kernelYield = 1;
+  TRIGGER_TRAP;
+
+} // kernel_yield
+
+
+
+/**
+  \fn void kernel_sleep(uint16_t ticks)
+
+  \brief wait for 'ticks' ms
+
+  \param[in]  ticks   duration [ms]. 0 = kernel_yield()
+
+  suspend thread for 'ticks' ms. Lower priority threads run meanwhile
+*/
+void kernel_sleep(uint16_t ticks) {
+
+  // no delay -> only yield
+  if (ticks == 0) {
+    kernel_yield();
+    return;
+  }
+
+  // suspend until tick ISR makes thread ready
+  ENTER_CRITICAL();
+    m_kernelThread[m_kernelCurrent].timeout = ticks;
+    m_kernelThread[m_kernelCurrent].state   = KERNEL_SLEEP;
+  EXIT_CRITICAL();
+  TRIGGER_TRAP;
+
+} // kernel_sleep
+
+
+
+/**
+  \fn uint8_t kernel_thread_id(void)
+
+  \brief get ID of running thread
+
+  \return ID of running thread. 0 = idle thread (main)
+*/
+uint8_t kernel_thread_id(void) {
+
+  return(m_kernelCurrent);
+
+} // kernel_thread_id
+
+
+
+/**
+  \fn uint16_t kernel_stack_used(uint8_t id)
+
+  \brief get max. stack usage of thread
+
+  \param[in]  id    thread ID
+
+  \return max. stack usage so far [B], or 0 for idle thread
+
+  count bytes at start (=bottom) of stack, which still contain KERNEL_STACK_FILL.
+  Validates the stack size of the static analysis, see stacks.h
+*/
+uint16_t kernel_stack_used(uint8_t id) {
+
+  uint16_t  i;
+
+  // idle thread or invalid ID
+  if ((id == 0) || (id >= m_kernelCount))
+    return(0);
+
+  // count untouched bytes from bottom of stack
+  for (i=0; (i<m_kernelThread[id].size) && (m_kernelThread[id].stack[i] == KERNEL_STACK_FILL); i++);
+
+  return(m_kernelThread[id].size - i);
+
+} // kernel_stack_used
+
+
+
+/**
+  \fn void kernel_sem_init(kernel_sem_t *sem, uint8_t count)
+
+  \brief init semaphore
+
+  \param[in]  sem     semaphore
+  \param[in]  count   initial number of tokens
+*/
+void kernel_sem_init(kernel_sem_t *sem, uint8_t count) {
+
+  sem->count = count;
+
+} // kernel_sem_init
+
+
+
+/**
+  \fn uint8_t kernel_sem_take(kernel_sem_t *sem, uint16_t timeout)
+
+  \brief take semaphore
+
+  \param[in]  sem       semaphore
+  \param[in]  timeout   max. waiting time [ms], 0 = no wait, KERNEL_FOREVER = wait forever
+
+  \return 1 on success, 0 on timeout
+
+  take a token of semaphore. If none is available, wait until the semaphore
+  is given or timeout
+*/
+uint8_t kernel_sem_take(kernel_sem_t *sem, uint16_t timeout) {
+
+  kernel_thread_t   *t = &(m_kernelThread[m_kernelCurrent]);
+  uint8_t           result = 1;
+
+  ENTER_CRITICAL();
+    if (sem->count)
+      sem->count--;
+    else if (timeout == 0)
+      result = 0;
+    else {
+      t->timeout = timeout;
+      t->wait    = sem;
+      t->state   = KERNEL_WAIT_SEM;
+      result = 2;
+    }
+  EXIT_CRITICAL();
+
+  // wait. kernel_sem_give() clears 'wait', timeout keeps it
+  if (result == 2) {
+    TRIGGER_TRAP;
+    result = (t->wait == NULL);
+    t->wait = NULL;
+  }
+
+  return(result);
+
+} // kernel_sem_take
+
+
+
+/**
+  \fn void kernel_sem_give_isr(kernel_sem_t *sem)
+
+  \brief give semaphore from ISR
+
+  \param[in]  sem   semaphore
+
+  pass token to the highest priority waiting thread, else increase count.
+  The thread switch is done by KERNEL_ISR_EXIT() of the outermost ISR
+*/
+void kernel_sem_give_isr(kernel_sem_t *sem) {
+
+  uint8_t   id;
+
+  ENTER_CRITICAL();
+    id = kernel_waiter(sem, KERNEL_WAIT_SEM);
+    if (id != KERNEL_NONE) {
+      m_kernelThread[id].wait = NULL;
+      kernel_ready(id);
+    }
+    else if (sem->count < 0xFF)
+      sem->count++;
+  EXIT_CRITICAL();
+
+} // kernel_sem_give_isr
+
+
+
+/**
+  \fn void kernel_sem_give(kernel_sem_t *sem)
+
+  \brief give semaphore from thread
+
+  \param[in]  sem   semaphore
+
+  pass token to the highest priority waiting thread, else increase count.
+  If the woken thread has a higher priority, switch immediately
+*/
+void kernel_sem_give(kernel_sem_t *sem) {
+
+  kernel_sem_give_isr(sem);
+  if (g_kernelPending)
+    TRIGGER_TRAP;
+
+} // kernel_sem_give
+
+
+
+/**
+  \fn void kernel_mutex_init(kernel_mutex_t *mutex)
+
+  \brief init mutex
+
+  \param[in]  mutex   mutex
+*/
+void kernel_mutex_init(kernel_mutex_t *mutex) {
+
+  mutex->owner = KERNEL_NONE;
+
+} // kernel_mutex_init
+
+
+
+/**
+  \fn void kernel_mutex_lock(kernel_mutex_t *mutex)
+
+  \brief lock mutex
+
+  \param[in]  mutex   mutex
+
+  lock mutex. If it is owned by another thread, raise the priority of the owner
+  (and of the owner of a mutex the owner waits for, etc.) to the priority of
+  the caller and wait. Mutexes are not recursive and must not be used in ISRs
+*/
+void kernel_mutex_lock(kernel_mutex_t *mutex) {
+
+  kernel_thread_t   *t = &(m_kernelThread[m_kernelCurrent]);
+  uint8_t           wait = 0;
+  uint8_t           owner;
+
+  ENTER_CRITICAL();
+    if (mutex->owner == KERNEL_NONE)
+      mutex->owner = m_kernelCurrent;
+    else {
+      t->timeout = KERNEL_FOREVER;
+      t->wait    = mutex;
+      t->state   = KERNEL_WAIT_MUTEX;
+      wait = 1;
+
+      // priority inheritance along chain of owners
+      #if (KERNEL_INHERIT)
+        owner = mutex->owner;
+        while ((owner != KERNEL_NONE) && (m_kernelThread[owner].prio < t->prio)) {
+          m_kernelThread[owner].prio = t->prio;
+          if (m_kernelThread[owner].state != KERNEL_WAIT_MUTEX)
+            break;
+          owner = ((kernel_mutex_t*) m_kernelThread[owner].wait)->owner;
+        }
+      #else
+        (void) owner;
+      #endif
+    }
+  EXIT_CRITICAL();
+
+  // wait. kernel_mutex_unlock() passes the mutex to this thread
+  if (wait)
+    TRIGGER_TRAP;
+
+} // kernel_mutex_lock
+
+
+
+/**
+  \fn void kernel_mutex_unlock(kernel_mutex_t *mutex)
+
+  \brief unlock mutex
+
+  \param[in]  mutex   mutex
+
+  pass mutex to the highest priority waiting thread and restore priority
+  of the caller. If a thread with higher priority is ready, switch immediately
+*/
+void kernel_mutex_unlock(kernel_mutex_t *mutex) {
+
+  uint8_t   id, prio;
+
+  ENTER_CRITICAL();
+
+    // pass to highest priority waiting thread
+    id = kernel_waiter(mutex, KERNEL_WAIT_MUTEX);
+    mutex->owner = id;
+
+    // restore priority of caller, switch if it is lowered
+    prio = kernel_prio(m_kernelCurrent);
+    if (prio < m_kernelThread[m_kernelCurrent].prio) {
+      m_kernelThread[m_kernelCurrent].prio = prio;
+      g_kernelPending = 1;
+    }
+
+    // new owner inherits priority of remaining waiting threads. Leave KERNEL_WAIT_MUTEX
+    // before kernel_prio(), which follows 'wait' of all threads in this state
+    if (id != KERNEL_NONE) {
+      m_kernelThread[id].wait  = NULL;
+      m_kernelThread[id].state = KERNEL_READY;
+      m_kernelThread[id].prio  = kernel_prio(id);
+      kernel_ready(id);
+    }
+
+  EXIT_CRITICAL();
+
+  if (g_kernelPending)
+    TRIGGER_TRAP;
+
+} // kernel_mutex_unlock
+
+
+
+/**
+  \fn void kernel_entry(void)
+
+  \brief entry of new threads
+
+  is entered via jump from KERNEL_TRAP_ISR with the empty stack of the new
+  thread. Enable interrupts and call thread function. If it returns,
+  terminate the thread
+*/
+void kernel_entry(void) {
+
+  // trap level -> thread level
+  ENABLE_INTERRUPTS();
+
+  // execute thread
+  m_kernelThread[m_kernelCurrent].func();
+
+  // thread returned -> never run again
+  DISABLE_INTERRUPTS();
+  m_kernelThread[m_kernelCurrent].state = KERNEL_DEAD;
+  TRIGGER_TRAP;
+  while (1);
+
+} // kernel_entry
+
+
+
+/**
+  \fn void KERNEL_TRAP_ISR(void)
+
+  \brief TRAP handler for context switch
+
+  context switch between threads. The CPU context (PC, Y, X, A, CC) is pushed
+  by TRAP and restored by IRET, the compiler pseudo registers are pushed
+  explicitely. Only the stack pointer is exchanged, i.e. the context of
+  each suspended thread is on its stack:
+    - TRAP in thread (kernel_yield(), blocking calls): CPU context
+    - TRAP in KERNEL_ISR_EXIT(): CPU context of ISR, i.e. the ISR is completed after thread is resumed
+  Note:
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: requires additional entry in file stm8_interrupt_vector.c
+    IAR: no additional measures
+*/
+ISR_HANDLER_TRAP(KERNEL_TRAP_ISR) {
+
+  // save context of current thread
+  _KERNEL_PUSH_REGS();
+  _KERNEL_SAVE_SP();
+
+  // select next thread
+  kernel_schedule();
+
+  // restore context of next thread. New thread -> jump to kernel_entry() (doesn't return)
+  _KERNEL_LOAD_SP();
+  if (m_kernelStart)
+    _KERNEL_START();
+  _KERNEL_POP_REGS();
+
+} // KERNEL_TRAP_ISR
+
+
+
+/**
+  \fn void TIM4_UPD_ISR(void)
+
+  \brief ISR for timer 4 (1ms kernel tick)
+
+  increase tick counter and make threads ready, whose sleep time or timeout
+  has expired. A higher priority thread is started on exit of the ISR
+  Note:
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: requires additional entry in file stm8_interrupt_vector.c
+    IAR: no additional measures
+*/
+#if defined(_TIM4_OVR_UIF_VECTOR_)
+  ISR_HANDLER(TIM4_UPD_ISR, _TIM4_OVR_UIF_VECTOR_)
+#elif defined(_TIM4_UIF_VECTOR_)
+  ISR_HANDLER(TIM4_UPD_ISR, _TIM4_UIF_VECTOR_)
+#else
+  #error TIM4 vector undefined
+#endif
+{
+  uint8_t           i;
+  kernel_thread_t   *t;
+
+  KERNEL_ISR_ENTER();
+
+  // clear timer 4 interrupt flag
+  #if defined(FAMILY_STM8S)
+    sfr_TIM4.SR.UIF = 0;
+  #else
+    sfr_TIM4.SR1.UIF = 0;
+  #endif
+
+  g_kernelTicks++;
+
+  // check sleep times and timeouts. Semaphore timeout keeps 'wait'
+  for (i=1; i<m_kernelCount; i++) {
+    t = &(m_kernelThread[i]);
+    if ((t->state >= KERNEL_SLEEP) && (t->state <= KERNEL_WAIT_MUTEX) && (t->timeout != KERNEL_FOREVER)) {
+      if (--(t->timeout) == 0)
+        kernel_ready(i);
+    }
+  }
+
+  KERNEL_ISR_EXIT();
+
+} // TIM4_UPD_ISR
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
@@ -0,0 +1,195 @@
+/**
+  \file kernel.h
+
+  \author G. Icking-Konert
+  \date 2021-10-10
+  \version 0.1
+
+  \brief declaration of a minimal preemptive kernel
+
+  declaration of a minimal preemptive kernel with fixed-priority threads:
+
+    - context switch via TRAP. The CPU pushes PC, Y, X, A and CC on trap entry,
+      KERNEL_TRAP_ISR additionally saves the compiler pseudo registers (IAR, Cosmic),
+      stores the stack pointer of the running thread and loads the stack pointer of
+      the next thread
+    - threads with static priority 1..255 and own stack. The stack size is
+      determined by static analysis, see stacks.h. main() continues as idle thread
+      with priority 0 after kernel_start()
+    - the highest priority ready thread runs. Threads of equal priority are switched
+      round-robin on kernel_yield(), not on tick
+    - 1ms tick via TIM4 for kernel_sleep() and timeouts
+    - ISRs which make a thread ready (tick, kernel_sem_give_isr()) request a switch,
+      which is done via TRAP on exit of the outermost ISR, see KERNEL_ISR_EXIT()
+    - mutexes with priority inheritance: the owner of a mutex runs with the highest
+      priority of the threads waiting for it
+    - counting semaphores with timeout. Can be given from ISRs
+
+  \note ISRs run on the stack of the interrupted thread, i.e. each thread stack must hold the worst-case ISR nesting
+  \note the scheduler runs inside the TRAP handler with interrupts disabled. Max. duration is O(KERNEL_THREADS)
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _KERNEL_H_
+#define _KERNEL_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// max. number of threads excl. idle thread (main); can be overwritten via compiler option
+#if !defined(KERNEL_THREADS)
+  #define KERNEL_THREADS          6
+#endif
+
+// priority inheritance of mutexes (=1) or plain mutexes for comparison (=0); can be overwritten via compiler option
+#if !defined(KERNEL_INHERIT)
+  #define KERNEL_INHERIT          1
+#endif
+
+#define KERNEL_NONE               0xFF          ///< invalid thread ID, e.g. mutex without owner
+#define KERNEL_FOREVER            0xFFFF        ///< timeout: wait forever
+#define KERNEL_STACK_FILL         0xAA          ///< pattern of unused stack, see kernel_stack_used()
+
+// thread states
+#define KERNEL_READY              0             ///< ready to run or running
+#define KERNEL_NEW                1             ///< ready, not yet started
+#define KERNEL_SLEEP              2             ///< waiting in kernel_sleep()
+#define KERNEL_WAIT_SEM           3             ///< waiting for semaphore
+#define KERNEL_WAIT_MUTEX         4             ///< waiting for mutex
+#define KERNEL_DEAD               5             ///< thread function returned
+
+/// milliseconds since kernel_init(). Overflows after 65.5s
+#define kernel_ticks()            g_kernelTicks
+
+/// call at start of ISRs which use kernel functions
+#define KERNEL_ISR_ENTER()        g_kernelNest++
+
+/// call at end of ISRs which use kernel functions. On exit of outermost ISR switch thread via TRAP if required
+#define KERNEL_ISR_EXIT()         { if ((--g_kernelNest == 0) && (g_kernelPending)) TRIGGER_TRAP; }
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL TYPEDEFS
+-----------------------------------------------------------------------------*/
+
+/// thread function
+typedef void (*kernel_func_t)(void);
+
+/// thread control block
+typedef struct {
+  uint16_t            sp;                       ///< saved stack pointer
+  kernel_func_t       func;                     ///< thread function
+  uint8_t             *stack;                   ///< start of stack
+  uint16_t            size;                     ///< size of stack [B]
+  uint8_t             base;                     ///< assigned priority
+  volatile uint8_t    prio;                     ///< effective priority (>= base via priority inheritance)
+  volatile uint8_t    state;                    ///< thread state, see KERNEL_READY etc.
+  volatile uint16_t   timeout;                  ///< remaining ticks of kernel_sleep() or timeout
+  void * volatile     wait;                     ///< semaphore or mutex the thread is waiting for
+} kernel_thread_t;
+
+/// counting semaphore
+typedef struct {
+  volatile uint8_t    count;                    ///< number of available tokens
+} kernel_sem_t;
+
+/// mutex with priority inheritance
+typedef struct {
+  volatile uint8_t    owner;                    ///< ID of owner thread, or KERNEL_NONE
+} kernel_mutex_t;
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL VARIABLES
+-----------------------------------------------------------------------------*/
+
+// declare or reference to global variables, depending on '_MAIN_'
+#if defined(_MAIN_)
+  volatile uint16_t           g_kernelTicks;            ///< 1ms counter. Increased in TIM4 ISR
+  volatile uint8_t            g_kernelNest;             ///< ISR nesting level, see KERNEL_ISR_ENTER()
+  volatile uint8_t            g_kernelPending;          ///< thread switch requested by ISR
+#else // _MAIN_
+  extern volatile uint16_t    g_kernelTicks;
+  extern volatile uint8_t     g_kernelNest;
+  extern volatile uint8_t     g_kernelPending;
+#endif // _MAIN_
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// init kernel and 1ms tick (TIM4). Caller (main) becomes idle thread
+void      kernel_init(void);
+
+/// create thread with priority 1..255 and stack. Return thread ID or KERNEL_NONE
+uint8_t   kernel_thread_create(kernel_func_t func, uint8_t prio, uint8_t *stack, uint16_t size);
+
+/// start scheduling. Returns in idle thread
+void      kernel_start(void);
+
+/// switch to next ready thread of same priority
+void      kernel_yield(void);
+
+/// wait for 'ticks' ms
+void      kernel_sleep(uint16_t ticks);
+
+/// return ID of running thread
+uint8_t   kernel_thread_id(void);
+
+/// return max. stack usage of thread [B]
+uint16_t  kernel_stack_used(uint8_t id);
+
+/// init semaphore with 'count' tokens
+void      kernel_sem_init(kernel_sem_t *sem, uint8_t count);
+
+/// take semaphore, wait max. 'timeout' ms. Return 1 on success, 0 on timeout
+uint8_t   kernel_sem_take(kernel_sem_t *sem, uint16_t timeout);
+
+/// give semaphore from thread
+void      kernel_sem_give(kernel_sem_t *sem);
+
+/// give semaphore from ISR. Requires KERNEL_ISR_ENTER() and KERNEL_ISR_EXIT()
+void      kernel_sem_give_isr(kernel_sem_t *sem);
+
+/// init mutex
+void      kernel_mutex_init(kernel_mutex_t *mutex);
+
+/// lock mutex. Wait until available
+void      kernel_mutex_lock(kernel_mutex_t *mutex);
+
+/// unlock mutex. Must be called by owner
+void      kernel_mutex_unlock(kernel_mutex_t *mutex);
+
+/// entry of new threads. Is called via jump from KERNEL_TRAP_ISR
+void      kernel_entry(void);
+
+/// TRAP handler for context switch
+ISR_HANDLER_TRAP(KERNEL_TRAP_ISR);
+
+/// ISR for timer 4 (1ms kernel tick)
+#if defined(_TIM4_OVR_UIF_VECTOR_)
+  ISR_HANDLER(TIM4_UPD_ISR, _TIM4_OVR_UIF_VECTOR_);
+#elif defined(_TIM4_UIF_VECTOR_)
+  ISR_HANDLER(TIM4_UPD_ISR, _TIM4_UIF_VECTOR_);
+#else
+  #error TIM4 vector undefined
+#endif
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _KERNEL_H_
@@ -0,0 +1,435 @@
+/**********************
+  Minimal preemptive kernel: context switch time and priority inheritance
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - STM8L Discovery board (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - TIM2 runs free at 16MHz as time base, i.e. 1 tick = 1 CPU cycle
+    - thread_ping wakes thread_high via semaphore. Then thread_ping and thread_pong (priority 2)
+      switch BENCH_SWITCHES times via kernel_yield(), i.e. TRAP, and sleep BENCH_PAUSE
+    - thread_high (priority 3) measures the switch time from kernel_sem_give() to return
+      of kernel_sem_take(), then accesses a resource shared with thread_report via mutex
+    - thread_isr (priority 4) measures the latency from TIM2 overflow to return of kernel_sem_take().
+      The TIM2 ISR gives the semaphore
+    - thread_report (priority 1) prints min/avg/max [cycles] every 1s via UART (19.2kBaud).
+      It holds the mutex while printing -> priority inheritance keeps thread_ping/thread_pong
+      from delaying thread_high (KERNEL_INHERIT=1). Max. wait of thread_high is printed
+    - main() continues as idle thread
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+  #include "kernel.h"
+#undef _MAIN_
+#include "stacks.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define BENCH_SWITCHES    100                     // thread switches via kernel_yield() per cycle
+#define BENCH_PAUSE       5                       // pause between cycles [ms]
+#define REPORT_PERIOD     1000                    // print period [ms]
+
+// stack size of thread: static analysis or estimate (stacks.h) plus reserve
+#define STACK_RESERVE     16
+#define STACK_SIZE(func)  (STACK_##func + STACK_RESERVE)
+
+
+/*----------------------------------------------------------
+    GLOBAL TYPEDEFS
+----------------------------------------------------------*/
+
+/// statistics of a measurement [cycles]
+typedef struct {
+  uint16_t  min;
+  uint16_t  max;
+  uint32_t  sum;
+  uint16_t  num;
+} bench_t;
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// thread stacks. Size by static analysis or estimate, see stacks.h
+static uint8_t            m_stackIsr[STACK_SIZE(thread_isr)];
+static uint8_t            m_stackHigh[STACK_SIZE(thread_high)];
+static uint8_t            m_stackPing[STACK_SIZE(thread_ping)];
+static uint8_t            m_stackPong[STACK_SIZE(thread_pong)];
+static uint8_t            m_stackReport[STACK_SIZE(thread_report)];
+
+/// thread IDs for stack usage
+static uint8_t            m_idIsr, m_idHigh, m_idPing, m_idPong, m_idReport;
+
+/// semaphores for thread_isr (given by TIM2 ISR) and thread_high (given by thread_ping)
+static kernel_sem_t       m_semIsr, m_semHigh;
+
+/// mutex for resource shared by thread_high and thread_report
+static kernel_mutex_t     m_mutex;
+
+/// time before thread switch [cycles]
+static volatile uint16_t  m_switchStart;
+
+/// measurements: switch via kernel_yield(), kernel_sem_give() -> kernel_sem_take(), TIM2 overflow -> kernel_sem_take()
+static bench_t            m_benchYield, m_benchSem, m_benchIsr;
+
+/// max. wait of thread_high for mutex [ms]
+static volatile uint16_t  m_mutexWait;
+
+/// shared resource, protected by m_mutex
+static uint16_t           m_shared;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn uint16_t bench_time(void)
+
+  \brief read TIM2 counter
+
+  \return  TIM2 counter [cycles]
+*/
+static uint16_t bench_time(void) {
+
+  uint16_t  t;
+
+  READ16(t, sfr_TIM2, CNTR);
+
+  return(t);
+
+} // bench_time
+
+
+
+/**
+  \fn void bench_add(bench_t *bench, uint16_t t)
+
+  \brief add measurement to statistics
+
+  \param[in]  bench   statistics
+  \param[in]  t       measured time [cycles]
+*/
+static void bench_add(bench_t *bench, uint16_t t) {
+
+  if ((bench->num == 0) || (t < bench->min))
+    bench->min = t;
+  if (t > bench->max)
+    bench->max = t;
+  bench->sum += t;
+  bench->num++;
+
+} // bench_add
+
+
+
+/**
+  \fn void bench_print(const char *name, bench_t *bench)
+
+  \brief print statistics
+
+  \param[in]  name    name of measurement
+  \param[in]  bench   statistics
+*/
+static void bench_print(const char *name, bench_t *bench) {
+
+  if (bench->num == 0)
+    printf("  %-24s -\n", name);
+  else
+    printf("  %-24s min %5u  avg %5u  max %5u  (n=%u)\n", name, bench->min, (uint16_t) (bench->sum / bench->num), bench->max, bench->num);
+
+} // bench_print
+
+
+
+/**
+  \fn void bench_yield(void)
+
+  \brief measure thread switch via kernel_yield()
+
+  switch BENCH_SWITCHES times to the other thread of same priority. The time
+  is measured from before kernel_yield() in one thread to return of kernel_yield()
+  in the other thread
+*/
+static void bench_yield(void) {
+
+  uint8_t   i;
+
+  for (i=0; i<BENCH_SWITCHES; i++) {
+    m_switchStart = bench_time();
+    kernel_yield();
+    bench_add(&m_benchYield, (uint16_t) (bench_time() - m_switchStart));
+  }
+
+} // bench_yield
+
+
+
+/**
+  \fn void thread_ping(void)
+
+  \brief thread for switch via kernel_sem_give() and kernel_yield()
+
+  wake thread_high via semaphore, switch with thread_pong, then pause
+*/
+void thread_ping(void) {
+
+  while (1) {
+
+    // switch to thread_high via semaphore
+    m_switchStart = bench_time();
+    kernel_sem_give(&m_semHigh);
+
+    // switch with thread_pong
+    bench_yield();
+
+    kernel_sleep(BENCH_PAUSE);
+
+  }
+
+} // thread_ping
+
+
+
+/**
+  \fn void thread_pong(void)
+
+  \brief thread for switch via kernel_yield()
+
+  switch with thread_ping, then pause
+*/
+void thread_pong(void) {
+
+  while (1) {
+    bench_yield();
+    kernel_sleep(BENCH_PAUSE);
+  }
+
+} // thread_pong
+
+
+
+/**
+  \fn void thread_high(void)
+
+  \brief high priority thread woken by thread_ping
+
+  measure time from kernel_sem_give() in thread_ping to return of
+  kernel_sem_take(), then access resource shared with thread_report
+*/
+void thread_high(void) {
+
+  uint16_t  t, start;
+
+  while (1) {
+
+    // wait for thread_ping
+    kernel_sem_take(&m_semHigh, KERNEL_FOREVER);
+    t = bench_time();
+    bench_add(&m_benchSem, (uint16_t) (t - m_switchStart));
+
+    // access shared resource. Without priority inheritance thread_ping/thread_pong may delay the owner thread_report
+    start = kernel_ticks();
+    kernel_mutex_lock(&m_mutex);
+    t = kernel_ticks() - start;
+    if (t > m_mutexWait)
+      m_mutexWait = t;
+    m_shared++;
+    kernel_mutex_unlock(&m_mutex);
+
+  }
+
+} // thread_high
+
+
+
+/**
+  \fn void thread_isr(void)
+
+  \brief highest priority thread woken by TIM2 ISR
+
+  measure time from TIM2 overflow (counter = 0) to return of kernel_sem_take(),
+  i.e. ISR latency + ISR + thread switch
+*/
+void thread_isr(void) {
+
+  while (1) {
+    kernel_sem_take(&m_semIsr, KERNEL_FOREVER);
+    bench_add(&m_benchIsr, bench_time());
+  }
+
+} // thread_isr
+
+
+
+/**
+  \fn void thread_report(void)
+
+  \brief low priority thread for output
+
+  every REPORT_PERIOD print and reset measurements. The shared resource is
+  locked while printing
+*/
+void thread_report(void) {
+
+  bench_t   yield, sem, isr;
+  uint16_t  wait;
+
+  while (1) {
+
+    kernel_sleep(REPORT_PERIOD);
+
+    // copy and reset measurements
+    ENTER_CRITICAL();
+      yield = m_benchYield;
+      sem   = m_benchSem;
+      isr   = m_benchIsr;
+      wait  = m_mutexWait;
+      m_benchYield.num = m_benchSem.num = m_benchIsr.num = 0;
+      m_benchYield.max = m_benchSem.max = m_benchIsr.max = 0;
+      m_benchYield.sum = m_benchSem.sum = m_benchIsr.sum = 0;
+      m_mutexWait = 0;
+    EXIT_CRITICAL();
+
+    // print with locked resource
+    kernel_mutex_lock(&m_mutex);
+    printf("\nt=%us, thread switch [cycles]:\n", kernel_ticks() / 1000);
+    bench_print("yield (TRAP)", &yield);
+    bench_print("sem thread->thread", &sem);
+    bench_print("sem TIM2 ISR->thread", &isr);
+    printf("  mutex wait of thread_high max %ums (inheritance %s), %u accesses\n", wait, (KERNEL_INHERIT) ? "on" : "off", m_shared);
+    printf("  stack used/size [B]: isr %u/%u, high %u/%u, ping %u/%u, pong %u/%u, report %u/%u\n",
+      kernel_stack_used(m_idIsr), (uint16_t) sizeof(m_stackIsr), kernel_stack_used(m_idHigh), (uint16_t) sizeof(m_stackHigh),
+      kernel_stack_used(m_idPing), (uint16_t) sizeof(m_stackPing), kernel_stack_used(m_idPong), (uint16_t) sizeof(m_stackPong),
+      kernel_stack_used(m_idReport), (uint16_t) sizeof(m_stackReport));
+    kernel_mutex_unlock(&m_mutex);
+
+  }
+
+} // thread_report
+
+
+
+/**
+  \fn void TIM2_UPD_ISR(void)
+
+  \brief ISR for timer 2 overflow
+
+  give semaphore to thread_isr. The thread switch is done on exit of the ISR
+  Note:
+    SDCC: ISR must be declared in file containing main(). Header inclusion is ok
+    Cosmic: requires additional entry in file stm8_interrupt_vector.c
+    IAR: no additional measures
+*/
+ISR_HANDLER(TIM2_UPD_ISR, _TIM2_OVR_UIF_VECTOR_) {
+
+  KERNEL_ISR_ENTER();
+
+  // clear timer 2 interrupt flag
+  sfr_TIM2.SR1.UIF = 0;
+
+  // wake thread_isr
+  kernel_sem_give_isr(&m_semIsr);
+
+  KERNEL_ISR_EXIT();
+
+} // TIM2_UPD_ISR
+
+
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // TIM2 runs free with 16MHz, overflow interrupt every 4.1ms
+  #if defined(FAMILY_STM8L)
+    sfr_CLK.PCKENR1.PCKEN10 = 1;
+  #endif
+  sfr_TIM2.PSCR.byte = 0x00;
+  sfr_TIM2.IER.UIE   = 1;
+  sfr_TIM2.CR1.CEN   = 1;
+
+  // init kernel and 1ms tick
+  kernel_init();
+
+  // init synchronization objects
+  kernel_sem_init(&m_semIsr, 0);
+  kernel_sem_init(&m_semHigh, 0);
+  kernel_mutex_init(&m_mutex);
+
+  // create threads
+  m_idIsr    = kernel_thread_create(thread_isr,    4, m_stackIsr,    sizeof(m_stackIsr));
+  m_idHigh   = kernel_thread_create(thread_high,   3, m_stackHigh,   sizeof(m_stackHigh));
+  m_idPing   = kernel_thread_create(thread_ping,   2, m_stackPing,   sizeof(m_stackPing));
+  m_idPong   = kernel_thread_create(thread_pong,   2, m_stackPong,   sizeof(m_stackPong));
+  m_idReport = kernel_thread_create(thread_report, 1, m_stackReport, sizeof(m_stackReport));
+
+  printf("\npreemptive kernel, %u threads\n", (uint16_t) KERNEL_THREADS);
+
+  // start scheduling. main() continues as idle thread
+  kernel_start();
+
+
+  // idle loop
+  while(1) {
+
+    // wait for next interrupt
+    WAIT_FOR_INTERRUPT();
+
+  } // idle loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
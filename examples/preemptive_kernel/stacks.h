@@ -0,0 +1,48 @@
+/**
+  \file stacks.h
+
+  \brief worst-case stack depth of threads [B]
+
+  ESTIMATES, not the output of the static analyser: SDCC was not available,
+  i.e. 'make stack' has not been run yet. Values are a manual analysis of the
+  call tree for SDCC (call = 2B, parameters on stack, frame = locals + 4B for
+  temporaries) incl. kernel entry, context switch via TRAP and worst-case ISR
+  nesting. 'make stack' overwrites this file with the result of
+  ../stack_usage/Utils/stack_depth.py; re-build after update.
+
+    - TRAP:  CPU context 9 + KERNEL_TRAP_ISR 2 + kernel_schedule() 8       =  19
+    - ISR:   all ISRs have priority 3, i.e. no nesting. Worst ISR is TIM4_UPD_ISR:
+             context 9 + locals 7 + max(kernel_ready() 7, TRAP 19)          =  35
+    - kernel_entry(): indirect call 2 + frame 4                             =   6
+    - kernel calls incl. TRAP: kernel_yield() 21, kernel_sleep() 30,
+      kernel_sem_take() 33, kernel_sem_give() 29, kernel_mutex_lock() 32,
+      kernel_mutex_unlock() 30
+    - printf(): call 2 + max. 11 parameters 22 + library 80 (same as
+      '-e printf=80' in Makefile, incl. putchar())                          = 104
+
+    thread          frame   deepest call               + entry + ISR   total
+    thread_isr        4     kernel_sem_take()     33       6      35      78
+    thread_high       8     kernel_sem_take()     33       6      35      82
+    thread_ping       4     kernel_sleep()        30       6      35      75
+    thread_pong       4     kernel_sleep()        30       6      35      75
+    thread_report    36     printf()             104       6      35     181
+
+  main.c adds STACK_RESERVE to each value.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _STACKS_H_
+#define _STACKS_H_
+
+#define STACK_thread_isr               78
+#define STACK_thread_high              82
+#define STACK_thread_ping              75
+#define STACK_thread_pong              75
+#define STACK_thread_report            181
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _STACKS_H_
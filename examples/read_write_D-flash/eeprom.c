@@ -39,8 +39,8 @@ uint8_t EEPROM_writeByte(uint16_t logAddr, uint8_t data) {
   if (logAddr > EEPROM_SIZE)
     return(0);
   
-  // begin critical cection (disable interrupts)
-  DISABLE_INTERRUPTS();
+  // begin critical section (disable interrupts, previous state restored at end)
+  ENTER_CRITICAL();
   
   // unlock w/e access to EEPROM
   sfr_FLASH.DUKR.byte = 0xAE;
@@ -59,8 +59,8 @@ uint8_t EEPROM_writeByte(uint16_t logAddr, uint8_t data) {
   // lock EEPROM again against accidental erase/write
   sfr_FLASH.IAPSR.DUL = 0;
   
-  // critical section (enable interrupts)
-  ENABLE_INTERRUPTS();
+  // end critical section (restore interrupt state, i.e. also callable with interrupts disabled)
+  EXIT_CRITICAL();
 
   // write successful -> return 1
   return(countTimeout != 0);
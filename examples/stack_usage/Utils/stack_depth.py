@@ -0,0 +1,627 @@
+#!/usr/bin/env python3
+"""
+static stack depth and ISR nesting analyser for SDCC builds
+
+Parses the SDCC outputs of an example (./SDCC/*.asm, or *.rst/*.lst if no
+.asm exists, optional *.cdb and *.map), builds the call graph incl. the
+ISR_HANDLER entry points and reports the worst-case stack depth
+
+  - per function (incl. callees)
+  - per ISR (incl. 9 bytes of CPU context)
+  - per interrupt nesting level and for the whole program
+
+and compares it with the stack available, i.e. RAM_SIZE minus static data.
+The exit code is 2 if the stack may overflow, i.e. the tool can be used as
+make target, see ../Makefile.
+
+usage:
+  python3 stack_depth.py [SDCC] [-c ../config.h] [-p UART_RXNE_ISR=2] [-n TIM4_UPD_ISR=2] [-e printf=80] [-v]
+  python3 stack_depth.py [SDCC] -t thread_a -t thread_b [-o stacks.h]
+
+Stack tracking:
+  The instructions of each function are followed along all branches. push,
+  pop, sub sp and addw sp change the local depth. A call adds the return
+  address (call 2 bytes, callf 3 bytes) and the depth of the callee. Tail
+  calls via jp/jra/jpf add the callee depth w/o return address.
+
+  Indirect calls (function pointers, e.g. scheduler tasks) are assumed to
+  call any function whose address is taken in the sources ('#_func' or
+  '.dw _func'), except ISRs and the vector table.
+
+  Functions which are not part of the sources (e.g. stm8.lib: printf,
+  _mullong) are external. Their depth is taken from option -e, else it is
+  0 and the result is flagged as incomplete.
+
+Interrupt nesting:
+  By default all ISRs have priority 3, i.e. they cannot interrupt each
+  other, and the worst case is main + deepest ISR. ISRs with lower priority
+  (ITC_SPRx, option -p NAME=1|2) are interrupted by ISRs with higher
+  priority. ISRs which re-enable interrupts ('rim', e.g. Task_Scheduler
+  running tasks in the TIM4 ISR) are interrupted by all other ISRs. Each
+  ISR occurs at most once per nesting chain, unless it re-enables interrupts
+  before its work is done and can interrupt itself (option -n NAME=COUNT,
+  e.g. scheduler tick with tasks longer than 1ms).
+
+Threads of a preemptive kernel:
+  A trap instruction adds the CPU context and the depth of the TRAP handler
+  (vector 'trap'). In the TRAP handler 'ldw sp, x/y' is a context switch,
+  i.e. the code after it runs on the stack of the next thread and is not
+  followed. Thread functions (option -t) are started by the indirect call in
+  kernel_entry() (option -k) on their own stack. Their worst case is
+  kernel_entry() + thread function + worst-case ISR nesting, because ISRs run
+  on the stack of the interrupted thread. Option -o writes the results as
+  STACK_<thread> to a header, e.g. for ../../preemptive_kernel/stacks.h
+
+RAM size:
+  read from the device header included in config.h (RAM_SIZE), or option
+  -r. Static data = areas DATA + INITIALIZED of the .map file, or the sum
+  of '.ds' in these areas of all .asm files (w/o library variables).
+"""
+
+import sys
+import os
+import re
+import glob
+import argparse
+
+
+# CPU context pushed on interrupt entry: PCE, PCH, PCL, YH, YL, XH, XL, A, CC
+ISR_CONTEXT = 9
+
+# return address pushed by call/callr, and by callf
+CALL_SIZE = 2
+CALLF_SIZE = 3
+
+# highest interrupt priority (ITC_SPRx = 3, default after reset)
+PRIO_MAX = 3
+
+# static data areas in SDCC output
+DATA_AREAS = ('DATA', 'INITIALIZED')
+
+# instruction in SDCC assembler output: [label:] [mnemonic [operands]] [; comment]
+ASM_LABEL = re.compile(r'^([\w$.]+)::?\s*(.*)$')
+ASM_INSTR = re.compile(r'^([a-z]+)\s*(.*)$')
+
+# function header comment of SDCC
+ASM_FUNCTION = re.compile(r'^;\s+function\s+(\w+)')
+
+# vector table entry: int _func ; int23
+ASM_VECTOR = re.compile(r'^int\s+(\w+)\s*;\s*(int(\d+)|\w+)')
+
+# function record in .cdb: F:G$name$0_0$0({2}DF,SV:S),Z,0,0,1,23,0
+CDB_FUNCTION = re.compile(r'^F:[GFL]\$(\w+)\$[^(]*\(.*\),(\w+),(\d+),(\d+),(\d+),(\d+),(\d+)')
+
+# listing line of .rst/.lst: address, code bytes, [cycles], line number, source
+LST_LINE = re.compile(r'^.*?\s(\d+)[ \t](\t.*|;.*|[\w$.]+::?.*|)$')
+
+# area size in .map: DATA  00000001  0000002A =  42. bytes (REL,CON)
+MAP_AREA = re.compile(r'^(\w+)\s+(?:0x)?[0-9A-Fa-f]+\s+(?:0x)?[0-9A-Fa-f]+\s*=\s*(\d+)\.\s*bytes')
+
+# RAM size in device header
+HDR_RAM = re.compile(r'^\s*#define\s+RAM_SIZE\s+(\d+)')
+
+# device header in config.h
+CFG_DEVICE = re.compile(r'^\s*#include\s+"([^"]*/include/\w+\.h)"')
+
+
+# header with thread stack sizes (option -o)
+STACK_HEADER = """/**
+  \\file %s
+
+  \\brief worst-case stack depth of threads [B]
+
+  generated by ../stack_usage/Utils/stack_depth.py (make stack). Worst-case
+  depth of each thread function incl. kernel entry, context switch via TRAP
+  and worst-case ISR nesting. Re-build after update.
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef %s
+#define %s
+
+%s
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // %s
+"""
+
+
+class StackError(Exception):
+  pass
+
+
+class Function:
+  """
+  function parsed from assembler source
+  """
+  def __init__(self, name, module):
+    self.name     = name          # C name
+    self.module   = module        # source file
+    self.code     = []            # list of (label, mnemonic, operands)
+    self.isr      = False         # ends with iret
+    self.switch   = False         # context switch via 'ldw sp, x' (TRAP handler of kernel)
+    self.vector   = None          # interrupt vector number
+    self.rim      = False         # enables interrupts
+    self.local    = 0             # max. local depth w/o calls
+    self.calls    = []            # list of (depth at call, callee or None for indirect)
+    self.unknown  = False         # stack pointer modified in unsupported way
+    self.worst    = None          # worst-case depth incl. callees
+    self.path     = []            # worst-case call path
+
+
+def read_source(filename):
+  """
+  read assembler source lines from .asm, or strip address/code columns from .rst/.lst
+  """
+  with open(filename, errors='replace') as f:
+    lines = f.read().splitlines()
+  if filename.endswith('.asm'):
+    return lines
+  src = []
+  for line in lines:
+    m = LST_LINE.match(line)
+    if m:
+      src.append(m.group(2))
+  return src
+
+
+def parse_module(filename, functions, taken, vectors, static):
+  """
+  parse one assembler file. Add functions, address-taken symbols, vectors and static data size
+  """
+  module = os.path.basename(filename)
+  area = None
+  func = None
+  pending = None
+  for raw in read_source(filename):
+    raw = raw.strip()
+
+    # function header comment
+    m = ASM_FUNCTION.match(raw)
+    if m:
+      pending = m.group(1)
+      continue
+
+    # vector table
+    m = ASM_VECTOR.match(raw)
+    if m:
+      if m.group(1).startswith('_'):
+        vectors[m.group(1)[1:]] = int(m.group(3)) if m.group(3) else m.group(2)
+      continue
+
+    # remove comment
+    line = raw.split(';', 1)[0].strip()
+    if not line:
+      continue
+
+    # area change
+    if line.startswith('.area'):
+      area = line.split()[1]
+      func = None
+      continue
+
+    # label, optionally followed by instruction
+    label = None
+    m = ASM_LABEL.match(line)
+    if m and not line.startswith('.'):
+      label, line = m.group(1), m.group(2)
+      if label.startswith('_') and (pending == label[1:] or (area == 'CODE' and not label.endswith('$'))):
+        name = label[1:]
+        if name in functions and functions[name].module != module:
+          sys.stderr.write('warning: %s defined in %s and %s, using first\n' % (name, functions[name].module, module))
+          func = None
+        else:
+          func = Function(name, module)
+          functions[name] = func
+        pending = None
+        label = None
+
+    # static data size
+    if area in DATA_AREAS and line.startswith('.ds'):
+      static[module] = static.get(module, 0) + int(line.split()[1], 0)
+      continue
+
+    # address of function taken (function pointer)
+    for sym in re.findall(r'#\(?_(\w+)|\.dw\s+_(\w+)', line):
+      taken.add(sym[0] or sym[1])
+
+    if func is None:
+      continue
+    if line.startswith('.dw'):
+      func.code.append((label, '.dw', line[3:].strip()))
+      continue
+    m = ASM_INSTR.match(line)
+    if m:
+      func.code.append((label, m.group(1), m.group(2).strip()))
+    elif label:
+      func.code.append((label, None, ''))
+
+
+def read_cdb(filename, functions):
+  """
+  read interrupt flags and numbers from .cdb debug file (SDCC option --debug)
+  """
+  with open(filename, errors='replace') as f:
+    for line in f:
+      m = CDB_FUNCTION.match(line)
+      if m and m.group(1) in functions and m.group(5) == '1':
+        functions[m.group(1)].isr = True
+        functions[m.group(1)].vector = int(m.group(6))
+
+
+def read_map(filename):
+  """
+  read size of static data areas from .map file. Return None if not found
+  """
+  size = None
+  with open(filename, errors='replace') as f:
+    for line in f:
+      m = MAP_AREA.match(line.strip())
+      if m and m.group(1) in DATA_AREAS:
+        size = (size or 0) + int(m.group(2))
+  return size
+
+
+def read_ram_size(config):
+  """
+  read RAM_SIZE from device header included in config.h. Board selection
+  via '#define BOARD' and '#if/#elif defined(BOARD)' is evaluated
+  """
+  defines = set()
+  active = [True]       # per #if level: branch active
+  taken = [True]        # per #if level: a branch was already active
+  with open(config) as f:
+    for line in f:
+      line = line.split('//', 1)[0].strip()
+      cond = re.match(r'#\s*(if|elif)\s+defined\s*\(?\s*(\w+)', line)
+      if cond and cond.group(1) == 'if':
+        hit = active[-1] and cond.group(2) in defines
+        active.append(hit)
+        taken.append(hit or not active[-2])
+        continue
+      if cond:
+        hit = not taken[-1] and cond.group(2) in defines
+        active[-1] = hit
+        taken[-1] = taken[-1] or hit
+        continue
+      if re.match(r'#\s*if', line):
+        active.append(active[-1])
+        taken.append(True)
+        continue
+      if re.match(r'#\s*else', line):
+        active[-1] = not taken[-1]
+        taken[-1] = True
+        continue
+      if re.match(r'#\s*endif', line):
+        active.pop()
+        taken.pop()
+        continue
+      if not active[-1]:
+        continue
+      d = re.match(r'#\s*define\s+(\w+)', line)
+      if d:
+        defines.add(d.group(1))
+      m = CFG_DEVICE.match(line)
+      if not m:
+        continue
+      header = os.path.normpath(os.path.join(os.path.dirname(config), m.group(1)))
+      with open(header) as h:
+        for l in h:
+          n = HDR_RAM.match(l)
+          if n:
+            return int(n.group(1)), os.path.basename(header)[:-2]
+  raise StackError('RAM_SIZE not found via %s, use option -r' % config)
+
+
+def jump_target(operands):
+  """
+  return label of jump instruction (last operand)
+  """
+  return operands.split(',')[-1].strip()
+
+
+def analyse_function(func, functions, trap):
+  """
+  follow all branches of function and record local depth and calls. 'trap' is the TRAP handler
+  """
+  labels = {}
+  for i, (label, mnem, ops) in enumerate(func.code):
+    if label:
+      labels[label] = i
+
+  # targets of switch jump tables (jp (x) with table of local labels)
+  switch = []
+  for (label, mnem, ops) in func.code:
+    if mnem == '.dw':
+      switch += [labels[t] for t in re.findall(r'#?([\w$]+)', ops) if t in labels]
+
+  seen = {}
+  work = [(0, 0)]
+  while work:
+    i, sp = work.pop()
+    while i < len(func.code):
+      if seen.get(i, -1) >= sp:
+        break
+      seen[i] = sp
+      label, mnem, ops = func.code[i]
+      i += 1
+      if mnem is None or mnem == '.dw':
+        continue
+      func.local = max(func.local, sp)
+
+      # stack pointer changes
+      if mnem == 'push':
+        sp += 1
+      elif mnem == 'pushw':
+        sp += 2
+      elif mnem == 'pop':
+        sp -= 1
+      elif mnem == 'popw':
+        sp -= 2
+      elif mnem == 'sub' and ops.replace(' ', '').startswith('sp,#'):
+        sp += int(ops.split('#')[1], 0)
+      elif mnem == 'addw' and ops.replace(' ', '').startswith('sp,#'):
+        sp -= int(ops.split('#')[1], 0)
+      elif mnem == 'ldw' and ops.replace(' ', '') in ('sp,x', 'sp,y') and func.name == trap:
+        func.switch = True
+        break
+      elif mnem in ('ldw', 'addw', 'subw') and ops.replace(' ', '').startswith('sp,'):
+        func.unknown = True
+      elif mnem == 'rim':
+        func.rim = True
+      func.local = max(func.local, sp)
+      if sp < 0 or sp > 0xFFFF:
+        func.unknown = True
+        break
+
+      # software interrupt: CPU context + TRAP handler
+      if mnem == 'trap':
+        func.calls.append((sp + ISR_CONTEXT, trap or 'TRAP'))
+        continue
+
+      # calls
+      if mnem in ('call', 'callr', 'callf'):
+        size = CALLF_SIZE if mnem == 'callf' else CALL_SIZE
+        target = ops.strip()
+        callee = target[1:] if target.startswith('_') else None
+        func.calls.append((sp + size, callee))
+        continue
+
+      # returns
+      if mnem in ('ret', 'retf', 'iret'):
+        if mnem == 'iret':
+          func.isr = True
+        break
+
+      # jumps
+      if mnem in ('jra', 'jrt', 'jp', 'jpf'):
+        target = jump_target(ops)
+        if target in labels:
+          i = labels[target]
+          continue
+        if target.startswith('_'):
+          func.calls.append((sp, target[1:]))
+        elif target.startswith('('):
+          for t in switch:
+            work.append((t, sp))
+        break
+      if mnem == 'jrf':
+        continue
+      if mnem.startswith('jr') or mnem in ('btjt', 'btjf'):
+        target = jump_target(ops)
+        if target in labels:
+          work.append((labels[target], sp))
+
+
+def worst_case(func, functions, indirect, external, missing, stack=()):
+  """
+  return worst-case depth of function incl. callees. Recursion raises StackError
+  """
+  if func.worst is not None:
+    return func.worst
+  if func.name in stack:
+    raise StackError('recursion: %s' % ' -> '.join(list(stack) + [func.name]))
+  stack = stack + (func.name,)
+  func.worst, func.path = func.local, []
+  for (depth, callee) in func.calls:
+    targets = [callee] if callee else indirect
+    for name in targets:
+      if name in functions:
+        d = depth + worst_case(functions[name], functions, indirect, external, missing, stack)
+        path = [name] + functions[name].path
+      else:
+        if name not in external:
+          missing.add(name)
+        d = depth + external.get(name, 0)
+        path = [name]
+      if d > func.worst:
+        func.worst, func.path = d, path
+  return func.worst
+
+
+def nesting(chain, isrs, prio, count):
+  """
+  return deepest chain of nested ISRs on top of 'chain' as (depth, [ISRs])
+  """
+  best = (0, [])
+  top = chain[-1] if chain else None
+  for isr in isrs:
+    if chain.count(isr) >= count.get(isr, 1):
+      continue
+    if top is not None and not (isrs[top].rim or prio[isr] > prio[top]):
+      continue
+    depth, sub = nesting(chain + [isr], isrs, prio, count)
+    depth += ISR_CONTEXT + isrs[isr].worst
+    if depth > best[0]:
+      best = (depth, [isr] + sub)
+  return best
+
+
+def main():
+  here = os.path.dirname(os.path.abspath(__file__))
+  parser = argparse.ArgumentParser(description='static stack depth and ISR nesting analyser for SDCC builds')
+  parser.add_argument('dir', nargs='?', default=os.path.join(here, '..', 'SDCC'), help='SDCC output directory (default: ../SDCC)')
+  parser.add_argument('-c', '--config', default=os.path.join(here, '..', 'config.h'), help='config.h with device header (default: ../config.h)')
+  parser.add_argument('-r', '--ram', type=int, help='RAM size [B] (default: RAM_SIZE of device header)')
+  parser.add_argument('-s', '--static', type=int, help='static data size [B] (default: from .map or .asm)')
+  parser.add_argument('-p', '--prio', action='append', default=[], metavar='ISR=LEVEL', help='ISR priority 1..3 (ITC_SPRx), default 3')
+  parser.add_argument('-n', '--nest', action='append', default=[], metavar='ISR=COUNT', help='max. nesting of ISR in itself (enables interrupts), default 1')
+  parser.add_argument('-e', '--extern', action='append', default=[], metavar='FUNC=BYTES', help='stack depth of external function, e.g. printf=80')
+  parser.add_argument('-t', '--thread', action='append', default=[], metavar='FUNC', help='thread function of preemptive kernel')
+  parser.add_argument('-k', '--kernel-entry', default='kernel_entry', metavar='FUNC', help='kernel function calling the threads (default: kernel_entry)')
+  parser.add_argument('-o', '--output', metavar='FILE', help='write thread stack sizes as STACK_<thread> to header')
+  parser.add_argument('-v', '--verbose', action='store_true', help='print all functions and worst-case call paths')
+  args = parser.parse_args()
+
+  try:
+    # find sources: .asm preferred, else .rst/.lst
+    sources = sorted(glob.glob(os.path.join(args.dir, '*.asm')))
+    if not sources:
+      sources = sorted(glob.glob(os.path.join(args.dir, '*.rst'))) or sorted(glob.glob(os.path.join(args.dir, '*.lst')))
+    if not sources:
+      raise StackError('no .asm/.rst/.lst files in %s' % args.dir)
+
+    # parse assembler sources
+    functions, taken, vectors, static = {}, set(), {}, {}
+    for src in sources:
+      parse_module(src, functions, taken, vectors, static)
+    for name in vectors:
+      if name in functions:
+        functions[name].vector = vectors[name]
+    for cdb in glob.glob(os.path.join(args.dir, '*.cdb')):
+      read_cdb(cdb, functions)
+    trap = ([n for n in vectors if vectors[n] == 'trap' and n in functions] + [None])[0]
+    for func in functions.values():
+      analyse_function(func, functions, trap)
+
+    # external depths and ISR priorities
+    external = {}
+    for e in args.extern:
+      name, size = e.split('=')
+      external[name.lstrip('_')] = int(size, 0)
+    isrs = dict((f.name, f) for f in functions.values() if f.isr and not f.switch)
+    prio = dict((name, PRIO_MAX) for name in isrs)
+    for p in args.prio:
+      name, level = p.split('=')
+      if name not in isrs:
+        raise StackError('unknown ISR %s' % name)
+      if int(level) not in (1, 2, 3):
+        raise StackError('priority of %s must be 1..3' % name)
+      prio[name] = int(level)
+    count = {}
+    for n in args.nest:
+      name, num = n.split('=')
+      if name not in isrs:
+        raise StackError('unknown ISR %s' % name)
+      count[name] = int(num)
+
+    # worst case per function. Function pointers may call any address-taken function
+    indirect = sorted(n for n in taken if n in functions and not functions[n].isr)
+    missing = set()
+    for func in functions.values():
+      worst_case(func, functions, indirect, external, missing)
+    for name in args.thread:
+      if name not in functions:
+        raise StackError('unknown thread %s' % name)
+
+    # propagate 'rim' from callees to callers
+    changed = True
+    while changed:
+      changed = False
+      for func in functions.values():
+        callees = [c for (d, c) in func.calls if c] + (indirect if any(c is None for (d, c) in func.calls) else [])
+        if not func.rim and any(c in functions and functions[c].rim for c in callees):
+          func.rim = changed = True
+
+    # RAM available for stack
+    if args.ram:
+      ram, device = args.ram, 'target'
+    else:
+      ram, device = read_ram_size(args.config)
+    data = args.static
+    if data is None:
+      maps = glob.glob(os.path.join(args.dir, '*.map'))
+      data = read_map(maps[0]) if maps else None
+    if data is None:
+      data = sum(static.values())
+  except (StackError, IOError, ValueError) as e:
+    sys.stderr.write('error: %s\n' % e)
+    sys.exit(1)
+  available = ram - data
+
+  # print functions
+  if args.verbose:
+    print('functions (local / worst-case incl. callees [B]):')
+    for func in sorted(functions.values(), key=lambda f: -f.worst):
+      print('  %-28s %4d %5d   %s' % (func.name, func.local, func.worst, ' -> '.join(func.path)))
+    if indirect:
+      print('targets of indirect calls: %s' % ', '.join(indirect))
+    print()
+
+  # main
+  if 'main' not in functions:
+    sys.stderr.write('error: main() not found\n')
+    sys.exit(1)
+  depth_main = functions['main'].worst
+  print('%s: RAM %d B, static data %d B, available for stack %d B' % (device, ram, data, available))
+  print()
+  print('  %-28s %6s %4s %6s' % ('entry', 'vector', 'prio', 'worst'))
+  print('  %-28s %6s %4s %6d' % ('main', '-', '0', depth_main))
+  for name in sorted(isrs, key=lambda n: str(isrs[n].vector)):
+    isr = isrs[name]
+    note = 'enables interrupts' if isr.rim else ''
+    print('  %-28s %6s %4d %6d   %s' % (name, isr.vector if isr.vector is not None else '?', prio[name], ISR_CONTEXT + isr.worst, note))
+    if args.verbose and isr.path:
+      print('  %-28s %s' % ('', ' -> '.join(isr.path)))
+
+  # worst-case nesting chain on top of main
+  depth, chain = nesting([], isrs, prio, count)
+  print()
+  print('worst-case nesting (incl. %d B context per ISR):' % ISR_CONTEXT)
+  total = depth_main
+  print('  level 0  %-28s %6d %6d' % ('main', depth_main, total))
+  for level, name in enumerate(chain):
+    total += ISR_CONTEXT + isrs[name].worst
+    print('  level %d  %-28s %+6d %6d' % (level + 1, name, ISR_CONTEXT + isrs[name].worst, total))
+
+  # threads: kernel entry + thread function + ISR nesting on thread stack
+  if args.thread:
+    entry = functions.get(args.kernel_entry)
+    start = max([d for (d, c) in entry.calls if c is None] or [CALL_SIZE]) if entry else CALL_SIZE
+    print()
+    print('threads (incl. %d B kernel entry, ISR nesting %d B):' % (start, depth))
+    sizes = []
+    for name in args.thread:
+      size = start + functions[name].worst + depth
+      sizes.append((name, size))
+      print('  %-28s %6d %6d' % (name, functions[name].worst, size))
+      if args.verbose and functions[name].path:
+        print('  %-28s %s' % ('', ' -> '.join(functions[name].path)))
+    if args.output:
+      guard = '_%s_' % re.sub(r'\W', '_', os.path.basename(args.output)).upper()
+      defines = ''.join('#define %-30s %d\n' % ('STACK_' + name, size) for (name, size) in sizes)
+      try:
+        with open(args.output, 'w') as f:
+          f.write(STACK_HEADER % (os.path.basename(args.output), guard, guard, defines, guard))
+      except IOError as e:
+        sys.stderr.write('error: %s\n' % e)
+        sys.exit(1)
+      print('thread stack sizes written to %s' % args.output)
+
+  # warnings
+  print()
+  unknown = sorted(f.name for f in functions.values() if f.unknown)
+  if unknown:
+    print('warning: unsupported stack pointer modification in %s' % ', '.join(unknown))
+  if missing:
+    print('warning: depth of external functions unknown (option -e): %s' % ', '.join(sorted(missing)))
+  status = 'OK' if total <= available else 'OVERFLOW'
+  print('worst-case stack %d B of %d B available (%d B reserve) -> %s%s' % (total, available, available - total, status, ', incomplete' if (missing or unknown) else ''))
+  sys.exit(0 if total <= available else 2)
+
+
+if __name__ == '__main__':
+  main()
@@ -0,0 +1,208 @@
+/**********************
+  Stack usage: static worst-case analysis vs. run-time measurement
+
+  supported hardware:
+    - Sduino Uno (https://github.com/roybaer/sduino_uno)
+    - Nucleo-8S208RB (https://www.st.com/en/evaluation-tools/nucleo-8s208rb.html)
+    - STM8L Discovery (https://www.st.com/en/evaluation-tools/stm8l-discovery.html)
+
+  Functionality:
+    - scheduler runs tasks in TIM4 ISR with interrupts enabled, i.e. UART ISR
+      nests on top of the task stack
+    - filter task every 10ms uses a local buffer and nested calls
+    - LED task toggles LED every 500ms
+    - stack high water mark (painted stack) is printed every 1s (19.2kBaud)
+    - compare with static analysis: make stack
+**********************/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "config.h"
+#include "Tasks.h"
+#include "stack.h"
+#define _MAIN_          // required for global variables
+  #include "uart.h"
+#undef _MAIN_
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+#define FILTER_SIZE   16                      // number of samples in filter task
+
+
+/*----------------------------------------------------------
+    GLOBAL VARIABLES
+----------------------------------------------------------*/
+
+/// filter result. Set in filter task
+volatile uint16_t   g_filter = 0;
+
+
+/*----------------------------------------------------------
+    FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn int putchar(int byte)
+
+  \brief output routine for printf()
+
+  \param[in]  data   byte to send
+
+  \return  sent byte
+
+  implementation of putchar() for printf(), using selected output channel.
+  Return type depends on used compiler (see respective stdio.h)
+*/
+#if defined(__CSMC__)
+  char putchar(char data) {
+#else // Standard C
+  int putchar(int data) {
+#endif
+
+  // send byte
+  UART_write(data);
+
+  // return sent byte
+  return(data);
+
+} // putchar
+
+
+
+/**
+  \fn uint16_t median3(uint16_t a, uint16_t b, uint16_t c)
+
+  \brief median of 3 values
+*/
+uint16_t median3(uint16_t a, uint16_t b, uint16_t c) {
+
+  if (a > b) { uint16_t t = a; a = b; b = t; }
+  if (b > c) b = c;
+  return((a > b) ? a : b);
+
+} // median3
+
+
+
+/**
+  \fn uint16_t filter(const uint16_t *buf, uint8_t len)
+
+  \brief median-3 filter and average of buffer
+*/
+uint16_t filter(const uint16_t *buf, uint8_t len) {
+
+  uint32_t  sum = 0;
+  uint8_t   i;
+
+  for (i=1; i<len-1; i++)
+    sum += median3(buf[i-1], buf[i], buf[i+1]);
+
+  return((uint16_t) (sum / (len-2)));
+
+} // filter
+
+
+
+/*----------------------------------------------------------
+    TASKS
+----------------------------------------------------------*/
+
+/// filter pseudo-random samples in local buffer. Call every 10ms
+void filter_task(void) {
+
+  uint16_t  buf[FILTER_SIZE];
+  uint8_t   i;
+
+  // fill buffer with TIM4 counter as pseudo-random samples
+  for (i=0; i<FILTER_SIZE; i++)
+    buf[i] = (uint16_t) (sfr_TIM4.CNTR.byte) * (i+1);
+
+  // nested calls add to stack depth
+  g_filter = filter(buf, FILTER_SIZE);
+
+} // filter_task
+
+
+/// toggle LED. Call every 500ms
+void led_task(void) {
+
+  #if defined(STM8L_DISCOVERY)
+    sfr_PORTE.ODR.ODR7 ^= 1;
+  #elif defined(SDUINO) || defined(NUCLEO_8S208RB)
+    sfr_PORTC.ODR.ODR5 ^= 1;
+  #endif
+
+} // led_task
+
+
+
+/////////////////
+//    main routine
+/////////////////
+void main (void) {
+
+  uint32_t  nextPrint = 0;
+
+  // disable interrupts
+  DISABLE_INTERRUPTS();
+
+  // fill unused stack with pattern
+  stack_paint();
+
+  // switch to 16MHz (default is 2MHz)
+  sfr_CLK.CKDIVR.byte = 0x00;
+
+  // configure LED pin as output
+  #if defined(STM8L_DISCOVERY)
+    sfr_PORTE.DDR.DDR7 = 1;     // input(=0) or output(=1)
+    sfr_PORTE.CR1.C17  = 1;     // input: 0=float, 1=pull-up; output: 0=open-drain, 1=push-pull
+  #elif defined(SDUINO) || defined(NUCLEO_8S208RB)
+    sfr_PORTC.DDR.DDR5 = 1;     // input(=0) or output(=1)
+    sfr_PORTC.CR1.C15  = 1;     // input: 0=float, 1=pull-up; output: 0=open-drain, 1=push-pull
+  #endif
+
+  // init UART for 19.2kBaud
+  UART_begin(19200);
+
+  // init scheduler and add tasks
+  Tasks_Init();
+  Tasks_Clear();
+  Tasks_Add(filter_task, 10, 0);
+  Tasks_Add(led_task, 500, 0);
+  Tasks_Start();
+
+  // enable interrupts
+  ENABLE_INTERRUPTS();
+
+  // print monitored range
+  printf("\nstack monitor: %d bytes below 0x%04x\n", (int) STACK_CHECK_SIZE, (int) (RAM_ADDR_END + 1));
+
+
+  // main loop
+  while(1) {
+
+    // print stack high water mark every 1s
+    if (millis() >= nextPrint) {
+      nextPrint += 1000;
+      printf("  stack used: %u bytes (filter %u)\n", stack_used(), g_filter);
+    }
+
+    // received a byte via UART (stored in receive ISR) -> echo
+    if (g_key) {
+      printf("received '%c'\n", (char) g_key);
+      g_key = 0;
+    }
+
+  } // main loop
+
+} // main
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
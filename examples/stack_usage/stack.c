@@ -0,0 +1,80 @@
+/**
+  \file stack.c
+
+  \author G. Icking-Konert
+  \date 2021-09-18
+  \version 0.1
+
+  \brief implementation of run-time stack usage measurement
+
+  implementation of stack painting and high water mark. For details see
+  stack.h
+*/
+
+/*----------------------------------------------------------
+    INCLUDE FILES
+----------------------------------------------------------*/
+#include "stack.h"
+
+
+/*----------------------------------------------------------
+    MACROS
+----------------------------------------------------------*/
+
+// lowest monitored address
+#define STACK_BOTTOM          ((uint8_t*) (RAM_ADDR_END + 1 - STACK_CHECK_SIZE))
+
+// bytes below current stack pointer which are not painted (frame of stack_paint())
+#define STACK_MARGIN          8
+
+
+/*----------------------------------------------------------
+    GLOBAL FUNCTIONS
+----------------------------------------------------------*/
+
+/**
+  \fn void stack_paint(void)
+
+  \brief fill unused stack with pattern
+
+  fill monitored stack from STACK_BOTTOM up to the current stack pointer
+  (address of local variable minus margin) with STACK_PATTERN.
+*/
+void stack_paint(void) {
+
+  volatile uint8_t  marker = 0;
+  uint8_t           *p;
+
+  // paint from bottom to current stack pointer
+  for (p = STACK_BOTTOM; p < (uint8_t*) &marker - STACK_MARGIN; p++)
+    *p = STACK_PATTERN;
+
+} // stack_paint
+
+
+
+/**
+  \fn uint16_t stack_used(void)
+
+  \brief get max. stack usage
+
+  \return max. stack usage [B] since stack_paint()
+
+  search lowest address with overwritten pattern. If the pattern is
+  overwritten at STACK_BOTTOM, the stack may exceed the monitored range.
+*/
+uint16_t stack_used(void) {
+
+  uint8_t   *p = STACK_BOTTOM;
+
+  // search first overwritten byte
+  while ((p <= (uint8_t*) RAM_ADDR_END) && (*p == STACK_PATTERN))
+    p++;
+
+  return((uint16_t) (RAM_ADDR_END + 1 - (uint16_t) p));
+
+} // stack_used
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE
+-----------------------------------------------------------------------------*/
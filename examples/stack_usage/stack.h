@@ -0,0 +1,66 @@
+/**
+  \file stack.h
+
+  \author G. Icking-Konert
+  \date 2021-09-18
+  \version 0.1
+
+  \brief declaration of run-time stack usage measurement
+
+  declaration of stack painting for comparison with the static analysis of
+  Utils/stack_depth.py. At start, stack_paint() fills the unused stack with
+  a pattern. stack_used() returns the max. stack usage so far (high water
+  mark), i.e. the lowest address where the pattern was overwritten.
+
+  The stack starts at RAM_ADDR_END and grows down. STACK_CHECK_SIZE bytes
+  below the stack top are monitored. They must not overlap static data,
+  i.e. STACK_CHECK_SIZE <= RAM_SIZE - static data (see output of
+  stack_depth.py).
+
+  \note the measured value is a lower limit of the worst case, e.g. if the
+        deepest ISR nesting did not occur yet. Use it to validate the analysis
+  \note call stack_paint() at start of main() with interrupts disabled
+*/
+
+/*-----------------------------------------------------------------------------
+    MODULE DEFINITION FOR MULTIPLE INCLUSION
+-----------------------------------------------------------------------------*/
+#ifndef _STACK_H_
+#define _STACK_H_
+
+
+/*-----------------------------------------------------------------------------
+    INCLUDE FILES
+-----------------------------------------------------------------------------*/
+#include <stdint.h>
+#include "config.h"
+
+
+/*-----------------------------------------------------------------------------
+    DEFINITION OF GLOBAL MACROS/#DEFINES
+-----------------------------------------------------------------------------*/
+
+// monitored stack size [B] below RAM_ADDR_END; can be overwritten via compiler option
+#ifndef STACK_CHECK_SIZE
+  #define STACK_CHECK_SIZE      512
+#endif
+
+// pattern for unused stack
+#define STACK_PATTERN           0xAA
+
+
+/*-----------------------------------------------------------------------------
+    DECLARATION OF GLOBAL FUNCTIONS
+-----------------------------------------------------------------------------*/
+
+/// fill unused part of monitored stack with STACK_PATTERN
+void      stack_paint(void);
+
+/// return max. stack usage [B] since stack_paint()
+uint16_t  stack_used(void);
+
+
+/*-----------------------------------------------------------------------------
+    END OF MODULE DEFINITION FOR MULTIPLE INLUSION
+-----------------------------------------------------------------------------*/
+#endif // _STACK_H_
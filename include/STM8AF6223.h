@@ -82,6 +82,12 @@
   #define ENTER_HALT()           _asm("halt")                         ///< put controller to HALT mode
   #define SW_RESET()             _asm("dc.b $75")                     ///< reset via illegal opcode (works for all devices)
 
+  // nestable critical sections (save/restore CC register), see CRITICAL SECTIONS below
+  #define ENTER_CRITICAL()       { uint8_t _cc = (uint8_t) _asm("push cc\n pop a"); _asm("sim");                                  ///< save CC and disable interrupts
+  #define EXIT_CRITICAL()        _asm("push a\n pop cc", _cc); }                                                                  ///< restore CC of ENTER_CRITICAL()
+  #define ENTER_CRITICAL_LEVEL(lvl) { uint8_t _cc = (uint8_t) _asm("push cc\n pop a"); _asm("push a\n pop cc", _CC_RAISE(_cc, lvl)); ///< save CC and raise CPU priority to 'lvl'
+  #define EXIT_CRITICAL_LEVEL()  _asm("push a\n pop cc", _cc); }                                                                  ///< restore CC of ENTER_CRITICAL_LEVEL()
+
   // data type in bit fields
   #define BITFIELD_UINT          unsigned int                         ///< data type in bit structs (follow C90 standard)
 
@@ -114,6 +120,12 @@
   #define ENTER_HALT()           __halt()                             ///< put controller to HALT mode
   #define SW_RESET()             __asm("dc8 0x75")                    ///< reset via illegal opcode (works for all devices)
 
+  // nestable critical sections (save/restore CC register), see CRITICAL SECTIONS below
+  #define ENTER_CRITICAL()       { __istate_t _cc = __get_interrupt_state(); __disable_interrupt();                               ///< save CC and disable interrupts
+  #define EXIT_CRITICAL()        __set_interrupt_state(_cc); }                                                                    ///< restore CC of ENTER_CRITICAL()
+  #define ENTER_CRITICAL_LEVEL(lvl) { __istate_t _cc = __get_interrupt_state(); __set_interrupt_state(_CC_RAISE(_cc, lvl));       ///< save CC and raise CPU priority to 'lvl'
+  #define EXIT_CRITICAL_LEVEL()  __set_interrupt_state(_cc); }                                                                    ///< restore CC of ENTER_CRITICAL_LEVEL()
+
   // data type in bit fields
   #define BITFIELD_UINT          unsigned char                        ///< data type in bit structs (deviating from C90 standard)
 
@@ -146,6 +158,17 @@
   #define ENTER_HALT()           __asm__("halt")                      ///< put controller to HALT mode
   #define SW_RESET()             __asm__(".db 0x75")                  ///< reset via illegal opcode (works for all devices)
 
+  // nestable critical sections via __critical block (push cc, sim ... pop cc), see CRITICAL SECTIONS below
+  #define ENTER_CRITICAL()       __critical {                         ///< save CC and disable interrupts
+  #define EXIT_CRITICAL()        }                                    ///< restore CC of ENTER_CRITICAL()
+  #define ENTER_CRITICAL_LEVEL(lvl) __critical { _CRITICAL_LEVEL_##lvl  ///< save CC and raise CPU priority to 'lvl' (literal 1..3)
+  #define EXIT_CRITICAL_LEVEL()  }                                    ///< restore CC of ENTER_CRITICAL_LEVEL()
+
+  // set CPU priority to max(CC saved by __critical at (1,sp), level). Interrupts are disabled on entry
+  #define _CRITICAL_LEVEL_1      __asm__("push a\n ld a, (2,sp)\n sll a\n sll a\n cpl a\n and a, (2,sp)\n and a, #0x20\n push a\n srl a\n srl a\n or a, (1,sp)\n xor a, (3,sp)\n addw sp, #1\n push a\n pop cc\n pop a")
+  #define _CRITICAL_LEVEL_2      __asm__("push a\n ld a, (2,sp)\n sll a\n sll a\n and a, (2,sp)\n and a, #0x20\n push a\n srl a\n srl a\n or a, (1,sp)\n addw sp, #1\n push a\n pop cc\n pop a")
+  #define _CRITICAL_LEVEL_3
+
   // data type in bit fields
   #define BITFIELD_UINT          unsigned int                         ///< data type in bit structs (follow C90 standard)
 
@@ -155,6 +178,152 @@
 #endif
 
 
+/*-------------------------------------------------------------------------
+  CRITICAL SECTIONS
+-------------------------------------------------------------------------*/
+
+// ENTER_CRITICAL() saves the CPU interrupt state (CC register) and disables interrupts,
+// EXIT_CRITICAL() restores the saved state. I.e. critical sections can be nested and
+// used in ISRs, unlike DISABLE_INTERRUPTS()/ENABLE_INTERRUPTS().
+// ENTER_CRITICAL_LEVEL(lvl) only raises the CPU priority to 'lvl' (1..3), i.e. ISRs with
+// a higher software priority (ITC_SPRx) stay enabled. If the CPU priority is already
+// >= lvl, it is not changed. Note: after reset all ISRs have priority 3.
+// Both open and close a block, i.e. use them pairwise in the same block and don't leave
+// the section via return, break or goto:
+//
+//   ENTER_CRITICAL();                 // or ENTER_CRITICAL_LEVEL(2);
+//     ...
+//   EXIT_CRITICAL();                  // or EXIT_CRITICAL_LEVEL();
+
+// CPU priority 0..3 of CC register (I1=bit 5, I0=bit 3): 10=0, 01=1, 00=2, 11=3
+#define _CC_LEVEL(cc)            ((uint8_t) ((((((cc) >> 2) ^ (cc)) & 0x08) ? 0 : 2) | (((cc) >> 3) & 0x01)))
+
+// CC bits I1/I0 for CPU priority 0..3
+#define _CC_BITS(lvl)            ((uint8_t) ((((lvl) & 0x01) ? 0x08 : 0x00) | ((((lvl) == 0) || ((lvl) == 3)) ? 0x20 : 0x00)))
+
+// CC with CPU priority raised to 'lvl', if lower
+#define _CC_RAISE(cc, lvl)       ((uint8_t) ((_CC_LEVEL(cc) >= (lvl)) ? (cc) : (((cc) & 0xD7) | _CC_BITS(lvl))))
+
+
+/*-------------------------------------------------------------------------
+  INTERRUPT PRIORITIES
+-------------------------------------------------------------------------*/
+
+// Software priority of interrupt vectors: 2 bits per vector in ITC_SPRx, encoded like
+// CC.I1:I0 (level 0 is reserved for main). After reset all vectors have level 3, i.e.
+// ISRs can't interrupt each other. ITC_SPRx can only be written with interrupts disabled.
+// ISR_SET_PRIORITY(vector, level) sets a single vector, level must be 1, 2 or 3:
+//
+//   ISR_SET_PRIORITY(_TIM4_OVR_UIF_VECTOR_, 1);
+//
+// ISR_SET_PRIORITIES(table) writes all ITC_SPRx from a compile-time table, i.e. one
+// constant write per register. Vectors not in the table are set to level 3:
+//
+//   #define MY_PRIORITIES(X,k)   X(k, _TIM4_OVR_UIF_VECTOR_, 1) X(k, _UART1_R_RXNE_VECTOR_, 3)
+//   ISR_SET_PRIORITIES(MY_PRIORITIES);
+
+#define ITC_SPR_ADDR             0x7F70          ///< address of 1st software priority register (vectors 0..3)
+#define ITC_SPR_NUM              8               ///< number of software priority registers
+
+// software priority levels for ISR_SET_PRIORITY()
+#define ISR_PRIORITY_1           0x01            ///< lowest ISR priority
+#define ISR_PRIORITY_2           0x00            ///< medium ISR priority
+#define ISR_PRIORITY_3           0x03            ///< highest ISR priority (reset value)
+
+// software priority register 'k' (0=vectors 0..3) and register / bit position of a vector
+#define _ITC_SPRK(k)             (((volatile uint8_t*) ITC_SPR_ADDR)[k])
+#define _ITC_SPR(vector)         _ITC_SPRK((vector) >> 2)
+#define _ITC_POS(vector)         (((vector) & 0x03) << 1)
+
+// ITC_SPRx bits for level 1..3. Other levels don't compile
+#define _ISR_PRIORITY(level)              ISR_PRIORITY_##level
+
+// set software priority of 'vector' to 'level' (1..3)
+#define ISR_SET_PRIORITY(vector, level)   (_ITC_SPR(vector) = (uint8_t) ((_ITC_SPR(vector) & ~(0x03 << _ITC_POS(vector))) | (_ISR_PRIORITY(level) << _ITC_POS(vector))))
+
+// value of software priority register 'k' from table. Evaluated by the compiler
+#define _ISR_SPR_CLR(k, vector, level)    | ((((vector) >> 2) == (k)) ? (0x03 << _ITC_POS(vector)) : 0)
+#define _ISR_SPR_SET(k, vector, level)    | ((((vector) >> 2) == (k)) ? (_ISR_PRIORITY(level) << _ITC_POS(vector)) : 0)
+#define ISR_SPR_VALUE(table, k)           ((uint8_t) ((0xFF & ~(0 table(_ISR_SPR_CLR, k))) | (0 table(_ISR_SPR_SET, k))))
+
+// write all software priority registers from table (see above). Call with interrupts disabled
+#define ISR_SET_PRIORITIES(table) do { \
+  _ITC_SPRK(0) = ISR_SPR_VALUE(table, 0); \
+  _ITC_SPRK(1) = ISR_SPR_VALUE(table, 1); \
+  _ITC_SPRK(2) = ISR_SPR_VALUE(table, 2); \
+  _ITC_SPRK(3) = ISR_SPR_VALUE(table, 3); \
+  _ITC_SPRK(4) = ISR_SPR_VALUE(table, 4); \
+  _ITC_SPRK(5) = ISR_SPR_VALUE(table, 5); \
+  _ITC_SPRK(6) = ISR_SPR_VALUE(table, 6); \
+  if (ITC_SPR_NUM > 7) \
+    _ITC_SPRK(7) = ISR_SPR_VALUE(table, 7); \
+} while (0)
+
+
+/*-------------------------------------------------------------------------
+  16-BIT REGISTER ACCESS
+-------------------------------------------------------------------------*/
+
+// 16-bit values are split into H/L byte registers, which must be accessed in a specific order:
+//   - timers: read and write MSB first. Reading CNTRH latches CNTRL, writing ARRH/CCRxH is
+//     buffered until the LSB is written
+//   - ADC with alignment option (STM8S/STM8A): read LSB first if right aligned (ALIGN=1), else MSB first
+//   - ADC w/o alignment option (STM8L): read MSB first
+// The accessors below use the order of the respective register (see table). An MSB first read
+// is a single ldw and thus atomic. Other single accesses are protected by a critical section:
+//
+//   READ16(val, sfr_TIM2, CNTR);          // val = TIM2 counter
+//   WRITE16(sfr_TIM2, ARR, 999);          // TIM2 auto-reload = 999
+//   READ16_BUF(buf, sfr_ADC1, DB0R, 4);   // buf[0..3] = ADC data buffer 0..3 (no critical section)
+//
+// Registers not in the table don't compile. For left aligned ADC use READ16_MSB() / READ16_BUF_MSB()
+
+// read/write 16-bit register via H/L registers 'h'/'l' or 'num' consecutive registers starting at 'h'
+#define _READ16_MSB_(var, h, l)           ((var) = *((volatile uint16_t*) &(h)))
+#define _READ16_LSB_(var, h, l)           do { uint8_t _l; ENTER_CRITICAL(); _l = (l).byte; (var) = (uint16_t) (((uint16_t) (h).byte << 8) | _l); EXIT_CRITICAL(); } while (0)
+#define _WRITE16_MSB_(h, l, val)          do { uint16_t _v = (val); ENTER_CRITICAL(); (h).byte = (uint8_t) (_v >> 8); (l).byte = (uint8_t) _v; EXIT_CRITICAL(); } while (0)
+#define _READ16_BUF_MSB_(dst, h, num)     do { uint8_t _i; volatile uint16_t *_p = (volatile uint16_t*) &(h); for (_i=0; _i<(num); _i++) (dst)[_i] = _p[_i]; } while (0)
+#define _READ16_BUF_LSB_(dst, h, num)     do { uint8_t _i, _l; volatile uint8_t *_p = (volatile uint8_t*) &(h); for (_i=0; _i<(num); _i++, _p+=2) { _l = _p[1]; (dst)[_i] = (uint16_t) (((uint16_t) _p[0] << 8) | _l); } } while (0)
+
+// select accessor via table entry _R16_<periph>_<reg>
+#define _R16_CAT(a, b)                    a##b
+#define _R16_SEL(a, b)                    _R16_CAT(a, b)
+
+// access 16-bit register 'reg' (w/o H/L) of peripheral 'periph' in correct order
+#define READ16(var, periph, reg)          _R16_SEL(_READ16, _R16_##periph##_##reg)(var, periph.reg##H, periph.reg##L)
+#define WRITE16(periph, reg, val)         _R16_SEL(_WRITE16, _R16_##periph##_##reg)(periph.reg##H, periph.reg##L, val)
+#define READ16_BUF(dst, periph, reg, num) _R16_SEL(_READ16_BUF, _R16_##periph##_##reg)(dst, periph.reg##H, num)
+
+// read MSB first, e.g. left aligned ADC
+#define READ16_MSB(var, periph, reg)            _READ16_MSB_(var, periph.reg##H, periph.reg##L)
+#define READ16_BUF_MSB(dst, periph, reg, num)   _READ16_BUF_MSB_(dst, periph.reg##H, num)
+
+// access order of 16-bit timer and ADC registers
+#define _R16_sfr_ADC_DB0R                 _LSB_
+#define _R16_sfr_ADC_DB1R                 _LSB_
+#define _R16_sfr_ADC_DB2R                 _LSB_
+#define _R16_sfr_ADC_DB3R                 _LSB_
+#define _R16_sfr_ADC_DB4R                 _LSB_
+#define _R16_sfr_ADC_DB5R                 _LSB_
+#define _R16_sfr_ADC_DB6R                 _LSB_
+#define _R16_sfr_ADC_DB7R                 _LSB_
+#define _R16_sfr_ADC_DB8R                 _LSB_
+#define _R16_sfr_ADC_DB9R                 _LSB_
+#define _R16_sfr_ADC_DR                   _LSB_
+#define _R16_sfr_TIM1_CNTR                _MSB_
+#define _R16_sfr_TIM1_PSCR                _MSB_
+#define _R16_sfr_TIM1_ARR                 _MSB_
+#define _R16_sfr_TIM1_CCR1                _MSB_
+#define _R16_sfr_TIM1_CCR2                _MSB_
+#define _R16_sfr_TIM1_CCR3                _MSB_
+#define _R16_sfr_TIM1_CCR4                _MSB_
+#define _R16_sfr_TIM5_CNTR                _MSB_
+#define _R16_sfr_TIM5_ARR                 _MSB_
+#define _R16_sfr_TIM5_CCR1                _MSB_
+#define _R16_sfr_TIM5_CCR2                _MSB_
+#define _R16_sfr_TIM5_CCR3                _MSB_
+
+
 /*-------------------------------------------------------------------------
   FOR CONVENIENT PIN ACCESS
 -------------------------------------------------------------------------*/